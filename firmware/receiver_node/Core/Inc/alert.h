@@ -0,0 +1,43 @@
+/**
+ * @file    alert.h
+ * @ingroup Receiver_Node
+ * @brief   Time-to-collision alerting on top of the zone ladder.
+ *
+ * The transmitter sends each sensor's closing velocity and whether its
+ * tracker is confident of it. For a confident velocity of at least
+ * ZONE_TTC_MIN_CLOSING_MM_S, the time to collision is looked up in the
+ * TTC curve of the zone table (Zone_TtcCm), which gives the distance of
+ * a parked obstacle that is as urgent. The closer of that distance and
+ * the measured one goes through the zone filter, so a fast approach gets
+ * the LEDs and buzzer cadence of a closer zone, and earlier, while a slow
+ * or uncertain one is indicated by distance alone, as before.
+ *
+ * The same rules are implemented by urgency_cm in gui/distance_logic.py.
+ */
+#ifndef __ALERT_H
+#define __ALERT_H
+
+#include <stdint.h>
+
+/** Time to collision reported when the obstacle is not closing in (ms) */
+#define ALERT_TTC_NONE      0xFFFFFFFFu
+
+/**
+ * @brief  Time to collision with an obstacle.
+ * @param  cm           Distance (cm).
+ * @param  closing_mm_s Closing velocity (mm/s), positive approaching.
+ * @retval Time to collision (ms), or ALERT_TTC_NONE if not closing in.
+ */
+uint32_t Alert_TtcMs(uint8_t cm, int16_t closing_mm_s);
+
+/**
+ * @brief  Distance to indicate for one sensor.
+ * @param  cm           Measured distance (cm).
+ * @param  closing_mm_s Closing velocity (mm/s), positive approaching.
+ * @param  confident    Non-zero if the velocity is confident.
+ * @retval The closer of the measured distance and the distance as urgent
+ *         as the time to collision (cm).
+ */
+uint8_t Alert_UrgencyCm(uint8_t cm, int16_t closing_mm_s, uint8_t confident);
+
+#endif /* __ALERT_H */
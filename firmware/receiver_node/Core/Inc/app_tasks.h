@@ -13,6 +13,80 @@
 #include "main.h"
 #include "cmsis_os.h"
 
+/* --------------------------------------------------------------------------
+ * CAN payload of the transmitter (StdId 0x103, TX_CAN_* on its side)
+ * -------------------------------------------------------------------------- */
+
+/** Number of sensors in the payload */
+#define RX_CAN_SENSORS          2u
+/** Offset of the filtered distance of each sensor (cm, u8) */
+#define RX_CAN_DISTANCE         0u
+/** Offset of the closing velocity of each sensor (mm/s, s16 little-endian,
+ *  positive approaching) */
+#define RX_CAN_CLOSING          RX_CAN_SENSORS
+/** Offset of the tracker flags (RX_CAN_FLAG_*) */
+#define RX_CAN_FLAGS            (3u * RX_CAN_SENSORS)
+/** Offset of the sample ages: a RX_CAN_AGE_BITS field per sensor, in
+ *  RX_CAN_AGE_UNIT_MS, at the time the frame was sent */
+#define RX_CAN_AGE              (3u * RX_CAN_SENSORS + 1u)
+
+/** Closing velocity of sensor i is confident */
+#define RX_CAN_FLAG_CONFIDENT(i)    (1u << (i))
+/** Reading of sensor i was dropped by the transmitter's classifier; the
+ *  distance is the filter's without it */
+#define RX_CAN_FLAG_DROPPED(i)      (1u << (RX_CAN_SENSORS + (i)))
+
+/** Width of each sample age field */
+#define RX_CAN_AGE_BITS         4u
+/** Unit of the sample ages (ms) */
+#define RX_CAN_AGE_UNIT_MS      16u
+
+/** Age of sensor i's sample when the frame was sent (ms) */
+#define RX_CAN_AGE_MS(data, i)  \
+    ((((data)[RX_CAN_AGE] >> (RX_CAN_AGE_BITS * (i))) & ((1u << RX_CAN_AGE_BITS) - 1u)) * RX_CAN_AGE_UNIT_MS)
+
+/* --------------------------------------------------------------------------
+ * Position payload of the transmitter (StdId RX_CAN_POSITION_ID,
+ * TX_CAN_POS_* on its side)
+ * -------------------------------------------------------------------------- */
+
+/** Identifier of the position frame */
+#define RX_CAN_POSITION_ID      0x105u
+/** Offset of the lateral offset of the obstacle (mm, s16 little-endian,
+ *  positive right of the bumper centre) */
+#define RX_CAN_POS_LATERAL      0u
+/** Offset of the distance of the obstacle from the bumper (mm, u16
+ *  little-endian) */
+#define RX_CAN_POS_FORWARD      2u
+/** Offset of the position flags (RX_CAN_POS_FLAG_*) */
+#define RX_CAN_POS_FLAGS        4u
+/** Offset of the sensor health, a nibble per sensor (sensor i in bits
+ *  4i..4i+3: RX_CAN_HEALTH_* level in the low two bits, RX_CAN_FAULT_* in
+ *  the high two); zero, all healthy, from a transmitter without it */
+#define RX_CAN_POS_HEALTH       5u
+/** Payload length */
+#define RX_CAN_POS_DLC          6u
+
+/** Both sensors see one obstacle and the position is valid */
+#define RX_CAN_POS_FLAG_VALID   0x01u
+
+/** Health levels (HEALTH_* on the transmitter side) */
+#define RX_CAN_HEALTH_OK        0u  /**< Readings trusted */
+#define RX_CAN_HEALTH_DEGRADED  1u  /**< Readings trusted, sensor wants attention */
+#define RX_CAN_HEALTH_POOR      2u  /**< Distances usable, velocities not */
+#define RX_CAN_HEALTH_FAILED    3u  /**< Readings not usable */
+
+/** Health faults (HEALTH_FAULT_* on the transmitter side) */
+#define RX_CAN_FAULT_TIMEOUT    0u  /**< No echo, not even out of range */
+#define RX_CAN_FAULT_NOISE      1u  /**< Scattered readings */
+#define RX_CAN_FAULT_STUCK      2u  /**< Frozen reading */
+#define RX_CAN_FAULT_XTALK      3u  /**< Readings of the other sensor */
+
+/** Health level of sensor i in the health byte */
+#define RX_CAN_HEALTH_LEVEL(health, i)  (((health) >> (4u * (i))) & 0x03u)
+/** Health fault of sensor i in the health byte */
+#define RX_CAN_HEALTH_FAULT(health, i)  (((health) >> (4u * (i) + 2u)) & 0x03u)
+
 /* --------------------------------------------------------------------------
  * FreeRTOS task handles
  * -------------------------------------------------------------------------- */
@@ -29,6 +103,9 @@ extern osThreadId_t buzzerTaskHandle;
 /** Handle for the LCD display task */
 extern osThreadId_t lcdTaskHandle;
 
+/** Handle for the stack monitor task */
+extern osThreadId_t monitorTaskHandle;
+
 /* --------------------------------------------------------------------------
  * FreeRTOS task function prototypes
  * -------------------------------------------------------------------------- */
@@ -69,4 +146,13 @@ void buzzerTask_init(void *argument);
  */
 void lcdTask_init(void *argument);
 
+/**
+ * @brief Stack monitor task.
+ *
+ * Samples the stack high-water mark of every task (see stack_mon.h).
+ *
+ * @param argument Pointer passed to the task (not used).
+ */
+void monitorTask_init(void *argument);
+
 #endif /* __APP_TASKS_H */
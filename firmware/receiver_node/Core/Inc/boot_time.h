@@ -0,0 +1,63 @@
+/**
+ * @file    boot_time.h
+ * @ingroup Receiver_Node
+ * @brief   Boot-phase timestamps from reset to the first indication.
+ *
+ * Boot_Start, called from SystemInit before the C start-up code runs,
+ * starts the DWT cycle counter at reset. Each Boot_Mark then converts the
+ * cycles since the previous mark at the core clock in effect over that
+ * interval (8 MHz HSI until SystemClock_Config, 72 MHz after), so every
+ * phase is timed in microseconds from reset. Only the first mark of a
+ * phase counts. The serial task reports the phases in FRAME_DIAG_BOOT
+ * records; tools/boot_report.py prints them as a timeline.
+ */
+#ifndef __BOOT_TIME_H
+#define __BOOT_TIME_H
+
+#include <stdint.h>
+
+/** Boot phases, in the order they are reached */
+typedef enum
+{
+    BOOT_MAIN = 0,          /**< main() entered: C start-up done */
+    BOOT_CLOCK,             /**< HAL and the 72 MHz clock ready */
+    BOOT_CAN,               /**< CAN started, reception enabled */
+    BOOT_PERIPH,            /**< Boot-path peripherals ready */
+    BOOT_SCHEDULER,         /**< First task running */
+    BOOT_FIRST_CAN,         /**< First distance frame received */
+    BOOT_FIRST_INDICATION,  /**< First zone indicated from received data */
+    BOOT_PHASE_COUNT
+} BootPhaseTypeDef;
+
+/**
+ * @brief Start the cycle counter at reset. Called from SystemInit, before
+ *        the C start-up code: touches no RAM.
+ */
+void Boot_Start(void);
+
+/**
+ * @brief Record the time since reset at which a phase is reached; later
+ *        marks of the same phase are ignored. Safe from interrupts.
+ * @param phase Boot phase.
+ */
+void Boot_Mark(BootPhaseTypeDef phase);
+
+/**
+ * @brief  Time since reset at which a phase was reached.
+ * @param  phase Boot phase.
+ * @retval Microseconds, 0 if not reached yet.
+ */
+uint32_t Boot_GetUs(BootPhaseTypeDef phase);
+
+/**
+ * @brief  Serialise the phase times for a FRAME_DIAG_BOOT record.
+ *
+ * Layout: phase count (u8), then the time of each phase in us since reset
+ * (u32, little-endian, 0 if not reached).
+ *
+ * @param  buf Output buffer of at least 1 + 4 * BOOT_PHASE_COUNT bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t Boot_Report(uint8_t *buf);
+
+#endif /* __BOOT_TIME_H */
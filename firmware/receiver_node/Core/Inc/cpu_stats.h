@@ -0,0 +1,57 @@
+/**
+ * @file    cpu_stats.h
+ * @ingroup Receiver_Node
+ * @brief   Per-task CPU load from the FreeRTOS run-time statistics.
+ *
+ * The run-time counter is the Cortex-M3 DWT cycle counter (see
+ * configureTimerForRunTimeStats in freertos.c), so the load is measured in
+ * CPU cycles. Each CpuStats_Update call reports the share of every task,
+ * including IDLE, over the cycles elapsed since the previous call. Calls
+ * must be less than one CYCCNT wrap apart (about 59 s at 72 MHz).
+ */
+#ifndef __CPU_STATS_H
+#define __CPU_STATS_H
+
+#include <stdint.h>
+
+/** Largest number of tasks reported */
+#define CPU_STATS_MAX_TASKS  7u
+
+/** Characters kept from each task name (NUL-padded, not terminated when full) */
+#define CPU_STATS_NAME_LEN   8u
+
+/** Load of one task */
+typedef struct
+{
+    char     name[CPU_STATS_NAME_LEN];  /**< Task name, truncated */
+    uint8_t  number;                    /**< Kernel task number (trace id) */
+    uint16_t permille;                  /**< Share of the elapsed cycles (0.1 %) */
+} CpuTaskLoadTypeDef;
+
+/** Load of all tasks over one measurement window */
+typedef struct
+{
+    uint32_t           cycles;                      /**< Window length (CPU cycles) */
+    uint8_t            count;                       /**< Number of tasks in task[] */
+    CpuTaskLoadTypeDef task[CPU_STATS_MAX_TASKS];   /**< Per-task load */
+} CpuLoadTypeDef;
+
+/**
+ * @brief Measure the load of every task since the previous call.
+ * @param load Filled with the result; count is 0 if there are more than
+ *             CPU_STATS_MAX_TASKS tasks.
+ */
+void CpuStats_Update(CpuLoadTypeDef *load);
+
+/**
+ * @brief  Measure the load and serialise it for a FRAME_DIAG_CPU record.
+ *
+ * Layout: task count, then per task the name (CPU_STATS_NAME_LEN bytes),
+ * the task number (u8) and the load in permille (u16, little-endian).
+ *
+ * @param  buf Output buffer of at least 1 + 11 * CPU_STATS_MAX_TASKS bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t CpuStats_Report(uint8_t *buf);
+
+#endif /* __CPU_STATS_H */
@@ -0,0 +1,122 @@
+/**
+ * @file    crash.h
+ * @ingroup Receiver_Node
+ * @brief   Crash context capture and fast restart.
+ *
+ * A HardFault, a failed configASSERT or Error_Handler saves the faulting
+ * PC, LR, fault status, the current task and a few words of its stack to
+ * a record in the last CRASH_AREA_SIZE bytes of RAM, then resets at once
+ * instead of spinning. The linker is given a RAM region that stops short
+ * of that area (see the Keil target memory settings), so neither the C
+ * library start-up nor any variable touches it across a reset.
+ *
+ * On the next boot Crash_Init reads the reset cause and moves a valid
+ * record out of the area; a watchdog reset without a record still gets one
+ * (see watchdog.h). The serial task reports it in FRAME_DIAG_CRASH records
+ * and tools/crash_report.py resolves the addresses against the map file.
+ */
+#ifndef __CRASH_H
+#define __CRASH_H
+
+#include <stdint.h>
+
+/** Bytes reserved for the crash area at the end of RAM */
+#define CRASH_AREA_SIZE     128u
+
+/** Start of the crash area (end of the STM32F103C6's 10 KB SRAM) */
+#define CRASH_AREA_ADDR     (0x20000000u + 10u * 1024u - CRASH_AREA_SIZE)
+
+/** Stack words saved after the exception frame */
+#define CRASH_STACK_WORDS   8u
+
+/** Task name characters saved */
+#define CRASH_NAME_LEN      12u
+
+/** Why the node restarted */
+typedef enum
+{
+    CRASH_NONE = 0,         /**< No crash record */
+    CRASH_HARDFAULT,        /**< HardFault (faults escalate to it) */
+    CRASH_ASSERT,           /**< configASSERT failed */
+    CRASH_ERROR,            /**< Error_Handler called */
+    CRASH_WATCHDOG          /**< Independent watchdog reset */
+} CrashReasonTypeDef;
+
+/** Context saved when the node crashed */
+typedef struct
+{
+    uint8_t  reason;                    /**< CrashReasonTypeDef */
+    uint8_t  task;                      /**< Kernel task number, 0 if none */
+    uint16_t line;                      /**< configASSERT line, 0 otherwise */
+    uint32_t pc;                        /**< Faulting or calling address */
+    uint32_t lr;                        /**< Link register */
+    uint32_t psr;                       /**< xPSR (IPSR != 0: in an interrupt) */
+    uint32_t cfsr;                      /**< SCB->CFSR */
+    uint32_t hfsr;                      /**< SCB->HFSR */
+    uint32_t sp;                        /**< Stack pointer before the fault */
+    uint32_t stack[CRASH_STACK_WORDS];  /**< Stack words above the frame */
+    char     name[CRASH_NAME_LEN];      /**< Task name, NUL-padded */
+} CrashRecordTypeDef;
+
+/** Return address of the calling function (for Error_Handler) */
+#if defined(__CC_ARM)
+#define CRASH_CALLER()      __return_address()
+#else
+#define CRASH_CALLER()      ((uint32_t)__builtin_return_address(0))
+#endif
+
+/**
+ * @brief Read the reset cause and take over the record of the previous
+ *        crash, if any. Call first thing in main().
+ */
+void Crash_Init(void);
+
+/**
+ * @brief  Record of the crash that caused the last reset.
+ * @retval The record, or NULL after a clean power-on or reset.
+ */
+const CrashRecordTypeDef *Crash_GetLast(void);
+
+/**
+ * @brief Save a record and reset the node.
+ * @param reason CrashReasonTypeDef.
+ * @param pc     Address to report (usually the caller's).
+ * @param line   Source line, 0 if none.
+ */
+void Crash_Halt(uint8_t reason, uint32_t pc, uint16_t line);
+
+/**
+ * @brief Failed configASSERT: save a record and reset the node.
+ * @param line Line of the assertion.
+ */
+void Crash_Assert(uint16_t line);
+
+/**
+ * @brief Save a record without resetting; it is dropped again by
+ *        Crash_Clear. Used by the watchdog supervisor before a reset that
+ *        it cannot prevent.
+ * @param reason CrashReasonTypeDef.
+ * @param task   Task to blame.
+ */
+void Crash_Save(uint8_t reason, void *task);
+
+/**
+ * @brief Drop a record saved with Crash_Save.
+ */
+void Crash_Clear(void);
+
+/**
+ * @brief  Serialise the record of the last crash for a FRAME_DIAG_CRASH
+ *         record.
+ *
+ * Layout (little-endian): reason (u8), task number (u8), line (u16),
+ * crash resets since power-on (u16), reset cause (u8: RCC_CSR bits 26-31),
+ * pc, lr, psr, cfsr, hfsr, sp (u32 each), CRASH_STACK_WORDS stack words
+ * (u32), task name (CRASH_NAME_LEN bytes).
+ *
+ * @param  buf Output buffer of at least 75 bytes.
+ * @retval Number of bytes written, 0 if there is no record.
+ */
+uint8_t Crash_Report(uint8_t *buf);
+
+#endif /* __CRASH_H */
@@ -0,0 +1,133 @@
+/**
+ * @file    frame.h
+ * @ingroup Receiver_Node
+ * @brief   Binary serial frame encoder for the GUI link.
+ *
+ * Each frame is COBS-encoded and terminated by a 0x00 delimiter, so the
+ * GUI can resynchronise on any zero byte. Before encoding, the frame holds
+ * (all fields little-endian):
+ *
+ * | Offset | Size | Field                                      |
+ * |--------|------|--------------------------------------------|
+ * | 0      | 1    | Version (FRAME_VERSION)                    |
+ * | 1      | 2    | Sequence number, +1 per frame              |
+ * | 3      | 4    | Capture timestamp of the newest data (ms)  |
+ * | 7      | 1    | Indicated zone (ZoneIdTypeDef)             |
+ * | 8      | 1    | Status flags (FRAME_FLAG_*)                |
+ * | 9      | 1    | Sensor count N                             |
+ * | 10     | 2*N  | Distance per sensor (mm)                   |
+ * | 10+2N  | 2*N  | Closing velocity per sensor (mm/s, signed, |
+ * |        |      | positive approaching)                      |
+ * | 10+4N  | 2*N  | Age of each distance (ms)                  |
+ * | 10+6N  | 1    | Confident velocities, bit i for sensor i   |
+ * | 11+6N  | 2    | Obstacle lateral offset (mm, signed,       |
+ * |        |      | positive right of the bumper centre)       |
+ * | 13+6N  | 2    | Obstacle distance from the bumper (mm), or |
+ * |        |      | FRAME_NO_POSITION                          |
+ * | 15+6N  | 2    | CRC-16/CCITT-FALSE over all previous bytes |
+ *
+ * The age counts from the echo to the frame, filter lag included, so the
+ * GUI can predict each distance to the present (predict.h). The obstacle
+ * position is the transmitter's trilateration of the two ranges
+ * (trilateration.h on its side), when it has a recent one.
+ *
+ * Diagnostic records share the framing: their first byte is a FRAME_DIAG_*
+ * identifier (0x80 and above) instead of the version, followed by a record
+ * specific payload and the CRC.
+ *
+ * The decoder lives in gui/frame_protocol.py.
+ */
+#ifndef __FRAME_H
+#define __FRAME_H
+
+#include <stdint.h>
+
+/** Frame layout version */
+#define FRAME_VERSION           3u
+
+/** Maximum number of sensor distances in one frame */
+#define FRAME_MAX_SENSORS       4u
+
+/** Obstacle distance when there is no position */
+#define FRAME_NO_POSITION       0xFFFFu
+
+/** No CAN data received recently; distances are stale */
+#define FRAME_FLAG_STALE        0x01u
+/** UART output was dropped since the previous frame */
+#define FRAME_FLAG_TX_OVERFLOW  0x02u
+/** A sensor is degraded or poor: its readings are kept, a poor one's
+ *  velocity is not trusted */
+#define FRAME_FLAG_SENSOR_DEGRADED  0x04u
+/** A sensor has failed: its readings are ignored by the indication */
+#define FRAME_FLAG_SENSOR_FAILED    0x08u
+
+/** Diagnostic record: task deadline statistics (Sched_Report) */
+#define FRAME_DIAG_SCHED        0x81u
+/** Diagnostic record: per-task CPU load (CpuStats_Report) */
+#define FRAME_DIAG_CPU          0x82u
+/** Diagnostic record: part of an event trace snapshot (Trace_Report) */
+#define FRAME_DIAG_TRACE        0x83u
+/** Diagnostic record: task stack high-water marks (StackMon_Report) */
+#define FRAME_DIAG_STACK        0x84u
+/** Diagnostic record: idle sleep residency and latency (Tickless_Report) */
+#define FRAME_DIAG_POWER        0x85u
+/** Diagnostic record: crash that caused the last reset (Crash_Report) */
+#define FRAME_DIAG_CRASH        0x86u
+/** Diagnostic record: boot-phase times since reset (Boot_Report) */
+#define FRAME_DIAG_BOOT         0x87u
+/** Diagnostic record: interrupt latency and duration (IsrStats_Report) */
+#define FRAME_DIAG_ISR          0x88u
+/** Diagnostic record: occupancy grid changes (see occupancy.h) */
+#define FRAME_DIAG_GRID         0x89u
+
+/** Largest diagnostic payload */
+#define FRAME_MAX_DIAG_PAYLOAD  80u
+
+/** Largest raw frame (identifier, payload and CRC) */
+#define FRAME_MAX_RAW           (1u + FRAME_MAX_DIAG_PAYLOAD + 2u)
+/** Largest encoded frame (COBS overhead and delimiter included) */
+#define FRAME_MAX_ENCODED       (FRAME_MAX_RAW + 2u)
+
+/** Contents of one frame */
+typedef struct
+{
+    uint16_t seq;                                /**< Sequence number */
+    uint32_t timestamp;                          /**< Capture time (ms) */
+    uint8_t  zone;                               /**< Indicated zone */
+    uint8_t  flags;                              /**< FRAME_FLAG_* bits */
+    uint8_t  count;                              /**< Number of distances */
+    uint16_t distance_mm[FRAME_MAX_SENSORS];     /**< Distances (mm) */
+    int16_t  closing_mm_s[FRAME_MAX_SENSORS];    /**< Closing velocities (mm/s) */
+    uint16_t age_ms[FRAME_MAX_SENSORS];          /**< Distance ages (ms) */
+    uint8_t  confident;                          /**< Confident velocity bits */
+    int16_t  lateral_mm;                         /**< Obstacle lateral offset (mm) */
+    uint16_t forward_mm;                         /**< Obstacle distance, or FRAME_NO_POSITION */
+} FrameTypeDef;
+
+/**
+ * @brief  Compute CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).
+ * @param  data Bytes to checksum.
+ * @param  len  Number of bytes.
+ * @retval CRC value.
+ */
+uint16_t Frame_Crc16(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief  Serialise, checksum and COBS-encode a frame.
+ * @param  frame Frame contents; count is clamped to FRAME_MAX_SENSORS.
+ * @param  out   Output buffer of at least FRAME_MAX_ENCODED bytes.
+ * @retval Number of bytes written, including the 0x00 delimiter.
+ */
+uint16_t Frame_Encode(const FrameTypeDef *frame, uint8_t *out);
+
+/**
+ * @brief  Checksum and COBS-encode a diagnostic record.
+ * @param  id      FRAME_DIAG_* identifier.
+ * @param  payload Record payload.
+ * @param  len     Payload length; clamped to FRAME_MAX_DIAG_PAYLOAD.
+ * @param  out     Output buffer of at least FRAME_MAX_ENCODED bytes.
+ * @retval Number of bytes written, including the 0x00 delimiter.
+ */
+uint16_t Frame_EncodeDiag(uint8_t id, const uint8_t *payload, uint8_t len, uint8_t *out);
+
+#endif /* __FRAME_H */
@@ -0,0 +1,114 @@
+/**
+ * @file    isr_stats.h
+ * @ingroup Receiver_Node
+ * @brief   Interrupt entry latency and duration histograms.
+ *
+ * Every IRQ handler brackets its body with ISR_STATS_ENTER/ISR_STATS_EXIT,
+ * which time it with the DWT cycle counter. Entry latency is only known
+ * where the hardware latches the time of the event: the timebase TIM
+ * callback reports the counter value, i.e. the time since the update
+ * event, with ISR_STATS_LATENCY. Both are kept per interrupt as min, sum,
+ * max and a histogram of ISR_STATS_BINS bins of ISR_STATS_BIN_CYCLES, from
+ * which the report derives the average and the 99th percentile.
+ *
+ * The serial task sends the statistics with each interrupt's NVIC
+ * priority in FRAME_DIAG_ISR records and restarts them;
+ * tools/isr_report.py prints them.
+ *
+ * Build with ISR_STATS_ENABLE=0 to compile the measurements out.
+ */
+#ifndef __ISR_STATS_H
+#define __ISR_STATS_H
+
+#include "main.h"
+
+#ifndef ISR_STATS_ENABLE
+#define ISR_STATS_ENABLE        1
+#endif
+
+/** Histogram bins; the last one also holds everything above it */
+#define ISR_STATS_BINS          16u
+
+/** Width of a histogram bin (CPU cycles, 0.89 us at 72 MHz) */
+#define ISR_STATS_BIN_CYCLES    64u
+
+/** CPU cycles per count of the 1 MHz timer counters */
+#define ISR_STATS_CYCLES_PER_COUNT  72u
+
+/** Measured interrupts */
+typedef enum
+{
+    ISR_STATS_TICK = 0,     /**< TIM2 timebase update (latency measured) */
+    ISR_STATS_CAN_RX,       /**< CAN RX FIFO 0 */
+    ISR_STATS_DMA_TX,       /**< USART2 TX DMA channel */
+    ISR_STATS_UART,         /**< USART2 */
+    ISR_STATS_COUNT
+} IsrStatsIdTypeDef;
+
+/** Summary of one histogram (CPU cycles) */
+typedef struct
+{
+    uint16_t count;         /**< Samples */
+    uint16_t min;           /**< Shortest */
+    uint16_t avg;           /**< Average */
+    uint16_t max;           /**< Longest */
+    uint16_t p99;           /**< 99th percentile, to one bin */
+} IsrStatsSummaryTypeDef;
+
+#if ISR_STATS_ENABLE
+
+/** Start timing an IRQ handler; must come first in its body */
+#define ISR_STATS_ENTER()               uint32_t isrStatsEntry = DWT->CYCCNT
+/** Stop timing an IRQ handler and record its duration */
+#define ISR_STATS_EXIT(id)              IsrStats_Duration((id), DWT->CYCCNT - isrStatsEntry)
+/** Record an entry latency, in 1 MHz timer counts since the event */
+#define ISR_STATS_LATENCY(id, counts)   IsrStats_Latency((id), (uint32_t)(counts) * ISR_STATS_CYCLES_PER_COUNT)
+
+#else
+
+#define ISR_STATS_ENTER()               ((void)0)
+#define ISR_STATS_EXIT(id)              ((void)0)
+#define ISR_STATS_LATENCY(id, counts)   ((void)0)
+
+#endif /* ISR_STATS_ENABLE */
+
+/**
+ * @brief Record the duration of one handler run.
+ * @param id     Interrupt.
+ * @param cycles Duration (CPU cycles).
+ */
+void IsrStats_Duration(IsrStatsIdTypeDef id, uint32_t cycles);
+
+/**
+ * @brief Record the entry latency of one interrupt.
+ * @param id     Interrupt.
+ * @param cycles Time from the event to the handler (CPU cycles).
+ */
+void IsrStats_Latency(IsrStatsIdTypeDef id, uint32_t cycles);
+
+/**
+ * @brief Collect the statistics of one interrupt since the previous call
+ *        and restart them.
+ * @param id       Interrupt.
+ * @param latency  Filled with the entry latency summary (count 0 if the
+ *                 latency of this interrupt is not measured).
+ * @param duration Filled with the duration summary.
+ */
+void IsrStats_Collect(IsrStatsIdTypeDef id, IsrStatsSummaryTypeDef *latency,
+                      IsrStatsSummaryTypeDef *duration);
+
+/**
+ * @brief  Collect the statistics of every interrupt and serialise them for
+ *         a FRAME_DIAG_ISR record.
+ *
+ * Layout (little-endian): interrupt count (u8), then per interrupt in
+ * IsrStatsIdTypeDef order: NVIC priority in bits 0-3 and bit 7 set if the
+ * latency was measured (u8), samples (u16), latency min, avg, max, p99
+ * (u16 each) and duration min, avg, max, p99 (u16 each), in CPU cycles.
+ *
+ * @param  buf Output buffer of at least 1 + 19 * ISR_STATS_COUNT bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t IsrStats_Report(uint8_t *buf);
+
+#endif /* __ISR_STATS_H */
@@ -11,6 +11,28 @@
 
 #include "main.h"
 
+/* --------------------------------------------------------------------------
+ * LED mask bits, in the order the bar graph fills up
+ * -------------------------------------------------------------------------- */
+#define LED_GREEN1  (1u << 0)
+#define LED_GREEN2  (1u << 1)
+#define LED_GREEN3  (1u << 2)
+#define LED_BLUE1   (1u << 3)
+#define LED_BLUE2   (1u << 4)
+#define LED_RED1    (1u << 5)
+#define LED_RED2    (1u << 6)
+
+/** All indicator LED pins on GPIOA */
+#define LED_PINS_A  (Green1_Pin | Green2_Pin | Blue2_Pin | Red1_Pin | Red2_Pin)
+/** All indicator LED pins on GPIOB */
+#define LED_PINS_B  (Green3_Pin | Blue1_Pin)
+
+/**
+ * @brief Drive all indicator LEDs from a bit mask.
+ * @param mask LED_* bits to light; every other LED is switched off.
+ */
+void leds_Set(uint8_t mask);
+
 /**
  * @brief Turn on LED pattern 1 (closest distance indication).
  */
@@ -26,6 +26,12 @@ extern "C" {
  */
 void Error_Handler(void);
 
+/**
+ * @brief  Initialises the peripherals left out of the fast-boot path.
+ * @retval None
+ */
+void MX_Deferred_Init(void);
+
 /* -------------------------------------------------------------------------- */
 /* GPIO Pin Definitions                                                       */
 /* -------------------------------------------------------------------------- */
@@ -114,6 +120,9 @@ extern CAN_HandleTypeDef hcan;
 /** UART2 peripheral handle (debug/serial output) */
 extern UART_HandleTypeDef huart2;
 
+/** Independent watchdog handle (see watchdog.h) */
+extern IWDG_HandleTypeDef hiwdg;
+
 /* -------------------------------------------------------------------------- */
 /* FreeRTOS Task Prototypes                                                    */
 /* -------------------------------------------------------------------------- */
@@ -0,0 +1,98 @@
+/**
+ * @file    occupancy.h
+ * @ingroup Receiver_Node
+ * @brief   Occupancy grid of the area behind the bumper.
+ *
+ * One distance per sensor says how far the nearest echo is, not where:
+ * the grid accumulates every measurement into OCC_COLS x OCC_ROWS cells
+ * (occupancy_table.h), so obstacles seen by several beams stand out where
+ * the beams agree. Each cell holds the log-odds of being occupied as an
+ * int8_t, in 1/16 nat: a measurement walks its sensor's beam from near to
+ * far, adding OCC_L_FREE to the cells short of the range and OCC_L_OCC to
+ * the cells at the range, within half a cell; a missing echo clears the
+ * whole beam. Values saturate at +/-OCC_L_MAX, and Occupancy_Decay pulls
+ * every cell back towards unknown (0), so a cell not seen for a while is
+ * forgotten instead of frozen.
+ *
+ * The grid reaches the GUI as deltas (Occupancy_Encode): each cell is sent
+ * as a 4-bit level, and only when its level differs from the one the GUI
+ * was last sent, run-length encoded:
+ *   - 0ccccccc  skip c + 1 cells, unchanged;
+ *   - 1LLLLccc  set c + 1 cells to level L.
+ * Cells that do not fit the record stay pending for the next one, and
+ * Occupancy_Resync sends the whole grid again from scratch.
+ *
+ * Updates and decay run in the default task and encoding in the serial
+ * task; a cell is a single byte, so encoding mid-update sends either its
+ * old or its new value and the next record catches up.
+ *
+ * Only depends on <stdint.h>; tools/occupancy_check.py compiles it on the
+ * host and checks the grid and its deltas against simulated scenes.
+ */
+#ifndef __OCCUPANCY_H
+#define __OCCUPANCY_H
+
+#include <stdint.h>
+#include "occupancy_table.h"
+
+/** Log-odds added to a cell at the measured range (1/16 nat) */
+#define OCC_L_OCC               12
+
+/** Log-odds added to a cell short of the measured range (1/16 nat) */
+#define OCC_L_FREE              (-5)
+
+/** Saturation of the log-odds either way (1/16 nat) */
+#define OCC_L_MAX               100
+
+/** Interval between two Occupancy_Decay calls (ms); each removes an
+ *  eighth of every cell's log-odds, plus one */
+#define OCC_DECAY_MS            250u
+
+/** Distance of a missing echo (cm) */
+#define OCC_NO_ECHO             0xFFu
+
+/** Level of a cell: its log-odds in steps of 16 (1 nat), from 1 for
+ *  certainly free through 8 for unknown to 14 for certainly occupied */
+#define OCC_LEVEL(l)            ((uint8_t)(((int16_t)(l) + 128) >> 4))
+
+/** Run header bit: set cells rather than skip them */
+#define OCC_RUN_SET             0x80u
+/** Longest skip run (cells) */
+#define OCC_RUN_SKIP_MAX        128u
+/** Longest set run (cells) */
+#define OCC_RUN_SET_MAX         8u
+
+/**
+ * @brief Clear the grid to unknown and schedule it to be sent whole.
+ */
+void Occupancy_Init(void);
+
+/**
+ * @brief Accumulate one measurement into the grid.
+ * @param sensor Sensor index, below OCC_SENSORS.
+ * @param cm     Measured distance (cm); OCC_NO_ECHO clears the beam.
+ */
+void Occupancy_Update(uint8_t sensor, uint8_t cm);
+
+/**
+ * @brief Decay every cell towards unknown, every OCC_DECAY_MS.
+ */
+void Occupancy_Decay(void);
+
+/**
+ * @brief Send every cell again, starting with the next record.
+ */
+void Occupancy_Resync(void);
+
+/**
+ * @brief  Run-length encode the cells changed since they were last sent.
+ *
+ * The cells written are marked as sent; the rest stay pending.
+ *
+ * @param  buf Output buffer.
+ * @param  max Size of buf (bytes).
+ * @retval Number of bytes written; 0 when no cell changed.
+ */
+uint8_t Occupancy_Encode(uint8_t *buf, uint8_t max);
+
+#endif /* __OCCUPANCY_H */
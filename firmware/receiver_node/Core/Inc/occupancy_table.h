@@ -0,0 +1,45 @@
+/**
+ * @file    occupancy_table.h
+ * @ingroup Receiver_Node
+ * @brief   Occupancy grid geometry shared with the GUI.
+ *
+ * Generated by tools/gen_occupancy_table.py - do not edit by hand.
+ *
+ * The grid is OCC_COLS cells across the bumper by OCC_ROWS away from it,
+ * each OCC_CELL_CM square; cell index is row * OCC_COLS + column, row 0
+ * against the bumper and column 0 on the left. The cells inside the beam
+ * of sensor s are occBeamCells[occBeamStart[s]] up to, not including,
+ * occBeamCells[occBeamStart[s + 1]], sorted by range.
+ */
+#ifndef __OCCUPANCY_TABLE_H
+#define __OCCUPANCY_TABLE_H
+
+#include <stdint.h>
+
+/** Cells across the bumper */
+#define OCC_COLS                16u
+/** Cells away from the bumper */
+#define OCC_ROWS                16u
+/** Number of cells */
+#define OCC_CELLS               (OCC_COLS * OCC_ROWS)
+/** Side of one cell (cm) */
+#define OCC_CELL_CM             10u
+/** Number of sensors */
+#define OCC_SENSORS             2u
+/** Entries in occBeamCells */
+#define OCC_BEAM_CELLS          284u
+
+/** One cell inside a sensor's beam */
+typedef struct
+{
+    uint8_t cell;       /**< Cell index */
+    uint8_t cm;         /**< Range of the cell centre from the sensor (cm) */
+} OccBeamCellTypeDef;
+
+/** Cells of every beam, sensor by sensor, each sorted by range */
+extern const OccBeamCellTypeDef occBeamCells[OCC_BEAM_CELLS];
+
+/** First entry of each sensor's beam in occBeamCells, and the end */
+extern const uint16_t occBeamStart[OCC_SENSORS + 1u];
+
+#endif /* __OCCUPANCY_TABLE_H */
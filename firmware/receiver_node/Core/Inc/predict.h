@@ -0,0 +1,47 @@
+/**
+ * @file    predict.h
+ * @ingroup Receiver_Node
+ * @brief   Latency-compensating range prediction.
+ *
+ * A distance reaches the LEDs tens to hundreds of milliseconds after the
+ * echo: the filter lag and the wait for the CAN slot on the transmitter,
+ * which it sends as the sample age, then the time since the frame arrived
+ * here. With the tracked closing velocity, the distance is extrapolated
+ * over that age to the present, so the indication keeps up with a steady
+ * approach without raising the sensor rate.
+ *
+ * Only a confident velocity is extrapolated. The age is clamped to
+ * PREDICT_MAX_AGE_MS, so lost frames do not run the distance away, and
+ * the correction to PREDICT_MAX_SHIFT_CM either way; the result stays a
+ * valid distance (0 to PREDICT_MAX_CM), and no-echo is passed through.
+ *
+ * The same rules are implemented by predict_cm in gui/distance_logic.py.
+ */
+#ifndef __PREDICT_H
+#define __PREDICT_H
+
+#include <stdint.h>
+
+/** Longest age extrapolated over (ms) */
+#define PREDICT_MAX_AGE_MS      300u
+
+/** Largest correction either way (cm) */
+#define PREDICT_MAX_SHIFT_CM    30
+
+/** Distance of a missing echo, passed through (cm) */
+#define PREDICT_NO_ECHO         0xFFu
+
+/** Farthest predicted distance (cm), short of PREDICT_NO_ECHO */
+#define PREDICT_MAX_CM          254u
+
+/**
+ * @brief  Extrapolate a distance to the present.
+ * @param  cm           Distance of the sample (cm), or PREDICT_NO_ECHO.
+ * @param  closing_mm_s Closing velocity (mm/s), positive approaching.
+ * @param  confident    Non-zero if the velocity is confident.
+ * @param  age_ms       Age of the sample (ms).
+ * @retval Predicted distance (cm).
+ */
+uint8_t Predict_Cm(uint8_t cm, int16_t closing_mm_s, uint8_t confident, uint32_t age_ms);
+
+#endif /* __PREDICT_H */
@@ -14,6 +14,9 @@
 
 #include "main.h"
 
+/** Segment encodings for digits 0-9 (GFEDCBA) */
+extern uint8_t segmentNumber[10];
+
 void SevenSegment_Update(uint8_t number);
 
 #endif /* __SEVENSEG_H */
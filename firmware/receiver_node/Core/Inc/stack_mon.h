@@ -0,0 +1,69 @@
+/**
+ * @file    stack_mon.h
+ * @ingroup Receiver_Node
+ * @brief   Task stack high-water-mark monitor.
+ *
+ * Every registered task's stack high-water mark (the least free stack the
+ * kernel has ever seen for it) is sampled by the monitor task every
+ * STACK_MON_PERIOD_MS. Tasks left with less than STACK_MON_MARGIN bytes
+ * are flagged in the report; tools/stack_report.py turns the reports into
+ * recommended stack sizes.
+ */
+#ifndef __STACK_MON_H
+#define __STACK_MON_H
+
+#include "cmsis_os.h"
+
+/** Largest number of monitored tasks */
+#define STACK_MON_MAX_TASKS  7u
+
+/** Free stack below which a task is flagged (bytes) */
+#ifndef STACK_MON_MARGIN
+#define STACK_MON_MARGIN     64u
+#endif
+
+/** Sampling period of the monitor task (ms) */
+#define STACK_MON_PERIOD_MS  500u
+
+/** Stack usage of one task */
+typedef struct
+{
+    osThreadId_t thread;        /**< Monitored task */
+    uint16_t     size;          /**< Stack size (bytes) */
+    uint16_t     min_free;      /**< Least free stack seen (bytes) */
+    uint8_t      number;        /**< Kernel task number (trace id) */
+} StackMonEntryTypeDef;
+
+/**
+ * @brief Add a task to the monitor.
+ * @param thread     Task handle; ignored if NULL or the table is full.
+ * @param stack_size Stack size given when the task was created (bytes).
+ */
+void StackMon_Register(osThreadId_t thread, uint32_t stack_size);
+
+/**
+ * @brief Add the kernel's idle and timer service tasks to the monitor.
+ * @note  Call once the scheduler is running.
+ */
+void StackMon_RegisterKernelTasks(void);
+
+/**
+ * @brief  Sample the high-water mark of every registered task.
+ * @retval Bit mask of the tasks (in registration order) under the margin.
+ */
+uint8_t StackMon_Sample(void);
+
+/**
+ * @brief  Serialise the latest sample for a FRAME_DIAG_STACK record.
+ *
+ * Layout: margin in bytes (u16), mask of tasks under the margin (u8),
+ * task count, then per task the kernel task number (u8), the stack size
+ * and the least free stack seen, in bytes (u16 each, little-endian).
+ * Task names are in the FRAME_DIAG_CPU record under the same numbers.
+ *
+ * @param  buf Output buffer of at least 4 + 5 * STACK_MON_MAX_TASKS bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t StackMon_Report(uint8_t *buf);
+
+#endif /* __STACK_MON_H */
@@ -0,0 +1,115 @@
+/**
+ * @file    task_sched.h
+ * @ingroup Receiver_Node
+ * @brief   Periodic task table, priority assignment and deadline monitor.
+ *
+ * Every receiver task is listed in schedTable with its period, relative
+ * deadline and execution budget. Priorities are derived from the table
+ * (deadline-monotonic: shorter deadline, higher priority; ties go to the
+ * earlier entry) when the tasks are created. Each task runs as
+ *
+ * @code
+ * Sched_Start(SCHED_xxx);
+ * for (;;)
+ * {
+ *     ... one job ...
+ *     Sched_WaitNextPeriod(SCHED_xxx);
+ * }
+ * @endcode
+ *
+ * and every job's response time is checked against its deadline. Ending
+ * a job also checks the task in with the watchdog (watchdog.h).
+ * tools/sched_check.py reads the same table for an offline check.
+ */
+#ifndef __TASK_SCHED_H
+#define __TASK_SCHED_H
+
+#include "main.h"
+#include "cmsis_os.h"
+
+/** Priority given to the lowest-ranked task; higher ranks count up */
+#define SCHED_BASE_PRIORITY  osPriorityNormal
+
+/** Stack buffer and its size in bytes, for one schedTable row */
+#define SCHED_STACK(buf)     (buf), sizeof(buf)
+
+/** Task identifiers, in schedTable order */
+typedef enum
+{
+    SCHED_DEFAULT = 0,
+    SCHED_SERIAL,
+    SCHED_BUZZER,
+    SCHED_LCD,
+    SCHED_MONITOR,
+    SCHED_TASK_COUNT
+} SchedTaskIdTypeDef;
+
+/** Static description of one periodic task */
+typedef struct
+{
+    const char    *name;        /**< Thread name */
+    osThreadFunc_t entry;       /**< Thread function */
+    uint64_t      *stack;       /**< Statically allocated stack */
+    uint32_t       stack_size;  /**< Stack size in bytes */
+    uint32_t       period;      /**< Release period (ms) */
+    uint32_t       deadline;    /**< Relative deadline (ms) */
+    uint32_t       wcet_us;     /**< Execution budget per job (us) */
+    osThreadId_t  *handle;      /**< Where the created handle is stored */
+} SchedTaskTypeDef;
+
+/** Runtime statistics of one periodic task */
+typedef struct
+{
+    uint32_t release;           /**< Release tick of the current job */
+    uint32_t jobs;              /**< Completed jobs */
+    uint32_t misses;            /**< Jobs that finished after the deadline */
+    uint32_t worst_response;    /**< Longest response time seen (ms) */
+} SchedStatsTypeDef;
+
+/** Task table, indexed by SchedTaskIdTypeDef */
+extern const SchedTaskTypeDef schedTable[SCHED_TASK_COUNT];
+
+/**
+ * @brief Create all tasks in schedTable with derived priorities, using
+ *        static control blocks and stacks.
+ */
+void Sched_CreateTasks(void);
+
+/**
+ * @brief Priority assigned to a task by Sched_CreateTasks.
+ * @param id Task identifier.
+ */
+osPriority_t Sched_GetPriority(SchedTaskIdTypeDef id);
+
+/**
+ * @brief Mark the release of a task's first job; the first call marks
+ *        BOOT_SCHEDULER.
+ * @param id Task identifier.
+ */
+void Sched_Start(SchedTaskIdTypeDef id);
+
+/**
+ * @brief End the current job, record its response time and sleep until
+ *        the next release.
+ * @param id Task identifier.
+ */
+void Sched_WaitNextPeriod(SchedTaskIdTypeDef id);
+
+/**
+ * @brief Runtime statistics of a task.
+ * @param id Task identifier.
+ */
+const SchedStatsTypeDef *Sched_GetStats(SchedTaskIdTypeDef id);
+
+/**
+ * @brief  Serialise the statistics for a FRAME_DIAG_SCHED record.
+ *
+ * Layout: task count, then per task priority (u8), deadline misses (u16)
+ * and worst response time in ms (u16), little-endian.
+ *
+ * @param  buf Output buffer of at least 1 + 5 * SCHED_TASK_COUNT bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t Sched_Report(uint8_t *buf);
+
+#endif /* __TASK_SCHED_H */
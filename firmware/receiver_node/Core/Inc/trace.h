@@ -0,0 +1,145 @@
+/**
+ * @file    trace.h
+ * @ingroup Receiver_Node
+ * @brief   RAM ring trace of RTOS and application events.
+ *
+ * Every event is 8 bytes: DWT cycle timestamp, event type, an id (task
+ * number, exception number or marker) and a 16-bit argument. The kernel
+ * hooks below are pulled into FreeRTOS through FreeRTOSConfig.h; ISRs and
+ * application code use TRACE_ISR_ENTER/EXIT and TRACE_MARK.
+ *
+ * The ring keeps the newest TRACE_BUFFER_EVENTS events. TRACE_FREEZE stops
+ * recording so the snapshot can be sent out; Trace_Resume clears it and
+ * records again. tools/trace_export.py turns a snapshot into Chrome/Perfetto
+ * trace JSON.
+ *
+ * Build with TRACE_ENABLE=0 to compile all of it out.
+ */
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <stdint.h>
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE         1
+#endif
+
+/** Events kept in the ring (8 bytes each) */
+#define TRACE_BUFFER_EVENTS  128u
+
+/** Events per FRAME_DIAG_TRACE record */
+#define TRACE_CHUNK_EVENTS   9u
+
+/** Event types */
+#define TRACE_EV_TASK_IN       0x01u  /**< id: task number */
+#define TRACE_EV_TASK_OUT      0x02u  /**< id: task number */
+#define TRACE_EV_ISR_ENTER     0x03u  /**< id: exception number */
+#define TRACE_EV_ISR_EXIT      0x04u  /**< id: exception number */
+#define TRACE_EV_QUEUE_SEND    0x05u  /**< arg: queue address, low 16 bits */
+#define TRACE_EV_QUEUE_RECEIVE 0x06u  /**< arg: queue address, low 16 bits */
+#define TRACE_EV_NOTIFY        0x07u  /**< id: notified task number */
+#define TRACE_EV_NOTIFY_TAKE   0x08u  /**< id: task number */
+#define TRACE_EV_MARK          0x10u  /**< id: TRACE_MARK_*, arg: marker data */
+
+/** Application markers (TRACE_EV_MARK ids), shared by both nodes */
+#define TRACE_MARK_TRIGGER     1u     /**< Ultrasonic trigger, arg: sensor */
+#define TRACE_MARK_ECHO        2u     /**< Echo captured, arg: distance (cm) */
+#define TRACE_MARK_CAN_TX      3u     /**< CAN frame queued, arg: StdId */
+#define TRACE_MARK_CAN_RX      4u     /**< CAN frame received, arg: StdId */
+#define TRACE_MARK_GPIO        5u     /**< Indicator output update, arg: value */
+
+/** One recorded event */
+typedef struct
+{
+    uint32_t cycles;    /**< DWT CYCCNT at the event */
+    uint8_t  type;      /**< TRACE_EV_* */
+    uint8_t  id;        /**< Task, exception or marker id */
+    uint16_t arg;       /**< Event argument */
+} TraceEventTypeDef;
+
+#if TRACE_ENABLE
+
+/**
+ * @brief Append an event to the ring (no-op while frozen). Callable from
+ *        tasks, ISRs and kernel hooks.
+ * @param type TRACE_EV_* type.
+ * @param id   Task, exception or marker id.
+ * @param arg  Event argument.
+ */
+void Trace_Record(uint8_t type, uint8_t id, uint16_t arg);
+
+/** @brief Record entry into the current exception handler. */
+void Trace_IsrEnter(void);
+
+/** @brief Record exit from the current exception handler. */
+void Trace_IsrExit(void);
+
+/** @brief Stop recording and keep the current snapshot. */
+void Trace_Freeze(void);
+
+/** @brief Non-zero while recording is stopped. */
+uint8_t Trace_IsFrozen(void);
+
+/** @brief Number of events in the snapshot. */
+uint16_t Trace_Count(void);
+
+/**
+ * @brief Copy one event of the snapshot.
+ * @param index Event index, 0 being the oldest.
+ * @param event Destination.
+ */
+void Trace_Read(uint16_t index, TraceEventTypeDef *event);
+
+/** @brief Discard the snapshot and start recording again. */
+void Trace_Resume(void);
+
+/**
+ * @brief  Serialise part of the snapshot for a FRAME_DIAG_TRACE record.
+ *
+ * Layout: index of the first event (u16), snapshot length (u16), then up
+ * to TRACE_CHUNK_EVENTS events as cycles (u32), type, id, arg (u16), all
+ * little-endian.
+ *
+ * @param  first Index of the first event to include.
+ * @param  buf   Output buffer of at least 4 + 8 * TRACE_CHUNK_EVENTS bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t Trace_Report(uint16_t first, uint8_t *buf);
+
+#define TRACE_MARK(id, arg)   Trace_Record(TRACE_EV_MARK, (id), (uint16_t)(arg))
+#define TRACE_ISR_ENTER()     Trace_IsrEnter()
+#define TRACE_ISR_EXIT()      Trace_IsrExit()
+#define TRACE_FREEZE()        Trace_Freeze()
+
+/* FreeRTOS hooks; expanded inside tasks.c and queue.c */
+#define traceTASK_SWITCHED_IN() \
+    Trace_Record(TRACE_EV_TASK_IN, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_SWITCHED_OUT() \
+    Trace_Record(TRACE_EV_TASK_OUT, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceQUEUE_SEND(pxQueue) \
+    Trace_Record(TRACE_EV_QUEUE_SEND, 0, (uint16_t)(uint32_t)(pxQueue))
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+    Trace_Record(TRACE_EV_QUEUE_SEND, 1, (uint16_t)(uint32_t)(pxQueue))
+#define traceQUEUE_RECEIVE(pxQueue) \
+    Trace_Record(TRACE_EV_QUEUE_RECEIVE, 0, (uint16_t)(uint32_t)(pxQueue))
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) \
+    Trace_Record(TRACE_EV_QUEUE_RECEIVE, 1, (uint16_t)(uint32_t)(pxQueue))
+#define traceTASK_NOTIFY() \
+    Trace_Record(TRACE_EV_NOTIFY, (uint8_t)pxTCB->uxTCBNumber, 0)
+#define traceTASK_NOTIFY_FROM_ISR() \
+    Trace_Record(TRACE_EV_NOTIFY, (uint8_t)pxTCB->uxTCBNumber, 1)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR() \
+    Trace_Record(TRACE_EV_NOTIFY, (uint8_t)pxTCB->uxTCBNumber, 1)
+#define traceTASK_NOTIFY_TAKE() \
+    Trace_Record(TRACE_EV_NOTIFY_TAKE, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+
+#else
+
+#define TRACE_MARK(id, arg)   ((void)0)
+#define TRACE_ISR_ENTER()     ((void)0)
+#define TRACE_ISR_EXIT()      ((void)0)
+#define TRACE_FREEZE()        ((void)0)
+
+#endif /* TRACE_ENABLE */
+
+#endif /* __TRACE_H */
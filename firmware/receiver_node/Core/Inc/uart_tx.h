@@ -0,0 +1,57 @@
+/**
+ * @file    uart_tx.h
+ * @ingroup Receiver_Node
+ * @brief   Non-blocking UART transmit driver (ring buffer drained by DMA).
+ *
+ * Tasks copy outgoing bytes into a ring buffer and return immediately.
+ * The buffer is drained with HAL_UART_Transmit_DMA, chaining the next
+ * contiguous chunk from the transmit-complete callback. When the buffer
+ * is full the message is dropped and counted instead of blocking.
+ */
+#ifndef __UART_TX_H
+#define __UART_TX_H
+
+#include "main.h"
+
+/** Ring buffer size in bytes (must be a power of two) */
+#define UART_TX_BUFFER_SIZE  128u
+
+/**
+ * @brief Attach the driver to a UART whose TX DMA channel is linked.
+ * @param huart UART handle to transmit on.
+ */
+void UartTx_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Queue bytes for transmission without blocking.
+ *
+ * The message is queued whole or not at all. Must be called from task
+ * context.
+ *
+ * @param data Bytes to send.
+ * @param len  Number of bytes.
+ * @retval Number of bytes queued (len, or 0 on overflow).
+ */
+uint16_t UartTx_Write(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief  Free space in the buffer.
+ *
+ * Only grows until the next write, so a writer can size a message to fit.
+ *
+ * @retval Bytes that can be queued now.
+ */
+uint16_t UartTx_GetFree(void);
+
+/**
+ * @brief Number of messages dropped because the buffer was full.
+ */
+uint32_t UartTx_GetOverflowCount(void);
+
+/**
+ * @brief Transmit-complete hook, called from HAL_UART_TxCpltCallback.
+ * @param huart UART handle that completed.
+ */
+void UartTx_TxCpltCallback(UART_HandleTypeDef *huart);
+
+#endif /* __UART_TX_H */
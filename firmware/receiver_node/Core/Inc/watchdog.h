@@ -0,0 +1,58 @@
+/**
+ * @file    watchdog.h
+ * @ingroup Receiver_Node
+ * @brief   Independent watchdog fed by a task-liveness check.
+ *
+ * The IWDG runs from the LSI oscillator, independent of the system clock,
+ * and resets the node unless it is refreshed within WATCHDOG_TIMEOUT_MS.
+ * It is only refreshed by Watchdog_Supervise (monitor task) when every
+ * registered task has called Watchdog_Checkin since the previous check,
+ * so a task that hangs, or is starved by a higher-priority one, resets the
+ * node as surely as a hung CPU. After WATCHDOG_RECORD_AFTER failed checks
+ * the stuck task's saved context is written as a crash record (crash.h),
+ * so the next boot reports which task stopped and where.
+ */
+#ifndef __WATCHDOG_H
+#define __WATCHDOG_H
+
+#include "main.h"
+#include "cmsis_os.h"
+
+/** Nominal timeout; the LSI (30-60 kHz) makes it 1.3 s to 2.7 s */
+#define WATCHDOG_TIMEOUT_MS     2000u
+
+/** Nominal LSI frequency (Hz) */
+#define WATCHDOG_LSI_HZ         40000u
+
+/** IWDG prescaler, and the divider it selects */
+#define WATCHDOG_PRESCALER      IWDG_PRESCALER_32
+#define WATCHDOG_DIVIDER        32u
+
+/** IWDG reload value for WATCHDOG_TIMEOUT_MS (12 bits) */
+#define WATCHDOG_RELOAD         (WATCHDOG_TIMEOUT_MS * (WATCHDOG_LSI_HZ / WATCHDOG_DIVIDER) / 1000u)
+
+/** Largest number of supervised tasks */
+#define WATCHDOG_MAX_TASKS      7u
+
+/** Failed checks after which the stuck task is recorded */
+#define WATCHDOG_RECORD_AFTER   2u
+
+/**
+ * @brief Supervise a task; it must call Watchdog_Checkin at least once
+ *        per supervision period from then on.
+ * @param thread Task handle; ignored if NULL or the table is full.
+ */
+void Watchdog_Register(osThreadId_t thread);
+
+/**
+ * @brief Report the calling task alive.
+ */
+void Watchdog_Checkin(void);
+
+/**
+ * @brief Refresh the IWDG if every supervised task checked in since the
+ *        previous call. Call periodically, well within the timeout.
+ */
+void Watchdog_Supervise(void);
+
+#endif /* __WATCHDOG_H */
@@ -0,0 +1,40 @@
+/**
+ * @file    zone_filter.h
+ * @ingroup Receiver_Node
+ * @brief   Hysteresis and dwell filter on top of the zone lookup table.
+ *
+ * Moving to a closer zone is indicated immediately. Moving to a farther
+ * zone requires the distance to exceed the current zone's release limit
+ * (zoneRelease) continuously for ZONE_DWELL_MS, which keeps sensor jitter
+ * near a threshold from toggling the LEDs and buzzer cadence.
+ */
+#ifndef __ZONE_FILTER_H
+#define __ZONE_FILTER_H
+
+#include <stdint.h>
+#include "zone_table.h"
+
+/** Filter state for one indication channel */
+typedef struct
+{
+    const ZoneEntryTypeDef *entry;  /**< Entry currently indicated */
+    uint32_t pendingSince;          /**< Tick at which a release was first seen */
+    uint8_t  pending;               /**< Non-zero while a release is being timed */
+} ZoneFilterTypeDef;
+
+/**
+ * @brief Reset a filter to the farthest zone.
+ * @param filter Filter state to initialise.
+ */
+void ZoneFilter_Init(ZoneFilterTypeDef *filter);
+
+/**
+ * @brief Feed one distance sample through the filter.
+ * @param filter Filter state.
+ * @param cm     Distance in centimetres.
+ * @param now    Current time in ms (e.g. HAL_GetTick()).
+ * @retval Non-zero if the indicated zone changed on this sample.
+ */
+uint8_t ZoneFilter_Update(ZoneFilterTypeDef *filter, uint8_t cm, uint32_t now);
+
+#endif /* __ZONE_FILTER_H */
@@ -0,0 +1,90 @@
+/**
+ * @file    zone_table.h
+ * @ingroup Receiver_Node
+ * @brief   Distance-to-zone lookup table shared with the GUI.
+ *
+ * Generated by tools/gen_zone_table.py - do not edit by hand.
+ *
+ * Distances are grouped in 10 cm buckets (rounded up) and each bucket maps
+ * directly to its zone, LED mask and buzzer period, so classification is a
+ * single table load. Times to collision are grouped in 100 ms buckets
+ * (rounded down) and each maps to the distance of equal urgency.
+ */
+#ifndef __ZONE_TABLE_H
+#define __ZONE_TABLE_H
+
+#include <stdint.h>
+
+/** Width of one distance bucket in centimetres */
+#define ZONE_BUCKET_CM          10u
+/** Number of entries in zoneTable */
+#define ZONE_BUCKET_COUNT       27u
+
+/** Buzzer period value meaning the buzzer is held on */
+#define ZONE_BUZZER_CONTINUOUS  0xFFFFu
+/** Buzzer period value meaning the buzzer is silent */
+#define ZONE_BUZZER_OFF         0u
+
+/** Time a farther zone must persist before it is indicated (ms) */
+#define ZONE_DWELL_MS           150u
+
+/** Width of one time-to-collision bucket (ms) */
+#define ZONE_TTC_BUCKET_MS      100u
+/** Number of entries in zoneTtcCm */
+#define ZONE_TTC_BUCKET_COUNT   27u
+/** Closing velocity under which the TTC is not used (mm/s) */
+#define ZONE_TTC_MIN_CLOSING_MM_S  50u
+
+/** Indication zones, ordered from closest to farthest */
+typedef enum
+{
+    ZONE_RED_FULL = 0,
+    ZONE_RED,
+    ZONE_YELLOW_FULL,
+    ZONE_YELLOW,
+    ZONE_GREEN_FULL,
+    ZONE_GREEN,
+    ZONE_NONE,
+    ZONE_COUNT
+} ZoneIdTypeDef;
+
+/** One bucket of the lookup table */
+typedef struct
+{
+    uint8_t  zone;       /**< ZoneIdTypeDef value */
+    uint8_t  led_mask;   /**< LEDs to light, bit 0 = Green1 ... bit 6 = Red2 */
+    uint16_t buzzer_ms;  /**< Buzzer toggle period in ms */
+} ZoneEntryTypeDef;
+
+/** Direct-indexed zone table, one entry per distance bucket */
+extern const ZoneEntryTypeDef zoneTable[ZONE_BUCKET_COUNT];
+
+/** Per-zone distance (cm) that must be exceeded to leave the zone */
+extern const uint8_t zoneRelease[ZONE_COUNT];
+
+/** Distance (cm) as urgent as each time-to-collision bucket */
+extern const uint8_t zoneTtcCm[ZONE_TTC_BUCKET_COUNT];
+
+/**
+ * @brief  Look up the zone entry for a distance.
+ * @param  cm Distance in centimetres as received over CAN.
+ * @retval Pointer to the matching table entry.
+ */
+static inline const ZoneEntryTypeDef *Zone_Lookup(uint8_t cm)
+{
+    return &zoneTable[(cm + ZONE_BUCKET_CM - 1u) / ZONE_BUCKET_CM];
+}
+
+/**
+ * @brief  Look up the distance as urgent as a time to collision.
+ * @param  ttc_ms Time to collision (ms).
+ * @retval Distance in centimetres; 255 beyond the curve.
+ */
+static inline uint8_t Zone_TtcCm(uint32_t ttc_ms)
+{
+    uint32_t bucket = ttc_ms / ZONE_TTC_BUCKET_MS;
+
+    return (bucket < ZONE_TTC_BUCKET_COUNT) ? zoneTtcCm[bucket] : 255u;
+}
+
+#endif /* __ZONE_TABLE_H */
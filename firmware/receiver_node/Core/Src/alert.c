@@ -0,0 +1,41 @@
+/**
+ * @file    alert.c
+ * @ingroup Receiver_Node
+ * @brief   Time-to-collision alerting on top of the zone ladder.
+ */
+#include "alert.h"
+#include "zone_table.h"
+
+/**
+ * @brief  Time to collision with an obstacle.
+ * @param  cm           Distance (cm).
+ * @param  closing_mm_s Closing velocity (mm/s), positive approaching.
+ * @retval Time to collision (ms), or ALERT_TTC_NONE if not closing in.
+ */
+uint32_t Alert_TtcMs(uint8_t cm, int16_t closing_mm_s)
+{
+    if (closing_mm_s <= 0)
+        return ALERT_TTC_NONE;
+
+    /* cm * 10 mm over mm/s, in ms */
+    return (uint32_t)cm * 10000u / (uint32_t)closing_mm_s;
+}
+
+/**
+ * @brief  Distance to indicate for one sensor.
+ * @param  cm           Measured distance (cm).
+ * @param  closing_mm_s Closing velocity (mm/s), positive approaching.
+ * @param  confident    Non-zero if the velocity is confident.
+ * @retval The closer of the measured distance and the distance as urgent
+ *         as the time to collision (cm).
+ */
+uint8_t Alert_UrgencyCm(uint8_t cm, int16_t closing_mm_s, uint8_t confident)
+{
+    uint8_t urgent;
+
+    if (!confident || closing_mm_s < (int16_t)ZONE_TTC_MIN_CLOSING_MM_S)
+        return cm;
+
+    urgent = Zone_TtcCm(Alert_TtcMs(cm, closing_mm_s));
+    return (urgent < cm) ? urgent : cm;
+}
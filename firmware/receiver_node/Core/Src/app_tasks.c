@@ -10,7 +10,21 @@
 #include "app_tasks.h"
 #include "sevenseg.h"
 #include "leds.h"
-#include <stdio.h>
+#include "zone_filter.h"
+#include "alert.h"
+#include "predict.h"
+#include "occupancy.h"
+#include "uart_tx.h"
+#include "frame.h"
+#include "task_sched.h"
+#include "cpu_stats.h"
+#include "stack_mon.h"
+#include "tickless.h"
+#include "trace.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "boot_time.h"
+#include "isr_stats.h"
 #include <string.h>
 
 /* --------------------------------------------------------------------------
@@ -20,12 +34,24 @@
 /** Distance value computed from received CAN data (meters) */
 extern float Distance;
 
-/** Buzzer timing variable (ms) */
-extern int time;
+/** Zone table entry for the current shortest distance */
+extern const ZoneEntryTypeDef *Zone;
 
 /** CAN received data buffer */
 extern uint8_t RxData[8];
 
+/** Tick at which the last CAN frame was received (ms) */
+extern volatile uint32_t RxTimestamp;
+
+/** Set once the first CAN frame has been received */
+extern volatile uint8_t RxReceived;
+
+/** CAN position frame buffer */
+extern uint8_t RxPosition[RX_CAN_POS_DLC];
+
+/** Tick at which the last position frame was received (ms) */
+extern volatile uint32_t RxPositionTimestamp;
+
 /* --------------------------------------------------------------------------
  * 7-segment display variables
  * -------------------------------------------------------------------------- */
@@ -37,15 +63,69 @@ extern uint8_t digit1;
 extern uint8_t digit2;
 
 /* --------------------------------------------------------------------------
- * UART and display buffers
+ * Display buffers
  * -------------------------------------------------------------------------- */
 
-/** UART transmission buffer */
-extern char Buffer[8];
-
 /** LCD/7-segment buffer */
 extern char lcdBuffer[8];
 
+/** Shortest predicted distance, shown on the 7-segment display (cm) */
+static volatile uint8_t displayCm = PREDICT_NO_ECHO;
+
+/** Age after which the sensor health of the position frame is out of date
+ *  and every sensor is taken as at least degraded (ms) */
+#define HEALTH_STALE_MS     250u
+
+/** Age after which the latest distance frame is out of date: the
+ *  transmitter or the CAN link has gone quiet, so every sensor is taken as
+ *  failed (ms) */
+#define RX_TIMEOUT_MS       250u
+
+/** LEDs lit while no sensor is usable: both ends of the bar graph, which
+ *  no zone lights on their own */
+#define FAULT_LED_MASK      (LED_GREEN1 | LED_RED2)
+
+/** Buzzer toggle period while no sensor is usable, slower than any zone's (ms) */
+#define FAULT_BUZZER_MS     1000u
+
+/** No sensor is usable: the fault is indicated instead of the zone */
+static volatile uint8_t sensorFault;
+
+/** Sensors whose health is RX_CAN_HEALTH_FAILED, bit i for sensor i */
+static volatile uint8_t failedSensors;
+
+/** Sensors whose health is RX_CAN_HEALTH_DEGRADED or POOR, bit i for sensor i */
+static volatile uint8_t degradedSensors;
+
+/** Segment pattern of the letter E, shown with the number of a failed sensor */
+#define SEGMENT_E           0x79u
+
+/** Number of distance frames between two records of the same kind */
+#define SERIAL_DIAG_EVERY   16u
+
+/** Number of distance frames between two trace snapshots (~5 s) */
+#define SERIAL_TRACE_EVERY  80u
+
+/** Age after which CAN data is flagged as stale in serial frames (ms) */
+#define SERIAL_STALE_MS     250u
+
+/** Number of distance frames between two resends of the whole grid (~5 s) */
+#define SERIAL_GRID_RESYNC_EVERY  80u
+
+/** Run bytes in one FRAME_DIAG_GRID record, at most */
+#define SERIAL_GRID_MAX_RUNS      32u
+
+/** Bytes of a FRAME_DIAG_GRID record besides its runs: identifier, grid
+ *  size and worst cycles, CRC and COBS overhead and delimiter */
+#define SERIAL_GRID_OVERHEAD      (1u + 4u + 2u + 2u)
+
+#if OCC_SENSORS != RX_CAN_SENSORS
+#error "occupancy_table.h does not match the CAN payload; run tools/gen_occupancy_table.py"
+#endif
+
+/** Longest occupancy grid update or decay since the last grid record (cycles) */
+static volatile uint32_t gridWorstCycles;
+
 /* --------------------------------------------------------------------------
  * GPIO macros for 7-segment multiplexing
  * -------------------------------------------------------------------------- */
@@ -60,56 +140,320 @@ extern char lcdBuffer[8];
  * FreeRTOS Tasks
  * -------------------------------------------------------------------------- */
 
+/**
+ * @brief Account one occupancy grid operation in gridWorstCycles.
+ * @param start CYCCNT value when it started.
+ */
+static void Grid_Time(uint32_t start)
+{
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    if (cycles > gridWorstCycles)
+        gridWorstCycles = cycles;
+}
+
 /**
  * @brief Default task handling LED indication logic.
  *
- * This task selects the shortest distance received via CAN and updates
- * LED patterns accordingly. It also updates the buzzer timing variable.
+ * This task extrapolates the distance of each sensor received via CAN
+ * to the present (see predict.h), over the sample age sent by the
+ * transmitter plus the time since the frame arrived; it runs every few
+ * milliseconds, so the prediction also moves on between frames. It takes
+ * the most urgent of the predicted distances, which is the distance
+ * itself or, for a sensor closing in fast, the distance as urgent as its
+ * time to collision (see alert.h), and classifies it through the zone
+ * filter. The LEDs are only rewritten when
+ * the indicated zone changes, and the entry is published in Zone for the
+ * buzzer and display tasks. Until the first frame arrives the farthest
+ * zone is kept: the zero-filled buffer would otherwise be indicated as an
+ * obstacle, and the release dwell would then delay the first real zone.
+ *
+ * The sensor health of the latest position frame degrades the indication
+ * gracefully: a failed sensor's distance is ignored, so the other sensor
+ * alone drives the zone and the display shows the failure; a poor
+ * sensor's velocity is not trusted, so its distance is neither predicted
+ * nor made more urgent. Health older than HEALTH_STALE_MS is out of date,
+ * so every sensor counts as at least degraded; distances older than
+ * RX_TIMEOUT_MS mean the link is lost, so every sensor counts as failed
+ * rather than the last zone being kept. When no sensor is usable
+ * the zone filter is held where it was and the LEDs and buzzer show the
+ * fault (FAULT_LED_MASK, FAULT_BUZZER_MS) rather than an all-clear.
+ *
+ * Each new frame's distances, as measured, are also accumulated into the
+ * occupancy grid (see occupancy.h), which is decayed every OCC_DECAY_MS
+ * on a job without a new frame, so the two never add up in one job.
  *
  * @param argument Pointer passed to the task (not used).
  */
 void StartDefaultTask(void *argument)
 {
+    ZoneFilterTypeDef filter;
+    uint8_t rx[8];
+    uint8_t nearest, cm, predicted, urgent, confident, health, stale, lost, level, failed, degraded, i;
+    int16_t closing;
+    uint32_t primask, stamp, posStamp, age, start;
+    uint32_t gridStamp = 0;
+    uint32_t gridDecay = 0;
+    uint8_t updated;
+
     (void)argument;
 
+    ZoneFilter_Init(&filter);
+    leds_Set(filter.entry->led_mask);
+    Occupancy_Init();
+
+    Sched_Start(SCHED_DEFAULT);
     for (;;)
     {
-        /* Select shortest distance from CAN data */
-        if (RxData[0] < RxData[1])
-            Distance = RxData[0] / 100.0f;
-        else
-            Distance = RxData[1] / 100.0f;
-
-        /* Update LEDs based on distance */
-        if (Distance <= 0.3f) leds_7();
-        else if (Distance <= 0.5f) { leds_6(); time = 50; }
-        else if (Distance <= 0.7f) { leds_5(); time = 100; }
-        else if (Distance <= 0.9f) { leds_4(); time = 300; }
-        else if (Distance <= 1.1f) { leds_3(); time = 400; }
-        else if (Distance <= 1.3f) { leds_2(); time = 600; }
-        else leds_1();
-
-        osDelay(1);
+        updated = 0;
+        if (RxReceived)
+        {
+            /* Copy the frame at once, with its reception tick */
+            primask = __get_PRIMASK();
+            __disable_irq();
+            memcpy(rx, RxData, sizeof(rx));
+            stamp = RxTimestamp;
+            health = RxPosition[RX_CAN_POS_HEALTH];
+            posStamp = RxPositionTimestamp;
+            __set_PRIMASK(primask);
+            age = HAL_GetTick() - stamp;
+            stale = (uint32_t)(HAL_GetTick() - posStamp) > HEALTH_STALE_MS;
+            lost = age > RX_TIMEOUT_MS;
+
+            /* Select shortest and most urgent predicted distances of the
+               sensors still usable */
+            nearest = 0xFFu;
+            cm = 0xFFu;
+            failed = 0;
+            degraded = 0;
+            for (i = 0; i < RX_CAN_SENSORS; i++)
+            {
+                level = RX_CAN_HEALTH_LEVEL(health, i);
+                if (lost)
+                    level = RX_CAN_HEALTH_FAILED;
+                else if (stale && level < RX_CAN_HEALTH_DEGRADED)
+                    level = RX_CAN_HEALTH_DEGRADED;
+                if (level == RX_CAN_HEALTH_FAILED)
+                {
+                    failed |= (uint8_t)(1u << i);
+                    continue;
+                }
+                if (level != RX_CAN_HEALTH_OK)
+                    degraded |= (uint8_t)(1u << i);
+
+                closing = (int16_t)(rx[RX_CAN_CLOSING + 2u * i] | (rx[RX_CAN_CLOSING + 2u * i + 1u] << 8));
+                confident = (level < RX_CAN_HEALTH_POOR) ? (rx[RX_CAN_FLAGS] & RX_CAN_FLAG_CONFIDENT(i)) : 0u;
+                predicted = Predict_Cm(rx[RX_CAN_DISTANCE + i], closing, confident,
+                                       age + RX_CAN_AGE_MS(rx, i));
+                if (predicted < nearest)
+                    nearest = predicted;
+                urgent = Alert_UrgencyCm(predicted, closing, confident);
+                if (urgent < cm)
+                    cm = urgent;
+            }
+            Distance = nearest / 100.0f;
+            displayCm = nearest;
+            failedSensors = failed;
+            degradedSensors = degraded;
+
+            /* Update LEDs only when the filtered zone changes or the
+               sensors are usable again */
+            if (failed != (1u << RX_CAN_SENSORS) - 1u)
+            {
+                if (ZoneFilter_Update(&filter, cm, HAL_GetTick()) || sensorFault)
+                {
+                    sensorFault = 0;
+                    Zone = filter.entry;
+                    leds_Set(Zone->led_mask);
+                    TRACE_MARK(TRACE_MARK_GPIO, Zone->led_mask);
+                }
+            }
+            else if (!sensorFault)
+            {
+                /* Nothing to range with: hold the zone, show the fault */
+                sensorFault = 1;
+                leds_Set(FAULT_LED_MASK);
+                TRACE_MARK(TRACE_MARK_GPIO, FAULT_LED_MASK);
+            }
+            Boot_Mark(BOOT_FIRST_INDICATION);
+
+            /* Accumulate each frame once into the occupancy grid */
+            if (stamp != gridStamp)
+            {
+                gridStamp = stamp;
+                for (i = 0; i < RX_CAN_SENSORS; i++)
+                {
+                    if (failed & (1u << i))
+                        continue;
+                    start = DWT->CYCCNT;
+                    Occupancy_Update(i, rx[RX_CAN_DISTANCE + i]);
+                    Grid_Time(start);
+                }
+                updated = 1;
+            }
+        }
+
+        if (!updated && (uint32_t)(HAL_GetTick() - gridDecay) >= OCC_DECAY_MS)
+        {
+            gridDecay = HAL_GetTick();
+            start = DWT->CYCCNT;
+            Occupancy_Decay();
+            Grid_Time(start);
+        }
+
+        Sched_WaitNextPeriod(SCHED_DEFAULT);
     }
 }
 
 /**
  * @brief UART serial output task.
  *
- * Periodically transmits the measured distance value via UART
- * for debugging or monitoring purposes.
+ * Periodically sends a binary frame (see frame.h) with both sensor
+ * distances as received, their closing velocities, confidence and ages,
+ * the obstacle position when a recent one was received, the indicated
+ * zone and status flags (with the sensor health as StartDefaultTask
+ * applied it) to the GUI, which predicts the distances itself, and every
+ * SERIAL_DIAG_EVERY frames diagnostic records with the task deadline
+ * statistics, the per-task CPU load, the stack high-water marks, the idle
+ * sleep statistics, the interrupt latency and duration statistics and the
+ * boot-phase times, plus the crash record of the last reset if there is
+ * one. The serial link itself is initialised here rather than on the boot
+ * path. When the event trace is frozen
+ * (every SERIAL_TRACE_EVERY frames or on a deadline miss), the snapshot is
+ * sent in FRAME_DIAG_TRACE records on the remaining periods and recording
+ * then resumes. Every period then ends with a FRAME_DIAG_GRID record of
+ * the occupancy grid cells that changed, sized to the room the other
+ * records left in the UART buffer; the whole grid is sent again every
+ * SERIAL_GRID_RESYNC_EVERY frames and after a dropped record. The writes
+ * never block; the bytes are sent by DMA in the background.
  *
  * @param argument Pointer passed to the task (not used).
  */
 void serialTask_init(void *argument)
 {
+    FrameTypeDef frame = {0};
+    uint8_t rx[8];
+    uint8_t pos[RX_CAN_POS_DLC];
+    uint32_t primask, age, sampleAge, posStamp, worst;
+    uint16_t room;
+    uint8_t i, runs;
+    /* Static to keep them off the task stack */
+    static uint8_t out[FRAME_MAX_ENCODED];
+    static uint8_t diag[FRAME_MAX_DIAG_PAYLOAD];
+    uint32_t overflows = 0;
+#if TRACE_ENABLE
+    uint16_t traceNext = 0;
+#endif
+
     (void)argument;
 
+    MX_Deferred_Init();
+
+    Sched_Start(SCHED_SERIAL);
     for (;;)
     {
-        sprintf(Buffer, "%.1f\r\n", Distance);
-        HAL_UART_Transmit(&huart2, (uint8_t *)Buffer, strlen(Buffer), 10);
-        osDelay(60);
+        primask = __get_PRIMASK();
+        __disable_irq();
+        memcpy(rx, RxData, sizeof(rx));
+        frame.timestamp = RxTimestamp;
+        memcpy(pos, RxPosition, sizeof(pos));
+        posStamp = RxPositionTimestamp;
+        __set_PRIMASK(primask);
+        frame.zone = Zone->zone;
+        frame.flags = 0;
+
+        age = HAL_GetTick() - frame.timestamp;
+        if (age > SERIAL_STALE_MS)
+            frame.flags |= FRAME_FLAG_STALE;
+
+        if (failedSensors)
+            frame.flags |= FRAME_FLAG_SENSOR_FAILED;
+        if (degradedSensors)
+            frame.flags |= FRAME_FLAG_SENSOR_DEGRADED;
+
+        if (UartTx_GetOverflowCount() != overflows)
+        {
+            overflows = UartTx_GetOverflowCount();
+            frame.flags |= FRAME_FLAG_TX_OVERFLOW;
+        }
+
+        frame.count = RX_CAN_SENSORS;
+        frame.confident = 0;
+        for (i = 0; i < RX_CAN_SENSORS; i++)
+        {
+            frame.distance_mm[i] = rx[RX_CAN_DISTANCE + i] * 10u;
+            frame.closing_mm_s[i] = (int16_t)(rx[RX_CAN_CLOSING + 2u * i] | (rx[RX_CAN_CLOSING + 2u * i + 1u] << 8));
+            sampleAge = age + RX_CAN_AGE_MS(rx, i);
+            frame.age_ms[i] = (uint16_t)((sampleAge > 0xFFFFu) ? 0xFFFFu : sampleAge);
+            if (rx[RX_CAN_FLAGS] & RX_CAN_FLAG_CONFIDENT(i))
+                frame.confident |= (uint8_t)(1u << i);
+        }
+
+        frame.lateral_mm = (int16_t)(pos[RX_CAN_POS_LATERAL] | (pos[RX_CAN_POS_LATERAL + 1u] << 8));
+        frame.forward_mm = (uint16_t)(pos[RX_CAN_POS_FORWARD] | (pos[RX_CAN_POS_FORWARD + 1u] << 8));
+        if (!(pos[RX_CAN_POS_FLAGS] & RX_CAN_POS_FLAG_VALID) ||
+            (uint32_t)(HAL_GetTick() - posStamp) > SERIAL_STALE_MS)
+            frame.forward_mm = FRAME_NO_POSITION;
+
+        UartTx_Write(out, Frame_Encode(&frame, out));
+        frame.seq++;
+
+        if (frame.seq % SERIAL_TRACE_EVERY == 0)
+            TRACE_FREEZE();
+
+        if (frame.seq % SERIAL_DIAG_EVERY == 0)
+            UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_SCHED, diag, Sched_Report(diag), out));
+        else if (frame.seq % SERIAL_DIAG_EVERY == SERIAL_DIAG_EVERY / 2)
+            UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_CPU, diag, CpuStats_Report(diag), out));
+        else if (frame.seq % SERIAL_DIAG_EVERY == SERIAL_DIAG_EVERY / 4)
+            UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_STACK, diag, StackMon_Report(diag), out));
+        else if (frame.seq % SERIAL_DIAG_EVERY == SERIAL_DIAG_EVERY * 3 / 4)
+            UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_POWER, diag, Tickless_Report(diag), out));
+        else if (frame.seq % SERIAL_DIAG_EVERY == SERIAL_DIAG_EVERY * 3 / 8)
+            UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_BOOT, diag, Boot_Report(diag), out));
+        else if (frame.seq % SERIAL_DIAG_EVERY == SERIAL_DIAG_EVERY * 5 / 8)
+            UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_ISR, diag, IsrStats_Report(diag), out));
+        else if (frame.seq % SERIAL_DIAG_EVERY == SERIAL_DIAG_EVERY / 8 && Crash_GetLast() != NULL)
+            UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_CRASH, diag, Crash_Report(diag), out));
+#if TRACE_ENABLE
+        else if (Trace_IsFrozen())
+        {
+            if (traceNext >= Trace_Count())
+            {
+                traceNext = 0;
+                Trace_Resume();
+            }
+            else if (UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_TRACE, diag, Trace_Report(traceNext, diag), out)))
+            {
+                traceNext += TRACE_CHUNK_EVENTS;
+            }
+        }
+#endif
+
+        /* Occupancy grid changes, in the room left by the other records */
+        if (frame.seq % SERIAL_GRID_RESYNC_EVERY == 0)
+            Occupancy_Resync();
+        room = UartTx_GetFree();
+        if (room > SERIAL_GRID_OVERHEAD)
+        {
+            room -= SERIAL_GRID_OVERHEAD;
+            runs = Occupancy_Encode(&diag[4], (uint8_t)((room < SERIAL_GRID_MAX_RUNS) ? room : SERIAL_GRID_MAX_RUNS));
+            if (runs)
+            {
+                worst = gridWorstCycles;
+                gridWorstCycles = 0;
+                if (worst > 0xFFFFu)
+                    worst = 0xFFFFu;
+                diag[0] = OCC_COLS;
+                diag[1] = OCC_ROWS;
+                diag[2] = (uint8_t)worst;
+                diag[3] = (uint8_t)(worst >> 8);
+                if (!UartTx_Write(out, Frame_EncodeDiag(FRAME_DIAG_GRID, diag, (uint8_t)(4u + runs), out)))
+                    Occupancy_Resync();
+            }
+        }
+
+        Sched_WaitNextPeriod(SCHED_SERIAL);
     }
 }
 
@@ -117,85 +461,160 @@ void serialTask_init(void *argument)
  * @brief Buzzer control task.
  *
  * Controls the buzzer behavior based on the measured distance.
- * The buzzer toggles faster as the distance decreases.
+ * The buzzer toggles faster as the distance decreases. The task runs at
+ * a fixed period and counts elapsed time towards the next toggle, so a
+ * zone change does not restart the cadence. While no sensor is usable it
+ * toggles every FAULT_BUZZER_MS instead (see StartDefaultTask).
  *
  * @param argument Pointer passed to the task (not used).
  */
 void buzzerTask_init(void *argument)
 {
-    (void)argument;
+    uint32_t period = schedTable[SCHED_BUZZER].period;
+    uint32_t elapsed = 0;
+    uint16_t toggle;
 
-    osDelay(200);
+    (void)argument;
 
+    Sched_Start(SCHED_BUZZER);
     for (;;)
     {
-        if (Distance <= 0.3f)
+        toggle = sensorFault ? FAULT_BUZZER_MS : Zone->buzzer_ms;
+
+        if (toggle == ZONE_BUZZER_CONTINUOUS)
         {
             HAL_GPIO_WritePin(GPIOA, Buzzer_Pin, GPIO_PIN_SET);
+            elapsed = 0;
         }
-        else if (Distance <= 1.3f)
+        else if (toggle != ZONE_BUZZER_OFF)
         {
-            HAL_GPIO_TogglePin(GPIOA, Buzzer_Pin);
-            osDelay(time);
+            if (elapsed == 0)
+                HAL_GPIO_TogglePin(GPIOA, Buzzer_Pin);
+
+            elapsed += period;
+            if (elapsed >= toggle)
+                elapsed = 0;
         }
         else
         {
             HAL_GPIO_WritePin(GPIOA, Buzzer_Pin, GPIO_PIN_RESET);
+            elapsed = 0;
         }
 
-        osDelay(1);
+        Sched_WaitNextPeriod(SCHED_BUZZER);
     }
 }
 
 /**
  * @brief 7-segment display task.
  *
- * Displays the shortest received distance on a multiplexed 2-digit
- * 7-segment display. If the distance exceeds the maximum threshold,
- * a warning pattern is shown.
+ * Displays the shortest predicted distance (see StartDefaultTask) on a
+ * multiplexed 2-digit 7-segment display. If the distance exceeds the maximum threshold,
+ * a warning pattern is shown. While a sensor has failed, "E" and its
+ * number (from 1) are shown instead, the other sensor still driving the
+ * LEDs and buzzer. Each job lights one digit and the task sleeps between
+ * jobs instead of busy-waiting.
  *
  * @param argument Pointer passed to the task (not used).
  */
 void lcdTask_init(void *argument)
 {
+    uint8_t second = 0;
+    uint8_t cm, failed, sensor;
+
     (void)argument;
 
+    Sched_Start(SCHED_LCD);
     for (;;)
     {
         /* Extract digits from shortest distance */
-        if (RxData[0] < RxData[1])
+        cm = displayCm;
+        digit1 = ((cm / 100) % 10);
+        digit2 = ((cm / 10) % 10);
+
+        failed = failedSensors;
+        if (failed)
         {
-            digit1 = ((RxData[0] / 100) % 10);
-            digit2 = ((RxData[0] / 10) % 10);
+            /* First failed sensor: "E" then its number */
+            for (sensor = 0; !(failed & (1u << sensor)); sensor++)
+                ;
+            DP_OFF();
+            if (!second)
+            {
+                DIG2_HIGH();
+                SevenSegment_Update(SEGMENT_E);
+                DIG1_LOW();
+            }
+            else
+            {
+                DIG1_HIGH();
+                SevenSegment_Update(segmentNumber[sensor + 1u]);
+                DIG2_LOW();
+            }
         }
-        else
+        else if (!second)
         {
-            digit1 = ((RxData[1] / 100) % 10);
-            digit2 = ((RxData[1] / 10) % 10);
+            DIG2_HIGH();
+            if (Zone->zone != ZONE_NONE)
+            {
+                DP_ON();
+                SevenSegment_Update(digit1);
+            }
+            else
+            {
+                /* Display warning pattern when distance is too large */
+                DP_OFF();
+                SevenSegment_Update(0x08);
+            }
+            DIG1_LOW();
         }
-
-        if (Distance <= 1.3f)
+        else
         {
-            SevenSegment_Update(digit1);
-            DIG1_LOW();
-            HAL_Delay(7);
             DIG1_HIGH();
-
-            SevenSegment_Update(digit2);
+            SevenSegment_Update(Zone->zone != ZONE_NONE ? digit2 : 0x08);
             DP_OFF();
             DIG2_LOW();
-            HAL_Delay(7);
-            DP_ON();
-            DIG2_HIGH();
         }
-        else
-        {
-            /* Display warning pattern when distance is too large */
-            SevenSegment_Update(0x08);
-            DIG1_LOW(); DP_OFF(); HAL_Delay(7); DIG1_HIGH();
+        second = !second;
 
-            SevenSegment_Update(0x08);
-            DIG2_LOW(); HAL_Delay(7); DIG2_HIGH();
-        }
+        Sched_WaitNextPeriod(SCHED_LCD);
+    }
+}
+
+/**
+ * @brief Stack monitor task.
+ *
+ * Registers every task of schedTable and the kernel's own tasks with the
+ * stack monitor, then samples their high-water marks every
+ * STACK_MON_PERIOD_MS. The serial task reports the result. A task dropping
+ * under STACK_MON_MARGIN for the first time freezes the event trace so the
+ * snapshot shows what it was doing. Running at the lowest priority, it
+ * also refreshes the watchdog when every task has checked in.
+ *
+ * @param argument Pointer passed to the task (not used).
+ */
+void monitorTask_init(void *argument)
+{
+    uint8_t low = 0;
+    uint8_t now;
+    uint8_t i;
+
+    (void)argument;
+
+    for (i = 0; i < SCHED_TASK_COUNT; i++)
+        StackMon_Register(*schedTable[i].handle, schedTable[i].stack_size);
+    StackMon_RegisterKernelTasks();
+
+    Sched_Start(SCHED_MONITOR);
+    for (;;)
+    {
+        now = StackMon_Sample();
+        if (now & ~low)
+            TRACE_FREEZE();
+        low = now;
+
+        Watchdog_Supervise();
+
+        Sched_WaitNextPeriod(SCHED_MONITOR);
     }
 }
@@ -0,0 +1,90 @@
+/**
+ * @file    boot_time.c
+ * @ingroup Receiver_Node
+ * @brief   Boot-phase timestamps from reset to the first indication.
+ */
+#include "boot_time.h"
+#include "main.h"
+
+/** Time of each phase since reset (us), 0 if not reached */
+static uint32_t bootUs[BOOT_PHASE_COUNT];
+
+/** Time since reset at the previous mark (us) */
+static uint32_t bootElapsedUs;
+
+/** CYCCNT at the previous mark; the counter starts at 0 at reset */
+static uint32_t bootLastCycles;
+
+/** Core clock since the previous mark (Hz), 0 before the first mark */
+static uint32_t bootLastHz;
+
+/**
+ * @brief Start the cycle counter at reset. Called from SystemInit, before
+ *        the C start-up code: touches no RAM.
+ */
+void Boot_Start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Record the time since reset at which a phase is reached; later
+ *        marks of the same phase are ignored. Safe from interrupts.
+ * @param phase Boot phase.
+ */
+void Boot_Mark(BootPhaseTypeDef phase)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now;
+
+    if (phase >= BOOT_PHASE_COUNT || bootUs[phase] != 0)
+        return;
+
+    __disable_irq();
+    if (bootUs[phase] == 0)
+    {
+        now = DWT->CYCCNT;
+        if (bootLastHz == 0)
+            bootLastHz = SystemCoreClock;   /* Reset clock, for the C start-up */
+
+        /* One counter wrap (59 s at 72 MHz) between marks is tolerated */
+        bootElapsedUs += (now - bootLastCycles) / (bootLastHz / 1000000u);
+        bootLastCycles = now;
+        bootLastHz = SystemCoreClock;
+        bootUs[phase] = bootElapsedUs ? bootElapsedUs : 1u;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Time since reset at which a phase was reached.
+ * @param  phase Boot phase.
+ * @retval Microseconds, 0 if not reached yet.
+ */
+uint32_t Boot_GetUs(BootPhaseTypeDef phase)
+{
+    return (phase < BOOT_PHASE_COUNT) ? bootUs[phase] : 0;
+}
+
+/**
+ * @brief  Serialise the phase times for a FRAME_DIAG_BOOT record.
+ * @param  buf Output buffer of at least 1 + 4 * BOOT_PHASE_COUNT bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t Boot_Report(uint8_t *buf)
+{
+    uint8_t n = 0;
+    uint8_t i;
+
+    buf[n++] = BOOT_PHASE_COUNT;
+    for (i = 0; i < BOOT_PHASE_COUNT; i++)
+    {
+        buf[n++] = (uint8_t)bootUs[i];
+        buf[n++] = (uint8_t)(bootUs[i] >> 8);
+        buf[n++] = (uint8_t)(bootUs[i] >> 16);
+        buf[n++] = (uint8_t)(bootUs[i] >> 24);
+    }
+    return n;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file    frame.c
+ * @ingroup Receiver_Node
+ * @brief   Binary serial frame encoder (COBS + CRC-16).
+ */
+#include "frame.h"
+#include <string.h>
+
+/** CRC-16/CCITT nibble table, trades a few cycles for 480 bytes of flash */
+static const uint16_t crcNibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/**
+ * @brief  Compute CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).
+ * @param  data Bytes to checksum.
+ * @param  len  Number of bytes.
+ * @retval CRC value.
+ */
+uint16_t Frame_Crc16(const uint8_t *data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    while (len--)
+    {
+        crc = (uint16_t)((crc << 4) ^ crcNibble[(crc >> 12) ^ (*data >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crcNibble[(crc >> 12) ^ (*data & 0x0F)]);
+        data++;
+    }
+
+    return crc;
+}
+
+/**
+ * @brief  COBS-encode a buffer and append the 0x00 delimiter.
+ * @param  in  Raw bytes (fewer than 254, so one code block is enough
+ *             between zeros).
+ * @param  len Number of raw bytes.
+ * @param  out Output buffer of at least len + 2 bytes.
+ * @retval Number of bytes written.
+ */
+static uint16_t Frame_Cobs(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint16_t code = 0;   /* Index of the current code byte */
+    uint16_t o = 1;
+    uint16_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[code] = (uint8_t)(o - code);
+            code = o++;
+        }
+        else
+        {
+            out[o++] = in[i];
+        }
+    }
+
+    out[code] = (uint8_t)(o - code);
+    out[o++] = 0;
+    return o;
+}
+
+/**
+ * @brief  Serialise, checksum and COBS-encode a frame.
+ * @param  frame Frame contents; count is clamped to FRAME_MAX_SENSORS.
+ * @param  out   Output buffer of at least FRAME_MAX_ENCODED bytes.
+ * @retval Number of bytes written, including the 0x00 delimiter.
+ */
+uint16_t Frame_Encode(const FrameTypeDef *frame, uint8_t *out)
+{
+    uint8_t raw[FRAME_MAX_RAW];
+    uint8_t count = frame->count;
+    uint16_t n = 0;
+    uint16_t crc;
+    uint8_t i;
+
+    if (count > FRAME_MAX_SENSORS)
+        count = FRAME_MAX_SENSORS;
+
+    raw[n++] = FRAME_VERSION;
+    raw[n++] = (uint8_t)(frame->seq);
+    raw[n++] = (uint8_t)(frame->seq >> 8);
+    raw[n++] = (uint8_t)(frame->timestamp);
+    raw[n++] = (uint8_t)(frame->timestamp >> 8);
+    raw[n++] = (uint8_t)(frame->timestamp >> 16);
+    raw[n++] = (uint8_t)(frame->timestamp >> 24);
+    raw[n++] = frame->zone;
+    raw[n++] = frame->flags;
+    raw[n++] = count;
+
+    for (i = 0; i < count; i++)
+    {
+        raw[n++] = (uint8_t)(frame->distance_mm[i]);
+        raw[n++] = (uint8_t)(frame->distance_mm[i] >> 8);
+    }
+    for (i = 0; i < count; i++)
+    {
+        raw[n++] = (uint8_t)(frame->closing_mm_s[i]);
+        raw[n++] = (uint8_t)((uint16_t)frame->closing_mm_s[i] >> 8);
+    }
+    for (i = 0; i < count; i++)
+    {
+        raw[n++] = (uint8_t)(frame->age_ms[i]);
+        raw[n++] = (uint8_t)(frame->age_ms[i] >> 8);
+    }
+    raw[n++] = frame->confident;
+    raw[n++] = (uint8_t)(frame->lateral_mm);
+    raw[n++] = (uint8_t)((uint16_t)frame->lateral_mm >> 8);
+    raw[n++] = (uint8_t)(frame->forward_mm);
+    raw[n++] = (uint8_t)(frame->forward_mm >> 8);
+
+    crc = Frame_Crc16(raw, n);
+    raw[n++] = (uint8_t)(crc);
+    raw[n++] = (uint8_t)(crc >> 8);
+
+    return Frame_Cobs(raw, n, out);
+}
+
+/**
+ * @brief  Checksum and COBS-encode a diagnostic record.
+ * @param  id      FRAME_DIAG_* identifier.
+ * @param  payload Record payload.
+ * @param  len     Payload length; clamped to FRAME_MAX_DIAG_PAYLOAD.
+ * @param  out     Output buffer of at least FRAME_MAX_ENCODED bytes.
+ * @retval Number of bytes written, including the 0x00 delimiter.
+ */
+uint16_t Frame_EncodeDiag(uint8_t id, const uint8_t *payload, uint8_t len, uint8_t *out)
+{
+    uint8_t raw[FRAME_MAX_RAW];
+    uint16_t n = 0;
+    uint16_t crc;
+
+    if (len > FRAME_MAX_DIAG_PAYLOAD)
+        len = FRAME_MAX_DIAG_PAYLOAD;
+
+    raw[n++] = id;
+    memcpy(&raw[n], payload, len);
+    n += len;
+
+    crc = Frame_Crc16(raw, n);
+    raw[n++] = (uint8_t)(crc);
+    raw[n++] = (uint8_t)(crc >> 8);
+
+    return Frame_Cobs(raw, n, out);
+}
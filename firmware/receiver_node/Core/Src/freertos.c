@@ -50,11 +50,36 @@
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
 
 /* USER CODE END FunctionPrototypes */
 
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
+/* Functions needed when configGENERATE_RUN_TIME_STATS is on */
+
+/**
+ * @brief Start the DWT cycle counter used as the run-time stats clock.
+ *
+ * Counting CPU cycles gives the finest resolution without using a timer.
+ * The 32-bit counter wraps after about 59 s at 72 MHz; cpu_stats.c only
+ * uses differences, which tolerate one wrap.
+ */
+void configureTimerForRunTimeStats(void)
+{
+  /* Already counting since reset (Boot_Start); only differences are used */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Current value of the run-time stats clock (CPU cycles).
+ */
+unsigned long getRunTimeCounterValue(void)
+{
+  return DWT->CYCCNT;
+}
 
 /* USER CODE END Application */
 
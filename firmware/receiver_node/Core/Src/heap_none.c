@@ -0,0 +1,51 @@
+/**
+ * @file    heap_none.c
+ * @ingroup Receiver_Node
+ * @brief   FreeRTOS allocator for a build without a heap (replaces heap_4.c).
+ *
+ * All tasks and kernel objects are allocated statically, so no RAM is
+ * reserved for a heap. The CMSIS-RTOS2 wrapper still references the
+ * dynamic API, which is why configSUPPORT_DYNAMIC_ALLOCATION stays 1 and
+ * these entry points exist; any allocation request is a bug and stops in
+ * configASSERT.
+ */
+#include "FreeRTOS.h"
+
+/**
+ * @brief  Reject an allocation request.
+ * @param  xWantedSize Requested size (ignored).
+ * @retval Always NULL.
+ */
+void *pvPortMalloc(size_t xWantedSize)
+{
+    (void)xWantedSize;
+
+    /* Something was created without static memory */
+    configASSERT(xWantedSize == 0);
+    return NULL;
+}
+
+/**
+ * @brief Nothing to free; present for the CMSIS-RTOS2 wrapper.
+ * @param pv Block pointer (ignored).
+ */
+void vPortFree(void *pv)
+{
+    (void)pv;
+}
+
+/**
+ * @brief Free heap space, always 0.
+ */
+size_t xPortGetFreeHeapSize(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Lowest free heap space seen, always 0.
+ */
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    return 0;
+}
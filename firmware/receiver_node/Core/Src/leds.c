@@ -9,65 +9,70 @@
 #include "leds.h"
 #include "main.h"
 
+/** GPIOA pins driven by leds_Set, indexed by LED mask bit */
+static const uint16_t ledPinsA[7] = {
+    Green1_Pin, Green2_Pin, 0, 0, Blue2_Pin, Red1_Pin, Red2_Pin
+};
+
+/** GPIOB pins driven by leds_Set, indexed by LED mask bit */
+static const uint16_t ledPinsB[7] = {
+    0, 0, Green3_Pin, Blue1_Pin, 0, 0, 0
+};
+
 /**
- * @brief Turn on all LEDs (pattern 7)  closest distance.
+ * @brief Drive all indicator LEDs from a bit mask.
+ * @param mask LED_* bits to light; every other LED is switched off.
  */
-void leds_7() {
-    HAL_GPIO_WritePin(GPIOB, Green3_Pin|Blue1_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, Green1_Pin|Green2_Pin|Blue2_Pin|Red1_Pin|Red2_Pin, GPIO_PIN_SET);
+void leds_Set(uint8_t mask)
+{
+    uint16_t onA = 0, onB = 0;
+    uint8_t i;
+
+    for (i = 0; i < 7; i++)
+    {
+        if (mask & (1u << i))
+        {
+            onA |= ledPinsA[i];
+            onB |= ledPinsB[i];
+        }
+    }
+
+    /* One BSRR write per port sets and clears all LEDs at once */
+    GPIOA->BSRR = onA | ((uint32_t)(LED_PINS_A & ~onA) << 16);
+    GPIOB->BSRR = onB | ((uint32_t)(LED_PINS_B & ~onB) << 16);
 }
 
+/**
+ * @brief Turn on all LEDs (pattern 7)  closest distance.
+ */
+void leds_7() { leds_Set(0x7F); }
+
 /**
  * @brief Turn on LEDs pattern 6.
  */
-void leds_6() {
-    HAL_GPIO_WritePin(GPIOB, Green3_Pin|Blue1_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, Green1_Pin|Green2_Pin|Blue2_Pin|Red1_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, Red2_Pin, GPIO_PIN_RESET);
-}
+void leds_6() { leds_Set(0x3F); }
 
 /**
  * @brief Turn on LEDs pattern 5.
  */
-void leds_5() {
-    HAL_GPIO_WritePin(GPIOB, Green3_Pin|Blue1_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, Green1_Pin|Green2_Pin|Blue2_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, Red1_Pin|Red2_Pin, GPIO_PIN_RESET);
-}
+void leds_5() { leds_Set(0x1F); }
 
 /**
  * @brief Turn on LEDs pattern 4.
  */
-void leds_4() {
-    HAL_GPIO_WritePin(GPIOB, Green3_Pin|Blue1_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, Green1_Pin|Green2_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, Blue2_Pin|Red1_Pin|Red2_Pin, GPIO_PIN_RESET);
-}
+void leds_4() { leds_Set(0x0F); }
 
 /**
  * @brief Turn on LEDs pattern 3.
  */
-void leds_3() {
-    HAL_GPIO_WritePin(GPIOB, Green3_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, Green1_Pin|Green2_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOB, Blue1_Pin, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(GPIOA, Blue2_Pin|Red1_Pin|Red2_Pin, GPIO_PIN_RESET);
-}
+void leds_3() { leds_Set(0x07); }
 
 /**
  * @brief Turn on LEDs pattern 2.
  */
-void leds_2() {
-    HAL_GPIO_WritePin(GPIOA, Green1_Pin|Green2_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOB, Green3_Pin|Blue1_Pin, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(GPIOA, Blue2_Pin|Red1_Pin|Red2_Pin, GPIO_PIN_RESET);
-}
+void leds_2() { leds_Set(0x03); }
 
 /**
  * @brief Turn on LEDs pattern 1  only Green1 for farthest distance.
  */
-void leds_1() {
-    HAL_GPIO_WritePin(GPIOA, Green1_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOB, Green3_Pin|Blue1_Pin, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(GPIOA, Green2_Pin|Blue2_Pin|Red1_Pin|Red2_Pin, GPIO_PIN_RESET);
-}
+void leds_1() { leds_Set(0x01); }
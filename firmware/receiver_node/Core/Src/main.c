@@ -15,12 +15,23 @@
 #include "app_tasks.h"
 #include "leds.h"
 #include "sevenseg.h"
+#include "zone_table.h"
+#include "uart_tx.h"
+#include "task_sched.h"
+#include "trace.h"
+#include "tickless.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "boot_time.h"
+#include "isr_stats.h"
 #include <stdio.h>
 #include <string.h>
 
 /* Private variables ---------------------------------------------------------*/
 CAN_HandleTypeDef hcan;
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_tx;
+IWDG_HandleTypeDef hiwdg;
 
 /* Definitions for defaultTask */
 osThreadId_t defaultTaskHandle;
@@ -34,12 +45,18 @@ osThreadId_t buzzerTaskHandle;
 /* Definitions for lcdTask */
 osThreadId_t lcdTaskHandle;
 
+/* Definitions for monitorTask */
+osThreadId_t monitorTaskHandle;
+
 /* Buffers and variables for CAN, UART, and display */
 float Distance;
-int time = 500;
-char Buffer[8];
+const ZoneEntryTypeDef *Zone = &zoneTable[ZONE_BUCKET_COUNT - 1];
 char lcdBuffer[8];
 uint8_t RxData[8];
+volatile uint32_t RxTimestamp;
+volatile uint8_t RxReceived;
+uint8_t RxPosition[RX_CAN_POS_DLC];
+volatile uint32_t RxPositionTimestamp;
 uint32_t TxMailbox;
 uint8_t digit1, digit2;
 
@@ -50,54 +67,104 @@ CAN_RxHeaderTypeDef RxHeader;
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_CAN_Init(void);
 static void MX_USART2_UART_Init(void);
+static void MX_IWDG_Init(void);
 
 /**
  * @fn void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
  * @brief  CAN RX FIFO 0 message pending callback.
  *
  * @note This callback is invoked by the HAL when a CAN message is received
- * in FIFO0. The received frame is read and stored in the RX buffer.
- * In case of reception error, an error indicator LED is activated.
+ * in FIFO0. A distance frame is stored in the RX buffer together with
+ * its reception tick, and RxReceived is set; a position frame goes to
+ * RxPosition with its own tick. In case of reception error, an error
+ * indicator LED is activated.
  *
  * @param  hcan Pointer to the CAN handle.
  * @retval None
  */
 void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
 {
-    if(HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &RxHeader, RxData) != HAL_OK)
+    uint8_t data[8] = {0};
+
+    if(HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &RxHeader, data) != HAL_OK)
     {
         HAL_GPIO_WritePin(GPIOC, GPIO_PIN_13, GPIO_PIN_SET); /* Error indicator */
     }
+    else if (RxHeader.StdId == RX_CAN_POSITION_ID)
+    {
+        memcpy(RxPosition, data, sizeof(RxPosition));
+        RxPositionTimestamp = HAL_GetTick();
+        TRACE_MARK(TRACE_MARK_CAN_RX, RxHeader.StdId);
+    }
+    else
+    {
+        memcpy(RxData, data, sizeof(RxData));
+        RxTimestamp = HAL_GetTick();
+        RxReceived = 1;
+        Boot_Mark(BOOT_FIRST_CAN);
+        TRACE_MARK(TRACE_MARK_CAN_RX, RxHeader.StdId);
+    }
+}
+
+/**
+ * @fn void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+ * @brief  UART transmit complete callback.
+ *
+ * @note Forwarded to the non-blocking UART driver, which starts the DMA
+ * transfer of the next queued chunk.
+ *
+ * @param  huart Pointer to the UART handle.
+ * @retval None
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    UartTx_TxCpltCallback(huart);
 }
 
 int main(void)
 {
+  uint8_t i;
+
+  Boot_Mark(BOOT_MAIN);
+
+  /* Take over the record of a crash before anything else runs */
+  Crash_Init();
+
   /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
   HAL_Init();
 
   /* Configure the system clock */
   SystemClock_Config();
+  Boot_Mark(BOOT_CLOCK);
 
-  /* Initialize all configured peripherals */
+  /* Fast boot: only what the first indication needs is initialised here,
+     CAN reception first; the serial link is set up by its task
+     (MX_Deferred_Init) */
   MX_GPIO_Init();
 	HAL_GPIO_WritePin(GPIOC, GPIO_PIN_13, GPIO_PIN_RESET);
   MX_CAN_Init();
-  MX_USART2_UART_Init();
 	
 	/* Start CAN and activate receive interrupt */
    HAL_CAN_Start(&hcan);
    HAL_CAN_ActivateNotification(&hcan, CAN_IT_RX_FIFO0_MSG_PENDING);
+  Boot_Mark(BOOT_CAN);
+
+  /* Start the watchdog; the monitor task refreshes it */
+  MX_IWDG_Init();
+  Boot_Mark(BOOT_PERIPH);
 
   /* Init scheduler */
   osKernelInitialize();
 
-  /* Create FreeRTOS tasks */
-  defaultTaskHandle = osThreadNew(StartDefaultTask, NULL, &(osThreadAttr_t){.name="defaultTask", .stack_size=128 * 4, .priority=osPriorityNormal});
-  serialTaskHandle = osThreadNew(serialTask_init, NULL, &(osThreadAttr_t){.name="serialTask", .stack_size=128 * 4, .priority=osPriorityNormal});
-  buzzerTaskHandle = osThreadNew(buzzerTask_init, NULL, &(osThreadAttr_t){.name="buzzerTask", .stack_size=128 * 4, .priority=osPriorityNormal});
-  lcdTaskHandle = osThreadNew(lcdTask_init, NULL, &(osThreadAttr_t){.name="lcdTask", .stack_size=128 * 4, .priority=osPriorityNormal});
+  /* Create FreeRTOS tasks with priorities derived from their deadlines */
+  Sched_CreateTasks();
+
+  /* The watchdog is only refreshed while every task keeps running */
+  for (i = 0; i < SCHED_TASK_COUNT; i++)
+    Watchdog_Register(*schedTable[i].handle);
 	
   /* Start scheduler */
   osKernelStart();
@@ -109,6 +176,19 @@ int main(void)
 	}
 }
 
+/**
+  * @brief  Initialise the peripherals left out of the fast-boot path.
+  * @note   Called by the serial task before its first job: the DMA
+  *         channel, USART2 and the non-blocking UART driver.
+  * @retval None
+  */
+void MX_Deferred_Init(void)
+{
+  MX_DMA_Init();
+  MX_USART2_UART_Init();
+  UartTx_Init(&huart2);
+}
+
 /**
   * @brief System Clock Configuration
   * @retval None
@@ -182,9 +262,10 @@ static void MX_CAN_Init(void)
 	/** 
 	* @brief  Configure CAN filter for receiving messages
 	* @details 
-	* This block sets up the CAN filter to accept messages from the
-	* transmitter node with ID 0x103. Only messages matching this
-	* ID will trigger the RX FIFO0 message pending callback.
+	* This block sets up the CAN filters to accept messages from the
+	* transmitter node with ID 0x103 (distances) and RX_CAN_POSITION_ID
+	* (obstacle position). Only messages matching these IDs will trigger
+	* the RX FIFO0 message pending callback.
 	*/
     TxHeader.DLC = 2;							
     TxHeader.ExtId = 0;
@@ -205,6 +286,11 @@ static void MX_CAN_Init(void)
     canfilterconfig.FilterScale = CAN_FILTERSCALE_32BIT;
     canfilterconfig.SlaveStartFilterBank = 0;         /**< Number of filters for master CAN */
 
+    HAL_CAN_ConfigFilter(&hcan, &canfilterconfig);
+
+    canfilterconfig.FilterBank = 2;                   /**< Filter bank index */
+    canfilterconfig.FilterIdHigh = RX_CAN_POSITION_ID << 5;  /**< Filter for the position frame */
+    canfilterconfig.FilterMaskIdHigh = 0x7FF << 5;    /**< Whole identifier */
     HAL_CAN_ConfigFilter(&hcan, &canfilterconfig);
     /* USER CODE END CAN_Config */
 }
@@ -242,6 +328,41 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+  * @brief IWDG Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_IWDG_Init(void)
+{
+  /* Keep the watchdog from resetting the node while halted in the debugger */
+  __HAL_DBGMCU_FREEZE_IWDG();
+
+  hiwdg.Instance = IWDG;
+  hiwdg.Init.Prescaler = WATCHDOG_PRESCALER;
+  hiwdg.Init.Reload = WATCHDOG_RELOAD;
+  if (HAL_IWDG_Init(&hiwdg) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Channel7_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -303,7 +424,9 @@ static void MX_GPIO_Init(void)
   * @brief  Period elapsed callback in non blocking mode
   * @note   This function is called  when TIM2 interrupt took place, inside
   * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
-  * a global variable "uwTick" used as application time base.
+  * a global variable "uwTick" used as application time base, and advances
+  * the RTOS tick (see tickless.h). The counter value is the time since the
+  * update event, i.e. the entry latency of the tick (see isr_stats.h).
   * @param  htim : TIM handle
   * @retval None
   */
@@ -316,7 +439,10 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     HAL_IncTick();
   }
   /* USER CODE BEGIN Callback 1 */
-
+  if (htim->Instance == TIM2) {
+    ISR_STATS_LATENCY(ISR_STATS_TICK, TICKLESS_TIM->CNT);
+    Tickless_IncTick();
+  }
   /* USER CODE END Callback 1 */
 }
 
@@ -327,11 +453,8 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
-  /* User can add his own implementation to report the HAL error return state */
-  __disable_irq();
-  while (1)
-  {
-  }
+  /* Record the caller and restart; the record is reported on the next boot */
+  Crash_Halt(CRASH_ERROR, CRASH_CALLER(), 0);
   /* USER CODE END Error_Handler_Debug */
 }
 
@@ -0,0 +1,160 @@
+/**
+ * @file    occupancy.c
+ * @ingroup Receiver_Node
+ * @brief   Occupancy grid of the area behind the bumper.
+ *
+ * The levels last sent to the GUI are kept two to a byte. Saturation keeps
+ * every level between 1 and 14, which leaves 15 to mark a cell as never
+ * sent, so a resync is a fill of the shadow.
+ */
+#include "occupancy.h"
+#include <string.h>
+
+/** Shadow level of a cell the GUI has not been sent */
+#define OCC_LEVEL_UNSENT        0x0Fu
+
+/** Log-odds of each cell (1/16 nat) */
+static int8_t occLogOdds[OCC_CELLS];
+
+/** Level last sent of each cell, two per byte, even cells in the low nibble */
+static uint8_t occSent[(OCC_CELLS + 1u) / 2u];
+
+/**
+ * @brief  Level last sent of a cell.
+ * @param  cell Cell index.
+ * @retval Level, or OCC_LEVEL_UNSENT.
+ */
+static uint8_t Occupancy_Sent(uint16_t cell)
+{
+    return (uint8_t)((occSent[cell >> 1] >> ((cell & 1u) * 4u)) & 0x0Fu);
+}
+
+/**
+ * @brief Record the level sent of a cell.
+ * @param cell  Cell index.
+ * @param level Level sent.
+ */
+static void Occupancy_SetSent(uint16_t cell, uint8_t level)
+{
+    uint8_t shift = (uint8_t)((cell & 1u) * 4u);
+
+    occSent[cell >> 1] = (uint8_t)((occSent[cell >> 1] & ~(0x0Fu << shift)) | (level << shift));
+}
+
+/**
+ * @brief Clear the grid to unknown and schedule it to be sent whole.
+ */
+void Occupancy_Init(void)
+{
+    memset(occLogOdds, 0, sizeof(occLogOdds));
+    Occupancy_Resync();
+}
+
+/**
+ * @brief Accumulate one measurement into the grid.
+ * @param sensor Sensor index, below OCC_SENSORS.
+ * @param cm     Measured distance (cm); OCC_NO_ECHO clears the beam.
+ */
+void Occupancy_Update(uint8_t sensor, uint8_t cm)
+{
+    const OccBeamCellTypeDef *beam = &occBeamCells[occBeamStart[sensor]];
+    const OccBeamCellTypeDef *end = &occBeamCells[occBeamStart[sensor + 1u]];
+    const int16_t near = (int16_t)cm - (int16_t)(OCC_CELL_CM / 2u);
+    const int16_t far = (int16_t)cm + (int16_t)(OCC_CELL_CM / 2u);
+    int16_t l;
+
+    /* Sorted by range: stop past the cells at the measured range */
+    for (; beam < end && beam->cm <= far; beam++)
+    {
+        l = occLogOdds[beam->cell];
+        if (beam->cm < near)
+        {
+            l += OCC_L_FREE;
+            if (l < -OCC_L_MAX)
+                l = -OCC_L_MAX;
+        }
+        else if (cm != OCC_NO_ECHO)
+        {
+            l += OCC_L_OCC;
+            if (l > OCC_L_MAX)
+                l = OCC_L_MAX;
+        }
+        occLogOdds[beam->cell] = (int8_t)l;
+    }
+}
+
+/**
+ * @brief Decay every cell towards unknown, every OCC_DECAY_MS.
+ */
+void Occupancy_Decay(void)
+{
+    uint16_t cell;
+    int8_t l;
+
+    for (cell = 0; cell < OCC_CELLS; cell++)
+    {
+        l = occLogOdds[cell];
+        if (l > 0)
+            occLogOdds[cell] = (int8_t)(l - (l >> 3) - 1);
+        else if (l < 0)
+            occLogOdds[cell] = (int8_t)(l + ((-l) >> 3) + 1);
+    }
+}
+
+/**
+ * @brief Send every cell again, starting with the next record.
+ */
+void Occupancy_Resync(void)
+{
+    memset(occSent, OCC_LEVEL_UNSENT | (OCC_LEVEL_UNSENT << 4), sizeof(occSent));
+}
+
+/**
+ * @brief  Run-length encode the cells changed since they were last sent.
+ *
+ * A set run goes on over following cells of the same level whether they
+ * changed or not, which is cheaper than a skip run between them.
+ *
+ * @param  buf Output buffer.
+ * @param  max Size of buf (bytes).
+ * @retval Number of bytes written; 0 when no cell changed.
+ */
+uint8_t Occupancy_Encode(uint8_t *buf, uint8_t max)
+{
+    uint16_t cell = 0;
+    uint16_t skip = 0;
+    uint16_t run;
+    uint8_t n = 0;
+    uint8_t level, count;
+
+    while (cell < OCC_CELLS)
+    {
+        level = OCC_LEVEL(occLogOdds[cell]);
+        if (level == Occupancy_Sent(cell))
+        {
+            skip++;
+            cell++;
+            continue;
+        }
+
+        /* The skip runs up to this cell and one set run have to fit */
+        if (n + (skip + OCC_RUN_SKIP_MAX - 1u) / OCC_RUN_SKIP_MAX + 1u > max)
+            break;
+        while (skip)
+        {
+            run = (skip < OCC_RUN_SKIP_MAX) ? skip : OCC_RUN_SKIP_MAX;
+            buf[n++] = (uint8_t)(run - 1u);
+            skip -= run;
+        }
+
+        count = 0;
+        do
+        {
+            Occupancy_SetSent(cell, level);
+            cell++;
+            count++;
+        } while (cell < OCC_CELLS && count < OCC_RUN_SET_MAX && OCC_LEVEL(occLogOdds[cell]) == level);
+        buf[n++] = (uint8_t)(OCC_RUN_SET | (level << 3) | (count - 1u));
+    }
+    return n;
+}
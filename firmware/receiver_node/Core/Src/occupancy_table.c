@@ -0,0 +1,63 @@
+/**
+ * @file    occupancy_table.c
+ * @ingroup Receiver_Node
+ * @brief   Occupancy grid beam tables.
+ *
+ * Generated by tools/gen_occupancy_table.py - do not edit by hand.
+ */
+#include "occupancy_table.h"
+
+const OccBeamCellTypeDef occBeamCells[OCC_BEAM_CELLS] = {
+    /* Sensor 0: -150 mm, 0 deg */
+    {   6u,   5u }, {  22u,  15u }, {  38u,  25u }, {  37u,  27u }, {  39u,  27u }, {  54u,  35u },
+    {  53u,  36u }, {  55u,  36u }, {  52u,  40u }, {  56u,  40u }, {  70u,  45u }, {  69u,  46u },
+    {  71u,  46u }, {  68u,  49u }, {  72u,  49u }, {  86u,  55u }, {  85u,  56u }, {  87u,  56u },
+    {  84u,  59u }, {  88u,  59u }, {  83u,  63u }, {  89u,  63u }, { 102u,  65u }, { 101u,  66u },
+    { 103u,  66u }, { 100u,  68u }, { 104u,  68u }, {  99u,  72u }, { 105u,  72u }, { 118u,  75u },
+    { 117u,  76u }, { 119u,  76u }, { 116u,  78u }, { 120u,  78u }, { 115u,  81u }, { 121u,  81u },
+    { 114u,  85u }, { 122u,  85u }, { 134u,  85u }, { 133u,  86u }, { 135u,  86u }, { 132u,  87u },
+    { 136u,  87u }, { 131u,  90u }, { 137u,  90u }, { 130u,  94u }, { 138u,  94u }, { 150u,  95u },
+    { 149u,  96u }, { 151u,  96u }, { 148u,  97u }, { 152u,  97u }, { 147u, 100u }, { 153u, 100u },
+    { 146u, 103u }, { 154u, 103u }, { 165u, 105u }, { 166u, 105u }, { 167u, 105u }, { 145u, 107u },
+    { 155u, 107u }, { 164u, 107u }, { 168u, 107u }, { 163u, 109u }, { 169u, 109u }, { 162u, 112u },
+    { 170u, 112u }, { 181u, 115u }, { 182u, 115u }, { 183u, 115u }, { 161u, 116u }, { 171u, 116u },
+    { 180u, 117u }, { 184u, 117u }, { 179u, 119u }, { 185u, 119u }, { 160u, 121u }, { 172u, 121u },
+    { 178u, 122u }, { 186u, 122u }, { 177u, 125u }, { 187u, 125u }, { 197u, 125u }, { 198u, 125u },
+    { 199u, 125u }, { 196u, 127u }, { 200u, 127u }, { 195u, 129u }, { 201u, 129u }, { 176u, 130u },
+    { 188u, 130u }, { 194u, 131u }, { 202u, 131u }, { 193u, 135u }, { 203u, 135u }, { 213u, 135u },
+    { 214u, 135u }, { 215u, 135u }, { 212u, 136u }, { 216u, 136u }, { 211u, 138u }, { 217u, 138u },
+    { 192u, 139u }, { 204u, 139u }, { 210u, 141u }, { 218u, 141u }, { 205u, 143u }, { 209u, 144u },
+    { 219u, 144u }, { 229u, 145u }, { 230u, 145u }, { 231u, 145u }, { 228u, 146u }, { 232u, 146u },
+    { 208u, 148u }, { 220u, 148u }, { 227u, 148u }, { 233u, 148u }, { 226u, 150u }, { 234u, 150u },
+    { 221u, 152u }, { 225u, 153u }, { 235u, 153u }, { 245u, 155u }, { 246u, 155u }, { 247u, 155u },
+    { 244u, 156u }, { 248u, 156u }, { 224u, 157u }, { 236u, 157u }, { 243u, 158u }, { 249u, 158u },
+    { 242u, 160u }, { 250u, 160u }, { 237u, 161u }, { 241u, 163u }, { 251u, 163u }, { 238u, 166u },
+    { 240u, 166u }, { 252u, 166u }, { 253u, 170u }, { 254u, 174u },
+    /* Sensor 1: 150 mm, 0 deg */
+    {   9u,   5u }, {  25u,  15u }, {  41u,  25u }, {  40u,  27u }, {  42u,  27u }, {  57u,  35u },
+    {  56u,  36u }, {  58u,  36u }, {  55u,  40u }, {  59u,  40u }, {  73u,  45u }, {  72u,  46u },
+    {  74u,  46u }, {  71u,  49u }, {  75u,  49u }, {  89u,  55u }, {  88u,  56u }, {  90u,  56u },
+    {  87u,  59u }, {  91u,  59u }, {  86u,  63u }, {  92u,  63u }, { 105u,  65u }, { 104u,  66u },
+    { 106u,  66u }, { 103u,  68u }, { 107u,  68u }, { 102u,  72u }, { 108u,  72u }, { 121u,  75u },
+    { 120u,  76u }, { 122u,  76u }, { 119u,  78u }, { 123u,  78u }, { 118u,  81u }, { 124u,  81u },
+    { 117u,  85u }, { 125u,  85u }, { 137u,  85u }, { 136u,  86u }, { 138u,  86u }, { 135u,  87u },
+    { 139u,  87u }, { 134u,  90u }, { 140u,  90u }, { 133u,  94u }, { 141u,  94u }, { 153u,  95u },
+    { 152u,  96u }, { 154u,  96u }, { 151u,  97u }, { 155u,  97u }, { 150u, 100u }, { 156u, 100u },
+    { 149u, 103u }, { 157u, 103u }, { 168u, 105u }, { 169u, 105u }, { 170u, 105u }, { 148u, 107u },
+    { 158u, 107u }, { 167u, 107u }, { 171u, 107u }, { 166u, 109u }, { 172u, 109u }, { 165u, 112u },
+    { 173u, 112u }, { 184u, 115u }, { 185u, 115u }, { 186u, 115u }, { 164u, 116u }, { 174u, 116u },
+    { 183u, 117u }, { 187u, 117u }, { 182u, 119u }, { 188u, 119u }, { 163u, 121u }, { 175u, 121u },
+    { 181u, 122u }, { 189u, 122u }, { 180u, 125u }, { 190u, 125u }, { 200u, 125u }, { 201u, 125u },
+    { 202u, 125u }, { 199u, 127u }, { 203u, 127u }, { 198u, 129u }, { 204u, 129u }, { 179u, 130u },
+    { 191u, 130u }, { 197u, 131u }, { 205u, 131u }, { 196u, 135u }, { 206u, 135u }, { 216u, 135u },
+    { 217u, 135u }, { 218u, 135u }, { 215u, 136u }, { 219u, 136u }, { 214u, 138u }, { 220u, 138u },
+    { 195u, 139u }, { 207u, 139u }, { 213u, 141u }, { 221u, 141u }, { 194u, 143u }, { 212u, 144u },
+    { 222u, 144u }, { 232u, 145u }, { 233u, 145u }, { 234u, 145u }, { 231u, 146u }, { 235u, 146u },
+    { 211u, 148u }, { 223u, 148u }, { 230u, 148u }, { 236u, 148u }, { 229u, 150u }, { 237u, 150u },
+    { 210u, 152u }, { 228u, 153u }, { 238u, 153u }, { 248u, 155u }, { 249u, 155u }, { 250u, 155u },
+    { 247u, 156u }, { 251u, 156u }, { 227u, 157u }, { 239u, 157u }, { 246u, 158u }, { 252u, 158u },
+    { 245u, 160u }, { 253u, 160u }, { 226u, 161u }, { 244u, 163u }, { 254u, 163u }, { 225u, 166u },
+    { 243u, 166u }, { 255u, 166u }, { 242u, 170u }, { 241u, 174u },
+};
+
+const uint16_t occBeamStart[OCC_SENSORS + 1u] = { 0u, 142u, 284u };
@@ -0,0 +1,40 @@
+/**
+ * @file    predict.c
+ * @ingroup Receiver_Node
+ * @brief   Latency-compensating range prediction.
+ */
+#include "predict.h"
+
+/**
+ * @brief  Extrapolate a distance to the present.
+ * @param  cm           Distance of the sample (cm), or PREDICT_NO_ECHO.
+ * @param  closing_mm_s Closing velocity (mm/s), positive approaching.
+ * @param  confident    Non-zero if the velocity is confident.
+ * @param  age_ms       Age of the sample (ms).
+ * @retval Predicted distance (cm).
+ */
+uint8_t Predict_Cm(uint8_t cm, int16_t closing_mm_s, uint8_t confident, uint32_t age_ms)
+{
+    int32_t shift, out;
+
+    if (!confident || cm == PREDICT_NO_ECHO)
+        return cm;
+
+    if (age_ms > PREDICT_MAX_AGE_MS)
+        age_ms = PREDICT_MAX_AGE_MS;
+
+    /* mm/s * ms is um; to cm, rounded half away from zero */
+    shift = (int32_t)closing_mm_s * (int32_t)age_ms;
+    shift = (shift >= 0) ? (shift + 5000) / 10000 : (shift - 5000) / 10000;
+    if (shift > PREDICT_MAX_SHIFT_CM)
+        shift = PREDICT_MAX_SHIFT_CM;
+    else if (shift < -PREDICT_MAX_SHIFT_CM)
+        shift = -PREDICT_MAX_SHIFT_CM;
+
+    out = (int32_t)cm - shift;
+    if (out < 0)
+        return 0;
+    if (out > (int32_t)PREDICT_MAX_CM)
+        return PREDICT_MAX_CM;
+    return (uint8_t)out;
+}
@@ -57,6 +57,7 @@
   */
 
 #include "stm32f1xx.h"
+#include "boot_time.h"
 
 /**
   * @}
@@ -175,6 +176,9 @@ const uint8_t APBPrescTable[8U] =  {0, 0, 0, 0, 1, 2, 3, 4};
   */
 void SystemInit (void)
 {
+  /* Time the boot from reset (see boot_time.h) */
+  Boot_Start();
+
 #if defined(STM32F100xE) || defined(STM32F101xE) || defined(STM32F101xG) || defined(STM32F103xE) || defined(STM32F103xG)
   #ifdef DATA_IN_ExtSRAM
     SystemInit_ExtMemCtl(); 
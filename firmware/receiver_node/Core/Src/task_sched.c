@@ -0,0 +1,158 @@
+/**
+ * @file    task_sched.c
+ * @ingroup Receiver_Node
+ * @brief   Periodic task table, priority assignment and deadline monitor.
+ *
+ * Keep one table row per line: tools/sched_check.py parses the rows to
+ * simulate the schedule on the host.
+ */
+#include "task_sched.h"
+#include "app_tasks.h"
+#include "trace.h"
+#include "watchdog.h"
+#include "boot_time.h"
+
+/* Task stacks; uint64_t keeps the 8-byte alignment the AAPCS expects */
+static uint64_t defaultStack[512 / 8];
+static uint64_t serialStack[512 / 8];
+static uint64_t buzzerStack[512 / 8];
+static uint64_t lcdStack[512 / 8];
+static uint64_t monitorStack[256 / 8];
+
+/** Receiver task table */
+const SchedTaskTypeDef schedTable[SCHED_TASK_COUNT] = {
+    /* name           entry             stack                      period  deadline  wcet_us  handle */
+    { "defaultTask",  StartDefaultTask, SCHED_STACK(defaultStack), 5u,     5u,       150u,    &defaultTaskHandle },
+    { "serialTask",   serialTask_init,  SCHED_STACK(serialStack),  60u,    60u,      400u,    &serialTaskHandle },
+    { "buzzerTask",   buzzerTask_init,  SCHED_STACK(buzzerStack),  10u,    5u,       50u,     &buzzerTaskHandle },
+    { "lcdTask",      lcdTask_init,     SCHED_STACK(lcdStack),     7u,     7u,       100u,    &lcdTaskHandle },
+    { "monitorTask",  monitorTask_init, SCHED_STACK(monitorStack), 500u,   500u,     150u,    &monitorTaskHandle },
+};
+
+/** Task control blocks */
+static StaticTask_t schedTcb[SCHED_TASK_COUNT];
+
+/** Priorities derived by Sched_CreateTasks */
+static osPriority_t schedPriority[SCHED_TASK_COUNT];
+
+/** Runtime statistics per task */
+static SchedStatsTypeDef schedStats[SCHED_TASK_COUNT];
+
+/**
+ * @brief Create all tasks in schedTable with derived priorities, using
+ *        static control blocks and stacks.
+ */
+void Sched_CreateTasks(void)
+{
+    osThreadAttr_t attr = {0};
+    uint8_t i, j, rank;
+
+    for (i = 0; i < SCHED_TASK_COUNT; i++)
+    {
+        /* Rank = number of tasks that must run before this one */
+        rank = 0;
+        for (j = 0; j < SCHED_TASK_COUNT; j++)
+        {
+            if (schedTable[j].deadline < schedTable[i].deadline ||
+                (schedTable[j].deadline == schedTable[i].deadline && j < i))
+                rank++;
+        }
+        schedPriority[i] = (osPriority_t)(SCHED_BASE_PRIORITY + (SCHED_TASK_COUNT - 1u - rank));
+
+        attr.name = schedTable[i].name;
+        attr.cb_mem = &schedTcb[i];
+        attr.cb_size = sizeof(schedTcb[i]);
+        attr.stack_mem = schedTable[i].stack;
+        attr.stack_size = schedTable[i].stack_size;
+        attr.priority = schedPriority[i];
+        *schedTable[i].handle = osThreadNew(schedTable[i].entry, NULL, &attr);
+    }
+}
+
+/**
+ * @brief Priority assigned to a task by Sched_CreateTasks.
+ * @param id Task identifier.
+ */
+osPriority_t Sched_GetPriority(SchedTaskIdTypeDef id)
+{
+    return schedPriority[id];
+}
+
+/**
+ * @brief Mark the release of a task's first job.
+ * @param id Task identifier.
+ */
+void Sched_Start(SchedTaskIdTypeDef id)
+{
+    Boot_Mark(BOOT_SCHEDULER);
+    schedStats[id].release = osKernelGetTickCount();
+}
+
+/**
+ * @brief End the current job, record its response time and sleep until
+ *        the next release.
+ * @param id Task identifier.
+ */
+void Sched_WaitNextPeriod(SchedTaskIdTypeDef id)
+{
+    const SchedTaskTypeDef *task = &schedTable[id];
+    SchedStatsTypeDef *stats = &schedStats[id];
+    uint32_t now = osKernelGetTickCount();
+    uint32_t response = now - stats->release;
+
+    stats->jobs++;
+    Watchdog_Checkin();
+    if (response > stats->worst_response)
+        stats->worst_response = response;
+    if (response > task->deadline)
+    {
+        stats->misses++;
+        TRACE_FREEZE();   /* Keep the events that led to the miss */
+    }
+
+    stats->release += task->period;
+
+    /* Overran into the next period: re-anchor instead of bursting */
+    if ((int32_t)(now - stats->release) >= 0)
+    {
+        stats->release = now;
+        return;
+    }
+
+    osDelayUntil(stats->release);
+}
+
+/**
+ * @brief Runtime statistics of a task.
+ * @param id Task identifier.
+ */
+const SchedStatsTypeDef *Sched_GetStats(SchedTaskIdTypeDef id)
+{
+    return &schedStats[id];
+}
+
+/**
+ * @brief  Serialise the statistics for a FRAME_DIAG_SCHED record.
+ * @param  buf Output buffer of at least 1 + 5 * SCHED_TASK_COUNT bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t Sched_Report(uint8_t *buf)
+{
+    uint8_t n = 0;
+    uint8_t i;
+    uint32_t misses, worst;
+
+    buf[n++] = SCHED_TASK_COUNT;
+    for (i = 0; i < SCHED_TASK_COUNT; i++)
+    {
+        misses = schedStats[i].misses > 0xFFFFu ? 0xFFFFu : schedStats[i].misses;
+        worst = schedStats[i].worst_response > 0xFFFFu ? 0xFFFFu : schedStats[i].worst_response;
+
+        buf[n++] = (uint8_t)schedPriority[i];
+        buf[n++] = (uint8_t)misses;
+        buf[n++] = (uint8_t)(misses >> 8);
+        buf[n++] = (uint8_t)worst;
+        buf[n++] = (uint8_t)(worst >> 8);
+    }
+    return n;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file    trace.c
+ * @ingroup Receiver_Node
+ * @brief   RAM ring trace of RTOS and application events.
+ */
+#include "trace.h"
+
+#if TRACE_ENABLE
+
+#include "main.h"
+
+#if (TRACE_BUFFER_EVENTS & (TRACE_BUFFER_EVENTS - 1u)) != 0
+#error "TRACE_BUFFER_EVENTS must be a power of two"
+#endif
+
+/** Event ring */
+static TraceEventTypeDef traceRing[TRACE_BUFFER_EVENTS];
+
+/** Index of the next event to write */
+static uint16_t traceHead;
+
+/** Number of valid events in the ring */
+static uint16_t traceCount;
+
+/** Non-zero while recording is stopped */
+static volatile uint8_t traceFrozen;
+
+/**
+ * @brief Append an event to the ring (no-op while frozen).
+ * @param type TRACE_EV_* type.
+ * @param id   Task, exception or marker id.
+ * @param arg  Event argument.
+ */
+void Trace_Record(uint8_t type, uint8_t id, uint16_t arg)
+{
+    TraceEventTypeDef *event;
+    uint32_t primask;
+
+    if (traceFrozen)
+        return;
+
+    /* PRIMASK rather than a kernel critical section: this also runs inside
+       the scheduler and in ISRs above configMAX_SYSCALL_INTERRUPT_PRIORITY */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    event = &traceRing[traceHead];
+    event->cycles = DWT->CYCCNT;
+    event->type = type;
+    event->id = id;
+    event->arg = arg;
+
+    traceHead = (traceHead + 1u) & (TRACE_BUFFER_EVENTS - 1u);
+    if (traceCount < TRACE_BUFFER_EVENTS)
+        traceCount++;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Record entry into the current exception handler.
+ */
+void Trace_IsrEnter(void)
+{
+    Trace_Record(TRACE_EV_ISR_ENTER, (uint8_t)__get_IPSR(), 0);
+}
+
+/**
+ * @brief Record exit from the current exception handler.
+ */
+void Trace_IsrExit(void)
+{
+    Trace_Record(TRACE_EV_ISR_EXIT, (uint8_t)__get_IPSR(), 0);
+}
+
+/**
+ * @brief Stop recording and keep the current snapshot.
+ */
+void Trace_Freeze(void)
+{
+    traceFrozen = 1;
+}
+
+/**
+ * @brief Non-zero while recording is stopped.
+ */
+uint8_t Trace_IsFrozen(void)
+{
+    return traceFrozen;
+}
+
+/**
+ * @brief Number of events in the snapshot.
+ */
+uint16_t Trace_Count(void)
+{
+    return traceCount;
+}
+
+/**
+ * @brief Copy one event of the snapshot.
+ * @param index Event index, 0 being the oldest.
+ * @param event Destination.
+ */
+void Trace_Read(uint16_t index, TraceEventTypeDef *event)
+{
+    uint16_t pos = (uint16_t)(traceHead - traceCount + index) & (TRACE_BUFFER_EVENTS - 1u);
+
+    *event = traceRing[pos];
+}
+
+/**
+ * @brief Discard the snapshot and start recording again.
+ */
+void Trace_Resume(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    traceHead = 0;
+    traceCount = 0;
+    traceFrozen = 0;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Serialise part of the snapshot for a FRAME_DIAG_TRACE record.
+ * @param  first Index of the first event to include.
+ * @param  buf   Output buffer of at least 4 + 8 * TRACE_CHUNK_EVENTS bytes.
+ * @retval Number of bytes written.
+ */
+uint8_t Trace_Report(uint16_t first, uint8_t *buf)
+{
+    TraceEventTypeDef event;
+    uint8_t n = 0;
+    uint16_t i;
+
+    buf[n++] = (uint8_t)first;
+    buf[n++] = (uint8_t)(first >> 8);
+    buf[n++] = (uint8_t)traceCount;
+    buf[n++] = (uint8_t)(traceCount >> 8);
+
+    for (i = first; i < traceCount && i < first + TRACE_CHUNK_EVENTS; i++)
+    {
+        Trace_Read(i, &event);
+        buf[n++] = (uint8_t)event.cycles;
+        buf[n++] = (uint8_t)(event.cycles >> 8);
+        buf[n++] = (uint8_t)(event.cycles >> 16);
+        buf[n++] = (uint8_t)(event.cycles >> 24);
+        buf[n++] = event.type;
+        buf[n++] = event.id;
+        buf[n++] = (uint8_t)event.arg;
+        buf[n++] = (uint8_t)(event.arg >> 8);
+    }
+    return n;
+}
+
+#endif /* TRACE_ENABLE */
@@ -0,0 +1,129 @@
+/**
+ * @file    uart_tx.c
+ * @ingroup Receiver_Node
+ * @brief   Non-blocking UART transmit driver (ring buffer drained by DMA).
+ *
+ * txHead is advanced by writers inside a critical section, txTail by the
+ * transmit-complete interrupt once a DMA chunk has gone out. Bytes between
+ * txTail and txTail + txDmaLen are owned by the DMA and never overwritten.
+ */
+#include "uart_tx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+#define UART_TX_MASK  (UART_TX_BUFFER_SIZE - 1u)
+
+/** Transmit ring buffer */
+static uint8_t txBuffer[UART_TX_BUFFER_SIZE];
+/** Index of the next free byte */
+static volatile uint16_t txHead;
+/** Index of the oldest unsent byte */
+static volatile uint16_t txTail;
+/** Bytes handed to the DMA and not yet completed (0 when idle) */
+static volatile uint16_t txDmaLen;
+/** Messages dropped on overflow */
+static volatile uint32_t txOverflows;
+/** UART used for transmission */
+static UART_HandleTypeDef *txUart;
+
+/**
+ * @brief Start a DMA transfer of the next contiguous chunk if idle.
+ * @note  Called with interrupts masked or from the UART interrupt.
+ */
+static void UartTx_Kick(void)
+{
+    uint16_t head = txHead;
+    uint16_t len;
+
+    if (txDmaLen != 0 || head == txTail)
+        return;
+
+    /* Send up to the end of the buffer; the wrap is sent next time */
+    if (head > txTail)
+        len = head - txTail;
+    else
+        len = UART_TX_BUFFER_SIZE - txTail;
+
+    if (HAL_UART_Transmit_DMA(txUart, &txBuffer[txTail], len) == HAL_OK)
+        txDmaLen = len;
+}
+
+/**
+ * @brief Attach the driver to a UART whose TX DMA channel is linked.
+ * @param huart UART handle to transmit on.
+ */
+void UartTx_Init(UART_HandleTypeDef *huart)
+{
+    txUart = huart;
+    txHead = 0;
+    txTail = 0;
+    txDmaLen = 0;
+    txOverflows = 0;
+}
+
+/**
+ * @brief Queue bytes for transmission without blocking.
+ * @param data Bytes to send.
+ * @param len  Number of bytes.
+ * @retval Number of bytes queued (len, or 0 on overflow).
+ */
+uint16_t UartTx_Write(const uint8_t *data, uint16_t len)
+{
+    uint16_t head, space, first;
+
+    taskENTER_CRITICAL();
+
+    head = txHead;
+    space = (uint16_t)((txTail - head - 1u) & UART_TX_MASK);
+
+    if (len > space)
+    {
+        txOverflows++;
+        taskEXIT_CRITICAL();
+        return 0;
+    }
+
+    first = UART_TX_BUFFER_SIZE - head;
+    if (first > len)
+        first = len;
+    memcpy(&txBuffer[head], data, first);
+    memcpy(&txBuffer[0], data + first, len - first);
+    txHead = (uint16_t)((head + len) & UART_TX_MASK);
+
+    UartTx_Kick();
+
+    taskEXIT_CRITICAL();
+    return len;
+}
+
+/**
+ * @brief  Free space in the buffer.
+ * @retval Bytes that can be queued now.
+ */
+uint16_t UartTx_GetFree(void)
+{
+    return (uint16_t)((txTail - txHead - 1u) & UART_TX_MASK);
+}
+
+/**
+ * @brief Number of messages dropped because the buffer was full.
+ */
+uint32_t UartTx_GetOverflowCount(void)
+{
+    return txOverflows;
+}
+
+/**
+ * @brief Transmit-complete hook, called from HAL_UART_TxCpltCallback.
+ * @param huart UART handle that completed.
+ */
+void UartTx_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart != txUart)
+        return;
+
+    txTail = (uint16_t)((txTail + txDmaLen) & UART_TX_MASK);
+    txDmaLen = 0;
+    UartTx_Kick();
+}
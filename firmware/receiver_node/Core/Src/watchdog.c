@@ -0,0 +1,95 @@
+/**
+ * @file    watchdog.c
+ * @ingroup Receiver_Node
+ * @brief   Independent watchdog fed by a task-liveness check.
+ */
+#include "watchdog.h"
+#include "crash.h"
+
+/** One supervised task */
+typedef struct
+{
+    osThreadId_t      thread;   /**< Supervised task */
+    volatile uint16_t beats;    /**< Check-ins, written by the task only */
+    uint16_t          seen;     /**< beats at the previous check */
+} WatchdogEntryTypeDef;
+
+/** Supervised tasks */
+static WatchdogEntryTypeDef watchdogTask[WATCHDOG_MAX_TASKS];
+
+/** Number of entries in watchdogTask */
+static uint8_t watchdogCount;
+
+/** Consecutive failed checks */
+static uint8_t watchdogMisses;
+
+/**
+ * @brief Supervise a task; it must call Watchdog_Checkin at least once
+ *        per supervision period from then on.
+ * @param thread Task handle; ignored if NULL or the table is full.
+ */
+void Watchdog_Register(osThreadId_t thread)
+{
+    if (thread == NULL || watchdogCount >= WATCHDOG_MAX_TASKS)
+        return;
+
+    watchdogTask[watchdogCount].thread = thread;
+    watchdogTask[watchdogCount].beats = 0;
+    watchdogTask[watchdogCount].seen = 0;
+    watchdogCount++;
+}
+
+/**
+ * @brief Report the calling task alive.
+ *
+ * Each task only writes its own counter, so no locking is needed.
+ */
+void Watchdog_Checkin(void)
+{
+    osThreadId_t self = osThreadGetId();
+    uint8_t i;
+
+    for (i = 0; i < watchdogCount; i++)
+    {
+        if (watchdogTask[i].thread == self)
+        {
+            watchdogTask[i].beats++;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Refresh the IWDG if every supervised task checked in since the
+ *        previous call. Call periodically, well within the timeout.
+ */
+void Watchdog_Supervise(void)
+{
+    WatchdogEntryTypeDef *stuck = NULL;
+    uint16_t beats;
+    uint8_t i;
+
+    for (i = 0; i < watchdogCount; i++)
+    {
+        beats = watchdogTask[i].beats;
+        if (beats == watchdogTask[i].seen)
+        {
+            if (stuck == NULL)
+                stuck = &watchdogTask[i];
+        }
+        watchdogTask[i].seen = beats;
+    }
+
+    if (stuck == NULL)
+    {
+        if (watchdogMisses >= WATCHDOG_RECORD_AFTER)
+            Crash_Clear();   /* Recovered: drop the pending record */
+        watchdogMisses = 0;
+        HAL_IWDG_Refresh(&hiwdg);
+        return;
+    }
+
+    /* No refresh: the IWDG resets the node unless the task recovers */
+    if (++watchdogMisses == WATCHDOG_RECORD_AFTER)
+        Crash_Save(CRASH_WATCHDOG, stuck->thread);
+}
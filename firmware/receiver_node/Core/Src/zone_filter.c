@@ -0,0 +1,70 @@
+/**
+ * @file    zone_filter.c
+ * @ingroup Receiver_Node
+ * @brief   Hysteresis and dwell filter for zone classification.
+ *
+ * The same rules are implemented by ZoneFilter in gui/distance_logic.py,
+ * and both use the limits generated into the zone table.
+ */
+#include "zone_filter.h"
+
+/**
+ * @brief Reset a filter to the farthest zone.
+ * @param filter Filter state to initialise.
+ */
+void ZoneFilter_Init(ZoneFilterTypeDef *filter)
+{
+    filter->entry = &zoneTable[ZONE_BUCKET_COUNT - 1];
+    filter->pendingSince = 0;
+    filter->pending = 0;
+}
+
+/**
+ * @brief Feed one distance sample through the filter.
+ * @param filter Filter state.
+ * @param cm     Distance in centimetres.
+ * @param now    Current time in ms.
+ * @retval Non-zero if the indicated zone changed on this sample.
+ */
+uint8_t ZoneFilter_Update(ZoneFilterTypeDef *filter, uint8_t cm, uint32_t now)
+{
+    const ZoneEntryTypeDef *raw = Zone_Lookup(cm);
+    uint8_t current = filter->entry->zone;
+
+    if (raw->zone == current)
+    {
+        filter->pending = 0;
+        return 0;
+    }
+
+    /* Closer: escalate immediately */
+    if (raw->zone < current)
+    {
+        filter->entry = raw;
+        filter->pending = 0;
+        return 1;
+    }
+
+    /* Farther: only inside the release band, wait */
+    if (cm <= zoneRelease[current])
+    {
+        filter->pending = 0;
+        return 0;
+    }
+
+    if (!filter->pending)
+    {
+        filter->pending = 1;
+        filter->pendingSince = now;
+        return 0;
+    }
+
+    if ((uint32_t)(now - filter->pendingSince) < ZONE_DWELL_MS)
+    {
+        return 0;
+    }
+
+    filter->entry = raw;
+    filter->pending = 0;
+    return 1;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file    zone_table.c
+ * @ingroup Receiver_Node
+ * @brief   Distance-to-zone lookup table data.
+ *
+ * Generated by tools/gen_zone_table.py - do not edit by hand.
+ */
+#include "zone_table.h"
+
+const ZoneEntryTypeDef zoneTable[ZONE_BUCKET_COUNT] = {
+    { ZONE_RED_FULL,    0x7Fu, ZONE_BUZZER_CONTINUOUS },  /*   0..  0 cm */
+    { ZONE_RED_FULL,    0x7Fu, ZONE_BUZZER_CONTINUOUS },  /*   1.. 10 cm */
+    { ZONE_RED_FULL,    0x7Fu, ZONE_BUZZER_CONTINUOUS },  /*  11.. 20 cm */
+    { ZONE_RED_FULL,    0x7Fu, ZONE_BUZZER_CONTINUOUS },  /*  21.. 30 cm */
+    { ZONE_RED,         0x3Fu, 50u                    },  /*  31.. 40 cm */
+    { ZONE_RED,         0x3Fu, 50u                    },  /*  41.. 50 cm */
+    { ZONE_YELLOW_FULL, 0x1Fu, 100u                   },  /*  51.. 60 cm */
+    { ZONE_YELLOW_FULL, 0x1Fu, 100u                   },  /*  61.. 70 cm */
+    { ZONE_YELLOW,      0x0Fu, 300u                   },  /*  71.. 80 cm */
+    { ZONE_YELLOW,      0x0Fu, 300u                   },  /*  81.. 90 cm */
+    { ZONE_GREEN_FULL,  0x07u, 400u                   },  /*  91..100 cm */
+    { ZONE_GREEN_FULL,  0x07u, 400u                   },  /* 101..110 cm */
+    { ZONE_GREEN,       0x03u, 600u                   },  /* 111..120 cm */
+    { ZONE_GREEN,       0x03u, 600u                   },  /* 121..130 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 131..140 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 141..150 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 151..160 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 161..170 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 171..180 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 181..190 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 191..200 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 201..210 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 211..220 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 221..230 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 231..240 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 241..250 cm */
+    { ZONE_NONE,        0x01u, ZONE_BUZZER_OFF        },  /* 251..255 cm */
+};
+
+const uint8_t zoneRelease[ZONE_COUNT] = {
+    34u,  /* ZONE_RED_FULL */
+    55u,  /* ZONE_RED */
+    75u,  /* ZONE_YELLOW_FULL */
+    96u,  /* ZONE_YELLOW */
+    116u, /* ZONE_GREEN_FULL */
+    138u, /* ZONE_GREEN */
+    255u, /* ZONE_NONE */
+};
+
+const uint8_t zoneTtcCm[ZONE_TTC_BUCKET_COUNT] = {
+    0u,   /*    0 ms */
+    5u,   /*  100 ms */
+    10u,  /*  200 ms */
+    15u,  /*  300 ms */
+    20u,  /*  400 ms */
+    25u,  /*  500 ms */
+    30u,  /*  600 ms */
+    35u,  /*  700 ms */
+    40u,  /*  800 ms */
+    45u,  /*  900 ms */
+    50u,  /* 1000 ms */
+    55u,  /* 1100 ms */
+    60u,  /* 1200 ms */
+    65u,  /* 1300 ms */
+    70u,  /* 1400 ms */
+    75u,  /* 1500 ms */
+    80u,  /* 1600 ms */
+    85u,  /* 1700 ms */
+    90u,  /* 1800 ms */
+    95u,  /* 1900 ms */
+    100u, /* 2000 ms */
+    105u, /* 2100 ms */
+    110u, /* 2200 ms */
+    115u, /* 2300 ms */
+    120u, /* 2400 ms */
+    125u, /* 2500 ms */
+    130u, /* 2600 ms */
+};
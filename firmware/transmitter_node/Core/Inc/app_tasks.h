@@ -4,8 +4,9 @@
  * @brief   FreeRTOS task declarations for the transmitter node.
  *
  * This header exposes:
- *   - Prototypes for ultrasonic sensor tasks
- *   - The CAN transmission task
+ *   - The CAN and report slot functions run by the time-triggered
+ *     schedule (tt_sched.h)
+ *   - The stack monitor task
  *   - External CAN-related variables shared with the main program
  *
  * All tasks declared here are created and managed in main.c.
@@ -26,25 +27,91 @@ extern "C" {
  * ---------------------------------------------------------------------------*/
 
 /**
- * @brief  Task for first ultrasonic sensor reading.
- * @param  argument: Pointer passed to the task (not used)
+ * @brief  Send the distances of the current cycle via CAN (CAN slot).
  * @retval None
  */
-void us1Task_init(void *argument);
+void Tx_SendDistances(void);
 
 /**
- * @brief  Task for second ultrasonic sensor reading.
- * @param  argument: Pointer passed to the task (not used)
+ * @brief  Write the next diagnostic line on USART2 (report slot).
  * @retval None
  */
-void us2Task_init(void *argument);
+void Tx_Report(void);
 
 /**
- * @brief  Task for transmitting measured distances via CAN.
+ * @brief  Task sampling the stack high-water marks (see stack_mon.h).
  * @param  argument: Pointer passed to the task (not used)
  * @retval None
  */
-void TxTask_init(void *argument);
+void MonTask_init(void *argument);
+
+/* ---------------------------------------------------------------------------
+ * CAN payload (StdId 0x103), sent once per schedule cycle
+ * ---------------------------------------------------------------------------*/
+
+/** Offset of the filtered distance of each sensor (cm, u8) */
+#define TX_CAN_DISTANCE         0u
+/** Offset of the closing velocity of each sensor (mm/s, s16 little-endian,
+ *  positive approaching) */
+#define TX_CAN_CLOSING          USENSOR_COUNT
+/** Offset of the tracker flags (TX_CAN_FLAG_*) */
+#define TX_CAN_FLAGS            (3u * USENSOR_COUNT)
+/** Offset of the sample ages: a TX_CAN_AGE_BITS field per sensor, in
+ *  TX_CAN_AGE_UNIT_MS, from the echo to the frame plus the filter lag */
+#define TX_CAN_AGE              (3u * USENSOR_COUNT + 1u)
+/** Payload length */
+#define TX_CAN_DLC              (3u * USENSOR_COUNT + 2u)
+
+/** Closing velocity of sensor i is confident */
+#define TX_CAN_FLAG_CONFIDENT(i)    (1u << (i))
+/** Reading of sensor i was classed ground or noise and dropped before
+ *  the filter (see obstacle_class.h) */
+#define TX_CAN_FLAG_DROPPED(i)      (1u << (USENSOR_COUNT + (i)))
+
+/** Width of each sample age field */
+#define TX_CAN_AGE_BITS         4u
+/** Unit of the sample ages (ms); the largest age sent is 15 units */
+#define TX_CAN_AGE_UNIT_MS      16u
+
+#if 2u * USENSOR_COUNT > 8u
+#error "The flags of every sensor must fit in the TX_CAN_FLAGS byte"
+#endif
+
+#if USENSOR_COUNT * TX_CAN_AGE_BITS > 8u
+#error "The sample ages of every sensor must fit in the TX_CAN_AGE byte"
+#endif
+
+/* ---------------------------------------------------------------------------
+ * Position payload (StdId TX_CAN_POSITION_ID), sent after the distances
+ * ---------------------------------------------------------------------------*/
+
+/** Identifier of the position frame */
+#define TX_CAN_POSITION_ID      0x105u
+/** Offset of the lateral offset of the obstacle (mm, s16 little-endian,
+ *  positive right of the bumper centre) */
+#define TX_CAN_POS_LATERAL      0u
+/** Offset of the distance of the obstacle from the bumper (mm, u16
+ *  little-endian) */
+#define TX_CAN_POS_FORWARD      2u
+/** Offset of the position flags (TX_CAN_POS_FLAG_*) */
+#define TX_CAN_POS_FLAGS        4u
+/** Offset of the sensor health, a HEALTH_NIBBLE per sensor (sensor i in
+ *  bits 4i..4i+3: level in the low two bits, fault in the high two; see
+ *  sensor_health.h) */
+#define TX_CAN_POS_HEALTH       5u
+/** Payload length */
+#define TX_CAN_POS_DLC          6u
+
+/** Both sensors see one obstacle and the position is valid */
+#define TX_CAN_POS_FLAG_VALID   0x01u
+
+#if USENSOR_COUNT != 2u
+#error "The position frame trilaterates exactly two sensors"
+#endif
+
+#if USENSOR_COUNT * 4u > 8u
+#error "The health of every sensor must fit in the TX_CAN_POS_HEALTH byte"
+#endif
 
 /* ---------------------------------------------------------------------------
  * CAN-related external variables
@@ -0,0 +1,63 @@
+/**
+ * @file    boot_time.h
+ * @ingroup Transmitter_Node
+ * @brief   Boot-phase timestamps from reset to the first CAN frame.
+ *
+ * Boot_Start, called from SystemInit before the C start-up code runs,
+ * starts the DWT cycle counter at reset. Each Boot_Mark then converts the
+ * cycles since the previous mark at the core clock in effect over that
+ * interval (8 MHz HSI until SystemClock_Config, 72 MHz after), so every
+ * phase is timed in microseconds from reset. Only the first mark of a
+ * phase counts. Tx_Report writes the phases as a "BOOT" line;
+ * tools/boot_report.py prints them as a timeline.
+ */
+#ifndef __BOOT_TIME_H
+#define __BOOT_TIME_H
+
+#include <stdint.h>
+
+/** Boot phases, in the order they are reached */
+typedef enum
+{
+    BOOT_MAIN = 0,          /**< main() entered: C start-up done */
+    BOOT_CLOCK,             /**< HAL and the 72 MHz clock ready */
+    BOOT_CAN,               /**< CAN started, reception enabled */
+    BOOT_PERIPH,            /**< Boot-path peripherals ready */
+    BOOT_SCHEDULER,         /**< Executive task running */
+    BOOT_FIRST_ECHO,        /**< First echo measured */
+    BOOT_FIRST_CAN,         /**< First distance frame queued for CAN */
+    BOOT_PHASE_COUNT
+} BootPhaseTypeDef;
+
+/**
+ * @brief Start the cycle counter at reset. Called from SystemInit, before
+ *        the C start-up code: touches no RAM.
+ */
+void Boot_Start(void);
+
+/**
+ * @brief Record the time since reset at which a phase is reached; later
+ *        marks of the same phase are ignored. Safe from interrupts.
+ * @param phase Boot phase.
+ */
+void Boot_Mark(BootPhaseTypeDef phase);
+
+/**
+ * @brief  Time since reset at which a phase was reached.
+ * @param  phase Boot phase.
+ * @retval Microseconds, 0 if not reached yet.
+ */
+uint32_t Boot_GetUs(BootPhaseTypeDef phase);
+
+/** Longest line written by Boot_Format */
+#define BOOT_LINE_MAX   (4u + 11u * BOOT_PHASE_COUNT + 2u)
+
+/**
+ * @brief  Format the phase times as one text line:
+ *         "BOOT,<us>,<us>,...\r\n", in us since reset, 0 if not reached.
+ * @param  buf Output buffer of at least BOOT_LINE_MAX bytes.
+ * @retval Number of characters written.
+ */
+uint16_t Boot_Format(char *buf);
+
+#endif /* __BOOT_TIME_H */
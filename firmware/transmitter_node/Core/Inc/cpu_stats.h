@@ -0,0 +1,60 @@
+/**
+ * @file    cpu_stats.h
+ * @ingroup Transmitter_Node
+ * @brief   Per-task CPU load from the FreeRTOS run-time statistics.
+ *
+ * The run-time counter is the Cortex-M3 DWT cycle counter (see
+ * configureTimerForRunTimeStats in freertos.c), so the load is measured in
+ * CPU cycles. Each CpuStats_Update call reports the share of every task,
+ * including IDLE, over the cycles elapsed since the previous call. Calls
+ * must be less than one CYCCNT wrap apart (about 59 s at 72 MHz).
+ */
+#ifndef __CPU_STATS_H
+#define __CPU_STATS_H
+
+#include <stdint.h>
+
+/** Largest number of tasks reported */
+#define CPU_STATS_MAX_TASKS  7u
+
+/** Characters kept from each task name (NUL-padded, not terminated when full) */
+#define CPU_STATS_NAME_LEN   8u
+
+/** Load of one task */
+typedef struct
+{
+    char     name[CPU_STATS_NAME_LEN];  /**< Task name, truncated */
+    uint8_t  number;                    /**< Kernel task number (trace id) */
+    uint16_t permille;                  /**< Share of the elapsed cycles (0.1 %) */
+} CpuTaskLoadTypeDef;
+
+/** Load of all tasks over one measurement window */
+typedef struct
+{
+    uint32_t           cycles;                      /**< Window length (CPU cycles) */
+    uint8_t            count;                       /**< Number of tasks in task[] */
+    CpuTaskLoadTypeDef task[CPU_STATS_MAX_TASKS];   /**< Per-task load */
+} CpuLoadTypeDef;
+
+/**
+ * @brief Measure the load of every task since the previous call.
+ * @param load Filled with the result; count is 0 if there are more than
+ *             CPU_STATS_MAX_TASKS tasks.
+ */
+void CpuStats_Update(CpuLoadTypeDef *load);
+
+/** Longest line written by CpuStats_Format, CR LF included */
+#define CPU_STATS_LINE_MAX   (5u + 18u * CPU_STATS_MAX_TASKS)
+
+/**
+ * @brief  Measure the load and format it as one text line.
+ *
+ * Format: "CPU,<number>,<name>,<permille>,...\r\n", one triplet per
+ * task. tools/cpu_report.py parses it.
+ *
+ * @param  buf Output buffer of at least CPU_STATS_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t CpuStats_Format(char *buf);
+
+#endif /* __CPU_STATS_H */
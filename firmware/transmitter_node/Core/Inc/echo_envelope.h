@@ -0,0 +1,90 @@
+/**
+ * @file    echo_envelope.h
+ * @ingroup Transmitter_Node
+ * @brief   Matched-filter ranging on a sampled echo envelope.
+ *
+ * The echo pin of an HC-SR04 style module only says when the received
+ * envelope crossed the module's own threshold, which moves with the echo
+ * strength and hides every echo after the first. With USENSOR_ENVELOPE
+ * set, usensor.c instead samples the receive envelope with the ADC for
+ * ECHO_ENV_SAMPLES samples after each trigger, and ranges here:
+ *   - the samples are correlated with the envelope of one echo
+ *     (echo_template.h, tools/gen_echo_template.py) by
+ *     arm_correlate_fast_q15, which lifts echoes out of the noise;
+ *   - every local maximum of the correlation ECHO_ENV_MIN_PEAK over its
+ *     mean, past the ECHO_ENV_BLANK_SAMPLES of the burst itself, is an
+ *     echo, as long as the correlation fell to half of the previous echo's
+ *     peak in between, so one echo is not counted twice;
+ *   - each peak is placed between samples by the vertex of the parabola
+ *     through it and its two neighbours;
+ *   - the burst ringing in the first ECHO_ENV_BLANK_SAMPLES tells a live
+ *     transducer from a dead or disconnected one, whose pings are silent
+ *     (EchoEnv_Ringing).
+ *
+ * Only depends on <stdint.h> and the CMSIS-DSP correlation;
+ * tools/envelope_check.py compiles it on the host with the vendored
+ * sources and checks it against synthetic echo buffers.
+ */
+#ifndef __ECHO_ENVELOPE_H
+#define __ECHO_ENVELOPE_H
+
+#include <stdint.h>
+#include "echo_template.h"
+
+/** ADC sample rate of the envelope (Hz) */
+#define ECHO_ENV_RATE_HZ        10000u
+
+/** Samples per ping: 16 ms, the template fits up to 255 cm */
+#define ECHO_ENV_SAMPLES        160u
+
+/** Samples at the start of a ping taken by the burst ringing */
+#define ECHO_ENV_BLANK_SAMPLES  ECHO_TEMPLATE_LEN
+
+/** Smallest echo, as correlation over its mean (q15, about 3% of full scale) */
+#define ECHO_ENV_MIN_PEAK       1000
+
+/** Smallest burst ringing, as correlation over the mean of the ping (q15) */
+#define ECHO_ENV_MIN_RINGING    (4 * ECHO_ENV_MIN_PEAK)
+
+/** Most echoes returned per ping */
+#define ECHO_ENV_MAX_ECHOES     4u
+
+/** Time of the first sample after the burst onset (us): usensor.c starts
+ *  the sample clock on the trigger edge and converts at the end of each
+ *  period; lower it for a front end that fires its burst late */
+#ifndef ECHO_ENV_FIRST_SAMPLE_US
+#define ECHO_ENV_FIRST_SAMPLE_US (1000000 / (int32_t)ECHO_ENV_RATE_HZ)
+#endif
+
+/** Cycle budget of one ping (0.5 ms at 72 MHz), well inside its echo window */
+#define ECHO_ENV_BUDGET_CYCLES  36000u
+
+#if ECHO_TEMPLATE_RATE_HZ != ECHO_ENV_RATE_HZ
+#error "echo_template.h is for another sample rate; run tools/gen_echo_template.py"
+#endif
+
+/** One echo found in a ping */
+typedef struct
+{
+    uint16_t mm;                /**< Range (mm) */
+    uint16_t strength;          /**< Correlation peak over its mean (q15) */
+} EchoEnvEchoTypeDef;
+
+/**
+ * @brief  Find the echoes in one ping.
+ * @param  samples ECHO_ENV_SAMPLES right-aligned 12-bit ADC samples from the
+ *                 trigger on; scaled to q15 in place.
+ * @param  echoes  Filled with the echoes found, nearest first.
+ * @param  max     Size of echoes, at most ECHO_ENV_MAX_ECHOES are found.
+ * @retval Number of echoes found.
+ */
+uint8_t EchoEnv_Range(uint16_t *samples, EchoEnvEchoTypeDef *echoes, uint8_t max);
+
+/**
+ * @brief  Whether the ping last ranged by EchoEnv_Range heard the burst.
+ * @retval Non-zero if the burst rang ECHO_ENV_MIN_RINGING over the mean of
+ *         the ping in its first ECHO_ENV_BLANK_SAMPLES.
+ */
+uint8_t EchoEnv_Ringing(void);
+
+#endif /* __ECHO_ENVELOPE_H */
@@ -0,0 +1,46 @@
+/**
+ * @file    echo_range.h
+ * @ingroup Transmitter_Node
+ * @brief   Echo pulse width and distance arithmetic.
+ *
+ * The computations on the captured edges, kept apart from the driver so
+ * they only depend on <stdint.h>, like zone_table.h and frame.c on the
+ * receiver, and can be compiled and checked off target.
+ *
+ * The conversion is integer: at 340 m/s the round trip covers 17 cm per
+ * 1000 us of echo, so the soft-float double arithmetic the Cortex-M3 would
+ * otherwise run in the capture interrupt is not needed.
+ */
+#ifndef __ECHO_RANGE_H
+#define __ECHO_RANGE_H
+
+#include <stdint.h>
+
+/** Counter values per wrap of the capture timers (ARR 0xFFFE) */
+#define ECHO_TIMER_WRAP     0xFFFFu
+
+/** Distance per 1000 us of echo (cm), half the 340 m/s round trip */
+#define ECHO_CM_PER_MS      17u
+
+/**
+ * @brief  Echo pulse width from the captured edges.
+ * @param  rise Counter value at the rising edge.
+ * @param  fall Counter value at the falling edge.
+ * @retval Width in timer counts (us), across at most one counter wrap.
+ */
+static inline uint32_t Echo_PulseWidth(uint32_t rise, uint32_t fall)
+{
+    return (fall > rise) ? (fall - rise) : ((ECHO_TIMER_WRAP - rise) + fall);
+}
+
+/**
+ * @brief  Distance for an echo pulse width.
+ * @param  width_us Pulse width (us).
+ * @retval Distance in whole centimetres, rounded down.
+ */
+static inline uint32_t Echo_WidthToCm(uint32_t width_us)
+{
+    return width_us * ECHO_CM_PER_MS / 1000u;
+}
+
+#endif /* __ECHO_RANGE_H */
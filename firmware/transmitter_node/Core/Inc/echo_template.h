@@ -0,0 +1,22 @@
+/**
+ * @file    echo_template.h
+ * @ingroup Transmitter_Node
+ * @brief   Envelope of one echo, for envelope ranging (generated, do not edit).
+ *
+ * Generated by tools/gen_echo_template.py for a 8-cycle 40 kHz burst,
+ * transducers of Q 15 and 10000 Hz sampling. Edit the specification there and
+ * re-run it.
+ */
+#ifndef __ECHO_TEMPLATE_H
+#define __ECHO_TEMPLATE_H
+
+/** Sample rate the template is made for (Hz) */
+#define ECHO_TEMPLATE_RATE_HZ   10000u
+
+/** Number of taps */
+#define ECHO_TEMPLATE_LEN       9u
+
+/** Envelope from the burst onset, one tap per sample, sum under one (q15) */
+#define ECHO_TEMPLATE_TAPS      { 0, 3362, 8153, 8307, 5662, 3345, 1834, 961, 488 }
+
+#endif /* __ECHO_TEMPLATE_H */
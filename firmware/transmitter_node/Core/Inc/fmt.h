@@ -0,0 +1,27 @@
+/**
+ * @file    fmt.h
+ * @ingroup Transmitter_Node
+ * @brief   Number formatting of the diagnostic text lines.
+ *
+ * The report lines on USART2 are built field by field into the caller's
+ * buffer, without printf: the C library formatter costs flash and stack
+ * the transmitter has no room for.
+ */
+#ifndef __FMT_H
+#define __FMT_H
+
+#include <stdint.h>
+
+/** Longest output of Fmt_Decimal (4294967295) */
+#define FMT_DECIMAL_MAX     10u
+
+/**
+ * @brief  Write an unsigned value in decimal, without leading zeros.
+ * @param  value Value to write.
+ * @param  buf   Output buffer of at least FMT_DECIMAL_MAX bytes, or the
+ *               digits of the largest value written.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint8_t Fmt_Decimal(uint32_t value, char *buf);
+
+#endif /* __FMT_H */
@@ -0,0 +1,118 @@
+/**
+ * @file    isr_stats.h
+ * @ingroup Transmitter_Node
+ * @brief   Interrupt entry latency and duration histograms.
+ *
+ * Every IRQ handler brackets its body with ISR_STATS_ENTER/ISR_STATS_EXIT,
+ * which time it with the DWT cycle counter. Entry latency is only known
+ * where the hardware latches the time of the event: the echo capture
+ * callback reports the counter minus the captured edge, and the timebase
+ * TIM callback the counter value, i.e. the time since the update event,
+ * with ISR_STATS_LATENCY. The echo timers capture the edges in hardware,
+ * so latency only costs range when the rising-edge handler has not yet
+ * switched the capture polarity by the time the falling edge arrives; the
+ * capture latency shows how much of that margin is left. Both are kept per interrupt as min, sum,
+ * max and a histogram of ISR_STATS_BINS bins of ISR_STATS_BIN_CYCLES, from
+ * which the report derives the average and the 99th percentile.
+ *
+ * Tx_Report writes the statistics of one interrupt per report round as an
+ * "ISR" line with its NVIC priority and restarts them;
+ * tools/isr_report.py prints them.
+ *
+ * Build with ISR_STATS_ENABLE=0 to compile the measurements out.
+ */
+#ifndef __ISR_STATS_H
+#define __ISR_STATS_H
+
+#include "main.h"
+
+#ifndef ISR_STATS_ENABLE
+#define ISR_STATS_ENABLE        1
+#endif
+
+/** Histogram bins; the last one also holds everything above it */
+#define ISR_STATS_BINS          16u
+
+/** Width of a histogram bin (CPU cycles, 0.89 us at 72 MHz) */
+#define ISR_STATS_BIN_CYCLES    64u
+
+/** CPU cycles per count of the 1 MHz timer counters */
+#define ISR_STATS_CYCLES_PER_COUNT  72u
+
+/** Measured interrupts */
+typedef enum
+{
+    ISR_STATS_ECHO1 = 0,    /**< TIM1 capture, sensor 0 (latency measured) */
+    ISR_STATS_ECHO2,        /**< TIM2 capture, sensor 1 (latency measured) */
+    ISR_STATS_TICK,         /**< TIM3 timebase update (latency measured) */
+    ISR_STATS_CAN,          /**< CAN RX FIFO 0 */
+    ISR_STATS_COUNT
+} IsrStatsIdTypeDef;
+
+/** Summary of one histogram (CPU cycles) */
+typedef struct
+{
+    uint16_t count;         /**< Samples */
+    uint16_t min;           /**< Shortest */
+    uint16_t avg;           /**< Average */
+    uint16_t max;           /**< Longest */
+    uint16_t p99;           /**< 99th percentile, to one bin */
+} IsrStatsSummaryTypeDef;
+
+#if ISR_STATS_ENABLE
+
+/** Start timing an IRQ handler; must come first in its body */
+#define ISR_STATS_ENTER()               uint32_t isrStatsEntry = DWT->CYCCNT
+/** Stop timing an IRQ handler and record its duration */
+#define ISR_STATS_EXIT(id)              IsrStats_Duration((id), DWT->CYCCNT - isrStatsEntry)
+/** Record an entry latency, in 1 MHz timer counts since the event */
+#define ISR_STATS_LATENCY(id, counts)   IsrStats_Latency((id), (uint32_t)(counts) * ISR_STATS_CYCLES_PER_COUNT)
+
+#else
+
+#define ISR_STATS_ENTER()               ((void)0)
+#define ISR_STATS_EXIT(id)              ((void)0)
+#define ISR_STATS_LATENCY(id, counts)   ((void)0)
+
+#endif /* ISR_STATS_ENABLE */
+
+/**
+ * @brief Record the duration of one handler run.
+ * @param id     Interrupt.
+ * @param cycles Duration (CPU cycles).
+ */
+void IsrStats_Duration(IsrStatsIdTypeDef id, uint32_t cycles);
+
+/**
+ * @brief Record the entry latency of one interrupt.
+ * @param id     Interrupt.
+ * @param cycles Time from the event to the handler (CPU cycles).
+ */
+void IsrStats_Latency(IsrStatsIdTypeDef id, uint32_t cycles);
+
+/**
+ * @brief Collect the statistics of one interrupt since the previous call
+ *        and restart them.
+ * @param id       Interrupt.
+ * @param latency  Filled with the entry latency summary (count 0 if the
+ *                 latency of this interrupt is not measured).
+ * @param duration Filled with the duration summary.
+ */
+void IsrStats_Collect(IsrStatsIdTypeDef id, IsrStatsSummaryTypeDef *latency,
+                      IsrStatsSummaryTypeDef *duration);
+
+/** Longest line written by IsrStats_Format */
+#define ISR_STATS_LINE_MAX  (11u + 6u * 9u)
+
+/**
+ * @brief  Collect the statistics of one interrupt and format them as one
+ *         text line: "ISR,<id>,<priority>,<samples>,<latency min>,<avg>,
+ *         <max>,<p99>,<duration min>,<avg>,<max>,<p99>\r\n", in CPU
+ *         cycles; the latency fields are empty if it is not measured.
+ * @param  id  Interrupt.
+ * @param  buf Output buffer of at least ISR_STATS_LINE_MAX bytes.
+ * @retval Number of characters written.
+ */
+uint16_t IsrStats_Format(IsrStatsIdTypeDef id, char *buf);
+
+#endif /* __ISR_STATS_H */
@@ -41,6 +41,10 @@ extern TIM_HandleTypeDef htim1;   /**< Timer 1 handle */
 extern TIM_HandleTypeDef htim2;   /**< Timer 2 handle */
 extern CAN_HandleTypeDef hcan;    /**< CAN handle */
 extern UART_HandleTypeDef huart2; /**< UART2 handle */
+extern IWDG_HandleTypeDef hiwdg;  /**< Independent watchdog handle */
+#ifdef HAL_ADC_MODULE_ENABLED
+extern ADC_HandleTypeDef hadc1;   /**< ADC1 handle, envelope sampling (USENSOR_ENVELOPE) */
+#endif
 
 /* ---------------------- Function Prototypes ---------------------- */
 /**
@@ -55,6 +59,12 @@ void SystemClock_Config(void);
  */
 void Error_Handler(void);
 
+/**
+ * @brief  Initialises the peripherals left out of the fast-boot path
+ * @note   Called by MonTask once the scheduler runs
+ */
+void MX_Deferred_Init(void);
+
 /* Peripheral initialization functions generated by CubeMX */
 static void MX_GPIO_Init(void);
 static void MX_TIM1_Init(void);
@@ -0,0 +1,59 @@
+/**
+ * @file    median_filter.h
+ * @ingroup Transmitter_Node
+ * @brief   Sliding-window running median of byte samples.
+ *
+ * Each filter keeps its window twice: in arrival order (a ring, to know
+ * which sample leaves) and sorted (to read the median at the middle).
+ * An update looks the leaving sample up in the sorted copy by binary
+ * search, overwrites it with the arriving one and moves that one to its
+ * rank, so only the samples between the two ranks shift and the median
+ * is a single load. The state is a caller-owned MedianFilterTypeDef per
+ * sensor; nothing is allocated.
+ *
+ * Building with MEDIAN_FILTER_SORTED=0 replaces the update with the naive
+ * copy-and-sort of the whole window, for comparing the two on the target
+ * ("FLT" lines). The host build in test/host links both: test_median
+ * checks them against a qsort of the window and bench_host times them.
+ *
+ * Only depends on <stdint.h>, like echo_range.h.
+ */
+#ifndef __MEDIAN_FILTER_H
+#define __MEDIAN_FILTER_H
+
+#include <stdint.h>
+
+#ifndef MEDIAN_FILTER_SORTED
+#define MEDIAN_FILTER_SORTED    1
+#endif
+
+/** Smallest and largest window (odd sizes in between) */
+#define MEDIAN_FILTER_MIN       3u
+#define MEDIAN_FILTER_MAX       9u
+
+/** Running median state */
+typedef struct
+{
+    uint8_t ring[MEDIAN_FILTER_MAX];    /**< Window in arrival order */
+    uint8_t sorted[MEDIAN_FILTER_MAX];  /**< Window in ascending order */
+    uint8_t size;                       /**< Window length */
+    uint8_t next;                       /**< Oldest entry of ring */
+} MedianFilterTypeDef;
+
+/**
+ * @brief Start a filter with its whole window at one value.
+ * @param filter Filter.
+ * @param size   Window length, odd, MEDIAN_FILTER_MIN to MEDIAN_FILTER_MAX.
+ * @param value  Initial sample.
+ */
+void MedianFilter_Init(MedianFilterTypeDef *filter, uint8_t size, uint8_t value);
+
+/**
+ * @brief  Slide the window by one sample.
+ * @param  filter Filter.
+ * @param  value  New sample; the oldest one leaves the window.
+ * @retval Median of the window.
+ */
+uint8_t MedianFilter_Update(MedianFilterTypeDef *filter, uint8_t value);
+
+#endif /* __MEDIAN_FILTER_H */
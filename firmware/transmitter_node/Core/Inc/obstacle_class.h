@@ -0,0 +1,90 @@
+/**
+ * @file    obstacle_class.h
+ * @ingroup Transmitter_Node
+ * @brief   Quantised classifier of what a sensor's echoes come from.
+ *
+ * A reading on its own cannot tell a bumper from a hedge, the ground or a
+ * stray echo, but the last OBS_WINDOW readings of a sensor can. They are
+ * reduced to OBS_FEATURES q7 features:
+ *   - range: mean of the echoes, 2 cm per unit;
+ *   - spread: mean absolute deviation of the echoes from that mean (cm);
+ *   - echo rate: readings with an echo, 127 for all of them;
+ *   - trend: least-squares slope of the echoes, 1/4 cm per cycle,
+ *     positive receding.
+ * A two-layer int8 network (obstacle_net.h, trained and exported by
+ * tools/train_obstacle_net.py) scores them through the vendored CMSIS-NN
+ * arm_fully_connected_q7 and arm_relu_q7, and the highest score is the
+ * class.
+ *
+ * Tx_SendDistances classifies every reading and, with OBS_CLASS_SUPPRESS,
+ * drops the ones from the ground or noise before the range filter, unless
+ * nearer than OBS_CLASS_KEEP_CM. The inference is timed for the "CLS"
+ * line. Only depends on <stdint.h> and CMSIS-NN; tools/obstacle_check.py
+ * compiles it on the host and checks it bit for bit against the exporter.
+ */
+#ifndef __OBSTACLE_CLASS_H
+#define __OBSTACLE_CLASS_H
+
+#include <stdint.h>
+
+/** Readings per window (power of two) */
+#define OBS_WINDOW              8u
+
+/** Features per window, the network's inputs */
+#define OBS_FEATURES            4u
+
+/** Reading without an echo, USENSOR_NO_ECHO */
+#define OBS_NO_ECHO             0xFFu
+
+/** Drop readings classed as ground or noise */
+#ifndef OBS_CLASS_SUPPRESS
+#define OBS_CLASS_SUPPRESS      1
+#endif
+
+/** Readings nearer than this are never dropped (cm) */
+#define OBS_CLASS_KEEP_CM       30u
+
+/** Cycle budget of one inference (28 us at 72 MHz) */
+#define OBS_CLASS_BUDGET_CYCLES 2000u
+
+/** Classes, in the order of the network's outputs */
+typedef enum
+{
+    OBS_SOLID = 0,              /**< Hard obstacle: steady, strong echoes */
+    OBS_SOFT,                   /**< Soft obstacle: weak, scattered echoes */
+    OBS_GROUND,                 /**< Reflection from the road surface */
+    OBS_NOISE,                  /**< No obstacle: stray echoes */
+    OBS_CLASSES
+} ObsClassTypeDef;
+
+/** Last readings of one sensor */
+typedef struct
+{
+    uint8_t cm[OBS_WINDOW];     /**< Readings (cm or OBS_NO_ECHO), oldest at next */
+    uint8_t next;               /**< Slot of the next reading */
+    uint8_t count;              /**< Readings held, up to OBS_WINDOW */
+} ObsWindowTypeDef;
+
+/**
+ * @brief  Add a reading to a window, replacing the oldest.
+ * @param  w  Window.
+ * @param  cm Reading (cm), or OBS_NO_ECHO.
+ */
+void ObsClass_Push(ObsWindowTypeDef *w, uint8_t cm);
+
+/**
+ * @brief  Reduce a window to the network's inputs.
+ * @param  w        Window.
+ * @param  features Filled with OBS_FEATURES q7 features.
+ */
+void ObsClass_Features(const ObsWindowTypeDef *w, int8_t *features);
+
+/**
+ * @brief  Classify a window.
+ * @param  features OBS_FEATURES q7 features from ObsClass_Features.
+ * @param  scores   Filled with the OBS_CLASSES output scores (q7); may be NULL.
+ * @retval Class with the highest score, the first one on a tie.
+ */
+ObsClassTypeDef ObsClass_Infer(const int8_t *features, int8_t *scores);
+
+#endif /* __OBSTACLE_CLASS_H */
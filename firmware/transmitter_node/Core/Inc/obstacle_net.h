@@ -0,0 +1,48 @@
+/**
+ * @file    obstacle_net.h
+ * @ingroup Transmitter_Node
+ * @brief   Weights of the obstacle classifier (generated, do not edit).
+ *
+ * Generated by tools/train_obstacle_net.py from simulated windows. Held-out
+ * accuracy 84.6% in float, 82.8% in q7. Fraction bits: 7 in the
+ * inputs, 3 in the hidden units, 1 in the scores.
+ */
+#ifndef __OBSTACLE_NET_H
+#define __OBSTACLE_NET_H
+
+/** Layer sizes */
+#define OBS_NET_INPUTS          4u
+#define OBS_NET_HIDDEN          12u
+#define OBS_NET_CLASSES         4u
+
+/** Shifts of arm_fully_connected_q7 */
+#define OBS_NET_L1_BIAS_SHIFT   5u
+#define OBS_NET_L1_OUT_SHIFT    6u
+#define OBS_NET_L2_BIAS_SHIFT   3u
+#define OBS_NET_L2_OUT_SHIFT    6u
+
+/** Hidden layer: one row of OBS_NET_INPUTS weights per unit, then biases */
+#define OBS_NET_W1 { \
+      -1,  -27,   18,  -13, \
+      -2,   -6,  -14,    0, \
+       1,  -67,    8,  -15, \
+     -21,  -11,    0,   -4, \
+       2,   -4,    4,   -4, \
+       5,   -5,  -15,    0, \
+       1,  -35,   -5,   15, \
+       0,   -4,    3,    3, \
+       4,   -7,   18,  -25, \
+      24,    0,   -1,   -1, \
+       1,   20,    4,   11, \
+      -2,   38,  -15,   -3 }
+#define OBS_NET_B1 { -49, 18, -7, 40, -23, 4, 24, -18, -53, -70, -11, 36 }
+
+/** Output layer: one row of OBS_NET_HIDDEN weights per class, then biases */
+#define OBS_NET_W2 { \
+      20,    2,   65,   16,    8,   -6,   14,   15,   17,    8,  -25,  -45, \
+     -11,  -12,  -14,   10,  -14,   -7,  -31,   -4,   -4,  -64,   11,  -14, \
+      -7,   -8,   29,  -74,   -8,  -14,   25,    0,  -27,   24,  -20,    0, \
+     -14,   27,  -70,    4,   -1,   22,  -11,    1,   10,   19,   50,   53 }
+#define OBS_NET_B2 { -53, 73, 20, -40 }
+
+#endif /* __OBSTACLE_NET_H */
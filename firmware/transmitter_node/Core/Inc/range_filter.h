@@ -0,0 +1,115 @@
+/**
+ * @file    range_filter.h
+ * @ingroup Transmitter_Node
+ * @brief   Per-sensor streaming range filter between capture and CAN.
+ *
+ * Every schedule cycle Tx_SendDistances passes each sensor's distance
+ * through two stages before it goes on the bus:
+ *   - a running median of RANGE_FILTER_MEDIAN samples (median_filter.h),
+ *     which drops spurious echoes from multipath and crosstalk and missed
+ *     ones (USENSOR_NO_ECHO is 255 cm), up to half the window in a row;
+ *   - a q15 low-pass, by default the Butterworth biquad and with
+ *     RANGE_FILTER_KERNEL set to RANGE_FILTER_FIR the windowed-sinc FIR,
+ *     both generated by tools/gen_range_filter.py.
+ *
+ * The median output also feeds a range tracker (range_tracker.h), whose
+ * closing velocity and confidence RangeFilter_GetTrack returns; the
+ * low-pass would only add lag to the velocity.
+ *
+ * The low-pass runs on the vendored CMSIS-DSP fast q15 kernels, or on the
+ * equivalent plain C loops when built with RANGE_FILTER_USE_CMSIS=0. The
+ * block is a single sample: each sensor gets one reading per cycle and
+ * waiting for more would only add latency. The first reading primes the
+ * filter state, so the output does not ramp up from 0 cm at boot.
+ *
+ * Each call is timed with the DWT cycle counter against
+ * RANGE_FILTER_BUDGET_CYCLES. Tx_Report writes the kernel, the average and
+ * worst cycles per sample and the budget overruns as an "FLT" line, read
+ * by tools/filter_report.py. tools/filter_check.py builds the CMSIS and
+ * plain C variants on the host, checks their outputs agree and times
+ * them.
+ */
+#ifndef __RANGE_FILTER_H
+#define __RANGE_FILTER_H
+
+#include <stdint.h>
+#include "range_tracker.h"
+
+/** Low-pass kernels */
+#define RANGE_FILTER_BIQUAD     0
+#define RANGE_FILTER_FIR        1
+
+#ifndef RANGE_FILTER_KERNEL
+#define RANGE_FILTER_KERNEL     RANGE_FILTER_BIQUAD
+#endif
+
+#ifndef RANGE_FILTER_USE_CMSIS
+#define RANGE_FILTER_USE_CMSIS  1
+#endif
+
+/** Samples in the median pre-stage (odd, 3 to 9); each one adds half a
+ *  cycle of delay to a real change of distance */
+#ifndef RANGE_FILTER_MEDIAN
+#define RANGE_FILTER_MEDIAN     3u
+#endif
+
+/** Cycle budget of one sample through every stage (21 us at 72 MHz) */
+#define RANGE_FILTER_BUDGET_CYCLES  1500u
+
+/** Filter timing over one report window */
+typedef struct
+{
+    uint32_t samples;           /**< Samples filtered */
+    uint32_t cycles;            /**< Total cycles spent */
+    uint16_t worst;             /**< Longest sample (cycles) */
+    uint16_t overruns;          /**< Samples over RANGE_FILTER_BUDGET_CYCLES */
+} RangeFilterStatsTypeDef;
+
+/**
+ * @brief  Filter the latest distance of a sensor.
+ * @param  sensor Sensor index, below USENSOR_COUNT.
+ * @param  cm     Measured distance (cm), or USENSOR_NO_ECHO.
+ * @retval Filtered distance (cm); USENSOR_NO_ECHO when out of range.
+ */
+uint8_t RangeFilter_Process(uint8_t sensor, uint8_t cm);
+
+/**
+ * @brief Tracked range and closing velocity of a sensor's latest sample.
+ * @param sensor Sensor index, below USENSOR_COUNT.
+ * @param track  Filled with the tracker output.
+ */
+void RangeFilter_GetTrack(uint8_t sensor, RangeTrackTypeDef *track);
+
+/**
+ * @brief  Lag of the filtered distance behind a steady approach.
+ *
+ * Tx_SendDistances adds it to the age of each sample, so the receiver
+ * extrapolates over the filter delay as well as the transport one.
+ *
+ * @retval Lag (ms).
+ */
+uint16_t RangeFilter_LagMs(void);
+
+/**
+ * @brief Collect the timing since the previous call and restart it.
+ * @param stats Filled with the result.
+ */
+void RangeFilter_GetStats(RangeFilterStatsTypeDef *stats);
+
+/** Longest line written by RangeFilter_Format, CR LF included */
+#define RANGE_FILTER_LINE_MAX   (4u + 14u + 4u * 11u + 2u)
+
+/**
+ * @brief  Collect the timing and format it as one text line.
+ *
+ * Format: "FLT,<kernel>,<avg_cycles>,<worst_cycles>,<budget>,<overruns>\r\n"
+ * with kernel one of biquad, fir, biquad_c or fir_c (plain C build),
+ * followed by _sort when the median sorts its whole window per sample
+ * (MEDIAN_FILTER_SORTED=0).
+ *
+ * @param  buf Output buffer of at least RANGE_FILTER_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t RangeFilter_Format(char *buf);
+
+#endif /* __RANGE_FILTER_H */
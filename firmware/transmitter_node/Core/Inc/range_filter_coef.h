@@ -0,0 +1,28 @@
+/**
+ * @file    range_filter_coef.h
+ * @ingroup Transmitter_Node
+ * @brief   Range filter coefficients (generated, do not edit).
+ *
+ * Generated by tools/gen_range_filter.py for a 60 ms schedule cycle and a
+ * 3.0 Hz cut-off. Edit the specification there and re-run it.
+ */
+#ifndef __RANGE_FILTER_COEF_H
+#define __RANGE_FILTER_COEF_H
+
+/** Butterworth low-pass, CMSIS DF1 order {b0, 0, b1, b2, a1, a2} (q15) */
+#define RANGE_FILTER_BIQUAD_COEFS       { 5737, 0, 11475, 5737, 17017, -7198 }
+
+/** Coefficient scaling of the biquad: values are divided by 2^shift */
+#define RANGE_FILTER_BIQUAD_POST_SHIFT  0
+
+/** Number of FIR taps */
+#define RANGE_FILTER_FIR_TAPS           6u
+
+/** Windowed-sinc low-pass taps, in CMSIS time-reversed order (q15) */
+#define RANGE_FILTER_FIR_COEFS          { 130, 3448, 12805, 12807, 3448, 130 }
+
+/** Lag of each kernel behind a steady approach (ms) */
+#define RANGE_FILTER_BIQUAD_LAG_MS      67u
+#define RANGE_FILTER_FIR_LAG_MS         150u
+
+#endif /* __RANGE_FILTER_COEF_H */
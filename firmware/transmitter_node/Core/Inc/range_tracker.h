@@ -0,0 +1,84 @@
+/**
+ * @file    range_tracker.h
+ * @ingroup Transmitter_Node
+ * @brief   Per-sensor range and closing-velocity tracker.
+ *
+ * A two-state (range, range rate) Kalman filter with a constant-velocity
+ * model and white acceleration noise, in fixed point: ranges are cm and
+ * velocities cm/s with 8 fraction bits, and the covariance is kept in the
+ * same units squared. With one state observed, the gains are two scalar
+ * divisions per sample, so no matrix code is needed.
+ *
+ * A measurement further than RANGE_TRACKER_GATE standard deviations of
+ * the innovation is not used; after RANGE_TRACKER_GATE_MISSES in a row the
+ * track restarts at the measurement, which is how a new obstacle entering
+ * the beam is picked up. The velocity is flagged as confident while its
+ * standard deviation is below RANGE_TRACKER_CONFIDENT_MM_S and the last
+ * measurement passed the gate.
+ *
+ * Only depends on <stdint.h>; tools/track_check.py compiles it on the host
+ * and checks it against synthetic approach profiles.
+ */
+#ifndef __RANGE_TRACKER_H
+#define __RANGE_TRACKER_H
+
+#include <stdint.h>
+
+/** Measurement noise of one reading (cm, standard deviation) */
+#define RANGE_TRACKER_NOISE_CM          1
+
+/** Acceleration noise of the target (cm/s^2, standard deviation) */
+#define RANGE_TRACKER_ACCEL_CM_S2       30
+
+/** Velocity uncertainty of a new track (cm/s, standard deviation) */
+#define RANGE_TRACKER_INIT_VEL_CM_S     200
+
+/** Innovation gate (standard deviations) */
+#define RANGE_TRACKER_GATE              4
+
+/** Gated measurements in a row that restart the track */
+#define RANGE_TRACKER_GATE_MISSES       3u
+
+/** Velocity standard deviation under which it is confident (mm/s) */
+#define RANGE_TRACKER_CONFIDENT_MM_S    100
+
+/** Tracker state of one sensor */
+typedef struct
+{
+    int32_t  range;             /**< Range (cm, Q8) */
+    int32_t  rate;              /**< Range rate (cm/s, Q8), negative closing */
+    int32_t  p_rr;              /**< Range variance (cm^2, Q8) */
+    int32_t  p_rv;              /**< Range-rate covariance (cm^2/s, Q8) */
+    int32_t  p_vv;              /**< Rate variance (cm^2/s^2, Q8) */
+    int32_t  q_rr;              /**< Process noise added to p_rr per step */
+    int32_t  q_rv;              /**< Process noise added to p_rv per step */
+    int32_t  q_vv;              /**< Process noise added to p_vv per step */
+    uint16_t dt;                /**< Sample period (s, Q16) */
+    uint8_t  misses;            /**< Gated measurements in a row */
+    uint8_t  started;           /**< A first measurement was taken */
+} RangeTrackerTypeDef;
+
+/** Tracker output for one sample */
+typedef struct
+{
+    uint8_t  cm;                /**< Smoothed range (cm) */
+    int16_t  closing_mm_s;      /**< Closing velocity (mm/s), positive approaching */
+    uint8_t  confident;         /**< Velocity is confident */
+} RangeTrackTypeDef;
+
+/**
+ * @brief Set up a tracker; the first update starts the track.
+ * @param tracker   Tracker.
+ * @param period_ms Sample period (ms), below 1000.
+ */
+void RangeTracker_Init(RangeTrackerTypeDef *tracker, uint16_t period_ms);
+
+/**
+ * @brief Advance the tracker by one sample period and take a measurement.
+ * @param tracker Tracker.
+ * @param cm      Measured range (cm).
+ * @param out     Filled with the tracked range and velocity.
+ */
+void RangeTracker_Update(RangeTrackerTypeDef *tracker, uint8_t cm, RangeTrackTypeDef *out);
+
+#endif /* __RANGE_TRACKER_H */
@@ -0,0 +1,128 @@
+/**
+ * @file    sensor_health.h
+ * @ingroup Transmitter_Node
+ * @brief   Per-sensor health from the statistics of its readings.
+ *
+ * Dirt, water, a broken transducer or crossed wiring do not stop a
+ * sensor from reporting distances, only make them wrong in telling ways.
+ * Every reading updates running statistics over a block of
+ * HEALTH_BLOCK readings, in O(1) time and memory:
+ *   - timeouts: windows without even the start of an echo, where an
+ *     obstacle out of range still raises the echo pin, or in envelope
+ *     mode without the burst ringing (USENSOR_SILENT);
+ *   - noise: variance of the change from one echo to the next (Welford),
+ *     which a steady approach keeps low and scattered echoes raise;
+ *   - stuck: the same reading HEALTH_STUCK_RUN times in a row, during
+ *     which the other sensor's reading has moved HEALTH_STUCK_MOVE_CM
+ *     away from where it was when the run began, so a parked car is not
+ *     taken for a stuck sensor;
+ *   - crosstalk: jumps of more than HEALTH_JUMP_CM that land within
+ *     HEALTH_XTALK_CM of the other sensor's reading of the same cycle,
+ *     when at least one jump in HEALTH_XTALK_SHARE does, so a sensor only
+ *     scattering its readings is not taken for one hearing the other.
+ * At the end of each block every indicator is graded against its
+ * thresholds; the worst grade is the sensor's level and its indicator
+ * the fault. A level rises at once but falls one step per block, so a
+ * sensor recovering from a fault is trusted again gradually.
+ *
+ * Tx_SendDistances publishes the levels and faults of both sensors in the
+ * health byte of the position frame (TX_CAN_POS_HEALTH), a HEALTH_NIBBLE
+ * per sensor. Only depends on <stdint.h>; tools/health_check.py compiles
+ * it on the host and simulates each fault.
+ */
+#ifndef __SENSOR_HEALTH_H
+#define __SENSOR_HEALTH_H
+
+#include <stdint.h>
+
+/** Readings per block (power of two): 1.9 s at the 60 ms schedule */
+#define HEALTH_BLOCK            32u
+
+/** Reading without an echo, USENSOR_NO_ECHO */
+#define HEALTH_NO_ECHO          0xFFu
+
+/** Timeouts per block for each level */
+#define HEALTH_TIMEOUT_DEGRADED (HEALTH_BLOCK / 8u)
+#define HEALTH_TIMEOUT_POOR     (HEALTH_BLOCK / 2u)
+#define HEALTH_TIMEOUT_FAILED   HEALTH_BLOCK
+
+/** Variance of the change between echoes for each level (cm^2) */
+#define HEALTH_NOISE_DEGRADED   25u
+#define HEALTH_NOISE_POOR       400u
+
+/** Equal readings in a row, and movement the other sensor sees meanwhile
+ *  (cm), for a stuck sensor */
+#define HEALTH_STUCK_RUN        48u
+#define HEALTH_STUCK_MOVE_CM    60u
+
+/** Jump of a reading (cm), and distance from the other sensor's reading
+ *  (cm), taken for crosstalk */
+#define HEALTH_JUMP_CM          20u
+#define HEALTH_XTALK_CM         3u
+
+/** Crosstalk jumps per block for each level */
+#define HEALTH_XTALK_DEGRADED   2u
+#define HEALTH_XTALK_POOR       6u
+
+/** Jumps per crosstalk jump, at most, for them to count */
+#define HEALTH_XTALK_SHARE      3u
+
+/** Levels, bits 0-1 of a health nibble */
+#define HEALTH_OK               0u  /**< Readings trusted */
+#define HEALTH_DEGRADED         1u  /**< Readings trusted, sensor wants attention */
+#define HEALTH_POOR             2u  /**< Distances usable, velocities not */
+#define HEALTH_FAILED           3u  /**< Readings not usable */
+
+/** Faults, bits 2-3 of a health nibble: the indicator behind the level */
+#define HEALTH_FAULT_TIMEOUT    0u  /**< No echo, not even out of range */
+#define HEALTH_FAULT_NOISE      1u  /**< Scattered readings */
+#define HEALTH_FAULT_STUCK      2u  /**< Frozen reading */
+#define HEALTH_FAULT_XTALK      3u  /**< Readings of the other sensor */
+
+/** Health nibble of a level and fault */
+#define HEALTH_NIBBLE(level, fault)  ((uint8_t)((level) | ((fault) << 2)))
+
+/** Health statistics of one sensor */
+typedef struct
+{
+    /* Block in progress */
+    uint8_t  readings;          /**< Readings in the block */
+    uint8_t  timeouts;          /**< Silent windows */
+    uint8_t  jumps;             /**< Jumps of more than HEALTH_JUMP_CM */
+    uint8_t  xtalk;             /**< Of them, jumps onto the other sensor's reading */
+    uint8_t  changes;           /**< Changes between echoes in the statistics */
+    int32_t  mean;              /**< Running mean of the changes (cm / 4) */
+    int32_t  m2;                /**< Running sum of squared deviations (cm^2 / 16) */
+
+    /* Across blocks */
+    uint8_t  last;              /**< Last reading (cm), or HEALTH_NO_ECHO */
+    uint8_t  run;               /**< Equal echoes in a row */
+    uint8_t  other_start;       /**< Other sensor's reading when the run began (cm) */
+    uint8_t  moved;             /**< The other sensor has moved during the run */
+    uint8_t  stuck;             /**< The run has been stuck within this block */
+    uint8_t  nibble;            /**< Published level and fault */
+} HealthSensorTypeDef;
+
+/**
+ * @brief  Start the statistics of a sensor, at HEALTH_OK.
+ * @param  h Statistics.
+ */
+void Health_Init(HealthSensorTypeDef *h);
+
+/**
+ * @brief  Account one reading of a sensor; grades it at the end of a block.
+ * @param  h        Statistics.
+ * @param  cm       Reading (cm), or HEALTH_NO_ECHO.
+ * @param  silent   Non-zero if the window saw no echo at all.
+ * @param  other_cm Reading of the other sensor in the same cycle.
+ */
+void Health_Update(HealthSensorTypeDef *h, uint8_t cm, uint8_t silent, uint8_t other_cm);
+
+/**
+ * @brief  Published health of a sensor.
+ * @param  h Statistics.
+ * @retval HEALTH_NIBBLE of the level and fault of the last graded block.
+ */
+uint8_t Health_Nibble(const HealthSensorTypeDef *h);
+
+#endif /* __SENSOR_HEALTH_H */
@@ -0,0 +1,72 @@
+/**
+ * @file    stack_mon.h
+ * @ingroup Transmitter_Node
+ * @brief   Task stack high-water-mark monitor.
+ *
+ * Every registered task's stack high-water mark (the least free stack the
+ * kernel has ever seen for it) is sampled by the monitor task every
+ * STACK_MON_PERIOD_MS. Tasks left with less than STACK_MON_MARGIN bytes
+ * are flagged in the "STK" line the report slot writes to USART2;
+ * tools/stack_report.py turns the lines into recommended stack sizes.
+ */
+#ifndef __STACK_MON_H
+#define __STACK_MON_H
+
+#include "cmsis_os.h"
+
+/** Largest number of monitored tasks */
+#define STACK_MON_MAX_TASKS  7u
+
+/** Free stack below which a task is flagged (bytes) */
+#ifndef STACK_MON_MARGIN
+#define STACK_MON_MARGIN     64u
+#endif
+
+/** Sampling period of the monitor task (ms) */
+#define STACK_MON_PERIOD_MS  500u
+
+/** Stack usage of one task */
+typedef struct
+{
+    osThreadId_t thread;        /**< Monitored task */
+    const char  *name;          /**< Task name (kept by the kernel) */
+    uint16_t     size;          /**< Stack size (bytes) */
+    uint16_t     min_free;      /**< Least free stack seen (bytes) */
+    uint8_t      number;        /**< Kernel task number (trace id) */
+} StackMonEntryTypeDef;
+
+/**
+ * @brief Add a task to the monitor.
+ * @param thread     Task handle; ignored if NULL or the table is full.
+ * @param stack_size Stack size given when the task was created (bytes).
+ */
+void StackMon_Register(osThreadId_t thread, uint32_t stack_size);
+
+/**
+ * @brief Add the kernel's idle and timer service tasks to the monitor.
+ * @note  Call once the scheduler is running.
+ */
+void StackMon_RegisterKernelTasks(void);
+
+/**
+ * @brief  Sample the high-water mark of every registered task.
+ * @retval Bit mask of the tasks (in registration order) under the margin.
+ */
+uint8_t StackMon_Sample(void);
+
+/** Longest line written by StackMon_Format, CR LF included */
+#define STACK_MON_LINE_MAX   (11u + 34u * STACK_MON_MAX_TASKS)
+
+/**
+ * @brief  Format the latest sample as one text line.
+ *
+ * Format: "STK,<margin>,<number>,<name>,<size>,<free>,<low>,...\r\n" with
+ * one group per task: kernel task number, name, stack size and least free
+ * stack seen in bytes, and 1 if the task is under the margin.
+ *
+ * @param  buf Output buffer of at least STACK_MON_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t StackMon_Format(char *buf);
+
+#endif /* __STACK_MON_H */
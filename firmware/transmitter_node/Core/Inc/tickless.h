@@ -0,0 +1,63 @@
+/**
+ * @file    tickless.h
+ * @ingroup Transmitter_Node
+ * @brief   RTOS tick on the HAL TIM timebase, with tickless idle.
+ *
+ * The FreeRTOS tick is driven by the same 1 kHz TIM update interrupt as
+ * the HAL tick (stm32f1xx_hal_timebase_tim.c) instead of SysTick, so there
+ * is a single timebase and a single tick interrupt. When every task is
+ * blocked for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks, the
+ * idle task stretches the TIM period to the expected idle time (up to
+ * TICKLESS_MAX_IDLE_TICKS) and sleeps in WFI. Any interrupt ends the sleep;
+ * the core stays in Sleep mode so every peripheral keeps running, and the
+ * only added interrupt latency is the short masked section around WFI,
+ * which is measured (see TicklessStatsTypeDef).
+ */
+#ifndef __TICKLESS_H
+#define __TICKLESS_H
+
+#include <stdint.h>
+
+/** Timer running the HAL and RTOS ticks (1 MHz counter, 1 ms period) */
+#define TICKLESS_TIM             TIM3
+
+/** Longest sleep: the 16-bit counter wraps after 65.5 ms at 1 MHz */
+#define TICKLESS_MAX_IDLE_TICKS  65u
+
+/** Sleep statistics over one report window */
+typedef struct
+{
+    uint32_t window_ms;         /**< Window length (ms) */
+    uint32_t sleep_us;          /**< Time spent in WFI (us) */
+    uint16_t sleeps;            /**< Tickless sleeps entered */
+    uint16_t longest_ms;        /**< Longest single sleep (ms) */
+    uint16_t masked_cycles;     /**< Longest masked section (CPU cycles) */
+    uint16_t residency;         /**< sleep_us / window, in permille */
+} TicklessStatsTypeDef;
+
+/**
+ * @brief Advance the RTOS tick; call from the timebase TIM update callback.
+ */
+void Tickless_IncTick(void);
+
+/**
+ * @brief Collect the statistics since the previous call and restart them.
+ * @param stats Filled with the result.
+ */
+void Tickless_GetStats(TicklessStatsTypeDef *stats);
+
+/** Longest line written by Tickless_Format, CR LF included */
+#define TICKLESS_LINE_MAX        (6u + 4u * 6u)
+
+/**
+ * @brief  Collect the statistics and format them as one text line.
+ *
+ * Format: "PWR,<residency>,<sleeps>,<longest_ms>,<masked_cycles>\r\n",
+ * residency in permille. tools/power_report.py parses it.
+ *
+ * @param  buf Output buffer of at least TICKLESS_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t Tickless_Format(char *buf);
+
+#endif /* __TICKLESS_H */
@@ -0,0 +1,62 @@
+/**
+ * @file    trilateration.h
+ * @ingroup Transmitter_Node
+ * @brief   Obstacle position from the ranges of the two sensors.
+ *
+ * The sensors sit on the bumper TRILAT_BASELINE_MM apart, sensor 0 on the
+ * left at x = -B/2 and sensor 1 on the right at x = +B/2, both facing +y.
+ * An obstacle seen by both at ranges r0 and r1 lies at the intersection
+ * of the two circles:
+ *
+ *     x = (r0^2 - r1^2) / (2 B)
+ *     y = sqrt(r0^2 - (x + B/2)^2)
+ *
+ * x is the lateral offset from the bumper centre, positive to the right,
+ * and y the perpendicular distance from the bumper. Ranges differing by
+ * more than the baseline have no intersection (two obstacles, or one
+ * outside a beam) and give no fix, as does a missing echo.
+ *
+ * Ranges are integer millimetres and the lateral offset keeps an eighth
+ * of a millimetre while solving; the squares still fit in 32 bits up to
+ * the 255 cm range limit, and the position is within a millimetre of the
+ * exact intersection of the ranges given. The square root is a bit-by-bit
+ * integer root, or with TRILAT_USE_CMSIS=1 the CMSIS-DSP arm_sqrt_q15 on a
+ * normalised argument. On the Cortex-M3 the latter runs its initial guess
+ * in software floating point, so the plain C root is the default;
+ * Tx_Report writes the cycles per solve in the "TRI" line to compare the
+ * two.
+ *
+ * Only depends on <stdint.h> in the default build; tools/trilat_check.py
+ * compiles it on the host and checks it over a grid of positions.
+ */
+#ifndef __TRILATERATION_H
+#define __TRILATERATION_H
+
+#include <stdint.h>
+
+#ifndef TRILAT_USE_CMSIS
+#define TRILAT_USE_CMSIS        0
+#endif
+
+/** Distance between the two sensors (mm) */
+#ifndef TRILAT_BASELINE_MM
+#define TRILAT_BASELINE_MM      300
+#endif
+
+/** Obstacle position */
+typedef struct
+{
+    int16_t  lateral_mm;        /**< Offset from the bumper centre (mm), positive right */
+    uint16_t forward_mm;        /**< Distance from the bumper (mm) */
+} TrilatFixTypeDef;
+
+/**
+ * @brief  Locate an obstacle seen by both sensors.
+ * @param  r0_mm Range of sensor 0, on the left (mm).
+ * @param  r1_mm Range of sensor 1, on the right (mm).
+ * @param  fix   Filled with the position when there is one.
+ * @retval 1 if the ranges intersect, 0 otherwise (fix left unchanged).
+ */
+uint8_t Trilat_Solve(uint16_t r0_mm, uint16_t r1_mm, TrilatFixTypeDef *fix);
+
+#endif /* __TRILATERATION_H */
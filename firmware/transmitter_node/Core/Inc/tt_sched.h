@@ -0,0 +1,76 @@
+/**
+ * @file    tt_sched.h
+ * @ingroup Transmitter_Node
+ * @brief   Time-triggered cyclic executive for the measurement schedule.
+ *
+ * One task (TtTask) runs ttTable every TT_CYCLE_MS. Every slot is placed
+ * at a fixed offset from the start of the cycle, and cycle starts are
+ * absolute tick counts, so nothing drifts: the tick is the TIM3 timebase
+ * (see tickless.h), the one hardware timer left free by the two echo
+ * capture timers. Each sensor has a trigger slot and an echo window that
+ * starts with it; the echo is abandoned when the window closes. The CAN
+ * frame goes out in its own slot with the distances of the cycle, and the
+ * diagnostic lines on USART2 in a report slot.
+ *
+ * Rules, checked before every build by tools/tt_check.py:
+ *   - slots lie inside the cycle;
+ *   - trigger, CAN and report slots (the ones that use the CPU) do not
+ *     overlap each other;
+ *   - echo windows do not overlap each other (no acoustic cross-talk);
+ *   - each sensor has one trigger and one echo window starting with it.
+ *
+ * Keep one table row per line in tt_sched.c for the checker.
+ */
+#ifndef __TT_SCHED_H
+#define __TT_SCHED_H
+
+#include "main.h"
+#include "cmsis_os.h"
+
+/** Length of one schedule cycle (ms) */
+#define TT_CYCLE_MS  60u
+
+/** Slot actions */
+typedef enum
+{
+    TT_TRIGGER = 0,     /**< Send a sensor's trigger pulse */
+    TT_ECHO,            /**< Echo window of a sensor; closed at its end */
+    TT_CAN_TX,          /**< Send the distances on CAN */
+    TT_REPORT           /**< Write the diagnostic lines on USART2 */
+} TtActionTypeDef;
+
+/** One slot of the schedule */
+typedef struct
+{
+    TtActionTypeDef action;     /**< What happens in the slot */
+    uint8_t         sensor;     /**< Sensor index (trigger and echo slots) */
+    uint16_t        offset;     /**< Start, from the start of the cycle (ms) */
+    uint16_t        length;     /**< Duration (ms) */
+} TtSlotTypeDef;
+
+/** Executive statistics */
+typedef struct
+{
+    uint32_t cycles;            /**< Completed cycles */
+    uint32_t late;              /**< Actions started after their release tick */
+    uint32_t worst_late;        /**< Largest release delay seen (ms) */
+} TtStatsTypeDef;
+
+/** Schedule table, in any order */
+extern const TtSlotTypeDef ttTable[];
+
+/** Number of rows in ttTable */
+extern const uint8_t ttTableSize;
+
+/**
+ * @brief Time-triggered executive task: runs ttTable forever.
+ * @param argument Not used
+ */
+void TtTask_init(void *argument);
+
+/**
+ * @brief Executive statistics.
+ */
+const TtStatsTypeDef *TtSched_GetStats(void);
+
+#endif /* __TT_SCHED_H */
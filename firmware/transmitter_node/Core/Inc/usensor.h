@@ -9,6 +9,12 @@
  *   - Function prototypes for sensor triggering and IC handling
  *
  * The implementation relies on hardware timers configured in main.c.
+ *
+ * With USENSOR_ENVELOPE=1 the echo pins are not used: the receive
+ * envelope of each sensor is sampled by ADC1 (TIM2 paces it, DMA1
+ * channel 1 stores it) for the whole echo window and ranged by
+ * EchoEnv_Range (see echo_envelope.h), which needs an analog tap on the
+ * receiver of each module.
  */
 #ifndef USENSOR_H
 #define USENSOR_H
@@ -26,10 +32,38 @@ extern "C" {
 /** @brief GPIO port for ultrasonic sensors */
 #define USENSOR_GPIO_PORT   GPIOA
 
-/** @brief Distance measured by sensor 1 in cm */
-extern uint8_t Distance_1;
-/** @brief Distance measured by sensor 2 in cm */
-extern uint8_t Distance_2;
+/** @brief Number of sensors (rows of the hardware table in usensor.c) */
+#define USENSOR_COUNT       2u
+
+/** @brief Distance reported when no echo ended inside the window or it is out of range */
+#define USENSOR_NO_ECHO     0xFFu
+
+/** @brief Outcome of the last echo window of a sensor */
+typedef enum
+{
+    USENSOR_ECHO = 0,             /**< Echo measured, Distance holds it */
+    USENSOR_OUT_OF_RANGE,         /**< Echo started (or ranged) but none usable */
+    USENSOR_SILENT                /**< Nothing at all: no echo start, no burst ringing, or missed samples */
+} USensorStatusTypeDef;
+
+/** @brief Range from the sampled echo envelope instead of the echo pins */
+#ifndef USENSOR_ENVELOPE
+#define USENSOR_ENVELOPE    0
+#endif
+
+#if USENSOR_ENVELOPE
+/** @brief Envelope ADC channel of each sensor (PA4, PA5) */
+#define USENSOR_ENV_CHANNELS { ADC_CHANNEL_4, ADC_CHANNEL_5 }
+
+/** @brief Longest "ENV" line, CR LF included */
+#define USENSOR_ENV_LINE_MAX (4u + 6u * 11u + 2u)
+#endif
+
+/** @brief Distance measured by each sensor in cm */
+extern uint8_t Distance[USENSOR_COUNT];
+
+/** @brief Tick at which each Distance was last set (ms) */
+extern uint32_t DistanceTick[USENSOR_COUNT];
 
 /**
  * @brief Initialize timers and GPIO for ultrasonic sensors
@@ -37,14 +71,28 @@ extern uint8_t Distance_2;
 void USensor_Init(void);
 
 /**
- * @brief Trigger the first ultrasonic sensor
+ * @brief Send the trigger pulse of a sensor and open its echo window
+ * @param sensor Sensor index, below USENSOR_COUNT
+ */
+void USensor_Trigger(uint8_t sensor);
+
+/**
+ * @brief Close the echo window of a sensor
+ * @param sensor Sensor index, below USENSOR_COUNT
+ *
+ * An echo still incomplete is abandoned and the distance set to
+ * USENSOR_NO_ECHO, so a late edge cannot be measured against the next
+ * trigger.
  */
-void USensor_Read1(void);
+void USensor_CloseWindow(uint8_t sensor);
 
 /**
- * @brief Trigger the second ultrasonic sensor
+ * @brief Outcome of the last closed echo window of a sensor
+ * @param sensor Sensor index, below USENSOR_COUNT
+ * @retval USENSOR_SILENT tells a dead or disconnected sensor from an
+ *         obstacle out of range, which both read USENSOR_NO_ECHO.
  */
-void USensor_Read2(void);
+USensorStatusTypeDef USensor_GetStatus(uint8_t sensor);
 
 /**
  * @brief Delay for a specified number of microseconds
@@ -52,6 +100,17 @@ void USensor_Read2(void);
  */
 void USensor_DelayUs(uint16_t us);
 
+#if USENSOR_ENVELOPE
+/**
+ * @brief  Format the envelope ranging timing as
+ *         "ENV,<avg_cycles>,<worst_cycles>,<budget>,<overruns>,<pings>,<echoes>"
+ *         and restart it.
+ * @param  buf Output buffer of at least USENSOR_ENV_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t USensor_FormatEnvelope(char *buf);
+#endif
+
 /**
  * @brief Callback function for Timer Input Capture events
  * @param htim Pointer to the TIM handle
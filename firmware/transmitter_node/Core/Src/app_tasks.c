@@ -3,78 +3,481 @@
  * @ingroup Transmitter_Node
  * @brief   FreeRTOS task implementations for the transmitter node.
  *
- * This file contains the RTOS task loops responsible for:
- *   - Periodic ultrasonic sensor triggering (Sensor 1 and Sensor 2)
+ * This file contains the work run in the slots of the time-triggered
+ * schedule (tt_sched.c):
  *   - Packaging and transmitting distance measurements through CAN
+ *   - Diagnostic lines on USART2
  *
- * Each task runs independently under FreeRTOS and uses modules provided
- * in usensor.c and the CAN HAL driver.
+ * and the stack monitor task. Sensor triggering and echo windows are
+ * handled by tt_sched.c with the functions of usensor.c.
  */
 #include "app_tasks.h"
+#include "fmt.h"
+#include "cpu_stats.h"
+#include "stack_mon.h"
+#include "tickless.h"
+#include "tt_sched.h"
+#include "trace.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "boot_time.h"
+#include "isr_stats.h"
+#include "range_filter.h"
+#include "trilateration.h"
+#include "obstacle_class.h"
+#include "sensor_health.h"
 #include <string.h> // For strlen if UART debug is enabled
 
+/** Number of schedule cycles between two CPU load reports (~1 s) */
+#define CPU_REPORT_EVERY  16u
+
+/** Number of schedule cycles between two trace snapshots (~5 s) */
+#define TRACE_SNAPSHOT_EVERY  80u
+
+/** Longest "TT" line, CR LF included */
+#define TT_LINE_MAX  40u
+
+/** Longest "TRI" line, CR LF included */
+#define TRI_LINE_MAX  (4u + 6u + 4u * 11u + 2u)
+
+/** Longest "CLS" line, CR LF included */
+#define CLS_LINE_MAX  (4u + 6u * 11u + 2u)
+
+/** Trilateration timing over one report window */
+typedef struct
+{
+    uint32_t solves;            /**< Positions attempted */
+    uint32_t fixes;             /**< Positions found */
+    uint32_t cycles;            /**< Total cycles spent */
+    uint32_t worst;             /**< Longest solve (cycles) */
+} TxTrilatStatsTypeDef;
+
+/** Trilateration timing since the previous "TRI" line; only touched by TtTask */
+static TxTrilatStatsTypeDef txTrilatStats;
+
+/** Classifier timing over one report window */
+typedef struct
+{
+    uint32_t inferences;        /**< Readings classified */
+    uint32_t dropped;           /**< Readings dropped as ground or noise */
+    uint32_t cycles;            /**< Total cycles spent */
+    uint32_t worst;             /**< Longest inference (cycles) */
+    uint32_t overruns;          /**< Inferences over OBS_CLASS_BUDGET_CYCLES */
+} TxClassStatsTypeDef;
+
+/** Classifier timing since the previous "CLS" line; only touched by TtTask */
+static TxClassStatsTypeDef txClassStats;
+
+/** Last readings of each sensor, for the classifier */
+static ObsWindowTypeDef txObsWindow[USENSOR_COUNT];
+
+/** Health statistics of each sensor; only touched by TtTask */
+static HealthSensorTypeDef txHealth[USENSOR_COUNT];
+
+/** txHealth has been started */
+static uint8_t txHealthReady;
+
+/** Header of the position frame */
+static CAN_TxHeaderTypeDef txPosHeader;
+
+/** Position frame payload */
+static uint8_t txPosData[TX_CAN_POS_DLC];
+
 /** ---------------------------------------------------------------------------
- * Task: us1Task_init
- * @brief  RTOS thread to periodically read the first ultrasonic sensor.
- * @param  argument: Not used
+ * @brief  Locate the obstacle from the filtered distances and fill the
+ *         position frame with it and the sensor health; the solve is
+ *         timed for the "TRI" line.
  * @retval None
  * --------------------------------------------------------------------------- */
-void us1Task_init(void *argument)
+static void Tx_FillPosition(void)
 {
-    (void) argument;  /**< Unused parameter */
+    TrilatFixTypeDef fix = {0};
+    uint32_t start, cycles;
+    uint8_t valid = 0;
+    uint8_t i;
 
-    for(;;)
+    /* A missing echo is no range to intersect */
+    if (TxData[TX_CAN_DISTANCE] != USENSOR_NO_ECHO && TxData[TX_CAN_DISTANCE + 1u] != USENSOR_NO_ECHO)
     {
-        USensor_Read1();   /**< Trigger first sensor measurement */
-        osDelay(60);       /**< Wait minimum 60 ms between measurements */
+        start = DWT->CYCCNT;
+        valid = Trilat_Solve((uint16_t)(TxData[TX_CAN_DISTANCE] * 10u),
+                             (uint16_t)(TxData[TX_CAN_DISTANCE + 1u] * 10u), &fix);
+        cycles = DWT->CYCCNT - start;
+
+        txTrilatStats.solves++;
+        txTrilatStats.fixes += valid;
+        txTrilatStats.cycles += cycles;
+        if (cycles > txTrilatStats.worst)
+            txTrilatStats.worst = cycles;
     }
+
+    txPosData[TX_CAN_POS_LATERAL] = (uint8_t)fix.lateral_mm;
+    txPosData[TX_CAN_POS_LATERAL + 1u] = (uint8_t)((uint16_t)fix.lateral_mm >> 8);
+    txPosData[TX_CAN_POS_FORWARD] = (uint8_t)fix.forward_mm;
+    txPosData[TX_CAN_POS_FORWARD + 1u] = (uint8_t)(fix.forward_mm >> 8);
+    txPosData[TX_CAN_POS_FLAGS] = valid ? TX_CAN_POS_FLAG_VALID : 0u;
+
+    txPosData[TX_CAN_POS_HEALTH] = 0;
+    for (i = 0; i < USENSOR_COUNT; i++)
+        txPosData[TX_CAN_POS_HEALTH] |= (uint8_t)(Health_Nibble(&txHealth[i]) << (4u * i));
 }
 
 /** ---------------------------------------------------------------------------
- * Task: us2Task_init
- * @brief  	RTOS thread to periodically read the second ultrasonic sensor.
- * @param  	argument: Not used
- * @retval 	None
+ * @brief  Classify the latest reading of a sensor and, with
+ *         OBS_CLASS_SUPPRESS, drop it when it comes from the ground or
+ *         noise; the inference is timed for the "CLS" line.
+ * @param  sensor Sensor index, below USENSOR_COUNT.
+ * @retval Reading to filter (cm), or USENSOR_NO_ECHO.
  * --------------------------------------------------------------------------- */
-void us2Task_init(void *argument)
+static uint8_t Tx_Classify(uint8_t sensor)
 {
-    (void) argument;  /**< Unused parameter */
+    ObsWindowTypeDef *w = &txObsWindow[sensor];
+    int8_t features[OBS_FEATURES];
+    ObsClassTypeDef cls;
+    uint32_t start, cycles;
+    uint8_t cm = Distance[sensor];
 
-    for(;;)
+    ObsClass_Push(w, cm);
+
+    /* Nothing to drop, or too few readings to tell */
+    if (cm == USENSOR_NO_ECHO || w->count < OBS_WINDOW)
+        return cm;
+
+    ObsClass_Features(w, features);
+    start = DWT->CYCCNT;
+    cls = ObsClass_Infer(features, NULL);
+    cycles = DWT->CYCCNT - start;
+
+    txClassStats.inferences++;
+    txClassStats.cycles += cycles;
+    if (cycles > txClassStats.worst)
+        txClassStats.worst = cycles;
+    if (cycles > OBS_CLASS_BUDGET_CYCLES)
+        txClassStats.overruns++;
+
+#if OBS_CLASS_SUPPRESS
+    if (cls >= OBS_GROUND && cm >= OBS_CLASS_KEEP_CM)
     {
-        USensor_Read2();   /**< Trigger second sensor measurement */
-        osDelay(60);       /**< Wait minimum 60 ms between measurements */
+        txClassStats.dropped++;
+        TxData[TX_CAN_FLAGS] |= TX_CAN_FLAG_DROPPED(sensor);
+        return USENSOR_NO_ECHO;
     }
+#else
+    (void)cls;
+#endif
+    return cm;
 }
 
 /** ---------------------------------------------------------------------------
- * Task: TxTask_init
- * @brief  RTOS thread to transmit sensor distances via CAN bus.
- * @param  argument: Not used
+ * Slot: Tx_SendDistances
+ * @brief  Transmit the distances of the current cycle via CAN bus.
+ *
+ * Every raw reading is first accounted in the health of its sensor,
+ * which the position frame carries.
  * @retval None
  * --------------------------------------------------------------------------- */
-void TxTask_init(void *argument)
+void Tx_SendDistances(void)
 {
-    (void) argument;  /**< Unused parameter */
     //char Buffer[50]; /**< Optional: For UART debug */
+    RangeTrackTypeDef track;
+    uint32_t now = HAL_GetTick();
+    uint32_t age;
+    uint8_t i;
 
-    for(;;)
+    /**< Fill CAN transmit buffer with the classified and filtered distances,
+         velocities and ages */
+    TxData[TX_CAN_FLAGS] = 0;
+    TxData[TX_CAN_AGE] = 0;
+    if (!txHealthReady)
+    {
+        for (i = 0; i < USENSOR_COUNT; i++)
+            Health_Init(&txHealth[i]);
+        txHealthReady = 1;
+    }
+    for (i = 0; i < USENSOR_COUNT; i++)
+    {
+        /* Health judges the raw readings, before anything is dropped */
+        Health_Update(&txHealth[i], Distance[i], USensor_GetStatus(i) == USENSOR_SILENT,
+                      Distance[(i + 1u) % USENSOR_COUNT]);
+        TxData[TX_CAN_DISTANCE + i] = RangeFilter_Process(i, Tx_Classify(i));
+        RangeFilter_GetTrack(i, &track);
+        TxData[TX_CAN_CLOSING + 2u * i] = (uint8_t)track.closing_mm_s;
+        TxData[TX_CAN_CLOSING + 2u * i + 1u] = (uint8_t)((uint16_t)track.closing_mm_s >> 8);
+        if (track.confident)
+            TxData[TX_CAN_FLAGS] |= TX_CAN_FLAG_CONFIDENT(i);
+
+        /* Round to the unit; older samples are sent as the largest age */
+        age = (now - DistanceTick[i] + RangeFilter_LagMs() + TX_CAN_AGE_UNIT_MS / 2u) / TX_CAN_AGE_UNIT_MS;
+        if (age > (1u << TX_CAN_AGE_BITS) - 1u)
+            age = (1u << TX_CAN_AGE_BITS) - 1u;
+        TxData[TX_CAN_AGE] |= (uint8_t)(age << (TX_CAN_AGE_BITS * i));
+    }
+
+    // Optional: UART debug
+    // sprintf(Buffer, "Sensor1: %d, Sensor2: %d\r\n", Distance[0], Distance[1]);
+    // HAL_UART_Transmit(&huart2, (uint8_t *)Buffer, strlen(Buffer), 10);
+
+    /**< Transmit CAN message */
+    TRACE_MARK(TRACE_MARK_CAN_TX, TxHeader.StdId);
+    if(HAL_CAN_AddTxMessage(&hcan, &TxHeader, TxData, &TxMailbox) != HAL_OK)
+    {
+        /**< CAN transmission failed, signal with LED (optional) */
+        HAL_GPIO_WritePin(GPIOC, GPIO_PIN_13, GPIO_PIN_RESET);
+    }
+    else
+    {
+        Boot_Mark(BOOT_FIRST_CAN);
+    }
+
+    /**< Position frame, same header but for the identifier and length */
+    Tx_FillPosition();
+    txPosHeader = TxHeader;
+    txPosHeader.StdId = TX_CAN_POSITION_ID;
+    txPosHeader.DLC = TX_CAN_POS_DLC;
+    TRACE_MARK(TRACE_MARK_CAN_TX, txPosHeader.StdId);
+    if(HAL_CAN_AddTxMessage(&hcan, &txPosHeader, txPosData, &TxMailbox) != HAL_OK)
     {
-        /**< Fill CAN transmit buffer */
-        TxData[0] = Distance_1;
-        TxData[1] = Distance_2;
+        HAL_GPIO_WritePin(GPIOC, GPIO_PIN_13, GPIO_PIN_RESET);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief  Format the executive statistics as "TT,<cycles>,<late>,<worst_ms>".
+ * @param  buf Output buffer of at least TT_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ * --------------------------------------------------------------------------- */
+static uint16_t Tx_FormatSchedule(char *buf)
+{
+    const TtStatsTypeDef *stats = TtSched_GetStats();
+    uint16_t n = 0;
+
+    buf[n++] = 'T';
+    buf[n++] = 'T';
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats->cycles, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats->late, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats->worst_late, &buf[n]);
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief  Format the trilateration timing as
+ *         "TRI,<sqrt>,<avg_cycles>,<worst_cycles>,<fixes>,<solves>" and
+ *         restart it; sqrt is isqrt, or cmsis with TRILAT_USE_CMSIS=1.
+ * @param  buf Output buffer of at least TRI_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ * --------------------------------------------------------------------------- */
+static uint16_t Tx_FormatTrilat(char *buf)
+{
+#if TRILAT_USE_CMSIS
+    static const char head[] = "TRI,cmsis,";
+#else
+    static const char head[] = "TRI,isqrt,";
+#endif
+    uint16_t n = sizeof(head) - 1u;
+
+    memcpy(buf, head, n);
+    n += Fmt_Decimal(txTrilatStats.solves ? txTrilatStats.cycles / txTrilatStats.solves : 0u, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(txTrilatStats.worst, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(txTrilatStats.fixes, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(txTrilatStats.solves, &buf[n]);
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+
+    memset(&txTrilatStats, 0, sizeof(txTrilatStats));
+    return n;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief  Format the classifier timing as
+ *         "CLS,<avg_cycles>,<worst_cycles>,<budget>,<overruns>,<inferences>,<dropped>"
+ *         and restart it.
+ * @param  buf Output buffer of at least CLS_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ * --------------------------------------------------------------------------- */
+static uint16_t Tx_FormatClass(char *buf)
+{
+    static const char head[] = "CLS,";
+    uint16_t n = sizeof(head) - 1u;
+
+    memcpy(buf, head, n);
+    n += Fmt_Decimal(txClassStats.inferences ? txClassStats.cycles / txClassStats.inferences : 0u, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(txClassStats.worst, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(OBS_CLASS_BUDGET_CYCLES, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(txClassStats.overruns, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(txClassStats.inferences, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(txClassStats.dropped, &buf[n]);
+    buf[n++] = '\r';
+    buf[n++] = '\n';
 
-        // Optional: UART debug
-        // sprintf(Buffer, "Sensor1: %d, Sensor2: %d\r\n", Distance_1, Distance_2);
-        // HAL_UART_Transmit(&huart2, (uint8_t *)Buffer, strlen(Buffer), 10);
+    memset(&txClassStats, 0, sizeof(txClassStats));
+    return n;
+}
 
-        /**< Transmit CAN message */
-        if(HAL_CAN_AddTxMessage(&hcan, &TxHeader, TxData, &TxMailbox) != HAL_OK)
+/** ---------------------------------------------------------------------------
+ * Slot: Tx_Report
+ * @brief  Write one diagnostic line on USART2.
+ *
+ * Every CPU_REPORT_EVERY cycles it writes the per-task CPU load (see
+ * CpuStats_Format), a quarter of the way the schedule statistics, half-way
+ * the stack usage (see StackMon_Format) and at three quarters the idle
+ * sleep statistics (see Tickless_Format). The boot-phase times go out at
+ * three eighths of the way (see Boot_Format), the latency and duration of
+ * one interrupt in turn at five eighths (see IsrStats_Format), the range
+ * filter timing at seven eighths (see RangeFilter_Format), the
+ * trilateration timing a sixteenth of the way (see Tx_FormatTrilat), in
+ * envelope mode the envelope ranging timing at three sixteenths (see
+ * USensor_FormatEnvelope), the classifier timing at five sixteenths (see
+ * Tx_FormatClass) and, after a crash reset, the crash record at an eighth
+ * of the way (see Crash_Format).
+ * Every
+ * TRACE_SNAPSHOT_EVERY cycles the event trace is frozen and sent as "TRC"
+ * lines, TRACE_LINE_EVENTS events per cycle.
+ *
+ * @retval None
+ * --------------------------------------------------------------------------- */
+void Tx_Report(void)
+{
+    static char cpuLine[CPU_STATS_LINE_MAX]; /**< CPU load report */
+    static char stackLine[STACK_MON_LINE_MAX]; /**< Stack usage report */
+    static char powerLine[TICKLESS_LINE_MAX];  /**< Idle sleep report */
+    static char ttLine[TT_LINE_MAX];           /**< Schedule report */
+    static char crashLine[CRASH_LINE_MAX];     /**< Last crash report */
+    static char bootLine[BOOT_LINE_MAX];       /**< Boot-phase report */
+    static char isrLine[ISR_STATS_LINE_MAX];   /**< Interrupt report */
+    static char filterLine[RANGE_FILTER_LINE_MAX]; /**< Range filter report */
+    static char triLine[TRI_LINE_MAX];         /**< Trilateration report */
+    static char clsLine[CLS_LINE_MAX];         /**< Classifier report */
+#if USENSOR_ENVELOPE
+    static char envLine[USENSOR_ENV_LINE_MAX]; /**< Envelope ranging report */
+#endif
+    static uint8_t isrNext = 0;                /**< Interrupt reported next */
+    static uint8_t reports = 0;
+#if TRACE_ENABLE
+    static char traceLine[TRACE_LINE_MAX]; /**< Trace snapshot line */
+    static uint8_t snapshots = 0;
+    static uint16_t traceNext = 0;
+#endif
+
+    /**< Periodic reports on USART2 */
+    if (++reports == CPU_REPORT_EVERY)
+    {
+        reports = 0;
+        HAL_UART_Transmit(&huart2, (uint8_t *)cpuLine, CpuStats_Format(cpuLine), 10);
+    }
+    else if (reports == CPU_REPORT_EVERY / 4)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)ttLine, Tx_FormatSchedule(ttLine), 10);
+    }
+    else if (reports == CPU_REPORT_EVERY / 2)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)stackLine, StackMon_Format(stackLine), 10);
+    }
+    else if (reports == CPU_REPORT_EVERY * 3 / 4)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)powerLine, Tickless_Format(powerLine), 10);
+    }
+    else if (reports == CPU_REPORT_EVERY * 3 / 8)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)bootLine, Boot_Format(bootLine), 10);
+    }
+    else if (reports == CPU_REPORT_EVERY * 5 / 8)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)isrLine, IsrStats_Format((IsrStatsIdTypeDef)isrNext, isrLine), 10);
+        if (++isrNext == ISR_STATS_COUNT)
+            isrNext = 0;
+    }
+    else if (reports == CPU_REPORT_EVERY * 7 / 8)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)filterLine, RangeFilter_Format(filterLine), 10);
+    }
+    else if (reports == CPU_REPORT_EVERY / 16)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)triLine, Tx_FormatTrilat(triLine), 10);
+    }
+    else if (reports == CPU_REPORT_EVERY * 5 / 16)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)clsLine, Tx_FormatClass(clsLine), 10);
+    }
+#if USENSOR_ENVELOPE
+    else if (reports == CPU_REPORT_EVERY * 3 / 16)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)envLine, USensor_FormatEnvelope(envLine), 10);
+    }
+#endif
+    else if (reports == CPU_REPORT_EVERY / 8 && Crash_GetLast() != NULL)
+    {
+        HAL_UART_Transmit(&huart2, (uint8_t *)crashLine, Crash_Format(crashLine), 20);
+    }
+#if TRACE_ENABLE
+    /**< Trace snapshot on USART2, a few events per cycle */
+    else if (Trace_IsFrozen())
+    {
+        if (traceNext < Trace_Count())
         {
-            /**< CAN transmission failed, signal with LED (optional) */
-            HAL_GPIO_WritePin(GPIOC, GPIO_PIN_13, GPIO_PIN_RESET);
+            HAL_UART_Transmit(&huart2, (uint8_t *)traceLine, Trace_Format(traceNext, traceLine), 10);
+            traceNext += TRACE_LINE_EVENTS;
         }
+        else
+        {
+            traceNext = 0;
+            Trace_Resume();
+        }
+    }
+    else if (++snapshots == TRACE_SNAPSHOT_EVERY)
+    {
+        snapshots = 0;
+        Trace_Freeze();
+    }
+#endif
+}
+
+/** ---------------------------------------------------------------------------
+ * Task: MonTask_init
+ * @brief  RTOS thread sampling the stack high-water mark of every task.
+ *
+ * Adds the kernel's idle and timer tasks to the monitor, then samples every
+ * STACK_MON_PERIOD_MS. A task dropping under STACK_MON_MARGIN for the first
+ * time freezes the event trace so the snapshot shows what it was doing.
+ * Running at the lowest priority, it also refreshes the watchdog when
+ * every task has checked in. USART2 is initialised here, off the boot
+ * path; reports before that are dropped by the HAL.
+ *
+ * @param  argument: Not used
+ * @retval None
+ * --------------------------------------------------------------------------- */
+void MonTask_init(void *argument)
+{
+    uint8_t low = 0;
+    uint8_t now;
+
+    (void) argument;  /**< Unused parameter */
+
+    MX_Deferred_Init();
+    StackMon_RegisterKernelTasks();
+
+    for(;;)
+    {
+        now = StackMon_Sample();
+        if (now & ~low)
+            TRACE_FREEZE();
+        low = now;
+
+        Watchdog_Supervise();
+        Watchdog_Checkin();
 
-        osDelay(60);  /**< Wait 60 ms before next transmission */
+        osDelay(STACK_MON_PERIOD_MS);
     }
 }
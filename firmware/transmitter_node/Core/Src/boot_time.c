@@ -0,0 +1,94 @@
+/**
+ * @file    boot_time.c
+ * @ingroup Transmitter_Node
+ * @brief   Boot-phase timestamps from reset to the first CAN frame.
+ */
+#include "boot_time.h"
+#include "fmt.h"
+#include "main.h"
+
+/** Time of each phase since reset (us), 0 if not reached */
+static uint32_t bootUs[BOOT_PHASE_COUNT];
+
+/** Time since reset at the previous mark (us) */
+static uint32_t bootElapsedUs;
+
+/** CYCCNT at the previous mark; the counter starts at 0 at reset */
+static uint32_t bootLastCycles;
+
+/** Core clock since the previous mark (Hz), 0 before the first mark */
+static uint32_t bootLastHz;
+
+/**
+ * @brief Start the cycle counter at reset. Called from SystemInit, before
+ *        the C start-up code: touches no RAM.
+ */
+void Boot_Start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Record the time since reset at which a phase is reached; later
+ *        marks of the same phase are ignored. Safe from interrupts.
+ * @param phase Boot phase.
+ */
+void Boot_Mark(BootPhaseTypeDef phase)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now;
+
+    if (phase >= BOOT_PHASE_COUNT || bootUs[phase] != 0)
+        return;
+
+    __disable_irq();
+    if (bootUs[phase] == 0)
+    {
+        now = DWT->CYCCNT;
+        if (bootLastHz == 0)
+            bootLastHz = SystemCoreClock;   /* Reset clock, for the C start-up */
+
+        /* One counter wrap (59 s at 72 MHz) between marks is tolerated */
+        bootElapsedUs += (now - bootLastCycles) / (bootLastHz / 1000000u);
+        bootLastCycles = now;
+        bootLastHz = SystemCoreClock;
+        bootUs[phase] = bootElapsedUs ? bootElapsedUs : 1u;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Time since reset at which a phase was reached.
+ * @param  phase Boot phase.
+ * @retval Microseconds, 0 if not reached yet.
+ */
+uint32_t Boot_GetUs(BootPhaseTypeDef phase)
+{
+    return (phase < BOOT_PHASE_COUNT) ? bootUs[phase] : 0;
+}
+
+/**
+ * @brief  Format the phase times as one text line.
+ * @param  buf Output buffer of at least BOOT_LINE_MAX bytes.
+ * @retval Number of characters written.
+ */
+uint16_t Boot_Format(char *buf)
+{
+    uint16_t n = 0;
+    uint8_t i;
+
+    buf[n++] = 'B';
+    buf[n++] = 'O';
+    buf[n++] = 'O';
+    buf[n++] = 'T';
+    for (i = 0; i < BOOT_PHASE_COUNT; i++)
+    {
+        buf[n++] = ',';
+        n += Fmt_Decimal(bootUs[i], &buf[n]);
+    }
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
+}
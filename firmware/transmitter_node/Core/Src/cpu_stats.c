@@ -0,0 +1,88 @@
+/**
+ * @file    cpu_stats.c
+ * @ingroup Transmitter_Node
+ * @brief   Per-task CPU load from the FreeRTOS run-time statistics.
+ */
+#include "cpu_stats.h"
+#include "fmt.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+/** Task states returned by the kernel */
+static TaskStatus_t cpuStatus[CPU_STATS_MAX_TASKS];
+
+/** Run-time counter of each task at the previous call, by task number */
+static uint32_t cpuLastCounter[CPU_STATS_MAX_TASKS + 1];
+
+/** Total run time at the previous call */
+static uint32_t cpuLastTotal;
+
+/**
+ * @brief Measure the load of every task since the previous call.
+ * @param load Filled with the result; count is 0 if there are more than
+ *             CPU_STATS_MAX_TASKS tasks.
+ */
+void CpuStats_Update(CpuLoadTypeDef *load)
+{
+    UBaseType_t n, i, num;
+    uint32_t total, scale, run, permille;
+
+    n = uxTaskGetSystemState(cpuStatus, CPU_STATS_MAX_TASKS, &total);
+
+    load->cycles = total - cpuLastTotal;
+    load->count = (uint8_t)n;
+    cpuLastTotal = total;
+
+    /* Cycles per permille; avoids a 64-bit division */
+    scale = load->cycles / 1000u;
+
+    for (i = 0; i < n; i++)
+    {
+        num = cpuStatus[i].xTaskNumber;
+        run = cpuStatus[i].ulRunTimeCounter;
+        if (num <= CPU_STATS_MAX_TASKS)
+        {
+            run -= cpuLastCounter[num];
+            cpuLastCounter[num] = cpuStatus[i].ulRunTimeCounter;
+        }
+
+        permille = scale ? run / scale : 0;
+        if (permille > 1000u)
+            permille = 1000u;
+
+        strncpy(load->task[i].name, cpuStatus[i].pcTaskName, CPU_STATS_NAME_LEN);
+        load->task[i].number = (uint8_t)num;
+        load->task[i].permille = (uint16_t)permille;
+    }
+}
+
+/**
+ * @brief  Measure the load and format it as one text line.
+ * @param  buf Output buffer of at least CPU_STATS_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t CpuStats_Format(char *buf)
+{
+    static CpuLoadTypeDef load;
+    uint16_t n;
+    uint8_t i, k;
+
+    CpuStats_Update(&load);
+
+    memcpy(buf, "CPU", 3);
+    n = 3;
+    for (i = 0; i < load.count; i++)
+    {
+        buf[n++] = ',';
+        n += Fmt_Decimal(load.task[i].number, &buf[n]);
+        buf[n++] = ',';
+        for (k = 0; k < CPU_STATS_NAME_LEN && load.task[i].name[k]; k++)
+            buf[n++] = load.task[i].name[k];
+        buf[n++] = ',';
+        n += Fmt_Decimal(load.task[i].permille, &buf[n]);
+    }
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
+}
@@ -0,0 +1,337 @@
+/**
+ * @file    crash.c
+ * @ingroup Transmitter_Node
+ * @brief   Crash context capture and fast restart.
+ */
+#include "crash.h"
+#include "fmt.h"
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+/** Marks a valid record in the crash area ("CRSH") */
+#define CRASH_MAGIC  0x43525348u
+
+/** Layout of the crash area; must fit in CRASH_AREA_SIZE bytes */
+typedef struct
+{
+    uint32_t           magic;       /**< CRASH_MAGIC while record is valid */
+    uint32_t           check;       /**< Checksum of record */
+    CrashRecordTypeDef record;      /**< Context of the crash */
+    uint16_t           resets;      /**< Crash resets since power-on */
+    uint16_t           resets_inv;  /**< ~resets, validates the counter */
+} CrashAreaTypeDef;
+
+/** The crash area, outside the linker's RAM region */
+#define crashArea  ((CrashAreaTypeDef *)CRASH_AREA_ADDR)
+
+/** Record of the crash that caused the last reset */
+static CrashRecordTypeDef crashLast;
+
+/** crashLast holds a record */
+static uint8_t crashValid;
+
+/** RCC_CSR reset flags of the last reset (bits 26-31) */
+static uint8_t crashCause;
+
+/** Crash resets since power-on */
+static uint16_t crashResets;
+
+/**
+ * @brief Checksum of a record.
+ * @param rec Record.
+ */
+static uint32_t Crash_Checksum(const CrashRecordTypeDef *rec)
+{
+    const uint32_t *word = (const uint32_t *)rec;
+    uint32_t sum = CRASH_MAGIC;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(*rec) / 4u; i++)
+        sum = ((sum << 5) | (sum >> 27)) ^ word[i];
+    return sum;
+}
+
+/**
+ * @brief  Check that words can be read without faulting again.
+ * @param  addr  Start address.
+ * @param  words Number of words.
+ * @retval 1 if the words lie in RAM below the crash area.
+ */
+static uint8_t Crash_InRam(const void *addr, uint32_t words)
+{
+    uint32_t start = (uint32_t)addr;
+
+    return (start & 3u) == 0 && start >= 0x20000000u &&
+           start + words * 4u <= CRASH_AREA_ADDR;
+}
+
+/**
+ * @brief  Task running when the crash happened.
+ * @retval Task handle, or NULL before the scheduler started.
+ */
+static TaskHandle_t Crash_CurrentTask(void)
+{
+    TaskHandle_t task;
+
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+        return NULL;
+    task = xTaskGetCurrentTaskHandle();
+    return Crash_InRam(task, 1u) ? task : NULL;
+}
+
+/**
+ * @brief Fill the crash area and mark it valid.
+ * @param reason CrashReasonTypeDef.
+ * @param line   Source line, 0 if none.
+ * @param task   Task to blame, or NULL.
+ * @param pc     Program counter.
+ * @param lr     Link register.
+ * @param psr    xPSR.
+ * @param sp     Stack pointer; the words above it are saved.
+ */
+static void Crash_Fill(uint8_t reason, uint16_t line, TaskHandle_t task,
+                       uint32_t pc, uint32_t lr, uint32_t psr, const uint32_t *sp)
+{
+    CrashRecordTypeDef *rec = &crashArea->record;
+    TaskStatus_t status;
+    uint8_t i;
+
+    crashArea->magic = 0;
+    memset(rec, 0, sizeof(*rec));
+
+    rec->reason = reason;
+    rec->line = line;
+    rec->pc = pc;
+    rec->lr = lr;
+    rec->psr = psr;
+    rec->cfsr = SCB->CFSR;
+    rec->hfsr = SCB->HFSR;
+    rec->sp = (uint32_t)sp;
+
+    if (task != NULL)
+    {
+        /* eInvalid: reads the TCB only, no kernel locking */
+        vTaskGetInfo(task, &status, pdFALSE, eInvalid);
+        rec->task = (uint8_t)status.xTaskNumber;
+        strncpy(rec->name, status.pcTaskName, CRASH_NAME_LEN);
+    }
+
+    if (Crash_InRam(sp, CRASH_STACK_WORDS))
+    {
+        for (i = 0; i < CRASH_STACK_WORDS; i++)
+            rec->stack[i] = sp[i];
+    }
+
+    crashArea->check = Crash_Checksum(rec);
+    crashArea->magic = CRASH_MAGIC;
+}
+
+/**
+ * @brief Read the reset cause and take over the record of the previous
+ *        crash, if any. Call first thing in main().
+ */
+void Crash_Init(void)
+{
+    uint32_t csr = RCC->CSR;
+
+    RCC->CSR |= RCC_CSR_RMVF;
+    crashCause = (uint8_t)(csr >> 26);
+
+    /* RAM content is undefined after a power-on */
+    if ((csr & RCC_CSR_PORRSTF) || (crashArea->resets ^ crashArea->resets_inv) != 0xFFFFu)
+    {
+        crashArea->magic = 0;
+        crashArea->resets = 0;
+    }
+
+    if (crashArea->magic == CRASH_MAGIC &&
+        crashArea->check == Crash_Checksum(&crashArea->record) &&
+        (crashArea->record.reason != CRASH_WATCHDOG || (csr & RCC_CSR_IWDGRSTF)))
+    {
+        crashLast = crashArea->record;
+        crashValid = 1;
+    }
+    else if (csr & RCC_CSR_IWDGRSTF)
+    {
+        /* Bitten with interrupts masked: no chance to save anything */
+        memset(&crashLast, 0, sizeof(crashLast));
+        crashLast.reason = CRASH_WATCHDOG;
+        crashValid = 1;
+    }
+    crashArea->magic = 0;
+
+    if (crashValid)
+        crashArea->resets++;
+    crashArea->resets_inv = (uint16_t)(crashArea->resets ^ 0xFFFFu);
+    crashResets = crashArea->resets;
+}
+
+/**
+ * @brief  Record of the crash that caused the last reset.
+ * @retval The record, or NULL after a clean power-on or reset.
+ */
+const CrashRecordTypeDef *Crash_GetLast(void)
+{
+    return crashValid ? &crashLast : NULL;
+}
+
+/**
+ * @brief Save a record and reset the node.
+ * @param reason CrashReasonTypeDef.
+ * @param pc     Address to report (usually the caller's).
+ * @param line   Source line, 0 if none.
+ */
+void Crash_Halt(uint8_t reason, uint32_t pc, uint16_t line)
+{
+    uint32_t here = 0;
+
+    __disable_irq();
+    Crash_Fill(reason, line, Crash_CurrentTask(), pc, 0, __get_xPSR(), &here);
+
+    NVIC_SystemReset();
+}
+
+/**
+ * @brief Failed configASSERT: save a record and reset the node.
+ * @param line Line of the assertion.
+ */
+void Crash_Assert(uint16_t line)
+{
+    Crash_Halt(CRASH_ASSERT, CRASH_CALLER(), line);
+}
+
+/**
+ * @brief Save a record without resetting; it is dropped again by
+ *        Crash_Clear.
+ *
+ * The blamed task is not running (the caller is), so its context is the
+ * one the port saved on its stack when it was switched out: R4-R11, then
+ * the exception frame R0-R3, R12, LR, PC, xPSR.
+ *
+ * @param reason CrashReasonTypeDef.
+ * @param task   Task to blame.
+ */
+void Crash_Save(uint8_t reason, void *task)
+{
+    const uint32_t *top = NULL;
+    uint32_t primask = __get_PRIMASK();
+
+    if (Crash_InRam(task, 1u))
+        top = *(const uint32_t * const *)task;   /* pxTopOfStack */
+
+    __disable_irq();
+    if (Crash_InRam(top, 16u))
+        Crash_Fill(reason, 0, task, top[14], top[13], top[15], &top[16]);
+    else
+        Crash_Fill(reason, 0, task, 0, 0, 0, NULL);
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Drop a record saved with Crash_Save.
+ */
+void Crash_Clear(void)
+{
+    crashArea->magic = 0;
+}
+
+/**
+ * @brief HardFault handler, continued with the stacked exception frame.
+ * @param frame R0-R3, R12, LR, PC, xPSR pushed on exception entry.
+ */
+void Crash_HardFault(const uint32_t *frame)
+{
+    if (Crash_InRam(frame, 8u))
+        Crash_Fill(CRASH_HARDFAULT, 0, Crash_CurrentTask(), frame[6], frame[5], frame[7], &frame[8]);
+    else
+        Crash_Fill(CRASH_HARDFAULT, 0, Crash_CurrentTask(), 0, 0, 0, frame);
+
+    NVIC_SystemReset();
+}
+
+/**
+ * @brief Hard fault handler: pass the stack holding the exception frame
+ *        (bit 2 of EXC_RETURN: process or main stack) to Crash_HardFault.
+ */
+#if defined(__CC_ARM)
+__asm void HardFault_Handler(void)
+{
+    IMPORT  Crash_HardFault
+    TST     LR, #4
+    ITE     EQ
+    MRSEQ   R0, MSP
+    MRSNE   R0, PSP
+    B       Crash_HardFault
+}
+#else
+__attribute__((naked)) void HardFault_Handler(void)
+{
+    __asm volatile(
+        "tst   lr, #4          \n"
+        "ite   eq              \n"
+        "mrseq r0, msp         \n"
+        "mrsne r0, psp         \n"
+        "b     Crash_HardFault \n");
+}
+#endif
+
+/**
+ * @brief  Write a value as hexadecimal digits.
+ * @param  value  Value to write.
+ * @param  digits Number of digits.
+ * @param  buf    Output buffer of at least digits bytes.
+ * @retval Number of characters written.
+ */
+static uint8_t Crash_Hex(uint32_t value, uint8_t digits, char *buf)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t i;
+
+    for (i = 0; i < digits; i++)
+        buf[i] = hex[(value >> (4u * (digits - 1u - i))) & 0xFu];
+    return digits;
+}
+
+/**
+ * @brief  Format the record of the last crash as one text line.
+ * @param  buf Output buffer of at least CRASH_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL), 0 if there is
+ *         no record.
+ */
+uint16_t Crash_Format(char *buf)
+{
+    const uint32_t *words = &crashLast.pc;
+    uint16_t n = 0;
+    uint8_t i;
+
+    if (!crashValid)
+        return 0;
+
+    memcpy(buf, "CRASH,", 6);
+    n = 6;
+    n += Fmt_Decimal(crashLast.reason, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(crashLast.task, &buf[n]);
+    buf[n++] = ',';
+    for (i = 0; i < CRASH_NAME_LEN && crashLast.name[i] != '\0'; i++)
+        buf[n++] = crashLast.name[i];
+    buf[n++] = ',';
+    n += Fmt_Decimal(crashLast.line, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(crashResets, &buf[n]);
+    buf[n++] = ',';
+    n += Crash_Hex(crashCause, 2u, &buf[n]);
+
+    /* pc .. sp, then the stack words */
+    for (i = 0; i < 6u + CRASH_STACK_WORDS; i++)
+    {
+        buf[n++] = ',';
+        n += Crash_Hex(words[i], 8u, &buf[n]);
+    }
+
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
+}
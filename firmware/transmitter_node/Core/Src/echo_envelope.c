@@ -0,0 +1,131 @@
+/**
+ * @file    echo_envelope.c
+ * @ingroup Transmitter_Node
+ * @brief   Matched-filter ranging on a sampled echo envelope.
+ *
+ * arm_correlate_fast_q15 writes 2 * ECHO_ENV_SAMPLES - 1 lags, the first
+ * half for the template ahead of the ping; only the lags at which the
+ * whole template overlaps the ping are searched. The taps sum to under
+ * one, so the 2.30 accumulator cannot wrap and no input scaling is needed.
+ */
+#include "echo_envelope.h"
+#include "echo_range.h"
+#include "arm_math.h"
+
+/** Range of one sample (um): half the round trip at ECHO_CM_PER_MS */
+#define ECHO_ENV_UM_PER_SAMPLE  (ECHO_CM_PER_MS * 10000000u / ECHO_ENV_RATE_HZ)
+
+/** Range of ECHO_ENV_FIRST_SAMPLE_US (mm) */
+#define ECHO_ENV_FIRST_SAMPLE_MM (ECHO_ENV_FIRST_SAMPLE_US * (int32_t)ECHO_CM_PER_MS / 100)
+
+/** Last lag searched: the template still fits in the ping */
+#define ECHO_ENV_LAST_LAG       (ECHO_ENV_SAMPLES - ECHO_TEMPLATE_LEN)
+
+/** Burst template (q15) */
+static q15_t echoEnvTemplate[ECHO_TEMPLATE_LEN] = ECHO_TEMPLATE_TAPS;
+
+/** Correlation of the ping with the template */
+static q15_t echoEnvCorr[2u * ECHO_ENV_SAMPLES - 1u];
+
+/** Correlation peak of the burst ringing over the mean of the last ping */
+static int32_t echoEnvRinging;
+
+/**
+ * @brief  Range of a correlation peak, placed between samples.
+ * @param  c   Correlation, indexed by lag.
+ * @param  lag Lag of the peak, with a neighbour either side.
+ * @retval Range (mm).
+ */
+static uint16_t EchoEnv_PeakMm(const q15_t *c, uint16_t lag)
+{
+    int32_t num = (int32_t)c[lag - 1u] - c[lag + 1u];
+    int32_t den = (int32_t)c[lag - 1u] - 2 * (int32_t)c[lag] + c[lag + 1u];
+    int32_t frac = 0;
+    int32_t mm;
+
+    /* Vertex of the parabola through the three points, in 1/256 sample */
+    if (den < 0)
+    {
+        frac = num * 128 / den;
+        if (frac > 128)
+            frac = 128;
+        else if (frac < -128)
+            frac = -128;
+    }
+    mm = (int32_t)((((int32_t)lag * 256 + frac) * (int32_t)ECHO_ENV_UM_PER_SAMPLE / 256 + 500) / 1000)
+         + ECHO_ENV_FIRST_SAMPLE_MM;
+    return (uint16_t)((mm > 0) ? mm : 0);
+}
+
+/**
+ * @brief  Find the echoes in one ping.
+ * @param  samples ECHO_ENV_SAMPLES right-aligned 12-bit ADC samples from the
+ *                 trigger on; scaled to q15 in place.
+ * @param  echoes  Filled with the echoes found, nearest first.
+ * @param  max     Size of echoes, at most ECHO_ENV_MAX_ECHOES are found.
+ * @retval Number of echoes found.
+ */
+uint8_t EchoEnv_Range(uint16_t *samples, EchoEnvEchoTypeDef *echoes, uint8_t max)
+{
+    q15_t *x = (q15_t *)samples;
+    const q15_t *c = &echoEnvCorr[ECHO_ENV_SAMPLES - 1u];
+    int32_t sum = 0;
+    int32_t mean, height, peak, rearm = 0;
+    uint16_t lag;
+    uint8_t found = 0;
+    uint8_t armed = 1;
+
+    if (max > ECHO_ENV_MAX_ECHOES)
+        max = ECHO_ENV_MAX_ECHOES;
+
+    for (lag = 0; lag < ECHO_ENV_SAMPLES; lag++)
+        x[lag] = (q15_t)(samples[lag] << 3);
+
+    arm_correlate_fast_q15(x, ECHO_ENV_SAMPLES, echoEnvTemplate, ECHO_TEMPLATE_LEN, echoEnvCorr);
+
+    /* Echoes are short next to the ping: the mean is the noise floor */
+    for (lag = ECHO_ENV_BLANK_SAMPLES; lag <= ECHO_ENV_LAST_LAG; lag++)
+        sum += c[lag];
+    mean = sum / (int32_t)(ECHO_ENV_LAST_LAG - ECHO_ENV_BLANK_SAMPLES + 1u);
+
+    /* A live transducer hears its own burst ring in the blanked samples */
+    peak = c[0];
+    for (lag = 1; lag < ECHO_ENV_BLANK_SAMPLES; lag++)
+        if (c[lag] > peak)
+            peak = c[lag];
+    echoEnvRinging = peak - mean;
+
+    for (lag = ECHO_ENV_BLANK_SAMPLES + 1u; lag < ECHO_ENV_LAST_LAG; lag++)
+    {
+        height = c[lag] - mean;
+        if (!armed && c[lag] < rearm)
+            armed = 1;
+
+        if (height < ECHO_ENV_MIN_PEAK || c[lag] <= c[lag - 1u] || c[lag] < c[lag + 1u])
+            continue;
+
+        if (armed)
+        {
+            if (found == max)
+                break;
+            found++;
+        }
+        else if (height <= echoes[found - 1u].strength)
+        {
+            /* A ripple on the echo already found */
+            continue;
+        }
+
+        /* A new echo, or a higher peak of the last one */
+        echoes[found - 1u].mm = EchoEnv_PeakMm(c, lag);
+        echoes[found - 1u].strength = (uint16_t)height;
+        rearm = mean + height / 2;
+        armed = 0;
+    }
+    return found;
+}
+
+uint8_t EchoEnv_Ringing(void)
+{
+    return echoEnvRinging >= ECHO_ENV_MIN_RINGING;
+}
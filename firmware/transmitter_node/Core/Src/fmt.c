@@ -0,0 +1,23 @@
+/**
+ * @file    fmt.c
+ * @ingroup Transmitter_Node
+ * @brief   Number formatting of the diagnostic text lines.
+ */
+#include "fmt.h"
+
+uint8_t Fmt_Decimal(uint32_t value, char *buf)
+{
+    char digits[FMT_DECIMAL_MAX];
+    uint8_t d = 0;
+    uint8_t n = 0;
+
+    do
+    {
+        digits[d++] = (char)('0' + value % 10u);
+        value /= 10u;
+    } while (value);
+
+    while (d)
+        buf[n++] = digits[--d];
+    return n;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file    isr_stats.c
+ * @ingroup Transmitter_Node
+ * @brief   Interrupt entry latency and duration histograms.
+ */
+#include "isr_stats.h"
+#include "fmt.h"
+
+/** Samples of one quantity since the previous report */
+typedef struct
+{
+    uint32_t sum;                       /**< Sum of the samples */
+    uint16_t count;                     /**< Samples, saturating */
+    uint16_t min;                       /**< Shortest sample */
+    uint16_t max;                       /**< Longest sample */
+    uint16_t bins[ISR_STATS_BINS];      /**< Histogram */
+} IsrStatsHistTypeDef;
+
+/** NVIC line of each measured interrupt, in IsrStatsIdTypeDef order */
+static const IRQn_Type isrStatsIrq[ISR_STATS_COUNT] = {
+    TIM1_CC_IRQn,
+    TIM2_IRQn,
+    TIM3_IRQn,
+    USB_LP_CAN1_RX0_IRQn,
+};
+
+/** Entry latency of each interrupt */
+static IsrStatsHistTypeDef isrLatency[ISR_STATS_COUNT];
+
+/** Handler duration of each interrupt */
+static IsrStatsHistTypeDef isrDuration[ISR_STATS_COUNT];
+
+/**
+ * @brief Add one sample to a histogram. Called from the interrupt itself,
+ *        which no other measured interrupt preempts (same priority).
+ * @param hist   Histogram.
+ * @param cycles Sample (CPU cycles).
+ */
+static void IsrStats_Add(IsrStatsHistTypeDef *hist, uint32_t cycles)
+{
+    uint32_t bin = cycles / ISR_STATS_BIN_CYCLES;
+    uint16_t value = (cycles > 0xFFFFu) ? 0xFFFFu : (uint16_t)cycles;
+
+    if (hist->count == 0xFFFFu)
+        return;
+
+    if (hist->count == 0 || value < hist->min)
+        hist->min = value;
+    if (value > hist->max)
+        hist->max = value;
+    hist->sum += value;
+    hist->count++;
+    hist->bins[(bin < ISR_STATS_BINS) ? bin : ISR_STATS_BINS - 1u]++;
+}
+
+/**
+ * @brief Summarise a histogram.
+ * @param hist    Histogram.
+ * @param summary Filled with the result.
+ */
+static void IsrStats_Summarise(const IsrStatsHistTypeDef *hist, IsrStatsSummaryTypeDef *summary)
+{
+    uint32_t target, seen = 0;
+    uint8_t b;
+
+    summary->count = hist->count;
+    summary->min = hist->min;
+    summary->max = hist->max;
+    summary->avg = hist->count ? (uint16_t)(hist->sum / hist->count) : 0;
+    summary->p99 = 0;
+    if (hist->count == 0)
+        return;
+
+    /* First bin holding the 99th percentile sample; report its upper edge */
+    target = hist->count - hist->count / 100u;
+    for (b = 0; b < ISR_STATS_BINS - 1u; b++)
+    {
+        seen += hist->bins[b];
+        if (seen >= target)
+            break;
+    }
+    if (b == ISR_STATS_BINS - 1u || (b + 1u) * ISR_STATS_BIN_CYCLES - 1u > hist->max)
+        summary->p99 = hist->max;   /* Open last bin, or beyond the largest sample */
+    else
+        summary->p99 = (uint16_t)((b + 1u) * ISR_STATS_BIN_CYCLES - 1u);
+}
+
+/**
+ * @brief Record the duration of one handler run.
+ * @param id     Interrupt.
+ * @param cycles Duration (CPU cycles).
+ */
+void IsrStats_Duration(IsrStatsIdTypeDef id, uint32_t cycles)
+{
+    IsrStats_Add(&isrDuration[id], cycles);
+}
+
+/**
+ * @brief Record the entry latency of one interrupt.
+ * @param id     Interrupt.
+ * @param cycles Time from the event to the handler (CPU cycles).
+ */
+void IsrStats_Latency(IsrStatsIdTypeDef id, uint32_t cycles)
+{
+    IsrStats_Add(&isrLatency[id], cycles);
+}
+
+/**
+ * @brief Collect the statistics of one interrupt since the previous call
+ *        and restart them.
+ * @param id       Interrupt.
+ * @param latency  Filled with the entry latency summary.
+ * @param duration Filled with the duration summary.
+ */
+void IsrStats_Collect(IsrStatsIdTypeDef id, IsrStatsSummaryTypeDef *latency,
+                      IsrStatsSummaryTypeDef *duration)
+{
+    static const IsrStatsHistTypeDef empty = {0};
+    IsrStatsHistTypeDef lat, dur;
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    lat = isrLatency[id];
+    dur = isrDuration[id];
+    isrLatency[id] = empty;
+    isrDuration[id] = empty;
+    __set_PRIMASK(primask);
+
+    IsrStats_Summarise(&lat, latency);
+    IsrStats_Summarise(&dur, duration);
+}
+
+/**
+ * @brief  Write a summary as ",min,avg,max,p99", or four empty fields if
+ *         it holds no samples.
+ * @param  summary Summary.
+ * @param  buf     Output buffer of at least 24 bytes.
+ * @retval Number of characters written.
+ */
+static uint8_t IsrStats_Put(const IsrStatsSummaryTypeDef *summary, char *buf)
+{
+    const uint16_t values[4] = { summary->min, summary->avg, summary->max, summary->p99 };
+    uint8_t n = 0;
+    uint8_t i;
+
+    for (i = 0; i < 4u; i++)
+    {
+        buf[n++] = ',';
+        if (summary->count)
+            n += Fmt_Decimal(values[i], &buf[n]);
+    }
+    return n;
+}
+
+/**
+ * @brief  Collect the statistics of one interrupt and format them as one
+ *         text line.
+ * @param  id  Interrupt.
+ * @param  buf Output buffer of at least ISR_STATS_LINE_MAX bytes.
+ * @retval Number of characters written.
+ */
+uint16_t IsrStats_Format(IsrStatsIdTypeDef id, char *buf)
+{
+    IsrStatsSummaryTypeDef latency, duration;
+    uint16_t n = 0;
+
+    IsrStats_Collect(id, &latency, &duration);
+
+    buf[n++] = 'I';
+    buf[n++] = 'S';
+    buf[n++] = 'R';
+    buf[n++] = ',';
+    n += Fmt_Decimal(id, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(NVIC_GetPriority(isrStatsIrq[id]), &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(duration.count, &buf[n]);
+    n += IsrStats_Put(&latency, &buf[n]);
+    n += IsrStats_Put(&duration, &buf[n]);
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
+}
@@ -13,11 +13,23 @@
  *   - Starts FreeRTOS scheduler with tasks for sensor reading and CAN transmission
  * 
  * @note	HAL_TIM_IC_CaptureCallback is forwarded to the ultrasonic sensor module.
+ *       With USENSOR_ENVELOPE=1, ADC1 and DMA1 are set up to sample the
+ *       echo envelopes instead (see usensor.h).
  */
 #include "main.h"
 #include "cmsis_os.h"
 #include "app_tasks.h"
 #include "usensor.h"
+#if USENSOR_ENVELOPE
+#include "echo_envelope.h"
+#endif
+#include "stack_mon.h"
+#include "tickless.h"
+#include "tt_sched.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "boot_time.h"
+#include "isr_stats.h"
 
 /* ---------------------------------------------------------------------------
  * Private variables
@@ -26,11 +38,21 @@ TIM_HandleTypeDef htim1;  /**< Timer 1 handle */
 TIM_HandleTypeDef htim2;  /**< Timer 2 handle */
 CAN_HandleTypeDef hcan;   /**< CAN handle */
 UART_HandleTypeDef huart2; /**< UART2 handle */
+IWDG_HandleTypeDef hiwdg; /**< Independent watchdog handle */
+#if USENSOR_ENVELOPE
+ADC_HandleTypeDef hadc1;  /**< ADC1 handle, envelope sampling */
+DMA_HandleTypeDef hdma_adc1; /**< DMA1 channel 1 handle, ADC1 to memory */
+#endif
 
 /* RTOS thread handles */
-osThreadId_t us1TaskHandle; /**< Ultrasonic sensor 1 task handle */
-osThreadId_t us2TaskHandle; /**< Ultrasonic sensor 2 task handle */
-osThreadId_t TxTaskHandle;  /**< CAN transmit task handle */
+osThreadId_t TtTaskHandle;  /**< Time-triggered executive task handle */
+osThreadId_t MonTaskHandle; /**< Stack monitor task handle */
+
+/* RTOS thread memory (static; there is no heap) */
+static StaticTask_t TtTaskCb;           /**< Executive task control block */
+static StaticTask_t MonTaskCb;          /**< Stack monitor task control block */
+static uint64_t TtTaskStack[512 / 8];   /**< Executive task stack */
+static uint64_t MonTaskStack[256 / 8];  /**< Stack monitor task stack */
 
 /* CAN transmission variables */
 CAN_TxHeaderTypeDef TxHeader; /**< CAN transmit header */
@@ -39,8 +61,8 @@ uint32_t TxMailbox;                 /**< CAN mailbox index */
 uint8_t TxData[8];                  /**< CAN transmit buffer */
 
 /* Ultrasonic sensor distances */
-uint8_t Distance_1 = 0; /**< Distance measured by sensor 1 */
-uint8_t Distance_2 = 0; /**< Distance measured by sensor 2 */
+uint8_t Distance[USENSOR_COUNT]; /**< Distance measured by each sensor */
+uint32_t DistanceTick[USENSOR_COUNT]; /**< Tick at which each distance was set */
 
 /* ---------------------------------------------------------------------------
  * Function prototypes
@@ -51,6 +73,11 @@ static void MX_TIM1_Init(void);
 static void MX_TIM2_Init(void);
 static void MX_CAN_Init(void);
 static void MX_USART2_UART_Init(void);
+static void MX_IWDG_Init(void);
+#if USENSOR_ENVELOPE
+static void MX_DMA_Init(void);
+static void MX_ADC1_Init(void);
+#endif
 
 /**
  * @brief  Main program entry point.
@@ -58,30 +85,58 @@ static void MX_USART2_UART_Init(void);
  */
 int main(void)
 {
+    Boot_Mark(BOOT_MAIN);
+
+    /* Take over the record of a crash before anything else runs */
+    Crash_Init();
+
     HAL_Init();
     SystemClock_Config();
+    Boot_Mark(BOOT_CLOCK);
 
-    /* Initialize peripherals */
+    /* Fast boot: only ranging and CAN are initialised here; USART2 is set
+       up by MonTask (MX_Deferred_Init) */
     MX_GPIO_Init();
     MX_TIM1_Init();
     MX_TIM2_Init();
     MX_CAN_Init();
-    MX_USART2_UART_Init();
 
+#if USENSOR_ENVELOPE
+    MX_DMA_Init();
+    MX_ADC1_Init();
+    HAL_ADCEx_Calibration_Start(&hadc1);
+
+    /* TIM1 only times the trigger pulse; TIM2 paces the envelope ADC */
+    HAL_TIM_Base_Start(&htim1);
+    HAL_TIM_Base_Start(&htim2);
+#else
     /* Start timers in input capture mode for ultrasonic sensors */
     HAL_TIM_IC_Start_IT(&htim1, TIM_CHANNEL_1);
     HAL_TIM_IC_Start_IT(&htim2, TIM_CHANNEL_1);
+#endif
 		
     /* Start CAN controller */
     HAL_CAN_Start(&hcan);
+    Boot_Mark(BOOT_CAN);
+
+    /* Start the watchdog; MonTask refreshes it */
+    MX_IWDG_Init();
+    Boot_Mark(BOOT_PERIPH);
 
     /* Initialize FreeRTOS */
     osKernelInitialize();
 
     /* Create tasks */
-    us1TaskHandle = osThreadNew(us1Task_init, NULL, &(osThreadAttr_t){.name="us1Task", .stack_size=512, .priority=osPriorityNormal});
-    us2TaskHandle = osThreadNew(us2Task_init, NULL, &(osThreadAttr_t){.name="us2Task", .stack_size=512, .priority=osPriorityNormal});
-    TxTaskHandle  = osThreadNew(TxTask_init, NULL,  &(osThreadAttr_t){.name="TxTask",  .stack_size=512, .priority=osPriorityNormal});
+    TtTaskHandle  = osThreadNew(TtTask_init, NULL,  &(osThreadAttr_t){.name="TtTask",  .cb_mem=&TtTaskCb,  .cb_size=sizeof(TtTaskCb),  .stack_mem=TtTaskStack,  .stack_size=sizeof(TtTaskStack),  .priority=osPriorityAboveNormal});
+    MonTaskHandle = osThreadNew(MonTask_init, NULL, &(osThreadAttr_t){.name="MonTask", .cb_mem=&MonTaskCb, .cb_size=sizeof(MonTaskCb), .stack_mem=MonTaskStack, .stack_size=sizeof(MonTaskStack), .priority=osPriorityLow});
+
+    /* Watch the stacks of all tasks (the kernel's are added by MonTask) */
+    StackMon_Register(TtTaskHandle, sizeof(TtTaskStack));
+    StackMon_Register(MonTaskHandle, sizeof(MonTaskStack));
+
+    /* The watchdog is only refreshed while both tasks keep running */
+    Watchdog_Register(TtTaskHandle);
+    Watchdog_Register(MonTaskHandle);
 
     /* Start scheduler */
     osKernelStart();
@@ -99,6 +154,16 @@ void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
     USensor_TIM_IC_Callback(htim);
 }
 
+/**
+ * @brief  Initialise the peripherals left out of the fast-boot path
+ * @note   Called by MonTask before its first sample: USART2, which only
+ *         carries the diagnostic reports
+ */
+void MX_Deferred_Init(void)
+{
+    MX_USART2_UART_Init();
+}
+
 /**
  * @brief  System Clock Configuration
  */
@@ -106,6 +171,9 @@ void SystemClock_Config(void)
 {
   RCC_OscInitTypeDef RCC_OscInitStruct = {0};
   RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+#if USENSOR_ENVELOPE
+  RCC_PeriphCLKInitTypeDef PeriphClkInit = {0};
+#endif
 
   /** Initializes the RCC Oscillators according to the specified parameters
   * in the RCC_OscInitTypeDef structure.
@@ -134,6 +202,16 @@ void SystemClock_Config(void)
   {
     Error_Handler();
   }
+#if USENSOR_ENVELOPE
+  /** ADC clock: 72 MHz / 6 = 12 MHz, under the 14 MHz limit
+  */
+  PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_ADC;
+  PeriphClkInit.AdcClockSelection = RCC_ADCPCLK2_DIV6;
+  if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#endif
 }
 
 /**
@@ -213,11 +291,19 @@ static void MX_TIM2_Init(void)
 {
   TIM_MasterConfigTypeDef sMasterConfig = {0};
   TIM_IC_InitTypeDef sConfigIC = {0};
+#if USENSOR_ENVELOPE
+  TIM_OC_InitTypeDef sConfigOC = {0};
+#endif
 
   htim2.Instance = TIM2;
   htim2.Init.Prescaler = 72-1;
   htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+#if USENSOR_ENVELOPE
+  /* One envelope sample per period, on the channel 2 compare at its end */
+  htim2.Init.Period = 1000000u / ECHO_ENV_RATE_HZ - 1u;
+#else
   htim2.Init.Period = 0xFFFF-1;
+#endif
   htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
   htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
   if (HAL_TIM_IC_Init(&htim2) != HAL_OK)
@@ -238,8 +324,57 @@ static void MX_TIM2_Init(void)
   {
     Error_Handler();
   }
+#if USENSOR_ENVELOPE
+  sConfigOC.OCMode = TIM_OCMODE_PWM1;
+  sConfigOC.Pulse = htim2.Init.Period;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  if (HAL_TIM_OC_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#endif
+}
+
+#if USENSOR_ENVELOPE
+/**
+ * @brief  DMA Initialization Function: DMA1 channel 1 serves ADC1. Its
+ *         interrupt is left off; usensor.c polls the transfer count.
+ */
+static void MX_DMA_Init(void)
+{
+  __HAL_RCC_DMA1_CLK_ENABLE();
 }
 
+/**
+ * @brief  ADC1 Initialization Function: one conversion per TIM2 channel 2
+ *         compare, channel set by USensor_Trigger.
+ */
+static void MX_ADC1_Init(void)
+{
+  ADC_ChannelConfTypeDef sConfig = {0};
+
+  hadc1.Instance = ADC1;
+  hadc1.Init.ScanConvMode = ADC_SCAN_DISABLE;
+  hadc1.Init.ContinuousConvMode = DISABLE;
+  hadc1.Init.DiscontinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T2_CC2;
+  hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc1.Init.NbrOfConversion = 1;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfig.Channel = ADC_CHANNEL_4;
+  sConfig.Rank = ADC_REGULAR_RANK_1;
+  sConfig.SamplingTime = ADC_SAMPLETIME_28CYCLES_5;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+#endif
+
 /**
  * @brief  CAN Initialization Function
  */
@@ -270,7 +405,7 @@ static void MX_CAN_Init(void)
 	*/
 
 	/* Configure CAN transmit header */
-	TxHeader.DLC = 2;							
+	TxHeader.DLC = TX_CAN_DLC;
 	TxHeader.ExtId = 0;
 	TxHeader.IDE = CAN_ID_STD;      /**< Standard CAN frame */
 	TxHeader.RTR = CAN_RTR_DATA;    /**< Data frame */
@@ -293,6 +428,23 @@ static void MX_CAN_Init(void)
 	/* USER CODE END CAN_Config */
 }
 
+/**
+ * @brief  IWDG Initialization Function
+ */
+static void MX_IWDG_Init(void)
+{
+  /* Keep the watchdog from resetting the node while halted in the debugger */
+  __HAL_DBGMCU_FREEZE_IWDG();
+
+  hiwdg.Instance = IWDG;
+  hiwdg.Init.Prescaler = WATCHDOG_PRESCALER;
+  hiwdg.Init.Reload = WATCHDOG_RELOAD;
+  if (HAL_IWDG_Init(&hiwdg) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
 /**
  * @brief  USART2 Initialization Function
  */
@@ -312,11 +464,28 @@ static void MX_USART2_UART_Init(void)
   }
 }
 
+/**
+ * @brief  Period elapsed callback of the timebase TIM3: advances the HAL
+ *         tick (uwTick) and the RTOS tick (see tickless.h). The counter
+ *         value is the time since the update event, i.e. the entry latency
+ *         of the tick (see isr_stats.h).
+ * @param  htim TIM handle
+ */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance == TIM3)
+    {
+        ISR_STATS_LATENCY(ISR_STATS_TICK, TICKLESS_TIM->CNT);
+        HAL_IncTick();
+        Tickless_IncTick();
+    }
+}
+
 /**
  * @brief  Error Handler
  */
 void Error_Handler(void)
 {
-    __disable_irq();
-    while (1) {}
+    /* Record the caller and restart; the record is reported on the next boot */
+    Crash_Halt(CRASH_ERROR, CRASH_CALLER(), 0);
 }
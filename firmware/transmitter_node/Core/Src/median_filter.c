@@ -0,0 +1,111 @@
+/**
+ * @file    median_filter.c
+ * @ingroup Transmitter_Node
+ * @brief   Sliding-window running median of byte samples.
+ */
+#include "median_filter.h"
+
+/**
+ * @brief Start a filter with its whole window at one value.
+ * @param filter Filter.
+ * @param size   Window length, odd, MEDIAN_FILTER_MIN to MEDIAN_FILTER_MAX.
+ * @param value  Initial sample.
+ */
+void MedianFilter_Init(MedianFilterTypeDef *filter, uint8_t size, uint8_t value)
+{
+    uint8_t i;
+
+    filter->size = size;
+    filter->next = 0;
+    for (i = 0; i < size; i++)
+    {
+        filter->ring[i] = value;
+        filter->sorted[i] = value;
+    }
+}
+
+#if MEDIAN_FILTER_SORTED
+
+/**
+ * @brief  Find a value in the sorted window.
+ * @param  filter Filter.
+ * @param  value  Value present in the window.
+ * @retval Index of one of its occurrences.
+ */
+static uint8_t MedianFilter_Find(const MedianFilterTypeDef *filter, uint8_t value)
+{
+    uint8_t lo = 0;
+    uint8_t hi = (uint8_t)(filter->size - 1u);
+    uint8_t mid;
+
+    while (lo < hi)
+    {
+        mid = (uint8_t)((lo + hi) / 2u);
+        if (filter->sorted[mid] < value)
+            lo = (uint8_t)(mid + 1u);
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief  Slide the window by one sample.
+ * @param  filter Filter.
+ * @param  value  New sample; the oldest one leaves the window.
+ * @retval Median of the window.
+ */
+uint8_t MedianFilter_Update(MedianFilterTypeDef *filter, uint8_t value)
+{
+    uint8_t *s = filter->sorted;
+    uint8_t i = MedianFilter_Find(filter, filter->ring[filter->next]);
+
+    filter->ring[filter->next] = value;
+    if (++filter->next == filter->size)
+        filter->next = 0;
+
+    /* Replace the leaving sample and move the new one to its rank */
+    while (i > 0 && s[i - 1u] > value)
+    {
+        s[i] = s[i - 1u];
+        i--;
+    }
+    while (i + 1u < filter->size && s[i + 1u] < value)
+    {
+        s[i] = s[i + 1u];
+        i++;
+    }
+    s[i] = value;
+
+    return s[filter->size / 2u];
+}
+
+#else
+
+/**
+ * @brief  Slide the window by one sample (reference: sort every time).
+ * @param  filter Filter.
+ * @param  value  New sample; the oldest one leaves the window.
+ * @retval Median of the window.
+ */
+uint8_t MedianFilter_Update(MedianFilterTypeDef *filter, uint8_t value)
+{
+    uint8_t *s = filter->sorted;
+    uint8_t i, j, v;
+
+    filter->ring[filter->next] = value;
+    if (++filter->next == filter->size)
+        filter->next = 0;
+
+    for (i = 0; i < filter->size; i++)
+    {
+        v = filter->ring[i];
+        for (j = i; j > 0 && s[j - 1u] > v; j--)
+            s[j] = s[j - 1u];
+        s[j] = v;
+    }
+
+    return s[filter->size / 2u];
+}
+
+#endif /* MEDIAN_FILTER_SORTED */
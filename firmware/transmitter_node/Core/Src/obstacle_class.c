@@ -0,0 +1,141 @@
+/**
+ * @file    obstacle_class.c
+ * @ingroup Transmitter_Node
+ * @brief   Quantised classifier of what a sensor's echoes come from.
+ *
+ * The features are integer arithmetic only, so the exporter reproduces
+ * them exactly. On the Cortex-M3 CMSIS-NN builds its reference loops
+ * (no ARM_MATH_DSP): arm_fully_connected_q7 then does not use its q15
+ * buffer, which is still sized for builds that do.
+ */
+#include "obstacle_class.h"
+#include "obstacle_net.h"
+#include "arm_nnfunctions.h"
+
+#if OBS_NET_INPUTS != OBS_FEATURES
+#error "obstacle_net.h was exported for other features; run tools/train_obstacle_net.py"
+#endif
+
+#if OBS_NET_CLASSES != 4u
+#error "obstacle_net.h needs one output per ObsClassTypeDef"
+#endif
+
+#if (OBS_WINDOW & (OBS_WINDOW - 1u)) != 0u
+#error "OBS_WINDOW must be a power of two"
+#endif
+
+/** Network weights and biases (q7), rows of inputs */
+static const q7_t obsW1[OBS_NET_HIDDEN * OBS_NET_INPUTS] = OBS_NET_W1;
+static const q7_t obsB1[OBS_NET_HIDDEN] = OBS_NET_B1;
+static const q7_t obsW2[OBS_NET_CLASSES * OBS_NET_HIDDEN] = OBS_NET_W2;
+static const q7_t obsB2[OBS_NET_CLASSES] = OBS_NET_B2;
+
+/** Hidden layer, and arm_fully_connected_q7's work buffer */
+static q7_t obsHidden[OBS_NET_HIDDEN];
+static q15_t obsVecBuffer[OBS_NET_HIDDEN];
+
+/**
+ * @brief  Limit a value to the q7 range, symmetric.
+ * @param  v Value.
+ * @retval v within -127..127.
+ */
+static int8_t ObsClass_Clamp(int32_t v)
+{
+    if (v > 127)
+        return 127;
+    if (v < -127)
+        return -127;
+    return (int8_t)v;
+}
+
+/**
+ * @brief  Add a reading to a window, replacing the oldest.
+ * @param  w  Window.
+ * @param  cm Reading (cm), or OBS_NO_ECHO.
+ */
+void ObsClass_Push(ObsWindowTypeDef *w, uint8_t cm)
+{
+    w->cm[w->next] = cm;
+    w->next = (uint8_t)((w->next + 1u) & (OBS_WINDOW - 1u));
+    if (w->count < OBS_WINDOW)
+        w->count++;
+}
+
+/**
+ * @brief  Reduce a window to the network's inputs.
+ * @param  w        Window.
+ * @param  features Filled with OBS_FEATURES q7 features.
+ */
+void ObsClass_Features(const ObsWindowTypeDef *w, int8_t *features)
+{
+    int32_t n = 0, sx = 0, si = 0, six = 0, sii = 0, dev = 0;
+    int32_t mean, num, den;
+    uint8_t first = (uint8_t)((w->next - w->count) & (OBS_WINDOW - 1u));
+    uint8_t i, x;
+
+    /* Echoes by age, oldest at 0 */
+    for (i = 0; i < w->count; i++)
+    {
+        x = w->cm[(first + i) & (OBS_WINDOW - 1u)];
+        if (x == OBS_NO_ECHO)
+            continue;
+        n++;
+        sx += x;
+        si += i;
+        six += (int32_t)i * x;
+        sii += (int32_t)i * i;
+    }
+
+    if (n == 0)
+    {
+        features[0] = 127;
+        features[1] = 0;
+        features[2] = 0;
+        features[3] = 0;
+        return;
+    }
+
+    mean = (sx + n / 2) / n;
+    for (i = 0; i < w->count; i++)
+    {
+        x = w->cm[(first + i) & (OBS_WINDOW - 1u)];
+        if (x != OBS_NO_ECHO)
+            dev += (x > mean) ? x - mean : mean - x;
+    }
+
+    num = n * six - si * sx;
+    den = n * sii - si * si;
+
+    features[0] = (int8_t)(mean / 2);
+    features[1] = ObsClass_Clamp((dev + n / 2) / n);
+    features[2] = (int8_t)(n * 127 / (int32_t)OBS_WINDOW);
+    features[3] = den ? ObsClass_Clamp(num * 4 / den) : 0;
+}
+
+/**
+ * @brief  Classify a window.
+ * @param  features OBS_FEATURES q7 features from ObsClass_Features.
+ * @param  scores   Filled with the OBS_CLASSES output scores (q7); may be NULL.
+ * @retval Class with the highest score, the first one on a tie.
+ */
+ObsClassTypeDef ObsClass_Infer(const int8_t *features, int8_t *scores)
+{
+    q7_t out[OBS_NET_CLASSES];
+    uint8_t best = 0;
+    uint8_t i;
+
+    arm_fully_connected_q7(features, obsW1, OBS_NET_INPUTS, OBS_NET_HIDDEN,
+                           OBS_NET_L1_BIAS_SHIFT, OBS_NET_L1_OUT_SHIFT, obsB1, obsHidden, obsVecBuffer);
+    arm_relu_q7(obsHidden, OBS_NET_HIDDEN);
+    arm_fully_connected_q7(obsHidden, obsW2, OBS_NET_HIDDEN, OBS_NET_CLASSES,
+                           OBS_NET_L2_BIAS_SHIFT, OBS_NET_L2_OUT_SHIFT, obsB2, out, obsVecBuffer);
+
+    for (i = 0; i < OBS_NET_CLASSES; i++)
+    {
+        if (out[i] > out[best])
+            best = i;
+        if (scores)
+            scores[i] = out[i];
+    }
+    return (ObsClassTypeDef)best;
+}
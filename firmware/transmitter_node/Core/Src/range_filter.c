@@ -0,0 +1,263 @@
+/**
+ * @file    range_filter.c
+ * @ingroup Transmitter_Node
+ * @brief   Per-sensor streaming range filter between capture and CAN.
+ *
+ * Distances enter the low-pass as q15 values of cm << RANGE_FILTER_SHIFT,
+ * so 255 cm is 0.125: three bits of headroom, which the 32-bit
+ * accumulators of the fast CMSIS kernels need (two bits for the biquad,
+ * log2 of the taps for the FIR).
+ */
+#include "range_filter.h"
+#include "fmt.h"
+#include "range_filter_coef.h"
+#include "median_filter.h"
+#include "usensor.h"
+#include "tt_sched.h"
+#if RANGE_FILTER_USE_CMSIS
+#include "arm_math.h"
+#endif
+
+/** q15 scaling of a distance in cm */
+#define RANGE_FILTER_SHIFT      4u
+
+#if RANGE_FILTER_MEDIAN < MEDIAN_FILTER_MIN || RANGE_FILTER_MEDIAN > MEDIAN_FILTER_MAX || !(RANGE_FILTER_MEDIAN & 1u)
+#error "RANGE_FILTER_MEDIAN must be odd, MEDIAN_FILTER_MIN to MEDIAN_FILTER_MAX"
+#endif
+
+#if RANGE_FILTER_KERNEL == RANGE_FILTER_FIR
+/** Lag of the low-pass behind a steady approach (ms) */
+#define RANGE_FILTER_KERNEL_LAG_MS  RANGE_FILTER_FIR_LAG_MS
+/** Taps, then one slot per block sample (the CMSIS state layout) */
+#define RANGE_FILTER_STATE_LEN  (RANGE_FILTER_FIR_TAPS + 1u)
+#else
+#define RANGE_FILTER_KERNEL_LAG_MS  RANGE_FILTER_BIQUAD_LAG_MS
+/** x[n-1], x[n-2], y[n-1], y[n-2] (the CMSIS DF1 state layout) */
+#define RANGE_FILTER_STATE_LEN  4u
+#endif
+
+/** Filter of one sensor */
+typedef struct
+{
+    MedianFilterTypeDef median;                 /**< Spike rejection stage */
+    RangeTrackerTypeDef tracker;                /**< Range and velocity tracker */
+    RangeTrackTypeDef track;                    /**< Latest tracker output */
+    uint8_t primed;                             /**< State holds a first sample */
+    int16_t state[RANGE_FILTER_STATE_LEN];      /**< Low-pass state (q15) */
+#if RANGE_FILTER_USE_CMSIS && RANGE_FILTER_KERNEL == RANGE_FILTER_FIR
+    arm_fir_instance_q15 fir;                   /**< CMSIS FIR instance */
+#elif RANGE_FILTER_USE_CMSIS
+    arm_biquad_casd_df1_inst_q15 biquad;        /**< CMSIS biquad instance */
+#endif
+} RangeFilterChannelTypeDef;
+
+#if RANGE_FILTER_KERNEL == RANGE_FILTER_FIR
+/** FIR taps, oldest sample first */
+static const int16_t rangeFilterCoefs[] = RANGE_FILTER_FIR_COEFS;
+#else
+/** Biquad coefficients {b0, 0, b1, b2, a1, a2} */
+static const int16_t rangeFilterCoefs[] = RANGE_FILTER_BIQUAD_COEFS;
+#endif
+
+/** Filter of each sensor */
+static RangeFilterChannelTypeDef rangeFilter[USENSOR_COUNT];
+
+/** Timing since the previous report; only touched by TtTask */
+static RangeFilterStatsTypeDef rangeFilterStats;
+
+/**
+ * @brief Start a sensor's filter at a steady distance.
+ * @param ch Sensor filter.
+ * @param cm First distance (cm).
+ */
+static void RangeFilter_Prime(RangeFilterChannelTypeDef *ch, uint8_t cm)
+{
+    int16_t x = (int16_t)(cm << RANGE_FILTER_SHIFT);
+    uint8_t i;
+
+#if RANGE_FILTER_USE_CMSIS && RANGE_FILTER_KERNEL == RANGE_FILTER_FIR
+    arm_fir_init_q15(&ch->fir, RANGE_FILTER_FIR_TAPS, (q15_t *)rangeFilterCoefs, ch->state, 1u);
+#elif RANGE_FILTER_USE_CMSIS
+    arm_biquad_cascade_df1_init_q15(&ch->biquad, 1u, (q15_t *)rangeFilterCoefs, ch->state,
+                                    RANGE_FILTER_BIQUAD_POST_SHIFT);
+#endif
+
+    /* Unity DC gain: a constant input is a fixed point of either kernel */
+    for (i = 0; i < RANGE_FILTER_STATE_LEN; i++)
+        ch->state[i] = x;
+    MedianFilter_Init(&ch->median, RANGE_FILTER_MEDIAN, cm);
+    RangeTracker_Init(&ch->tracker, TT_CYCLE_MS);
+    ch->primed = 1;
+}
+
+#if !RANGE_FILTER_USE_CMSIS
+/**
+ * @brief  Saturate an accumulator to q15.
+ * @param  acc Accumulator, already shifted.
+ * @retval q15 value.
+ */
+static int16_t RangeFilter_Sat(int32_t acc)
+{
+    if (acc > 32767)
+        return 32767;
+    if (acc < -32768)
+        return -32768;
+    return (int16_t)acc;
+}
+#endif
+
+/**
+ * @brief  Run one sample through the low-pass.
+ * @param  ch Sensor filter.
+ * @param  x  Input (q15).
+ * @retval Output (q15).
+ */
+static int16_t RangeFilter_LowPass(RangeFilterChannelTypeDef *ch, int16_t x)
+{
+    int16_t y;
+#if RANGE_FILTER_USE_CMSIS && RANGE_FILTER_KERNEL == RANGE_FILTER_FIR
+    arm_fir_fast_q15(&ch->fir, &x, &y, 1u);
+#elif RANGE_FILTER_USE_CMSIS
+    arm_biquad_cascade_df1_fast_q15(&ch->biquad, &x, &y, 1u);
+#elif RANGE_FILTER_KERNEL == RANGE_FILTER_FIR
+    int16_t *s = ch->state;
+    int32_t acc = 0;
+    uint8_t k;
+
+    s[RANGE_FILTER_FIR_TAPS - 1u] = x;
+    for (k = 0; k < RANGE_FILTER_FIR_TAPS; k++)
+        acc += (int32_t)s[k] * rangeFilterCoefs[k];
+    for (k = 0; k < RANGE_FILTER_FIR_TAPS - 1u; k++)
+        s[k] = s[k + 1u];
+    y = RangeFilter_Sat(acc >> 15);
+#else
+    const int16_t *c = rangeFilterCoefs;
+    int16_t *s = ch->state;
+    int32_t acc;
+
+    acc = (int32_t)c[0] * x + (int32_t)c[2] * s[0] + (int32_t)c[3] * s[1] +
+          (int32_t)c[4] * s[2] + (int32_t)c[5] * s[3];
+    y = RangeFilter_Sat(acc >> (15 - RANGE_FILTER_BIQUAD_POST_SHIFT));
+    s[1] = s[0];
+    s[0] = x;
+    s[3] = s[2];
+    s[2] = y;
+#endif
+    return y;
+}
+
+/**
+ * @brief  Filter the latest distance of a sensor.
+ * @param  sensor Sensor index, below USENSOR_COUNT.
+ * @param  cm     Measured distance (cm), or USENSOR_NO_ECHO.
+ * @retval Filtered distance (cm); USENSOR_NO_ECHO when out of range.
+ */
+uint8_t RangeFilter_Process(uint8_t sensor, uint8_t cm)
+{
+    RangeFilterChannelTypeDef *ch = &rangeFilter[sensor];
+    uint32_t start = DWT->CYCCNT;
+    uint32_t cycles;
+    int32_t out;
+
+    if (!ch->primed)
+        RangeFilter_Prime(ch, cm);
+
+    out = MedianFilter_Update(&ch->median, cm);
+    RangeTracker_Update(&ch->tracker, (uint8_t)out, &ch->track);
+    out = RangeFilter_LowPass(ch, (int16_t)(out << RANGE_FILTER_SHIFT));
+    out = (out + (1 << (RANGE_FILTER_SHIFT - 1u))) >> RANGE_FILTER_SHIFT;
+    if (out < 0)
+        out = 0;
+    else if (out > (int32_t)USENSOR_NO_ECHO)
+        out = USENSOR_NO_ECHO;
+
+    cycles = DWT->CYCCNT - start;
+    rangeFilterStats.samples++;
+    rangeFilterStats.cycles += cycles;
+    if (cycles > rangeFilterStats.worst)
+        rangeFilterStats.worst = (cycles > 0xFFFFu) ? 0xFFFFu : (uint16_t)cycles;
+    if (cycles > RANGE_FILTER_BUDGET_CYCLES && rangeFilterStats.overruns != 0xFFFFu)
+        rangeFilterStats.overruns++;
+
+    return (uint8_t)out;
+}
+
+/**
+ * @brief Tracked range and closing velocity of a sensor's latest sample.
+ * @param sensor Sensor index, below USENSOR_COUNT.
+ * @param track  Filled with the tracker output.
+ */
+void RangeFilter_GetTrack(uint8_t sensor, RangeTrackTypeDef *track)
+{
+    *track = rangeFilter[sensor].track;
+}
+
+/**
+ * @brief  Lag of the filtered distance behind a steady approach.
+ * @retval Lag (ms): the median's middle sample is (RANGE_FILTER_MEDIAN - 1)
+ *         / 2 cycles old, plus the low-pass group delay.
+ */
+uint16_t RangeFilter_LagMs(void)
+{
+    return (uint16_t)((RANGE_FILTER_MEDIAN - 1u) / 2u * TT_CYCLE_MS + RANGE_FILTER_KERNEL_LAG_MS);
+}
+
+/**
+ * @brief Collect the timing since the previous call and restart it.
+ * @param stats Filled with the result.
+ */
+void RangeFilter_GetStats(RangeFilterStatsTypeDef *stats)
+{
+    static const RangeFilterStatsTypeDef empty = {0};
+
+    *stats = rangeFilterStats;
+    rangeFilterStats = empty;
+}
+
+/**
+ * @brief  Collect the timing and format it as one text line.
+ * @param  buf Output buffer of at least RANGE_FILTER_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t RangeFilter_Format(char *buf)
+{
+#if RANGE_FILTER_KERNEL == RANGE_FILTER_FIR
+    static const char kernel[] = "fir";
+#else
+    static const char kernel[] = "biquad";
+#endif
+#if !MEDIAN_FILTER_SORTED
+    static const char sorting[] = "_sort";
+#endif
+    RangeFilterStatsTypeDef stats;
+    uint16_t n = 0;
+    uint8_t i;
+
+    RangeFilter_GetStats(&stats);
+
+    buf[n++] = 'F';
+    buf[n++] = 'L';
+    buf[n++] = 'T';
+    buf[n++] = ',';
+    for (i = 0; kernel[i]; i++)
+        buf[n++] = kernel[i];
+#if !RANGE_FILTER_USE_CMSIS
+    buf[n++] = '_';
+    buf[n++] = 'c';
+#endif
+#if !MEDIAN_FILTER_SORTED
+    for (i = 0; sorting[i]; i++)
+        buf[n++] = sorting[i];
+#endif
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats.samples ? stats.cycles / stats.samples : 0u, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats.worst, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(RANGE_FILTER_BUDGET_CYCLES, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats.overruns, &buf[n]);
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
+}
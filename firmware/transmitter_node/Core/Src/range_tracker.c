@@ -0,0 +1,119 @@
+/**
+ * @file    range_tracker.c
+ * @ingroup Transmitter_Node
+ * @brief   Per-sensor range and closing-velocity tracker.
+ *
+ * Products are formed in 64 bits and scaled back, so the covariance keeps
+ * its 8 fraction bits from a 0.03 cm^2 process noise up to the variance
+ * of a new track. The sample period is held in seconds with 16 fraction
+ * bits, which turns every time step into a multiply and a shift.
+ */
+#include "range_tracker.h"
+
+/** Q8 scaling of ranges, velocities and covariances */
+#define RANGE_TRACKER_Q         8
+
+/**
+ * @brief  Product of a value and a Q16 factor.
+ * @param  value  Value.
+ * @param  factor Factor (Q16).
+ * @retval value * factor, in the units of value.
+ */
+static int32_t RangeTracker_Mul(int32_t value, int32_t factor)
+{
+    return (int32_t)(((int64_t)value * factor) >> 16);
+}
+
+/**
+ * @brief Start the track at a measurement, velocity unknown.
+ * @param tracker Tracker.
+ * @param z       Measured range (cm, Q8).
+ */
+static void RangeTracker_Start(RangeTrackerTypeDef *tracker, int32_t z)
+{
+    tracker->range = z;
+    tracker->rate = 0;
+    tracker->p_rr = (RANGE_TRACKER_NOISE_CM * RANGE_TRACKER_NOISE_CM) << RANGE_TRACKER_Q;
+    tracker->p_rv = 0;
+    tracker->p_vv = (RANGE_TRACKER_INIT_VEL_CM_S * RANGE_TRACKER_INIT_VEL_CM_S) << RANGE_TRACKER_Q;
+    tracker->misses = 0;
+    tracker->started = 1;
+}
+
+/**
+ * @brief Set up a tracker; the first update starts the track.
+ * @param tracker   Tracker.
+ * @param period_ms Sample period (ms), below 1000.
+ */
+void RangeTracker_Init(RangeTrackerTypeDef *tracker, uint16_t period_ms)
+{
+    const int64_t a2 = (int64_t)RANGE_TRACKER_ACCEL_CM_S2 * RANGE_TRACKER_ACCEL_CM_S2;
+    int64_t t2;
+
+    tracker->dt = (uint16_t)(((uint32_t)period_ms << 16) / 1000u);
+    t2 = ((int64_t)tracker->dt * tracker->dt) >> 16;
+
+    /* Discrete white acceleration: a^2 * {T^4/4, T^3/2, T^2}, to Q8 */
+    tracker->q_rr = (int32_t)((a2 * t2 * t2) >> (32 - RANGE_TRACKER_Q + 2));
+    tracker->q_rv = (int32_t)((a2 * t2 * tracker->dt) >> (32 - RANGE_TRACKER_Q + 1));
+    tracker->q_vv = (int32_t)((a2 * t2) >> (16 - RANGE_TRACKER_Q));
+    tracker->started = 0;
+}
+
+/**
+ * @brief Advance the tracker by one sample period and take a measurement.
+ * @param tracker Tracker.
+ * @param cm      Measured range (cm).
+ * @param out     Filled with the tracked range and velocity.
+ */
+void RangeTracker_Update(RangeTrackerTypeDef *tracker, uint8_t cm, RangeTrackTypeDef *out)
+{
+    const int32_t r = (RANGE_TRACKER_NOISE_CM * RANGE_TRACKER_NOISE_CM) << RANGE_TRACKER_Q;
+    const int32_t z = (int32_t)cm << RANGE_TRACKER_Q;
+    int32_t s, y, kr, kv, closing;
+
+    if (!tracker->started)
+        RangeTracker_Start(tracker, z);
+
+    /* Predict: x = F x, P = F P F' + Q */
+    tracker->range += RangeTracker_Mul(tracker->rate, tracker->dt);
+    tracker->p_rr += RangeTracker_Mul(2 * tracker->p_rv + RangeTracker_Mul(tracker->p_vv, tracker->dt),
+                                      tracker->dt) + tracker->q_rr;
+    tracker->p_rv += RangeTracker_Mul(tracker->p_vv, tracker->dt) + tracker->q_rv;
+    tracker->p_vv += tracker->q_vv;
+
+    /* Gate the innovation against its variance */
+    s = tracker->p_rr + r;
+    y = z - tracker->range;
+    if ((int64_t)y * y > ((int64_t)RANGE_TRACKER_GATE * RANGE_TRACKER_GATE * s) << RANGE_TRACKER_Q)
+    {
+        if (++tracker->misses >= RANGE_TRACKER_GATE_MISSES)
+            RangeTracker_Start(tracker, z);
+    }
+    else
+    {
+        /* Update: K = P H' / S, x += K y, P = (I - K H) P */
+        kr = (int32_t)(((int64_t)tracker->p_rr << 16) / s);
+        kv = (int32_t)(((int64_t)tracker->p_rv << 16) / s);
+        tracker->range += RangeTracker_Mul(y, kr);
+        tracker->rate += RangeTracker_Mul(y, kv);
+        tracker->p_vv -= RangeTracker_Mul(tracker->p_rv, kv);
+        tracker->p_rv = RangeTracker_Mul(tracker->p_rv, 65536 - kr);
+        tracker->p_rr = RangeTracker_Mul(tracker->p_rr, 65536 - kr);
+        tracker->misses = 0;
+    }
+
+    if (tracker->range < 0)
+        out->cm = 0;
+    else if (tracker->range > (255 << RANGE_TRACKER_Q))
+        out->cm = 255;
+    else
+        out->cm = (uint8_t)((tracker->range + (1 << (RANGE_TRACKER_Q - 1))) >> RANGE_TRACKER_Q);
+
+    /* Closing is the negated rate, in mm/s */
+    closing = -(int32_t)(((int64_t)tracker->rate * 10) >> RANGE_TRACKER_Q);
+    out->closing_mm_s = (int16_t)((closing > 32767) ? 32767 : (closing < -32768) ? -32768 : closing);
+    out->confident = (uint8_t)(tracker->misses == 0 &&
+                               tracker->p_vv < ((RANGE_TRACKER_CONFIDENT_MM_S / 10) *
+                                                (RANGE_TRACKER_CONFIDENT_MM_S / 10)) << RANGE_TRACKER_Q);
+}
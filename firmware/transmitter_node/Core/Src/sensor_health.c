@@ -0,0 +1,178 @@
+/**
+ * @file    sensor_health.c
+ * @ingroup Transmitter_Node
+ * @brief   Per-sensor health from the statistics of its readings.
+ *
+ * The changes between echoes are kept in quarter centimetres, so the
+ * integer Welford mean keeps some resolution; the sum of squares then
+ * stays under 2^27 over a block.
+ */
+#include "sensor_health.h"
+
+#if (HEALTH_BLOCK & (HEALTH_BLOCK - 1u)) != 0u || HEALTH_BLOCK > 128u
+#error "HEALTH_BLOCK must be a power of two up to 128"
+#endif
+
+/** Changes between echoes needed to grade the noise */
+#define HEALTH_NOISE_MIN_CHANGES    (HEALTH_BLOCK / 4u)
+
+/**
+ * @brief  Distance between two readings.
+ * @param  a Reading (cm).
+ * @param  b Reading (cm).
+ * @retval |a - b| (cm).
+ */
+static uint8_t Health_Diff(uint8_t a, uint8_t b)
+{
+    return (uint8_t)((a > b) ? a - b : b - a);
+}
+
+/**
+ * @brief  Start a new block.
+ * @param  h Statistics.
+ */
+static void Health_StartBlock(HealthSensorTypeDef *h)
+{
+    h->readings = 0;
+    h->timeouts = 0;
+    h->jumps = 0;
+    h->xtalk = 0;
+    h->changes = 0;
+    h->mean = 0;
+    h->m2 = 0;
+    h->stuck = 0;
+}
+
+/**
+ * @brief  Grade a finished block and publish the level and fault.
+ * @param  h Statistics.
+ */
+static void Health_Grade(HealthSensorTypeDef *h)
+{
+    uint8_t level = HEALTH_OK;
+    uint8_t fault = HEALTH_FAULT_TIMEOUT;
+    uint8_t last = h->nibble & 0x03u;
+    uint32_t variance;
+
+    /* The first indicator to reach a level names the fault */
+    if (h->stuck)
+    {
+        level = HEALTH_FAILED;
+        fault = HEALTH_FAULT_STUCK;
+    }
+
+    if (h->timeouts >= HEALTH_TIMEOUT_FAILED && level < HEALTH_FAILED)
+        level = HEALTH_FAILED, fault = HEALTH_FAULT_TIMEOUT;
+    else if (h->timeouts >= HEALTH_TIMEOUT_POOR && level < HEALTH_POOR)
+        level = HEALTH_POOR, fault = HEALTH_FAULT_TIMEOUT;
+    else if (h->timeouts >= HEALTH_TIMEOUT_DEGRADED && level < HEALTH_DEGRADED)
+        level = HEALTH_DEGRADED, fault = HEALTH_FAULT_TIMEOUT;
+
+    if ((uint16_t)h->xtalk * HEALTH_XTALK_SHARE >= h->jumps)
+    {
+        if (h->xtalk >= HEALTH_XTALK_POOR && level < HEALTH_POOR)
+            level = HEALTH_POOR, fault = HEALTH_FAULT_XTALK;
+        else if (h->xtalk >= HEALTH_XTALK_DEGRADED && level < HEALTH_DEGRADED)
+            level = HEALTH_DEGRADED, fault = HEALTH_FAULT_XTALK;
+    }
+
+    if (h->changes >= HEALTH_NOISE_MIN_CHANGES)
+    {
+        variance = (uint32_t)h->m2 / (16u * (h->changes - 1u));
+        if (variance >= HEALTH_NOISE_POOR && level < HEALTH_POOR)
+            level = HEALTH_POOR, fault = HEALTH_FAULT_NOISE;
+        else if (variance >= HEALTH_NOISE_DEGRADED && level < HEALTH_DEGRADED)
+            level = HEALTH_DEGRADED, fault = HEALTH_FAULT_NOISE;
+    }
+
+    /* Recover one level per block, still naming the fault recovered from */
+    if (level < last)
+    {
+        level = (uint8_t)(last - 1u);
+        fault = (uint8_t)(h->nibble >> 2);
+    }
+    h->nibble = HEALTH_NIBBLE(level, level != HEALTH_OK ? fault : HEALTH_FAULT_TIMEOUT);
+
+    Health_StartBlock(h);
+}
+
+/**
+ * @brief  Start the statistics of a sensor, at HEALTH_OK.
+ * @param  h Statistics.
+ */
+void Health_Init(HealthSensorTypeDef *h)
+{
+    Health_StartBlock(h);
+    h->last = HEALTH_NO_ECHO;
+    h->run = 0;
+    h->other_start = HEALTH_NO_ECHO;
+    h->moved = 0;
+    h->nibble = HEALTH_NIBBLE(HEALTH_OK, HEALTH_FAULT_TIMEOUT);
+}
+
+/**
+ * @brief  Account one reading of a sensor; grades it at the end of a block.
+ * @param  h        Statistics.
+ * @param  cm       Reading (cm), or HEALTH_NO_ECHO.
+ * @param  silent   Non-zero if the window saw no echo at all.
+ * @param  other_cm Reading of the other sensor in the same cycle.
+ */
+void Health_Update(HealthSensorTypeDef *h, uint8_t cm, uint8_t silent, uint8_t other_cm)
+{
+    int32_t change, delta;
+
+    if (silent)
+        h->timeouts++;
+
+    if (cm != HEALTH_NO_ECHO && h->last != HEALTH_NO_ECHO)
+    {
+        /* Welford update with the change since the previous cycle */
+        change = ((int32_t)cm - h->last) * 4;
+        h->changes++;
+        delta = change - h->mean;
+        h->mean += delta / h->changes;
+        h->m2 += delta * (change - h->mean);
+
+        if (Health_Diff(cm, h->last) > HEALTH_JUMP_CM)
+        {
+            h->jumps++;
+            if (other_cm != HEALTH_NO_ECHO && Health_Diff(cm, other_cm) <= HEALTH_XTALK_CM)
+                h->xtalk++;
+        }
+    }
+
+    /* Run of equal echoes, and how far the other sensor moved meanwhile */
+    if (cm != HEALTH_NO_ECHO && cm == h->last)
+    {
+        if (h->run < 0xFFu)
+            h->run++;
+    }
+    else
+    {
+        h->run = 0;
+        h->other_start = other_cm;
+        h->moved = 0;
+    }
+    if (h->other_start == HEALTH_NO_ECHO)
+        h->other_start = other_cm;
+    if (other_cm != HEALTH_NO_ECHO && h->other_start != HEALTH_NO_ECHO &&
+        Health_Diff(other_cm, h->other_start) >= HEALTH_STUCK_MOVE_CM)
+        h->moved = 1;
+    if (h->run >= HEALTH_STUCK_RUN && h->moved)
+        h->stuck = 1;
+
+    h->last = cm;
+
+    if (++h->readings == HEALTH_BLOCK)
+        Health_Grade(h);
+}
+
+/**
+ * @brief  Published health of a sensor.
+ * @param  h Statistics.
+ * @retval HEALTH_NIBBLE of the level and fault of the last graded block.
+ */
+uint8_t Health_Nibble(const HealthSensorTypeDef *h)
+{
+    return h->nibble;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file    stack_mon.c
+ * @ingroup Transmitter_Node
+ * @brief   Task stack high-water-mark monitor.
+ */
+#include "stack_mon.h"
+#include "fmt.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include <string.h>
+
+/** Monitored tasks, in registration order */
+static StackMonEntryTypeDef stackMon[STACK_MON_MAX_TASKS];
+
+/** Number of entries in stackMon */
+static uint8_t stackMonCount;
+
+/** Tasks under the margin at the latest sample */
+static uint8_t stackMonLow;
+
+/**
+ * @brief Add a task to the monitor.
+ * @param thread     Task handle; ignored if NULL or the table is full.
+ * @param stack_size Stack size given when the task was created (bytes).
+ */
+void StackMon_Register(osThreadId_t thread, uint32_t stack_size)
+{
+    TaskStatus_t status;
+    StackMonEntryTypeDef *entry;
+
+    if (thread == NULL || stackMonCount >= STACK_MON_MAX_TASKS)
+        return;
+
+    /* Only the task number is wanted: skip the stack scan */
+    vTaskGetInfo((TaskHandle_t)thread, &status, pdFALSE, eInvalid);
+
+    entry = &stackMon[stackMonCount++];
+    entry->thread = thread;
+    entry->name = status.pcTaskName;
+    entry->size = (uint16_t)stack_size;
+    entry->min_free = (uint16_t)stack_size;
+    entry->number = (uint8_t)status.xTaskNumber;
+}
+
+/**
+ * @brief Add the kernel's idle and timer service tasks to the monitor.
+ * @note  Call once the scheduler is running.
+ */
+void StackMon_RegisterKernelTasks(void)
+{
+    StackMon_Register(xTaskGetIdleTaskHandle(),
+                      configMINIMAL_STACK_SIZE * sizeof(StackType_t));
+    StackMon_Register(xTimerGetTimerDaemonTaskHandle(),
+                      configTIMER_TASK_STACK_DEPTH * sizeof(StackType_t));
+}
+
+/**
+ * @brief  Sample the high-water mark of every registered task.
+ * @retval Bit mask of the tasks (in registration order) under the margin.
+ */
+uint8_t StackMon_Sample(void)
+{
+    uint8_t low = 0;
+    uint8_t i;
+    uint32_t free;
+
+    for (i = 0; i < stackMonCount; i++)
+    {
+        /* The kernel keeps the all-time minimum; this only converts units */
+        free = uxTaskGetStackHighWaterMark((TaskHandle_t)stackMon[i].thread) * sizeof(StackType_t);
+        if (free < stackMon[i].min_free)
+            stackMon[i].min_free = (uint16_t)free;
+
+        if (stackMon[i].min_free < STACK_MON_MARGIN)
+            low |= (uint8_t)(1u << i);
+    }
+
+    stackMonLow = low;
+    return low;
+}
+
+/**
+ * @brief  Format the latest sample as one text line.
+ * @param  buf Output buffer of at least STACK_MON_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t StackMon_Format(char *buf)
+{
+    uint16_t n;
+    uint8_t i, k;
+
+    memcpy(buf, "STK,", 4);
+    n = 4;
+    n += Fmt_Decimal(STACK_MON_MARGIN, &buf[n]);
+    for (i = 0; i < stackMonCount; i++)
+    {
+        buf[n++] = ',';
+        n += Fmt_Decimal(stackMon[i].number, &buf[n]);
+        buf[n++] = ',';
+        for (k = 0; k < configMAX_TASK_NAME_LEN - 1 && stackMon[i].name[k]; k++)
+            buf[n++] = stackMon[i].name[k];
+        buf[n++] = ',';
+        n += Fmt_Decimal(stackMon[i].size, &buf[n]);
+        buf[n++] = ',';
+        n += Fmt_Decimal(stackMon[i].min_free, &buf[n]);
+        buf[n++] = ',';
+        buf[n++] = (stackMonLow & (1u << i)) ? '1' : '0';
+    }
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
+}
@@ -23,6 +23,8 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "trace.h"
+#include "isr_stats.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -84,20 +86,7 @@ void NMI_Handler(void)
   /* USER CODE END NonMaskableInt_IRQn 1 */
 }
 
-/**
-  * @brief This function handles Hard fault interrupt.
-  */
-void HardFault_Handler(void)
-{
-  /* USER CODE BEGIN HardFault_IRQn 0 */
-
-  /* USER CODE END HardFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_HardFault_IRQn 0 */
-    /* USER CODE END W1_HardFault_IRQn 0 */
-  }
-}
+/* HardFault_Handler is in crash.c: it needs the stacked exception frame */
 
 /**
   * @brief This function handles Memory management fault.
@@ -170,11 +159,13 @@ void DebugMon_Handler(void)
 void USB_LP_CAN1_RX0_IRQHandler(void)
 {
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 0 */
-
+  ISR_STATS_ENTER();
+  TRACE_ISR_ENTER();
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 0 */
   HAL_CAN_IRQHandler(&hcan);
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 1 */
-
+  TRACE_ISR_EXIT();
+  ISR_STATS_EXIT(ISR_STATS_CAN);
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 1 */
 }
 
@@ -184,11 +175,13 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
 void TIM1_CC_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_CC_IRQn 0 */
-
+  ISR_STATS_ENTER();
+  TRACE_ISR_ENTER();
   /* USER CODE END TIM1_CC_IRQn 0 */
   HAL_TIM_IRQHandler(&htim1);
   /* USER CODE BEGIN TIM1_CC_IRQn 1 */
-
+  TRACE_ISR_EXIT();
+  ISR_STATS_EXIT(ISR_STATS_ECHO1);
   /* USER CODE END TIM1_CC_IRQn 1 */
 }
 
@@ -198,11 +191,13 @@ void TIM1_CC_IRQHandler(void)
 void TIM2_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM2_IRQn 0 */
-
+  ISR_STATS_ENTER();
+  TRACE_ISR_ENTER();
   /* USER CODE END TIM2_IRQn 0 */
   HAL_TIM_IRQHandler(&htim2);
   /* USER CODE BEGIN TIM2_IRQn 1 */
-	
+  TRACE_ISR_EXIT();
+  ISR_STATS_EXIT(ISR_STATS_ECHO2);
   /* USER CODE END TIM2_IRQn 1 */
 }
 
@@ -212,11 +207,11 @@ void TIM2_IRQHandler(void)
 void TIM3_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM3_IRQn 0 */
-
+  ISR_STATS_ENTER();
   /* USER CODE END TIM3_IRQn 0 */
   HAL_TIM_IRQHandler(&htim3);
   /* USER CODE BEGIN TIM3_IRQn 1 */
-
+  ISR_STATS_EXIT(ISR_STATS_TICK);
   /* USER CODE END TIM3_IRQn 1 */
 }
 
@@ -0,0 +1,184 @@
+/**
+ * @file    tickless.c
+ * @ingroup Transmitter_Node
+ * @brief   RTOS tick on the HAL TIM timebase, with tickless idle.
+ */
+#include "tickless.h"
+#include "fmt.h"
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+/** Timer counts per tick (1 MHz counter) */
+#define TICKLESS_COUNTS_PER_TICK  1000u
+
+/** Statistics of the current window */
+static TicklessStatsTypeDef ticklessStats;
+
+/** Tick count at the start of the window */
+static TickType_t ticklessWindowStart;
+
+extern void xPortSysTickHandler(void);
+
+/**
+ * @brief Keep the longest masked section seen.
+ * @param start CYCCNT value when interrupts were masked.
+ */
+static void Tickless_Masked(uint32_t start)
+{
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    if (cycles > 0xFFFFu)
+        cycles = 0xFFFFu;
+    if (cycles > ticklessStats.masked_cycles)
+        ticklessStats.masked_cycles = (uint16_t)cycles;
+}
+
+/**
+ * @brief Advance the RTOS tick; call from the timebase TIM update callback.
+ */
+void Tickless_IncTick(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        xPortSysTickHandler();
+}
+
+/**
+ * @brief Start the RTOS tick (called by the port when the scheduler starts).
+ *
+ * Replaces the SysTick setup of port.c. The timebase TIM is already
+ * running from HAL_InitTick and Tickless_IncTick starts forwarding its
+ * updates to the kernel as soon as the scheduler runs, so there is nothing
+ * left to configure.
+ */
+void vPortSetupTimerInterrupt(void)
+{
+}
+
+/**
+ * @brief Sleep until the next task is due or an interrupt arrives.
+ *
+ * Called by the idle task with the scheduler suspended. The timer counter
+ * is stopped only while its period is changed, which costs at most one
+ * count (1 us) of drift per sleep.
+ *
+ * @param xExpectedIdleTime Ticks until the next task unblocks.
+ */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+    TIM_TypeDef *tim = TICKLESS_TIM;
+    uint32_t start, entry, count, slept, ticks;
+
+    if (xExpectedIdleTime > TICKLESS_MAX_IDLE_TICKS)
+        xExpectedIdleTime = TICKLESS_MAX_IDLE_TICKS;
+
+    /* PRIMASK: interrupts still wake WFI but are only taken after the
+       ticks have been accounted for */
+    __disable_irq();
+    start = DWT->CYCCNT;
+
+    /* A task became ready, or a tick is already pending */
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep || (tim->SR & TIM_SR_UIF))
+    {
+        __enable_irq();
+        return;
+    }
+
+    /* Stretch the current tick period to the whole idle time */
+    tim->CR1 &= ~TIM_CR1_CEN;
+    entry = tim->CNT;
+    tim->ARR = xExpectedIdleTime * TICKLESS_COUNTS_PER_TICK - 1u;
+    tim->CR1 |= TIM_CR1_CEN;
+
+    Tickless_Masked(start);
+    __DSB();
+    __WFI();
+    __ISB();
+    start = DWT->CYCCNT;
+
+    tim->CR1 &= ~TIM_CR1_CEN;
+    count = tim->CNT;
+    if (tim->SR & TIM_SR_UIF)
+    {
+        /* Slept the whole time; the pending update adds the last tick */
+        slept = xExpectedIdleTime * TICKLESS_COUNTS_PER_TICK + count - entry;
+        ticks = xExpectedIdleTime - 1u;
+    }
+    else
+    {
+        /* Woken early by another interrupt */
+        slept = count - entry;
+        ticks = count / TICKLESS_COUNTS_PER_TICK;
+        count %= TICKLESS_COUNTS_PER_TICK;
+    }
+    tim->CNT = count;
+    tim->ARR = TICKLESS_COUNTS_PER_TICK - 1u;
+    tim->CR1 |= TIM_CR1_CEN;
+
+    if (ticks)
+    {
+        vTaskStepTick(ticks);
+        uwTick += ticks * uwTickFreq;
+    }
+
+    ticklessStats.sleeps++;
+    ticklessStats.sleep_us += slept;
+    if (slept / 1000u > ticklessStats.longest_ms)
+        ticklessStats.longest_ms = (uint16_t)(slept / 1000u);
+
+    Tickless_Masked(start);
+    __enable_irq();
+}
+
+/**
+ * @brief Collect the statistics since the previous call and restart them.
+ * @param stats Filled with the result.
+ */
+void Tickless_GetStats(TicklessStatsTypeDef *stats)
+{
+    TickType_t now;
+
+    taskENTER_CRITICAL();
+    now = xTaskGetTickCount();
+    *stats = ticklessStats;
+    ticklessStats.sleeps = 0;
+    ticklessStats.sleep_us = 0;
+    ticklessStats.longest_ms = 0;
+    ticklessStats.masked_cycles = 0;
+    taskEXIT_CRITICAL();
+
+    stats->window_ms = (uint32_t)(now - ticklessWindowStart) * portTICK_PERIOD_MS;
+    ticklessWindowStart = now;
+
+    stats->residency = stats->window_ms ?
+        (uint16_t)(stats->sleep_us / stats->window_ms) : 0;
+    if (stats->residency > 1000u)
+        stats->residency = 1000u;
+}
+
+/**
+ * @brief  Collect the statistics and format them as one text line.
+ * @param  buf Output buffer of at least TICKLESS_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t Tickless_Format(char *buf)
+{
+    TicklessStatsTypeDef stats;
+    uint16_t n;
+
+    Tickless_GetStats(&stats);
+
+    memcpy(buf, "PWR,", 4);
+    n = 4;
+    n += Fmt_Decimal(stats.residency, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats.sleeps, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats.longest_ms, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats.masked_cycles, &buf[n]);
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
+}
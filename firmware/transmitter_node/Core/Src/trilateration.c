@@ -0,0 +1,106 @@
+/**
+ * @file    trilateration.c
+ * @ingroup Transmitter_Node
+ * @brief   Obstacle position from the ranges of the two sensors.
+ */
+#include "trilateration.h"
+#if TRILAT_USE_CMSIS
+#include "arm_math.h"
+#endif
+
+/** Fraction bits of the lateral offset while solving: rounding it to whole
+ *  mm would cost a few mm of distance for an obstacle far off-centre */
+#define TRILAT_FRAC_BITS        3
+
+#if TRILAT_USE_CMSIS
+
+/**
+ * @brief  Square root with arm_sqrt_q15.
+ *
+ * The argument is shifted right by an odd count s until it is below 1.0
+ * in q15, so that sqrt(v 2^s) = sqrt(v 2^15) 2^((s - 15) / 2) is the q15
+ * root shifted by a whole count.
+ *
+ * @param  value Argument.
+ * @retval Rounded square root.
+ */
+static uint32_t Trilat_Sqrt(uint32_t value)
+{
+    uint8_t shift = 1u;
+    q15_t root;
+
+    while ((value >> shift) >= 0x8000u)
+        shift += 2u;
+
+    arm_sqrt_q15((q15_t)(value >> shift), &root);
+    shift = (uint8_t)((15u - shift) / 2u);
+    return shift ? ((uint32_t)root + (1u << (shift - 1u))) >> shift : (uint32_t)root;
+}
+
+#else
+
+/**
+ * @brief  Square root, one result bit per iteration.
+ * @param  value Argument.
+ * @retval Rounded square root.
+ */
+static uint32_t Trilat_Sqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1uL << 30;
+
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    /* Round: the remainder exceeds root when value is past (root + 0.5)^2 */
+    return (value > root) ? root + 1u : root;
+}
+
+#endif /* TRILAT_USE_CMSIS */
+
+/**
+ * @brief  Locate an obstacle seen by both sensors.
+ * @param  r0_mm Range of sensor 0, on the left (mm).
+ * @param  r1_mm Range of sensor 1, on the right (mm).
+ * @param  fix   Filled with the position when there is one.
+ * @retval 1 if the ranges intersect, 0 otherwise (fix left unchanged).
+ */
+uint8_t Trilat_Solve(uint16_t r0_mm, uint16_t r1_mm, TrilatFixTypeDef *fix)
+{
+    const int32_t b = TRILAT_BASELINE_MM;
+    const int32_t half = 1 << (TRILAT_FRAC_BITS - 1);
+    int32_t d, x, u, y2;
+
+    /* Triangle inequality: no intersection past the baseline */
+    d = (int32_t)r0_mm - (int32_t)r1_mm;
+    if (d > b || d < -b)
+        return 0;
+
+    /* x = (r0 - r1)(r0 + r1) / 2B, rounded half away from zero */
+    x = (d * ((int32_t)r0_mm + (int32_t)r1_mm)) << TRILAT_FRAC_BITS;
+    x = (x >= 0) ? (x + b) / (2 * b) : (x - b) / (2 * b);
+
+    /* y^2 = r0^2 - (x + B/2)^2, all with twice the fraction bits */
+    u = x + (b << (TRILAT_FRAC_BITS - 1));
+    y2 = (((int32_t)r0_mm * r0_mm) << (2 * TRILAT_FRAC_BITS)) - u * u;
+    if (y2 < 0)
+        return 0;
+
+    fix->lateral_mm = (int16_t)((x >= 0) ? (x + half) >> TRILAT_FRAC_BITS : -((half - x) >> TRILAT_FRAC_BITS));
+    fix->forward_mm = (uint16_t)((Trilat_Sqrt((uint32_t)y2) + (uint32_t)half) >> TRILAT_FRAC_BITS);
+    return 1;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file    tt_sched.c
+ * @ingroup Transmitter_Node
+ * @brief   Time-triggered cyclic executive for the measurement schedule.
+ *
+ * Keep one table row per line: tools/tt_check.py parses the rows to check
+ * the slots before every build.
+ */
+#include "tt_sched.h"
+#include "app_tasks.h"
+#include "watchdog.h"
+#include "boot_time.h"
+
+/** Transmitter schedule: two sensors measured one after the other, then CAN */
+const TtSlotTypeDef ttTable[] = {
+    /* action      sensor  offset  length */
+    { TT_TRIGGER,  0u,     0u,     1u  },
+    { TT_ECHO,     0u,     0u,     25u },
+    { TT_REPORT,   0u,     1u,     23u },
+    { TT_TRIGGER,  1u,     25u,    1u  },
+    { TT_ECHO,     1u,     25u,    25u },
+    { TT_CAN_TX,   0u,     50u,    1u  },
+};
+
+/** Number of rows in ttTable */
+const uint8_t ttTableSize = sizeof(ttTable) / sizeof(ttTable[0]);
+
+/** One dispatch point of the cycle */
+typedef struct
+{
+    uint16_t time;              /**< Release, from the start of the cycle (ms) */
+    uint8_t  slot;              /**< Row of ttTable */
+} TtEventTypeDef;
+
+/** Dispatch points in release order, built from ttTable */
+static TtEventTypeDef ttEvents[sizeof(ttTable) / sizeof(ttTable[0])];
+
+/** Executive statistics */
+static TtStatsTypeDef ttStats;
+
+/**
+ * @brief Release time of a slot's action: echo windows act when they close.
+ * @param slot Table row.
+ */
+static uint16_t TtSched_ReleaseTime(const TtSlotTypeDef *slot)
+{
+    return (slot->action == TT_ECHO) ? (uint16_t)(slot->offset + slot->length) : slot->offset;
+}
+
+/**
+ * @brief Sort the table rows into dispatch order.
+ *
+ * Stable insertion sort on the release time; at equal times a closing echo
+ * window goes first, so a trigger at the same tick starts clean.
+ */
+static void TtSched_Build(void)
+{
+    TtEventTypeDef event;
+    uint8_t i, j;
+
+    for (i = 0; i < ttTableSize; i++)
+    {
+        event.time = TtSched_ReleaseTime(&ttTable[i]);
+        event.slot = i;
+
+        for (j = i; j > 0; j--)
+        {
+            if (ttEvents[j - 1].time < event.time ||
+                (ttEvents[j - 1].time == event.time &&
+                 (ttTable[ttEvents[j - 1].slot].action == TT_ECHO || ttTable[i].action != TT_ECHO)))
+                break;
+            ttEvents[j] = ttEvents[j - 1];
+        }
+        ttEvents[j] = event;
+    }
+}
+
+/**
+ * @brief Sleep until an absolute tick, recording late releases.
+ * @param release Release tick.
+ */
+static void TtSched_WaitUntil(uint32_t release)
+{
+    uint32_t now = osKernelGetTickCount();
+    uint32_t late;
+
+    if ((int32_t)(release - now) > 0)
+    {
+        osDelayUntil(release);
+        return;
+    }
+
+    late = now - release;
+    if (late)
+    {
+        ttStats.late++;
+        if (late > ttStats.worst_late)
+            ttStats.worst_late = late;
+    }
+}
+
+/**
+ * @brief Run the action of one slot.
+ * @param slot Table row.
+ */
+static void TtSched_Dispatch(const TtSlotTypeDef *slot)
+{
+    switch (slot->action)
+    {
+    case TT_TRIGGER:
+        USensor_Trigger(slot->sensor);
+        break;
+    case TT_ECHO:
+        USensor_CloseWindow(slot->sensor);
+        break;
+    case TT_CAN_TX:
+        Tx_SendDistances();
+        break;
+    case TT_REPORT:
+        Tx_Report();
+        break;
+    }
+}
+
+/**
+ * @brief Time-triggered executive task: runs ttTable forever.
+ * @param argument Not used
+ */
+void TtTask_init(void *argument)
+{
+    uint32_t cycle;
+    uint8_t i;
+
+    (void) argument;  /**< Unused parameter */
+
+    Boot_Mark(BOOT_SCHEDULER);
+    TtSched_Build();
+
+    cycle = osKernelGetTickCount();
+    for(;;)
+    {
+        for (i = 0; i < ttTableSize; i++)
+        {
+            TtSched_WaitUntil(cycle + ttEvents[i].time);
+            TtSched_Dispatch(&ttTable[ttEvents[i].slot]);
+        }
+
+        cycle += TT_CYCLE_MS;
+        ttStats.cycles++;
+        Watchdog_Checkin();
+
+        /* Overran into the next cycle: re-anchor instead of bursting */
+        if ((int32_t)(osKernelGetTickCount() - cycle) > 0)
+            cycle = osKernelGetTickCount();
+    }
+}
+
+/**
+ * @brief Executive statistics.
+ */
+const TtStatsTypeDef *TtSched_GetStats(void)
+{
+    return &ttStats;
+}
@@ -4,32 +4,79 @@
  * @brief   Ultrasonic sensor measurement driver using STM32 timers.
  *
  * This file implements:
- *   - Trigger generation for two ultrasonic sensors
+ *   - Trigger generation for USENSOR_COUNT ultrasonic sensors
  *   - Microsecond delay using a hardware timer
- *   - Input Capture processing for echo pulse measurement
+ *   - Input Capture processing for echo pulse measurement, bounded by the
+ *     echo windows of the time-triggered schedule (tt_sched.c)
  *
  * The module converts echo pulse duration into a distance in centimeters
- * and updates the global variables Distance_1 and Distance_2.
+ * (see echo_range.h) and updates the global Distance array, with the
+ * tick of each update in DistanceTick.
+ *
+ * With USENSOR_ENVELOPE=1 the trigger instead starts ADC1 on the sensor's
+ * envelope channel, one conversion per TIM2 period into usensorEnvelope
+ * by DMA, and the window close ranges the finished buffer with
+ * EchoEnv_Range; the nearest echo is the distance, and a ping without the
+ * burst ringing (EchoEnv_Ringing) is silent. The DMA runs without
+ * its interrupt: HAL_ADC_Stop_DMA at the window close returns the ADC to
+ * the ready state.
  */
 #include "usensor.h"
+#include "fmt.h"
+#include "echo_range.h"
+#include "trace.h"
+#include "boot_time.h"
+#include "isr_stats.h"
+#if USENSOR_ENVELOPE
+#include "echo_envelope.h"
+#endif
+
+/** @brief Trigger pin and echo capture timer (channel 1) of one sensor */
+typedef struct
+{
+    TIM_HandleTypeDef *htim;      /**< Echo input capture timer */
+    uint16_t           trig_pin;  /**< Trigger pin on USENSOR_GPIO_PORT */
+} USensorHwTypeDef;
+
+/** @brief Echo capture state of one sensor */
+typedef struct
+{
+    uint32_t rise;                /**< Counter value at the rising edge */
+    uint8_t  first_captured;      /**< Rising edge seen, waiting for the falling one */
+} USensorCaptureTypeDef;
 
-/** @brief Internal variable for input capture of sensor 1 */
-static uint32_t IC1_Val1 = 0;
-/** @brief Internal variable for input capture of sensor 1 (second reading) */
-static uint32_t IC1_Val2 = 0;
-/** @brief Flag to indicate first capture of sensor 1 */
-static uint8_t IC1_FirstCaptured = 0;
-/** @brief Time difference captured for sensor 1 */
-static uint32_t IC1_Diff = 0;
-
-/** @brief Internal variable for input capture of sensor 2 */
-static uint32_t IC2_Val1 = 0;
-/** @brief Internal variable for input capture of sensor 2 (second reading) */
-static uint32_t IC2_Val2 = 0;
-/** @brief Flag to indicate first capture of sensor 2 */
-static uint8_t IC2_FirstCaptured = 0;
-/** @brief Time difference captured for sensor 2 */
-static uint32_t IC2_Diff = 0;
+/** @brief Sensor hardware, indexed by sensor */
+static const USensorHwTypeDef usensorHw[USENSOR_COUNT] = {
+    { &htim1, USENSOR1_TRIG_PIN },
+    { &htim2, USENSOR2_TRIG_PIN },
+};
+
+/** @brief Capture state, indexed by sensor */
+static USensorCaptureTypeDef usensorCapture[USENSOR_COUNT];
+
+/** @brief Outcome of the last echo window, indexed by sensor */
+static volatile uint8_t usensorStatus[USENSOR_COUNT];
+
+#if USENSOR_ENVELOPE
+/** @brief Envelope ranging timing over one report window */
+typedef struct
+{
+    uint32_t pings;               /**< Pings ranged */
+    uint32_t echoes;              /**< Echoes found */
+    uint32_t cycles;              /**< Total cycles spent */
+    uint32_t worst;               /**< Longest ping (cycles) */
+    uint32_t overruns;            /**< Pings over ECHO_ENV_BUDGET_CYCLES */
+} USensorEnvStatsTypeDef;
+
+/** @brief Envelope ADC channel, indexed by sensor */
+static const uint32_t usensorEnvChannel[USENSOR_COUNT] = USENSOR_ENV_CHANNELS;
+
+/** @brief Envelope of the ping in progress, written by DMA */
+static uint16_t usensorEnvelope[ECHO_ENV_SAMPLES];
+
+/** @brief Envelope ranging timing since the previous "ENV" line; only touched by TtTask */
+static USensorEnvStatsTypeDef usensorEnvStats;
+#endif
 
 /**
  * @brief Microsecond delay using TIM1
@@ -42,74 +89,222 @@ void USensor_DelayUs(uint16_t us)
 }
 
 /**
- * @brief Trigger the first ultrasonic sensor
+ * @brief Reset the capture of a sensor to wait for a rising edge
+ * @param sensor Sensor index
+ */
+static void USensor_ResetCapture(uint8_t sensor)
+{
+    TIM_HandleTypeDef *htim = usensorHw[sensor].htim;
+
+    __HAL_TIM_DISABLE_IT(htim, TIM_IT_CC1);
+    usensorCapture[sensor].first_captured = 0;
+    __HAL_TIM_SET_CAPTUREPOLARITY(htim, TIM_CHANNEL_1, TIM_INPUTCHANNELPOLARITY_RISING);
+}
+
+#if USENSOR_ENVELOPE
+/**
+ * @brief Send the trigger pulse of a sensor and start sampling its envelope
+ * @param sensor Sensor index, below USENSOR_COUNT
+ *
+ * TIM2 is held at the start of its period while the ADC is set up and the
+ * pulse sent, and restarted at the end of the pulse, so the first sample
+ * is one period after the burst (ECHO_ENV_FIRST_SAMPLE_US).
  */
-void USensor_Read1(void)
+void USensor_Trigger(uint8_t sensor)
 {
-    HAL_GPIO_WritePin(USENSOR_GPIO_PORT, USENSOR1_TRIG_PIN, GPIO_PIN_SET);
+    ADC_ChannelConfTypeDef channel = {0};
+
+    __HAL_TIM_SET_COUNTER(&htim2, 0);
+    channel.Channel = usensorEnvChannel[sensor];
+    channel.Rank = ADC_REGULAR_RANK_1;
+    channel.SamplingTime = ADC_SAMPLETIME_28CYCLES_5;
+    HAL_ADC_ConfigChannel(&hadc1, &channel);
+    HAL_ADC_Start_DMA(&hadc1, (uint32_t *)usensorEnvelope, ECHO_ENV_SAMPLES);
+
+    TRACE_MARK(TRACE_MARK_TRIGGER, sensor + 1u);
+    HAL_GPIO_WritePin(USENSOR_GPIO_PORT, usensorHw[sensor].trig_pin, GPIO_PIN_SET);
     USensor_DelayUs(10);  /**< 10us trigger pulse */
-    HAL_GPIO_WritePin(USENSOR_GPIO_PORT, USENSOR1_TRIG_PIN, GPIO_PIN_RESET);
-    __HAL_TIM_ENABLE_IT(&htim1, TIM_IT_CC1);
+    HAL_GPIO_WritePin(USENSOR_GPIO_PORT, usensorHw[sensor].trig_pin, GPIO_PIN_RESET);
+    __HAL_TIM_SET_COUNTER(&htim2, 0);
 }
 
 /**
- * @brief Trigger the second ultrasonic sensor
+ * @brief Close the echo window of a sensor and range its envelope
+ * @param sensor Sensor index, below USENSOR_COUNT
  */
-void USensor_Read2(void)
+void USensor_CloseWindow(uint8_t sensor)
 {
-    HAL_GPIO_WritePin(USENSOR_GPIO_PORT, USENSOR2_TRIG_PIN, GPIO_PIN_SET);
-    USensor_DelayUs(10);
-    HAL_GPIO_WritePin(USENSOR_GPIO_PORT, USENSOR2_TRIG_PIN, GPIO_PIN_RESET);
-    __HAL_TIM_ENABLE_IT(&htim2, TIM_IT_CC1);
+    EchoEnvEchoTypeDef echoes[ECHO_ENV_MAX_ECHOES];
+    uint32_t start, cycles, cm = USENSOR_NO_ECHO;
+    uint8_t complete = (__HAL_DMA_GET_COUNTER(hadc1.DMA_Handle) == 0u);
+    uint8_t found;
+    uint8_t ringing = 0;
+
+    HAL_ADC_Stop_DMA(&hadc1);
+
+    /* A ping still sampling at the close missed conversions: no echo */
+    if (complete)
+    {
+        start = DWT->CYCCNT;
+        found = EchoEnv_Range(usensorEnvelope, echoes, ECHO_ENV_MAX_ECHOES);
+        cycles = DWT->CYCCNT - start;
+
+        usensorEnvStats.pings++;
+        usensorEnvStats.echoes += found;
+        usensorEnvStats.cycles += cycles;
+        if (cycles > usensorEnvStats.worst)
+            usensorEnvStats.worst = cycles;
+        if (cycles > ECHO_ENV_BUDGET_CYCLES)
+            usensorEnvStats.overruns++;
+
+        /* Without its own burst the transducer heard no echo either */
+        ringing = EchoEnv_Ringing();
+        if (found && ringing)
+        {
+            cm = (echoes[0].mm + 5u) / 10u;
+            Boot_Mark(BOOT_FIRST_ECHO);
+        }
+    }
+    usensorStatus[sensor] = !ringing ? USENSOR_SILENT :
+                            (cm < USENSOR_NO_ECHO) ? USENSOR_ECHO : USENSOR_OUT_OF_RANGE;
+
+    Distance[sensor] = (cm < USENSOR_NO_ECHO) ? (uint8_t)cm : USENSOR_NO_ECHO;
+    DistanceTick[sensor] = HAL_GetTick();
+    TRACE_MARK(TRACE_MARK_ECHO, ((uint16_t)sensor << 8) | Distance[sensor]);
+}
+
+/**
+ * @brief  Format the envelope ranging timing as
+ *         "ENV,<avg_cycles>,<worst_cycles>,<budget>,<overruns>,<pings>,<echoes>"
+ *         and restart it.
+ * @param  buf Output buffer of at least USENSOR_ENV_LINE_MAX bytes.
+ * @retval Number of characters written (no terminating NUL).
+ */
+uint16_t USensor_FormatEnvelope(char *buf)
+{
+    USensorEnvStatsTypeDef *stats = &usensorEnvStats;
+    uint16_t n = 0;
+
+    buf[n++] = 'E';
+    buf[n++] = 'N';
+    buf[n++] = 'V';
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats->pings ? stats->cycles / stats->pings : 0u, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats->worst, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(ECHO_ENV_BUDGET_CYCLES, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats->overruns, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats->pings, &buf[n]);
+    buf[n++] = ',';
+    n += Fmt_Decimal(stats->echoes, &buf[n]);
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+
+    stats->pings = 0;
+    stats->echoes = 0;
+    stats->cycles = 0;
+    stats->worst = 0;
+    stats->overruns = 0;
+    return n;
+}
+#else
+/**
+ * @brief Send the trigger pulse of a sensor and open its echo window
+ * @param sensor Sensor index, below USENSOR_COUNT
+ */
+void USensor_Trigger(uint8_t sensor)
+{
+    const USensorHwTypeDef *hw = &usensorHw[sensor];
+
+    USensor_ResetCapture(sensor);
+
+    TRACE_MARK(TRACE_MARK_TRIGGER, sensor + 1u);
+    HAL_GPIO_WritePin(USENSOR_GPIO_PORT, hw->trig_pin, GPIO_PIN_SET);
+    USensor_DelayUs(10);  /**< 10us trigger pulse */
+    HAL_GPIO_WritePin(USENSOR_GPIO_PORT, hw->trig_pin, GPIO_PIN_RESET);
+
+    __HAL_TIM_CLEAR_FLAG(hw->htim, TIM_FLAG_CC1);
+    __HAL_TIM_ENABLE_IT(hw->htim, TIM_IT_CC1);
+}
+
+/**
+ * @brief Close the echo window of a sensor
+ * @param sensor Sensor index, below USENSOR_COUNT
+ */
+void USensor_CloseWindow(uint8_t sensor)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    /* The capture interrupt is still enabled while the echo is incomplete */
+    __disable_irq();
+    if (__HAL_TIM_GET_IT_SOURCE(usensorHw[sensor].htim, TIM_IT_CC1) != RESET)
+    {
+        /* An echo pin still high is an obstacle out of range, one never raised a dead sensor */
+        usensorStatus[sensor] = usensorCapture[sensor].first_captured ? USENSOR_OUT_OF_RANGE : USENSOR_SILENT;
+        USensor_ResetCapture(sensor);
+        Distance[sensor] = USENSOR_NO_ECHO;
+        DistanceTick[sensor] = HAL_GetTick();
+        TRACE_MARK(TRACE_MARK_ECHO, ((uint16_t)sensor << 8) | USENSOR_NO_ECHO);
+    }
+    __set_PRIMASK(primask);
+}
+#endif
+
+/**
+ * @brief Outcome of the last closed echo window of a sensor
+ * @param sensor Sensor index, below USENSOR_COUNT
+ * @retval Status of the window
+ */
+USensorStatusTypeDef USensor_GetStatus(uint8_t sensor)
+{
+    return (USensorStatusTypeDef)usensorStatus[sensor];
 }
 
 /**
  * @brief Input capture callback called from HAL_TIM_IC_CaptureCallback
  * @param htim Pointer to the TIM handle
  *
- * Measures the pulse width for both ultrasonic sensors and calculates distance.
+ * Measures the pulse width of each ultrasonic sensor and calculates distance.
+ * The counter read right after each captured edge gives the capture
+ * latency (see isr_stats.h).
  */
 void USensor_TIM_IC_Callback(TIM_HandleTypeDef *htim)
 {
-    /* Sensor 1 */
-    if (htim->Instance == htim1.Instance && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1)
-    {
-        if (IC1_FirstCaptured == 0)
-        {
-            IC1_Val1 = HAL_TIM_ReadCapturedValue(&htim1, TIM_CHANNEL_1);
-            IC1_FirstCaptured = 1;
-            __HAL_TIM_SET_CAPTUREPOLARITY(&htim1, TIM_CHANNEL_1, TIM_INPUTCHANNELPOLARITY_FALLING);
-        }
-        else
-        {
-            IC1_Val2 = HAL_TIM_ReadCapturedValue(&htim1, TIM_CHANNEL_1);
-            __HAL_TIM_SET_COUNTER(&htim1, 0);
-            IC1_Diff = (IC1_Val2 > IC1_Val1) ? (IC1_Val2 - IC1_Val1) : ((0xFFFF - IC1_Val1) + IC1_Val2);
-            Distance_1 = (uint8_t)(IC1_Diff * 0.034 / 2);
-            IC1_FirstCaptured = 0;
-            __HAL_TIM_SET_CAPTUREPOLARITY(&htim1, TIM_CHANNEL_1, TIM_INPUTCHANNELPOLARITY_RISING);
-            __HAL_TIM_DISABLE_IT(&htim1, TIM_IT_CC1);
-        }
-    }
+    USensorCaptureTypeDef *cap;
+    uint32_t fall, cm;
+    uint8_t i;
 
-    /* Sensor 2 */
-    if (htim->Instance == htim2.Instance && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1)
+    if (htim->Channel != HAL_TIM_ACTIVE_CHANNEL_1)
+        return;
+
+    for (i = 0; i < USENSOR_COUNT; i++)
     {
-        if (IC2_FirstCaptured == 0)
+        if (htim->Instance != usensorHw[i].htim->Instance)
+            continue;
+
+        cap = &usensorCapture[i];
+        if (cap->first_captured == 0)
         {
-            IC2_Val1 = HAL_TIM_ReadCapturedValue(&htim2, TIM_CHANNEL_1);
-            IC2_FirstCaptured = 1;
-            __HAL_TIM_SET_CAPTUREPOLARITY(&htim2, TIM_CHANNEL_1, TIM_INPUTCHANNELPOLARITY_FALLING);
+            cap->rise = HAL_TIM_ReadCapturedValue(htim, TIM_CHANNEL_1);
+            ISR_STATS_LATENCY((IsrStatsIdTypeDef)(ISR_STATS_ECHO1 + i), (uint16_t)(__HAL_TIM_GET_COUNTER(htim) - cap->rise));
+            cap->first_captured = 1;
+            __HAL_TIM_SET_CAPTUREPOLARITY(htim, TIM_CHANNEL_1, TIM_INPUTCHANNELPOLARITY_FALLING);
         }
         else
         {
-            IC2_Val2 = HAL_TIM_ReadCapturedValue(&htim2, TIM_CHANNEL_1);
-            __HAL_TIM_SET_COUNTER(&htim2, 0);
-            IC2_Diff = (IC2_Val2 > IC2_Val1) ? (IC2_Val2 - IC2_Val1) : ((0xFFFF - IC2_Val1) + IC2_Val2);
-            Distance_2 = (uint8_t)(IC2_Diff * 0.034 / 2);
-            IC2_FirstCaptured = 0;
-            __HAL_TIM_SET_CAPTUREPOLARITY(&htim2, TIM_CHANNEL_1, TIM_INPUTCHANNELPOLARITY_RISING);
-            __HAL_TIM_DISABLE_IT(&htim2, TIM_IT_CC1);
+            fall = HAL_TIM_ReadCapturedValue(htim, TIM_CHANNEL_1);
+            ISR_STATS_LATENCY((IsrStatsIdTypeDef)(ISR_STATS_ECHO1 + i), (uint16_t)(__HAL_TIM_GET_COUNTER(htim) - fall));
+            __HAL_TIM_SET_COUNTER(htim, 0);
+            cm = Echo_WidthToCm(Echo_PulseWidth(cap->rise, fall));
+            Distance[i] = (cm < USENSOR_NO_ECHO) ? (uint8_t)cm : USENSOR_NO_ECHO;
+            DistanceTick[i] = HAL_GetTick();
+            usensorStatus[i] = (cm < USENSOR_NO_ECHO) ? USENSOR_ECHO : USENSOR_OUT_OF_RANGE;
+            TRACE_MARK(TRACE_MARK_ECHO, ((uint16_t)i << 8) | Distance[i]);
+            Boot_Mark(BOOT_FIRST_ECHO);
+            USensor_ResetCapture(i);
         }
     }
 }
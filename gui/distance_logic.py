@@ -1,9 +1,13 @@
+from zone_table import DWELL_MS, RELEASE_CM, TTC_MIN_CLOSING_MM_S, ZONES, lookup, ttc_cm
+
+
 def get_zone(dist):
     """
     Determine the color zone based on the measured radar distance.
 
     Zones are defined for visual display on the GUI (RED, YELLOW, GREEN)
-    and indicate proximity to obstacles.
+    and indicate proximity to obstacles. The thresholds come from the
+    generated `zone_table` module, which the receiver firmware shares.
 
     Args:
         dist (float): Distance measured by the radar (in meters).
@@ -18,17 +22,159 @@ def get_zone(dist):
             - "GREEN"    : Slightly further distance
             - "NONE"     : Out of range / no warning
     """
-    if dist <= 0.3:
-        return "RED_FULL"
-    elif dist <= 0.5:
-        return "RED"
-    elif dist <= 0.7:
-        return "YELLOW_FULL"
-    elif dist <= 0.9:
-        return "YELLOW"
-    elif dist <= 1.1:
-        return "GREEN_FULL"
-    elif dist <= 1.3:
-        return "GREEN"
-    else:
-        return "NONE"
+    zone, _, _ = lookup(round(dist * 100))
+    return ZONES[zone]
+
+
+def urgency_cm(cm, closing_mm_s, confident):
+    """
+    Distance to indicate for one sensor, given its closing velocity.
+
+    Mirrors Alert_UrgencyCm in the receiver firmware: for a confident
+    velocity of at least TTC_MIN_CLOSING_MM_S, the time to collision is
+    mapped through the TTC curve to the distance of a parked obstacle as
+    urgent, and the closer of the two distances is indicated.
+
+    Args:
+        cm (int): Measured distance in centimetres.
+        closing_mm_s (int): Closing velocity in mm/s, positive approaching.
+        confident (bool): Whether the transmitter's tracker trusts the velocity.
+
+    Returns:
+        int: Distance in centimetres to classify.
+    """
+    if not confident or closing_mm_s < TTC_MIN_CLOSING_MM_S:
+        return cm
+    return min(cm, ttc_cm(cm * 10000 // closing_mm_s))
+
+
+#: Longest age extrapolated over (ms), PREDICT_MAX_AGE_MS in predict.h
+PREDICT_MAX_AGE_MS = 300
+
+#: Largest correction either way (cm), PREDICT_MAX_SHIFT_CM in predict.h
+PREDICT_MAX_SHIFT_CM = 30
+
+#: Distance of a missing echo (cm), passed through
+PREDICT_NO_ECHO = 255
+
+#: Farthest predicted distance (cm), PREDICT_MAX_CM in predict.h
+PREDICT_MAX_CM = 254
+
+
+def predict_cm(cm, closing_mm_s, confident, age_ms):
+    """
+    Extrapolate a distance to the present.
+
+    Mirrors Predict_Cm in the receiver firmware: a confident closing
+    velocity is applied over the sample age, clamped to PREDICT_MAX_AGE_MS,
+    and the correction is clamped to PREDICT_MAX_SHIFT_CM either way.
+
+    Args:
+        cm (int): Distance of the sample in centimetres.
+        closing_mm_s (int): Closing velocity in mm/s, positive approaching.
+        confident (bool): Whether the transmitter's tracker trusts the velocity.
+        age_ms (float): Age of the sample in milliseconds.
+
+    Returns:
+        int: Predicted distance in centimetres.
+    """
+    if not confident or cm == PREDICT_NO_ECHO:
+        return cm
+    # mm/s * ms is um; to cm, rounded half away from zero like the firmware
+    um = closing_mm_s * min(age_ms, PREDICT_MAX_AGE_MS)
+    shift = int(abs(um) / 10000.0 + 0.5) * (1 if um >= 0 else -1)
+    shift = max(-PREDICT_MAX_SHIFT_CM, min(PREDICT_MAX_SHIFT_CM, shift))
+    return max(0, min(PREDICT_MAX_CM, cm - shift))
+
+
+#: Half-width of the band around the bumper centre in which an obstacle
+#: lights both sides (mm); half the sensor baseline, TRILAT_BASELINE_MM
+CENTRE_BAND_MM = 150
+
+
+def side_cm(urgent_cm, lateral_mm):
+    """
+    Distance to indicate on the left and right bars.
+
+    Without a position, each side shows its own sensor (sensor 0 is on the
+    left). With one, both sensors see the same obstacle: its side shows the
+    nearer distance and the other side is released, unless the obstacle is
+    within CENTRE_BAND_MM of the centre, where both sides show it.
+
+    Args:
+        urgent_cm (sequence[int]): Distance to classify per sensor, in centimetres.
+        lateral_mm (int | None): Obstacle offset from the bumper centre in mm,
+            positive right, or None without a position.
+
+    Returns:
+        tuple[int, int]: Left and right distances in centimetres,
+        PREDICT_NO_ECHO for a released side.
+    """
+    if lateral_mm is None or len(urgent_cm) < 2:
+        return urgent_cm[0], urgent_cm[-1]
+    cm = min(urgent_cm)
+    return (cm if lateral_mm <= CENTRE_BAND_MM else PREDICT_NO_ECHO,
+            cm if lateral_mm >= -CENTRE_BAND_MM else PREDICT_NO_ECHO)
+
+
+class ZoneFilter:
+    """
+    Hysteresis and dwell filter applied on top of `get_zone`.
+
+    Mirrors ZoneFilter_Update in the receiver firmware: moving to a closer
+    zone is immediate, while moving to a farther zone requires the distance
+    to exceed the current zone's release limit for `DWELL_MS`.
+
+    Attributes:
+        zone (int): Index into `ZONES` of the zone currently indicated.
+    """
+
+    def __init__(self):
+        """Start in the farthest zone with no release pending."""
+        self.zone = len(ZONES) - 1
+        self._pending_since = None
+
+    def update(self, dist, now_ms):
+        """
+        Feed one distance sample through the filter.
+
+        Args:
+            dist (float): Distance measured by the radar (in meters).
+            now_ms (float): Current time in milliseconds.
+
+        Returns:
+            bool: True if the indicated zone changed on this sample.
+        """
+        cm = round(dist * 100)
+        raw, _, _ = lookup(cm)
+
+        if raw == self.zone:
+            self._pending_since = None
+            return False
+
+        # Closer: escalate immediately
+        if raw < self.zone:
+            self.zone = raw
+            self._pending_since = None
+            return True
+
+        # Farther: only inside the release band, wait
+        if cm <= RELEASE_CM[self.zone]:
+            self._pending_since = None
+            return False
+
+        if self._pending_since is None:
+            self._pending_since = now_ms
+            return False
+
+        if now_ms - self._pending_since < DWELL_MS:
+            return False
+
+        self.zone = raw
+        self._pending_since = None
+        return True
+
+    @property
+    def name(self):
+        """str: Name of the zone currently indicated."""
+        return ZONES[self.zone]
@@ -0,0 +1,477 @@
+"""
+Streaming decoder for the receiver's binary serial frames.
+
+Frames are COBS-encoded and delimited by 0x00. Once decoded, a frame holds
+(little-endian):
+
+    version u8 | seq u16 | timestamp_ms u32 | zone u8 | flags u8 |
+    count u8 | distance_mm u16 * count | closing_mm_s s16 * count |
+    age_ms u16 * count | confident u8 | lateral_mm s16 | forward_mm u16 |
+    crc16 u16
+
+The closing velocity is positive approaching, the age counts from the echo
+to the frame and bit i of `confident` is set when sensor i's velocity can
+be used to predict its distance (`distance_logic.predict_cm`). The obstacle
+position is the transmitter's trilateration of the two ranges: lateral
+offset from the bumper centre, positive right, and distance from the
+bumper, or NO_POSITION. Frames of versions 1 and 2, without some of these
+fields, are still accepted, with no velocity or no position.
+
+The CRC is CRC-16/CCITT-FALSE over everything before it. The encoder is
+Frame_Encode in firmware/receiver_node/Core/Src/frame.c.
+
+Diagnostic records use the same framing with a first byte of 0x80 or above
+(DIAG_*) followed by a record-specific payload and the CRC
+(Frame_EncodeDiag).
+"""
+import binascii
+import struct
+from collections import namedtuple
+
+#: Frame layout version understood by this decoder
+FRAME_VERSION = 3
+
+#: forward_mm of a frame without an obstacle position
+NO_POSITION = 0xFFFF
+
+#: No CAN data received recently; distances are stale
+FLAG_STALE = 0x01
+
+#: Receiver dropped UART output since the previous frame
+FLAG_TX_OVERFLOW = 0x02
+
+#: A sensor reports a degraded or poor health; its readings are still used
+FLAG_SENSOR_DEGRADED = 0x04
+
+#: A sensor reports a failure; the receiver ignores its readings
+FLAG_SENSOR_FAILED = 0x08
+
+#: Diagnostic record: task priorities, deadline misses, worst response
+DIAG_SCHED = 0x81
+
+#: Diagnostic record: per-task CPU load
+DIAG_CPU = 0x82
+
+#: Diagnostic record: part of an event trace snapshot
+DIAG_TRACE = 0x83
+
+#: Diagnostic record: task stack high-water marks
+DIAG_STACK = 0x84
+
+#: Diagnostic record: idle sleep residency and latency
+DIAG_POWER = 0x85
+
+#: Diagnostic record: crash that caused the last reset
+DIAG_CRASH = 0x86
+
+#: Diagnostic record: boot-phase times since reset
+DIAG_BOOT = 0x87
+
+#: Diagnostic record: interrupt entry latency and duration
+DIAG_ISR = 0x88
+
+#: Diagnostic record: occupancy grid cells changed since the last record
+DIAG_GRID = 0x89
+
+#: Level of a grid cell with log-odds 0 (occupancy.h)
+GRID_LEVEL_UNKNOWN = 8
+
+#: Longest encoded frame accepted before the buffer is discarded
+MAX_FRAME_LEN = 96
+
+_HEADER = struct.Struct("<BHIBBB")
+
+_POSITION = struct.Struct("<hH")
+
+#: Bytes after the header for `count` sensors, by frame version
+_BODY_SIZE = {
+    1: lambda count: 2 * count,
+    2: lambda count: 6 * count + 1,
+    3: lambda count: 6 * count + 1 + _POSITION.size,
+}
+
+Frame = namedtuple("Frame", "seq timestamp zone flags distances_mm closing_mm_s age_ms confident "
+                           "lateral_mm forward_mm")
+
+DiagFrame = namedtuple("DiagFrame", "kind payload")
+
+SchedStats = namedtuple("SchedStats", "priority misses worst_ms")
+
+TaskLoad = namedtuple("TaskLoad", "name number permille")
+
+TraceEvent = namedtuple("TraceEvent", "cycles type id arg")
+
+StackUsage = namedtuple("StackUsage", "number size min_free low")
+
+PowerStats = namedtuple("PowerStats", "residency sleeps longest_ms masked_cycles")
+
+IsrStats = namedtuple("IsrStats", "priority count latency duration")
+
+GridDelta = namedtuple("GridDelta", "cols rows worst_cycles runs")
+
+CrashRecord = namedtuple("CrashRecord", "reason task line resets cause pc lr psr "
+                                        "cfsr hfsr sp stack name")
+
+#: Crash reasons (CrashReasonTypeDef in crash.h)
+CRASH_REASONS = ("none", "hardfault", "assert", "error", "watchdog")
+
+#: Stack words in a crash record (CRASH_STACK_WORDS)
+CRASH_STACK_WORDS = 8
+
+#: Task name characters in a crash record (CRASH_NAME_LEN)
+CRASH_NAME_LEN = 12
+
+#: Receiver boot phases (BootPhaseTypeDef in boot_time.h)
+BOOT_PHASES = ("main", "clock", "can", "periph", "scheduler", "first_can",
+               "first_indication")
+
+#: Receiver interrupts in DIAG_ISR records (IsrStatsIdTypeDef in isr_stats.h)
+ISR_NAMES = ("tick", "can_rx", "dma_tx", "uart")
+
+_ISR = struct.Struct("<BH4H4H")
+
+_CRASH = struct.Struct("<BBHHB6I%dI%ds" % (CRASH_STACK_WORDS, CRASH_NAME_LEN))
+
+_TRACE_EVENT = struct.Struct("<IBBH")
+
+#: Characters of each task name in a DIAG_CPU record
+CPU_NAME_LEN = 8
+
+
+def crc16(data):
+    """Return the CRC-16/CCITT-FALSE of `data`."""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def cobs_decode(data):
+    """
+    Decode one COBS block (without its 0x00 delimiter).
+
+    Raises:
+        ValueError: If the block is malformed.
+    """
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def parse_frame(raw):
+    """
+    Check and unpack one decoded frame.
+
+    Returns:
+        Frame | DiagFrame: The distance frame or diagnostic record.
+
+    Raises:
+        ValueError: On CRC, version or length mismatch.
+    """
+    if len(raw) < 3:
+        raise ValueError("short frame")
+    if crc16(raw[:-2]) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+        raise ValueError("CRC mismatch")
+    if raw[0] >= 0x80:
+        return DiagFrame(raw[0], bytes(raw[1:-2]))
+    if len(raw) < _HEADER.size + 2:
+        raise ValueError("short frame")
+
+    version, seq, timestamp, zone, flags, count = _HEADER.unpack_from(raw)
+    if version not in _BODY_SIZE:
+        raise ValueError("unsupported version %d" % version)
+    if len(raw) != _HEADER.size + _BODY_SIZE[version](count) + 2:
+        raise ValueError("length mismatch")
+
+    distances = struct.unpack_from("<%dH" % count, raw, _HEADER.size)
+    if version == 1:
+        return Frame(seq, timestamp, zone, flags, distances, (0,) * count, (0,) * count,
+                     (False,) * count, 0, NO_POSITION)
+
+    offset = _HEADER.size + 2 * count
+    closing = struct.unpack_from("<%dh" % count, raw, offset)
+    ages = struct.unpack_from("<%dH" % count, raw, offset + 2 * count)
+    mask = raw[offset + 4 * count]
+    lateral, forward = 0, NO_POSITION
+    if version >= 3:
+        lateral, forward = _POSITION.unpack_from(raw, offset + 4 * count + 1)
+    return Frame(seq, timestamp, zone, flags, distances, closing, ages,
+                 tuple(bool(mask & (1 << i)) for i in range(count)), lateral, forward)
+
+
+def parse_sched(payload):
+    """
+    Unpack a DIAG_SCHED payload (Sched_Report in task_sched.c).
+
+    Returns:
+        list[SchedStats]: One entry per task, in schedTable order.
+
+    Raises:
+        ValueError: If the payload length does not match the task count.
+    """
+    if not payload or len(payload) != 1 + 5 * payload[0]:
+        raise ValueError("bad sched record")
+    return [SchedStats(*struct.unpack_from("<BHH", payload, 1 + 5 * i))
+            for i in range(payload[0])]
+
+
+def parse_cpu(payload):
+    """
+    Unpack a DIAG_CPU payload (CpuStats_Report in cpu_stats.c).
+
+    Returns:
+        list[TaskLoad]: Task name, kernel task number and load in permille,
+        in kernel order.
+
+    Raises:
+        ValueError: If the payload length does not match the task count.
+    """
+    size = CPU_NAME_LEN + 3
+    if not payload or len(payload) != 1 + size * payload[0]:
+        raise ValueError("bad cpu record")
+    loads = []
+    for i in range(payload[0]):
+        off = 1 + size * i
+        name = payload[off:off + CPU_NAME_LEN].split(b"\0")[0].decode("ascii", "replace")
+        number, permille = struct.unpack_from("<BH", payload, off + CPU_NAME_LEN)
+        loads.append(TaskLoad(name, number, permille))
+    return loads
+
+
+def parse_trace(payload):
+    """
+    Unpack a DIAG_TRACE payload (Trace_Report in trace.c).
+
+    Returns:
+        tuple: (first, total, list[TraceEvent]) where `first` is the
+        snapshot index of the first event and `total` the snapshot length.
+
+    Raises:
+        ValueError: If the payload is truncated.
+    """
+    if len(payload) < 4 or (len(payload) - 4) % _TRACE_EVENT.size:
+        raise ValueError("bad trace record")
+    first, total = struct.unpack_from("<HH", payload)
+    events = [TraceEvent(*_TRACE_EVENT.unpack_from(payload, off))
+              for off in range(4, len(payload), _TRACE_EVENT.size)]
+    return first, total, events
+
+
+def parse_stack(payload):
+    """
+    Unpack a DIAG_STACK payload (StackMon_Report in stack_mon.c).
+
+    Returns:
+        tuple: (margin, list[StackUsage]) with the firmware's margin and,
+        per task, the kernel task number, stack size and least free stack
+        in bytes, and whether it is under the margin.
+
+    Raises:
+        ValueError: If the payload length does not match the task count.
+    """
+    if len(payload) < 4 or len(payload) != 4 + 5 * payload[3]:
+        raise ValueError("bad stack record")
+    margin, low, count = struct.unpack_from("<HBB", payload)
+    return margin, [StackUsage(*struct.unpack_from("<BHH", payload, 4 + 5 * i),
+                               low=bool(low & (1 << i)))
+                    for i in range(count)]
+
+
+def parse_power(payload):
+    """
+    Unpack a DIAG_POWER payload (Tickless_Report in tickless.c).
+
+    Returns:
+        PowerStats: Sleep residency in permille, number of sleeps, longest
+        sleep (ms) and longest masked section (CPU cycles) over the window.
+
+    Raises:
+        ValueError: If the payload length is wrong.
+    """
+    if len(payload) != 8:
+        raise ValueError("bad power record")
+    return PowerStats(*struct.unpack("<HHHH", payload))
+
+
+def parse_crash(payload):
+    """
+    Unpack a DIAG_CRASH payload (Crash_Report in crash.c).
+
+    Returns:
+        CrashRecord: Reason index (see CRASH_REASONS), kernel task number,
+        configASSERT line, crash resets since power-on, reset cause
+        (RCC_CSR bits 26-31), PC, LR, xPSR, CFSR, HFSR, SP, the stack words
+        above SP and the task name.
+
+    Raises:
+        ValueError: If the payload length is wrong.
+    """
+    if len(payload) != _CRASH.size:
+        raise ValueError("bad crash record")
+    fields = _CRASH.unpack(payload)
+    name = fields[-1].split(b"\0", 1)[0].decode("ascii", "replace")
+    return CrashRecord(*fields[:11], stack=list(fields[11:-1]), name=name)
+
+
+def parse_boot(payload):
+    """
+    Unpack a DIAG_BOOT payload (Boot_Report in boot_time.c).
+
+    Returns:
+        list[int]: Time of each boot phase in us since reset, in the order
+        of BOOT_PHASES; 0 for a phase not reached yet.
+
+    Raises:
+        ValueError: If the payload length does not match the phase count.
+    """
+    if len(payload) < 1 or len(payload) != 1 + 4 * payload[0]:
+        raise ValueError("bad boot record")
+    return list(struct.unpack_from("<%dI" % payload[0], payload, 1))
+
+
+def parse_isr(payload):
+    """
+    Unpack a DIAG_ISR payload (IsrStats_Report in isr_stats.c).
+
+    Returns:
+        list[IsrStats]: Per interrupt, in the order of ISR_NAMES: NVIC
+        priority, handler runs, and the (min, avg, max, p99) entry latency
+        and duration in CPU cycles; latency is None where not measured.
+
+    Raises:
+        ValueError: If the payload length does not match the count.
+    """
+    if len(payload) < 1 or len(payload) != 1 + _ISR.size * payload[0]:
+        raise ValueError("bad isr record")
+    stats = []
+    for i in range(payload[0]):
+        info, count, *values = _ISR.unpack_from(payload, 1 + _ISR.size * i)
+        stats.append(IsrStats(info & 0x0F, count,
+                              tuple(values[:4]) if info & 0x80 else None,
+                              tuple(values[4:])))
+    return stats
+
+
+def parse_grid(payload):
+    """
+    Unpack a DIAG_GRID payload (serialTask_init in app_tasks.c, runs by
+    Occupancy_Encode in occupancy.c).
+
+    Returns:
+        GridDelta: Grid size, the longest grid update or decay in CPU
+        cycles since the previous record, and the runs as (cells, level)
+        pairs: level None leaves that many cells unchanged, otherwise they
+        are set to it (0..15, GRID_LEVEL_UNKNOWN for log-odds 0).
+
+    Raises:
+        ValueError: If the payload is short or its runs overflow the grid.
+    """
+    if len(payload) < 4:
+        raise ValueError("bad grid record")
+    cols, rows, worst = struct.unpack_from("<BBH", payload)
+    runs = []
+    cells = 0
+    for byte in payload[4:]:
+        if byte & 0x80:
+            runs.append(((byte & 0x07) + 1, (byte >> 3) & 0x0F))
+        else:
+            runs.append((byte + 1, None))
+        cells += runs[-1][0]
+    if cells > cols * rows:
+        raise ValueError("grid record overflows %dx%d cells" % (cols, rows))
+    return GridDelta(cols, rows, worst, runs)
+
+
+def apply_grid(levels, delta):
+    """
+    Apply a DIAG_GRID record to a grid of cell levels.
+
+    Args:
+        levels (list): Level of each cell, row by row from the bumper,
+            None for a cell not received yet; replaced by an all-None list
+            when the grid size changed.
+        delta (GridDelta): Record from `parse_grid`.
+
+    Returns:
+        list: The updated levels.
+    """
+    if len(levels) != delta.cols * delta.rows:
+        levels = [None] * (delta.cols * delta.rows)
+    cell = 0
+    for count, level in delta.runs:
+        if level is not None:
+            levels[cell:cell + count] = [level] * count
+        cell += count
+    return levels
+
+
+class FrameDecoder:
+    """
+    Incremental decoder: feed it bytes as they arrive, get frames back.
+
+    Attributes:
+        frames (int): Frames decoded successfully.
+        errors (int): Frames rejected (COBS, CRC, version or length).
+        lost (int): Frames missing according to sequence-number gaps.
+    """
+
+    def __init__(self):
+        self._buf = bytearray()
+        self._discard = False
+        self._last_seq = None
+        self.frames = 0
+        self.errors = 0
+        self.lost = 0
+
+    def feed(self, data):
+        """
+        Consume received bytes.
+
+        Args:
+            data (bytes): Bytes read from the serial port.
+
+        Returns:
+            list[Frame | DiagFrame]: Frames completed by these bytes, in
+            order.
+        """
+        frames = []
+        for byte in data:
+            if byte != 0:
+                if self._discard:
+                    continue
+                self._buf.append(byte)
+                if len(self._buf) > MAX_FRAME_LEN:
+                    # No delimiter in sight: drop the rest of this frame
+                    # up to the next delimiter and resynchronise there
+                    self._buf.clear()
+                    self._discard = True
+                    self.errors += 1
+                continue
+
+            if self._discard:
+                self._discard = False
+                continue
+
+            if not self._buf:
+                continue
+            try:
+                frame = parse_frame(cobs_decode(bytes(self._buf)))
+            except ValueError:
+                self.errors += 1
+            else:
+                if isinstance(frame, Frame):
+                    self._track(frame.seq)
+                frames.append(frame)
+            self._buf.clear()
+        return frames
+
+    def _track(self, seq):
+        if self._last_seq is not None:
+            self.lost += (seq - self._last_seq - 1) & 0xFFFF
+        self._last_seq = seq
+        self.frames += 1
@@ -2,6 +2,7 @@ from PyQt5 import QtWidgets
 from ui_generated import Ui_Form
 from serial_worker import SerialWorker
 from ui_main import RadarUI
+from occupancy_view import OccupancyView
 import sys
 
 """
@@ -10,7 +11,9 @@ Main entry point for the STM32 Reversing Radar GUI application.
 - Initializes the PyQt5 application.
 - Sets up the UI from Qt Designer.
 - Starts the SerialWorker thread to read radar distances.
-- Updates the GUI in real-time based on received distances.
+- Updates the GUI in real-time based on received distances, predicted to the
+  present from their age and closing velocity.
+- Shows the receiver's occupancy grid of the rear area in a second window.
 """
 
 # --- Create the PyQt5 application ---
@@ -26,12 +29,17 @@ radar_ui = RadarUI(ui)
 
 # --- Initialize and start the serial reading thread ---
 serial_thread = SerialWorker(port="COM8")
-# Connect the distance signal to the GUI update method
-serial_thread.distance_received.connect(radar_ui.update_display)
+# Connect the decoded frames to the GUI update method, which predicts their
+# distances to the present
+serial_thread.sample_received.connect(radar_ui.update_frame)
+# Grid records carry the changed cells; the view keeps the whole grid
+grid_view = OccupancyView()
+serial_thread.diag_received.connect(grid_view.update_diag)
 serial_thread.start()
 
 # --- Show the main window ---
 Form.show()
+grid_view.show()
 
 # --- Start the Qt event loop ---
 exit_code = app.exec_()
@@ -0,0 +1,20 @@
+"""
+Occupancy grid geometry shared with the receiver firmware.
+
+Generated by tools/gen_occupancy_table.py - do not edit by hand.
+"""
+
+#: Cells across the bumper; column 0 is on the left
+COLS = 16
+
+#: Cells away from the bumper; row 0 is against it
+ROWS = 16
+
+#: Side of one cell (cm)
+CELL_CM = 10
+
+#: (lateral position in mm, positive right, yaw in degrees) per sensor
+SENSORS = [(-150, 0), (150, 0)]
+
+#: Half-angle of each sensor's beam (degrees)
+BEAM_HALF_DEG = 30
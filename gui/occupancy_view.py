@@ -0,0 +1,79 @@
+from PyQt5 import QtCore, QtGui, QtWidgets
+from frame_protocol import DIAG_GRID, apply_grid, parse_grid
+from occupancy_table import CELL_CM, COLS, ROWS, SENSORS
+import math
+
+#: Side of one cell on screen (pixels)
+CELL_PX = 20
+
+#: Log-odds units per level and per nat (occupancy.h)
+LEVEL_STEP = 16
+
+
+def level_probability(level):
+    """
+    Return the occupancy probability of a grid cell level.
+
+    A level covers LEVEL_STEP log-odds units of 1/16 nat; its middle is
+    taken, so GRID_LEVEL_UNKNOWN (log-odds 0 to 15) reads just over 0.5.
+
+    Args:
+        level (int): Cell level, 0..15.
+
+    Returns:
+        float: Probability that the cell is occupied.
+    """
+    logodds = (level * LEVEL_STEP - 128 + LEVEL_STEP // 2) / float(LEVEL_STEP)
+    return 1.0 / (1.0 + math.exp(-logodds))
+
+
+class OccupancyView(QtWidgets.QWidget):
+    """
+    Occupancy grid of the area behind the bumper, as sent by the receiver.
+
+    DIAG_GRID records fed through `update_diag` only carry the cells that
+    changed; the grid is kept here and repainted, bumper at the bottom,
+    from white (free) through grey (unknown) to black (occupied). Cells not
+    received yet are drawn hatched until the receiver resends the grid.
+    """
+
+    def __init__(self, parent=None):
+        super().__init__(parent)
+        self.levels = []        # Level per cell, None until received
+        self.setWindowTitle("Rear occupancy (%d cm cells)" % CELL_CM)
+        self.setMinimumSize(COLS * CELL_PX, ROWS * CELL_PX + CELL_PX // 2)
+
+    def update_diag(self, frame):
+        """
+        Apply a diagnostic record if it is a DIAG_GRID one.
+
+        Args:
+            frame (frame_protocol.DiagFrame): Record decoded by the serial worker.
+        """
+        if frame.kind != DIAG_GRID:
+            return
+        try:
+            self.levels = apply_grid(self.levels, parse_grid(frame.payload))
+        except ValueError:
+            return
+        self.update()
+
+    def paintEvent(self, event):
+        painter = QtGui.QPainter(self)
+        top = self.height() - ROWS * CELL_PX - CELL_PX // 2
+        for cell, level in enumerate(self.levels):
+            row, col = divmod(cell, COLS)
+            rect = QtCore.QRect(col * CELL_PX, top + (ROWS - 1 - row) * CELL_PX, CELL_PX, CELL_PX)
+            if level is None:
+                painter.fillRect(rect, QtGui.QBrush(QtCore.Qt.gray, QtCore.Qt.BDiagPattern))
+            else:
+                shade = int(255 * (1.0 - level_probability(level)))
+                painter.fillRect(rect, QtGui.QColor(shade, shade, shade))
+
+        # Sensors on the bumper line
+        painter.setBrush(QtGui.QColor("red"))
+        for lateral_mm, _ in SENSORS:
+            x = int((lateral_mm / 10.0 / CELL_CM + COLS / 2.0) * CELL_PX)
+            painter.drawEllipse(QtCore.QPoint(x, top + ROWS * CELL_PX + CELL_PX // 4),
+                                CELL_PX // 4, CELL_PX // 4)
+        painter.end()
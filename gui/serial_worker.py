@@ -1,15 +1,29 @@
 from PyQt5.QtCore import QThread, pyqtSignal
+from frame_protocol import DiagFrame, FrameDecoder
 import serial
+import time
 
 class SerialWorker(QThread):
     """
     QThread subclass to handle asynchronous reading of radar distance data from a serial port.
 
+    The receiver sends binary frames (see `frame_protocol`), which are decoded
+    as bytes arrive. Corrupt frames and sequence gaps are counted on
+    `decoder` instead of being silently dropped.
+
     Signals:
-        distance_received (float): Emitted whenever a valid distance reading is received.
+        distance_received (float): Emitted with the shortest distance (meters) of each valid frame.
+        frame_received (object): Emitted with every decoded `frame_protocol.Frame`.
+        sample_received (object, float): Emitted with every decoded `frame_protocol.Frame`
+            and the `time.monotonic()` at which it was decoded, so the display can add the
+            time spent in the Qt event queue to the age of its distances.
+        diag_received (object): Emitted with every `frame_protocol.DiagFrame`.
     """
 
     distance_received = pyqtSignal(float)
+    frame_received = pyqtSignal(object)
+    sample_received = pyqtSignal(object, float)
+    diag_received = pyqtSignal(object)
 
     def __init__(self, port="COM8", baudrate=115200):
         """
@@ -23,15 +37,15 @@ class SerialWorker(QThread):
         self.port = port
         self.baudrate = baudrate
         self.running = True  # Flag to control thread execution
+        self.decoder = FrameDecoder()
 
     def run(self):
         """
         Main thread execution method.
 
         - Opens the serial port.
-        - Continuously reads lines from the serial buffer.
-        - Converts lines to float and emits `distance_received`.
-        - Ignores lines that cannot be converted to float.
+        - Reads whatever bytes are available and feeds them to the frame decoder.
+        - Emits `frame_received`, `sample_received` and `distance_received` for each valid frame.
         """
         try:
             ser = serial.Serial(self.port, self.baudrate, timeout=1)
@@ -40,15 +54,17 @@ class SerialWorker(QThread):
             return
 
         while self.running:
-            if ser.in_waiting:
-                try:
-                    # Read a line, decode, strip whitespace, convert to float
-                    dist = float(ser.readline().decode().strip())
-                    # Emit the distance to connected slots
-                    self.distance_received.emit(dist)
-                except ValueError:
-                    # Ignore invalid lines that cannot be converted to float
-                    pass
+            # Block for at least one byte (up to the timeout), then drain the buffer
+            data = ser.read(max(ser.in_waiting, 1))
+            for frame in self.decoder.feed(data):
+                if isinstance(frame, DiagFrame):
+                    self.diag_received.emit(frame)
+                    continue
+                self.frame_received.emit(frame)
+                self.sample_received.emit(frame, time.monotonic())
+                if frame.distances_mm:
+                    # Emit the shortest distance, in meters, to connected slots
+                    self.distance_received.emit(min(frame.distances_mm) / 1000.0)
 
         # Close the serial port when the thread stops
         ser.close()
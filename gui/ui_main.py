@@ -1,10 +1,22 @@
-from PyQt5 import QtWidgets
-from distance_logic import get_zone
+from PyQt5 import QtCore, QtWidgets
+from distance_logic import PREDICT_MAX_AGE_MS, ZoneFilter, predict_cm, side_cm, urgency_cm
+from frame_protocol import NO_POSITION
+import time
+
+#: Interval at which the last frame is predicted again between frames (ms)
+REFRESH_MS = 20
 
 class RadarUI(QtWidgets.QWidget):
     """
     PyQt5 Widget class to manage the Reversing Radar GUI display.
 
+    Frames fed through `update_frame` are shown predicted to the present
+    (`distance_logic.predict_cm`): each distance is extrapolated over its age
+    at the receiver plus the time since the frame was decoded, and again
+    every REFRESH_MS until a newer frame arrives or the age exceeds the
+    prediction limit. The left and right bars each have their own zone
+    filter, fed by `distance_logic.side_cm` from the obstacle position.
+
     Attributes:
         ui (object): The UI object generated from Qt Designer (Ui_Form), containing widgets like
                      lcdNumber and color indicators.
@@ -19,25 +31,87 @@ class RadarUI(QtWidgets.QWidget):
         """
         super().__init__()
         self.ui = ui
+        self.zone_filters = {"left": ZoneFilter(), "right": ZoneFilter()}
+        self.shown_zones = {"left": None, "right": None}  # Zones the indicators currently show
+        self.sample = None      # Last frame and the monotonic time it was decoded
+        self.timer = QtCore.QTimer(self)
+        self.timer.timeout.connect(self._refresh)
 
-    def update_display(self, dist):
+    def update_frame(self, frame, received):
+        """
+        Show a frame, predicted to the present, and keep predicting it.
+
+        Args:
+            frame (frame_protocol.Frame): Frame decoded by the serial worker.
+            received (float): `time.monotonic()` at which it was decoded.
+        """
+        if not frame.distances_mm:
+            return
+        self.sample = (frame, received)
+        self._refresh()
+        self.timer.start(REFRESH_MS)
+
+    def _refresh(self):
+        """Predict the last frame to the present and update the display."""
+        frame, received = self.sample
+        waited = (time.monotonic() - received) * 1000.0
+        predicted = []
+        urgent = []
+        for mm, closing, age, confident in zip(frame.distances_mm, frame.closing_mm_s,
+                                               frame.age_ms, frame.confident):
+            cm = predict_cm(mm // 10, closing, confident, age + waited)
+            predicted.append(cm)
+            urgent.append(urgency_cm(cm, closing, confident))
+
+        lateral = None if frame.forward_mm == NO_POSITION else frame.lateral_mm
+        left, right = side_cm(urgent, lateral)
+        self.update_display(min(predicted) / 100.0, left / 100.0, right / 100.0)
+
+        # Past the limit the prediction no longer moves
+        if min(frame.age_ms) + waited > PREDICT_MAX_AGE_MS:
+            self.timer.stop()
+
+    def update_display(self, dist, left=None, right=None):
         """
         Update the radar GUI based on the current distance measurement.
 
-        - Determines which color zone the distance falls into using `get_zone`.
+        - Determines the color zone of each side through its hysteresis `ZoneFilter`.
         - Updates the LCD display.
-        - Shows or hides red, yellow, and green indicators accordingly.
+        - Shows or hides the red, yellow, and green indicators of a side when its zone changes.
 
         Args:
             dist (float): The distance measured by the radar (in meters).
+            left (float): Distance to classify on the left bars (in meters); `dist` if omitted.
+            right (float): Distance to classify on the right bars (in meters); `dist` if omitted.
         """
-        # Determine the zone for the given distance
-        zone = get_zone(dist)
+        now_ms = time.monotonic() * 1000.0
+        sides = {"left": dist if left is None else left,
+                 "right": dist if right is None else right}
 
-        # Show the LCD display if the zone is not "NONE"
-        self.ui.lcdNumber.setVisible(zone != "NONE")
         self.ui.lcdNumber.display(dist)
 
+        for side, side_dist in sides.items():
+            # Determine the zone for the side's distance
+            self.zone_filters[side].update(side_dist, now_ms)
+            zone = self.zone_filters[side].name
+
+            # Indicators only need repainting when the zone changes
+            if zone == self.shown_zones[side]:
+                continue
+            self.shown_zones[side] = zone
+            self._show_side(side, zone)
+
+        # Show the LCD display if either side is not "NONE"
+        self.ui.lcdNumber.setVisible(any(zone != "NONE" for zone in self.shown_zones.values()))
+
+    def _show_side(self, side, zone):
+        """
+        Show the indicators of one side for a zone.
+
+        Args:
+            side (str): "left" or "right".
+            zone (str): Zone name from `distance_logic.ZONES`.
+        """
         def set_group(group, state):
             """
             Helper function to show or hide a group of QLabel widgets.
@@ -49,19 +123,11 @@ class RadarUI(QtWidgets.QWidget):
             for item in group:
                 item.setVisible(state)
 
-        # Group widgets by color for easy management
-        red = [
-            self.ui.redLeft1, self.ui.redLeft2,
-            self.ui.redRight1, self.ui.redRight2
-        ]
-        yellow = [
-            self.ui.yellowLeft1, self.ui.yellowLeft2,
-            self.ui.yellowRight1, self.ui.yellowRight2
-        ]
-        green = [
-            self.ui.greenLeft1, self.ui.greenLeft2,
-            self.ui.greenRight1, self.ui.greenRight2
-        ]
+        # Group the side's widgets by color for easy management
+        name = side.capitalize()
+        red = [getattr(self.ui, "red%s%d" % (name, i)) for i in (1, 2)]
+        yellow = [getattr(self.ui, "yellow%s%d" % (name, i)) for i in (1, 2)]
+        green = [getattr(self.ui, "green%s%d" % (name, i)) for i in (1, 2)]
 
         # Update visibility for each color group based on the zone
         set_group(red, zone in ["RED_FULL", "RED"])
@@ -0,0 +1,102 @@
+"""
+Distance-to-zone lookup table shared with the receiver firmware.
+
+Generated by tools/gen_zone_table.py - do not edit by hand.
+"""
+
+#: Width of one distance bucket in centimetres
+BUCKET_CM = 10
+
+#: Largest distance reported by the radar (cm)
+MAX_CM = 255
+
+#: Buzzer period value meaning the buzzer is held on
+BUZZER_CONTINUOUS = 0xFFFF
+
+#: Buzzer period value meaning the buzzer is silent
+BUZZER_OFF = 0
+
+#: Time a farther zone must persist before it is indicated (ms)
+DWELL_MS = 150
+
+#: Zone names, ordered from closest to farthest
+ZONES = (
+    "RED_FULL",
+    "RED",
+    "YELLOW_FULL",
+    "YELLOW",
+    "GREEN_FULL",
+    "GREEN",
+    "NONE",
+)
+
+#: (zone index, LED mask, buzzer period ms) per distance bucket
+TABLE = (
+    (0, 0x7F, 65535),
+    (0, 0x7F, 65535),
+    (0, 0x7F, 65535),
+    (0, 0x7F, 65535),
+    (1, 0x3F, 50),
+    (1, 0x3F, 50),
+    (2, 0x1F, 100),
+    (2, 0x1F, 100),
+    (3, 0x0F, 300),
+    (3, 0x0F, 300),
+    (4, 0x07, 400),
+    (4, 0x07, 400),
+    (5, 0x03, 600),
+    (5, 0x03, 600),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+    (6, 0x01, 0),
+)
+
+#: Per-zone distance (cm) that must be exceeded to leave the zone
+RELEASE_CM = (34, 55, 75, 96, 116, 138, 255)
+
+#: Width of one time-to-collision bucket (ms)
+TTC_BUCKET_MS = 100
+
+#: Closing velocity under which the TTC is not used (mm/s)
+TTC_MIN_CLOSING_MM_S = 50
+
+#: Distance (cm) as urgent as each time-to-collision bucket
+TTC_CM = (0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 85, 90, 95, 100, 105, 110, 115, 120, 125, 130)
+
+
+def lookup(cm):
+    """
+    Return the table entry for a distance in centimetres.
+
+    Args:
+        cm (int): Distance in centimetres; clamped to 0..MAX_CM.
+
+    Returns:
+        tuple: (zone index, LED mask, buzzer period ms)
+    """
+    cm = min(max(int(cm), 0), MAX_CM)
+    return TABLE[(cm + BUCKET_CM - 1) // BUCKET_CM]
+
+
+def ttc_cm(ttc_ms):
+    """
+    Return the distance as urgent as a time to collision.
+
+    Args:
+        ttc_ms (float): Time to collision in milliseconds.
+
+    Returns:
+        int: Distance in centimetres; MAX_CM beyond the curve.
+    """
+    bucket = int(ttc_ms) // TTC_BUCKET_MS
+    return TTC_CM[bucket] if 0 <= bucket < len(TTC_CM) else MAX_CM
@@ -0,0 +1,164 @@
+/**
+ * @file    bench.c
+ * @ingroup Host_Tests
+ * @brief   Runner of the host micro-benchmarks (bench.h).
+ */
+#include "bench.h"
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Most runs of one benchmark while raising the iterations */
+#define BENCH_MAX_RUNS      32u
+
+/** Most iterations of one run */
+#define BENCH_MAX_ITERATIONS    1000000000ull
+
+/** A registered benchmark */
+typedef struct
+{
+    char name[BENCH_NAME_MAX];
+    BenchFuncTypeDef func;
+    int32_t arg;
+} BenchEntryTypeDef;
+
+/** Benchmarks, in registration order */
+static BenchEntryTypeDef benchList[BENCH_MAX];
+static uint32_t benchCount;
+
+void Bench_Register(const char *name, BenchFuncTypeDef func)
+{
+    if (benchCount < BENCH_MAX)
+    {
+        snprintf(benchList[benchCount].name, BENCH_NAME_MAX, "%s", name);
+        benchList[benchCount].func = func;
+        benchList[benchCount].arg = 0;
+        benchCount++;
+    }
+}
+
+void Bench_RegisterArg(const char *name, BenchFuncTypeDef func, int32_t arg)
+{
+    if (benchCount < BENCH_MAX)
+    {
+        snprintf(benchList[benchCount].name, BENCH_NAME_MAX, "%s/%ld", name, (long)arg);
+        benchList[benchCount].func = func;
+        benchList[benchCount].arg = arg;
+        benchCount++;
+    }
+}
+
+void Bench_StartTimer(BenchStateTypeDef *state)
+{
+    clock_gettime(CLOCK_MONOTONIC, &state->wall0);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &state->cpu0);
+}
+
+/**
+ * @brief  Seconds from a start time to now on a clock.
+ * @param  clock Clock.
+ * @param  start Start time.
+ * @retval Elapsed time (s).
+ */
+static double Bench_Since(clockid_t clock, const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(clock, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+void Bench_StopTimer(BenchStateTypeDef *state)
+{
+    state->wall = Bench_Since(CLOCK_MONOTONIC, &state->wall0);
+    state->cpu = Bench_Since(CLOCK_PROCESS_CPUTIME_ID, &state->cpu0);
+}
+
+/**
+ * @brief Run a benchmark with more and more iterations until a run lasts
+ *        min_time, the way Google Benchmark does, then print it.
+ * @param entry    Benchmark.
+ * @param min_time Shortest run (s).
+ */
+static void Bench_Run(const BenchEntryTypeDef *entry, double min_time)
+{
+    BenchStateTypeDef state;
+    uint64_t iterations = 1;
+    double scale;
+    uint32_t run;
+
+    for (run = 0; run < BENCH_MAX_RUNS; run++)
+    {
+        memset(&state, 0, sizeof(state));
+        state.iterations = iterations;
+        state.left = iterations;
+        state.arg = entry->arg;
+        entry->func(&state);
+
+        if (state.wall >= min_time || iterations >= BENCH_MAX_ITERATIONS)
+            break;
+
+        /* Aim 40 % past the goal, at most ten times the iterations */
+        scale = (state.wall > 0.0) ? 1.4 * min_time / state.wall : 10.0;
+        if (scale > 10.0)
+            scale = 10.0;
+        iterations = (uint64_t)((double)iterations * scale) + 1u;
+        if (iterations > BENCH_MAX_ITERATIONS)
+            iterations = BENCH_MAX_ITERATIONS;
+    }
+
+    printf("%-32s %10.1f ns %10.1f ns %12llu\n", entry->name,
+           state.wall * 1e9 / (double)state.iterations, state.cpu * 1e9 / (double)state.iterations,
+           (unsigned long long)state.iterations);
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = ".";
+    double min_time = 0.5;
+    int list = 0;
+    regex_t re;
+    uint32_t i;
+    int a;
+
+    for (a = 1; a < argc; a++)
+    {
+        if (strncmp(argv[a], "--benchmark_filter=", 19) == 0)
+            filter = argv[a] + 19;
+        else if (strncmp(argv[a], "--benchmark_min_time=", 21) == 0)
+            min_time = atof(argv[a] + 21);
+        else if (strcmp(argv[a], "--benchmark_list_tests") == 0)
+            list = 1;
+        else
+        {
+            fprintf(stderr, "usage: %s [--benchmark_filter=<regex>] [--benchmark_min_time=<s>] "
+                    "[--benchmark_list_tests]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (regcomp(&re, filter, REG_EXTENDED | REG_NOSUB) != 0)
+    {
+        fprintf(stderr, "bad filter: %s\n", filter);
+        return 2;
+    }
+
+    if (!list)
+    {
+        printf("%-32s %13s %13s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+        printf("%.*s\n", 73, "-------------------------------------------------------------------------------");
+    }
+    for (i = 0; i < benchCount; i++)
+    {
+        if (regexec(&re, benchList[i].name, 0, NULL, 0) != 0)
+            continue;
+        if (list)
+            printf("%s\n", benchList[i].name);
+        else
+            Bench_Run(&benchList[i], min_time);
+    }
+
+    regfree(&re);
+    return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file    bench.h
+ * @ingroup Host_Tests
+ * @brief   Micro-benchmarks of the host build, after Google Benchmark.
+ *
+ * A benchmark is a function registered with BENCHMARK, with its set-up
+ * before and the code measured inside the Bench_KeepRunning loop:
+ *
+ *     BENCHMARK(BM_Something)
+ *     {
+ *         Setup();
+ *         while (Bench_KeepRunning(state))
+ *             BENCH_DO_NOT_OPTIMIZE(Something());
+ *     }
+ *
+ * A benchmark taking an argument, a window size for instance, reads it
+ * from state->arg and is registered once per value with BENCHMARK_ARG;
+ * it is named "<function>/<arg>".
+ *
+ * The runner (bench.c) raises the iterations until a run lasts
+ * --benchmark_min_time seconds and prints the wall and CPU time per
+ * iteration in the Google Benchmark table layout;
+ * --benchmark_filter=<regex> picks benchmarks by name and
+ * --benchmark_list_tests only lists them. Host times only rank changes
+ * against each other: the target's are the cycle counts of its reports.
+ */
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+/** Benchmarks a program can register */
+#define BENCH_MAX           32u
+
+/** Longest benchmark name, argument included */
+#define BENCH_NAME_MAX      48u
+
+/** State of one benchmark run */
+typedef struct
+{
+    uint64_t iterations;        /**< Iterations of the run */
+    uint64_t left;              /**< Iterations still to go */
+    int32_t arg;                /**< Argument of BENCHMARK_ARG, else 0 */
+    struct timespec wall0;      /**< Wall clock at the first iteration */
+    struct timespec cpu0;       /**< Process CPU time at the first iteration */
+    double wall;                /**< Wall time of the run (s) */
+    double cpu;                 /**< CPU time of the run (s) */
+} BenchStateTypeDef;
+
+/** A benchmark function */
+typedef void (*BenchFuncTypeDef)(BenchStateTypeDef *state);
+
+/**
+ * @brief Add a benchmark to the runner; called before main by BENCHMARK.
+ * @param name Name printed and filtered on.
+ * @param func Benchmark.
+ */
+void Bench_Register(const char *name, BenchFuncTypeDef func);
+
+/**
+ * @brief Add a benchmark run with an argument; called before main by
+ *        BENCHMARK_ARG.
+ * @param name Name of the function; "/<arg>" is appended.
+ * @param func Benchmark.
+ * @param arg  Value of state->arg.
+ */
+void Bench_RegisterArg(const char *name, BenchFuncTypeDef func, int32_t arg);
+
+/**
+ * @brief Start the clocks of a run.
+ * @param state Run.
+ */
+void Bench_StartTimer(BenchStateTypeDef *state);
+
+/**
+ * @brief Stop the clocks of a run.
+ * @param state Run.
+ */
+void Bench_StopTimer(BenchStateTypeDef *state);
+
+/**
+ * @brief  Loop condition of a benchmark: times from the first call to
+ *         the last.
+ * @param  state Run.
+ * @retval Non-zero while iterations are left.
+ */
+static inline int Bench_KeepRunning(BenchStateTypeDef *state)
+{
+    if (state->left == state->iterations)
+        Bench_StartTimer(state);
+    if (state->left != 0)
+    {
+        state->left--;
+        return 1;
+    }
+    Bench_StopTimer(state);
+    return 0;
+}
+
+/** Make the compiler produce a value it would otherwise drop */
+#define BENCH_DO_NOT_OPTIMIZE(value)    __asm__ volatile("" : : "r,m"(value) : "memory")
+
+/** Make the compiler assume any memory may have been read and written */
+#define BENCH_CLOBBER_MEMORY()          __asm__ volatile("" : : : "memory")
+
+/** Define and register a benchmark; the body sees the run as state */
+#define BENCHMARK(name) \
+    static void name(BenchStateTypeDef *state); \
+    __attribute__((constructor)) static void name##_Register(void) { Bench_Register(#name, name); } \
+    static void name(BenchStateTypeDef *state)
+
+/** Register a benchmark function, defined as "static void func(BenchStateTypeDef *state)",
+ *  with one argument */
+#define BENCHMARK_ARG(func, arg) \
+    __attribute__((constructor)) static void func##_Register_##arg(void) { Bench_RegisterArg(#func, func, arg); }
+
+#endif /* __BENCH_H */
@@ -0,0 +1,97 @@
+/**
+ * @file    bench_rx.c
+ * @ingroup Host_Tests
+ * @brief   Micro-benchmarks of the receiver: zone classification and its
+ *          indication, and the GUI frame formatting.
+ */
+#include "bench.h"
+#include "hal_mock.h"
+#include "zone_table.h"
+#include "zone_filter.h"
+#include "leds.h"
+#include "sevenseg.h"
+#include "frame.h"
+
+/** Table lookup alone */
+BENCHMARK(BM_ZoneLookup)
+{
+    uint8_t cm = 0;
+
+    while (Bench_KeepRunning(state))
+        BENCH_DO_NOT_OPTIMIZE(Zone_Lookup(cm++));
+}
+
+/** Classification of a distance sweep, hysteresis and dwell included,
+ *  and the LED bar of the zone */
+BENCHMARK(BM_ZoneClassify)
+{
+    ZoneFilterTypeDef filter;
+    uint32_t now = 0;
+    uint8_t cm = 0;
+    int8_t step = 1;
+
+    HostHal_Reset();
+    ZoneFilter_Init(&filter);
+    while (Bench_KeepRunning(state))
+    {
+        now += 60u;
+        ZoneFilter_Update(&filter, cm, now);
+        leds_Set(filter.entry->led_mask);
+        if (cm == 0)
+            step = 1;
+        else if (cm == 200u)
+            step = -1;
+        cm = (uint8_t)(cm + step);
+    }
+    BENCH_DO_NOT_OPTIMIZE(filter.entry);
+}
+
+/** Seven-segment digit, seven HAL pin writes */
+BENCHMARK(BM_SevenSegment)
+{
+    uint8_t digit = 0;
+
+    HostHal_Reset();
+    while (Bench_KeepRunning(state))
+    {
+        SevenSegment_Update(segmentNumber[digit]);
+        digit = (digit < 9u) ? (uint8_t)(digit + 1u) : 0u;
+    }
+}
+
+/** Two-sensor frame: serialise, CRC and COBS */
+BENCHMARK(BM_FrameEncode)
+{
+    FrameTypeDef frame = {0};
+    uint8_t out[FRAME_MAX_ENCODED];
+
+    frame.count = 2;
+    frame.distance_mm[0] = 1230;
+    frame.distance_mm[1] = 880;
+    frame.closing_mm_s[0] = 150;
+    frame.age_ms[0] = 48;
+    frame.age_ms[1] = 64;
+    frame.forward_mm = FRAME_NO_POSITION;
+    while (Bench_KeepRunning(state))
+    {
+        frame.seq++;
+        frame.timestamp += 60u;
+        BENCH_DO_NOT_OPTIMIZE(Frame_Encode(&frame, out));
+        BENCH_CLOBBER_MEMORY();
+    }
+}
+
+/** CRC of a largest frame */
+BENCHMARK(BM_FrameCrc16)
+{
+    uint8_t raw[FRAME_MAX_RAW];
+    uint8_t i;
+
+    for (i = 0; i < sizeof(raw); i++)
+        raw[i] = (uint8_t)(i * 13u);
+    while (Bench_KeepRunning(state))
+    {
+        BENCH_DO_NOT_OPTIMIZE(Frame_Crc16(raw, sizeof(raw)));
+        BENCH_CLOBBER_MEMORY();
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ * @file    bench_tx.c
+ * @ingroup Host_Tests
+ * @brief   Micro-benchmarks of the transmitter: echo capture, distance
+ *          conversion, the running median and the CAN and report
+ *          formatting.
+ */
+#include "bench.h"
+#include "hal_mock.h"
+#include "usensor.h"
+#include "echo_range.h"
+#include "app_tasks.h"
+#include "median_filter.h"
+#include "median_sort.h"
+
+/** Readings the median benchmarks slide over (power of two) */
+#define MEDIAN_READINGS     1024u
+
+/** One echo of sensor 0: rising then falling edge through the callback */
+BENCHMARK(BM_CaptureEcho)
+{
+    uint32_t width = 1000;
+
+    HostHal_Reset();
+    htim1.Channel = HAL_TIM_ACTIVE_CHANNEL_1;
+    while (Bench_KeepRunning(state))
+    {
+        TIM1->CCR1 = 100;
+        USensor_TIM_IC_Callback(&htim1);
+        TIM1->CCR1 = 100 + width;
+        USensor_TIM_IC_Callback(&htim1);
+        width = (width + 97u) & 0x3FFFu;
+    }
+    htim1.Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+    BENCH_DO_NOT_OPTIMIZE(Distance[0]);
+}
+
+/** Pulse width to centimetres, over the whole counter range */
+BENCHMARK(BM_WidthToCm)
+{
+    uint32_t width = 0;
+
+    while (Bench_KeepRunning(state))
+    {
+        BENCH_DO_NOT_OPTIMIZE(Echo_WidthToCm(width));
+        width = (width + 37u) & 0xFFFFu;
+    }
+}
+
+/**
+ * @brief Fill readings of a noisy approach with missed echoes and spikes.
+ * @param readings MEDIAN_READINGS samples.
+ */
+static void MedianReadings(uint8_t *readings)
+{
+    uint32_t r = 0x12345678u;
+    uint32_t i;
+
+    for (i = 0; i < MEDIAN_READINGS; i++)
+    {
+        r = r * 1664525u + 1013904223u;
+        readings[i] = (uint8_t)(250u - i * 200u / MEDIAN_READINGS + ((r >> 24) & 3u));
+        if ((r >> 16) % 20u == 0)
+            readings[i] = USENSOR_NO_ECHO;
+        else if ((r >> 16) % 20u == 1)
+            readings[i] /= 2u;
+    }
+}
+
+/** Running median, sorted window kept up to date (MEDIAN_FILTER_SORTED=1) */
+static void BM_MedianSorted(BenchStateTypeDef *state)
+{
+    static uint8_t readings[MEDIAN_READINGS];
+    MedianFilterTypeDef filter;
+    uint32_t i = 0;
+
+    MedianReadings(readings);
+    MedianFilter_Init(&filter, (uint8_t)state->arg, readings[0]);
+    while (Bench_KeepRunning(state))
+    {
+        BENCH_DO_NOT_OPTIMIZE(MedianFilter_Update(&filter, readings[i]));
+        i = (i + 1u) & (MEDIAN_READINGS - 1u);
+    }
+}
+BENCHMARK_ARG(BM_MedianSorted, 3)
+BENCHMARK_ARG(BM_MedianSorted, 5)
+BENCHMARK_ARG(BM_MedianSorted, 9)
+
+/** Running median, whole window sorted per sample (MEDIAN_FILTER_SORTED=0) */
+static void BM_MedianSort(BenchStateTypeDef *state)
+{
+    static uint8_t readings[MEDIAN_READINGS];
+    MedianFilterTypeDef filter;
+    uint32_t i = 0;
+
+    MedianReadings(readings);
+    MedianFilterSort_Init(&filter, (uint8_t)state->arg, readings[0]);
+    while (Bench_KeepRunning(state))
+    {
+        BENCH_DO_NOT_OPTIMIZE(MedianFilterSort_Update(&filter, readings[i]));
+        i = (i + 1u) & (MEDIAN_READINGS - 1u);
+    }
+}
+BENCHMARK_ARG(BM_MedianSort, 3)
+BENCHMARK_ARG(BM_MedianSort, 5)
+BENCHMARK_ARG(BM_MedianSort, 9)
+
+/** CAN slot: classify, filter, trilaterate and queue both frames */
+BENCHMARK(BM_SendDistances)
+{
+    uint32_t tick = 0;
+    uint8_t cm = 40;
+
+    HostHal_Reset();
+    while (Bench_KeepRunning(state))
+    {
+        tick += 60u;
+        HostHal_SetTick(tick);
+        Distance[0] = cm;
+        Distance[1] = (uint8_t)(cm + 10u);
+        DistanceTick[0] = tick;
+        DistanceTick[1] = tick;
+        Tx_SendDistances();
+        cm = (cm < 200u) ? (uint8_t)(cm + 1u) : 40u;
+    }
+}
+
+/** Report slot: the next diagnostic line, a report cycle in turn */
+BENCHMARK(BM_Report)
+{
+    HostHal_Reset();
+    while (Bench_KeepRunning(state))
+        Tx_Report();
+    BENCH_DO_NOT_OPTIMIZE(HostHal_UartBytes());
+}
@@ -0,0 +1,44 @@
+/**
+ * @file    check.h
+ * @ingroup Host_Tests
+ * @brief   Assertions of the host unit tests.
+ *
+ * A test file is a list of static test functions run by CHECK_RUN from
+ * main; a failed check prints where and goes on, so one run lists every
+ * failure. main returns CHECK_RESULT(), non-zero if any check failed.
+ */
+#ifndef __CHECK_H
+#define __CHECK_H
+
+#include <stdio.h>
+#include <string.h>
+
+/** Checks failed so far, in the whole test file */
+static unsigned checkFailures;
+
+/** Check a condition */
+#define CHECK(cond) \
+    do { if (!(cond)) { checkFailures++; \
+        printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); } } while (0)
+
+/** Check two integers are equal */
+#define CHECK_EQ(actual, expected) \
+    do { long long a_ = (long long)(actual), e_ = (long long)(expected); \
+        if (a_ != e_) { checkFailures++; \
+        printf("  %s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); } } while (0)
+
+/** Check a string is equal to the expected one */
+#define CHECK_STR(actual, expected) \
+    do { const char *a_ = (actual), *e_ = (expected); \
+        if (strcmp(a_, e_) != 0) { checkFailures++; \
+        printf("  %s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, a_, e_); } } while (0)
+
+/** Run a test function and report it */
+#define CHECK_RUN(test) \
+    do { unsigned before_ = checkFailures; test(); \
+        printf("%-40s %s\n", #test, checkFailures == before_ ? "ok" : "FAIL"); } while (0)
+
+/** Exit status of the test file */
+#define CHECK_RESULT()  (checkFailures ? 1 : 0)
+
+#endif /* __CHECK_H */
@@ -0,0 +1,21 @@
+/**
+ * @file    median_sort.h
+ * @ingroup Host_Tests
+ * @brief   The naive build of median_filter.c (MEDIAN_FILTER_SORTED=0).
+ *
+ * CMakeLists.txt compiles median_filter.c a second time with the sort of
+ * the whole window per sample and its functions renamed, so both builds
+ * link into one test or benchmark; they share MedianFilterTypeDef.
+ */
+#ifndef __MEDIAN_SORT_H
+#define __MEDIAN_SORT_H
+
+#include "median_filter.h"
+
+/** MedianFilter_Init of the naive build */
+void MedianFilterSort_Init(MedianFilterTypeDef *filter, uint8_t size, uint8_t value);
+
+/** MedianFilter_Update of the naive build */
+uint8_t MedianFilterSort_Update(MedianFilterTypeDef *filter, uint8_t value);
+
+#endif /* __MEDIAN_SORT_H */
@@ -0,0 +1,42 @@
+/**
+ * @file    cmsis_nvic_virtual.h
+ * @ingroup Host_Tests
+ * @brief   NVIC functions of the host build (CMSIS_NVIC_VIRTUAL).
+ *
+ * The inline NVIC functions of core_cm3.h are expanded with the target
+ * register addresses; these, in hal_mock.c, work on the host registers.
+ * NVIC_SystemReset only counts the resets (hostResets).
+ */
+#ifndef __HOST_CMSIS_NVIC_VIRTUAL_H
+#define __HOST_CMSIS_NVIC_VIRTUAL_H
+
+#define NVIC_SetPriorityGrouping    HostNvic_SetPriorityGrouping
+#define NVIC_GetPriorityGrouping    HostNvic_GetPriorityGrouping
+#define NVIC_EnableIRQ              HostNvic_EnableIRQ
+#define NVIC_GetEnableIRQ           HostNvic_GetEnableIRQ
+#define NVIC_DisableIRQ             HostNvic_DisableIRQ
+#define NVIC_GetPendingIRQ          HostNvic_GetPendingIRQ
+#define NVIC_SetPendingIRQ          HostNvic_SetPendingIRQ
+#define NVIC_ClearPendingIRQ        HostNvic_ClearPendingIRQ
+#define NVIC_GetActive              HostNvic_GetActive
+#define NVIC_SetPriority            HostNvic_SetPriority
+#define NVIC_GetPriority            HostNvic_GetPriority
+#define NVIC_SystemReset            HostNvic_SystemReset
+
+/** Resets requested with NVIC_SystemReset */
+extern volatile uint32_t hostResets;
+
+void     HostNvic_SetPriorityGrouping(uint32_t PriorityGroup);
+uint32_t HostNvic_GetPriorityGrouping(void);
+void     HostNvic_EnableIRQ(IRQn_Type IRQn);
+uint32_t HostNvic_GetEnableIRQ(IRQn_Type IRQn);
+void     HostNvic_DisableIRQ(IRQn_Type IRQn);
+uint32_t HostNvic_GetPendingIRQ(IRQn_Type IRQn);
+void     HostNvic_SetPendingIRQ(IRQn_Type IRQn);
+void     HostNvic_ClearPendingIRQ(IRQn_Type IRQn);
+uint32_t HostNvic_GetActive(IRQn_Type IRQn);
+void     HostNvic_SetPriority(IRQn_Type IRQn, uint32_t priority);
+uint32_t HostNvic_GetPriority(IRQn_Type IRQn);
+void     HostNvic_SystemReset(void);
+
+#endif /* __HOST_CMSIS_NVIC_VIRTUAL_H */
@@ -0,0 +1,15 @@
+/**
+ * @file    cmsis_os.h
+ * @ingroup Host_Tests
+ * @brief   CMSIS-RTOS of the host build: the v2 API without the kernel.
+ *
+ * The FreeRTOS port of the nodes (RVDS/ARM_CM3) is armcc assembly, so the
+ * host build only declares the CMSIS-RTOS v2 API; the few calls the
+ * modules under test make are the stubs of the node stub files.
+ */
+#ifndef __HOST_CMSIS_OS_H
+#define __HOST_CMSIS_OS_H
+
+#include "cmsis_os2.h"
+
+#endif /* __HOST_CMSIS_OS_H */
@@ -0,0 +1,108 @@
+/**
+ * @file    core_cm3.h
+ * @ingroup Host_Tests
+ * @brief   Cortex-M3 core of the host build.
+ *
+ * Found before Drivers/CMSIS/Include by the device header and arm_math.h,
+ * it includes the real core_cm3.h, with the register layouts, attributes
+ * and C intrinsics of cmsis_gcc.h, except for what only the target has:
+ *   - the interrupt mask, IPSR and the barriers, Cortex-M instructions,
+ *     are plain C on the state kept by hal_mock.c;
+ *   - the core peripherals (SCB, NVIC, SysTick, DWT, CoreDebug) are
+ *     register blocks in host memory;
+ *   - the NVIC functions are those of hal_mock.c, on the host registers,
+ *     through the CMSIS_NVIC_VIRTUAL hook (cmsis_nvic_virtual.h).
+ */
+#include <stdint.h>
+
+#define CMSIS_NVIC_VIRTUAL
+
+#ifndef __HOST_CORE_CM3_H_GENERIC
+#define __HOST_CORE_CM3_H_GENERIC
+
+/* Keep the target versions out of the way; never emitted, as unused */
+#define __enable_irq    __target_enable_irq
+#define __disable_irq   __target_disable_irq
+#define __get_IPSR      __target_get_IPSR
+#define __get_PRIMASK   __target_get_PRIMASK
+#define __set_PRIMASK   __target_set_PRIMASK
+#define __ISB           __target_ISB
+#define __DSB           __target_DSB
+#define __DMB           __target_DMB
+
+#include_next "core_cm3.h"
+
+#undef __enable_irq
+#undef __disable_irq
+#undef __get_IPSR
+#undef __get_PRIMASK
+#undef __set_PRIMASK
+#undef __ISB
+#undef __DSB
+#undef __DMB
+#undef __NOP
+#undef __WFI
+#undef __WFE
+#undef __SEV
+#undef __BKPT
+
+/* ---------------------------------------------------------------------------
+ * Core registers
+ * ---------------------------------------------------------------------------*/
+
+/** PRIMASK of the host core, 1 while interrupts are masked */
+extern volatile uint32_t hostPrimask;
+
+/** IPSR of the host core, the exception being "handled" (0: thread) */
+extern volatile uint32_t hostIpsr;
+
+/** Sleeps (WFI) entered on the host core */
+extern volatile uint32_t hostSleeps;
+
+static inline void __enable_irq(void)            { hostPrimask = 0; }
+static inline void __disable_irq(void)           { hostPrimask = 1; }
+static inline uint32_t __get_PRIMASK(void)       { return hostPrimask; }
+static inline void __set_PRIMASK(uint32_t mask)  { hostPrimask = mask; }
+static inline uint32_t __get_IPSR(void)          { return hostIpsr; }
+static inline void __ISB(void)                   { __sync_synchronize(); }
+static inline void __DSB(void)                   { __sync_synchronize(); }
+static inline void __DMB(void)                   { __sync_synchronize(); }
+
+#define __NOP()         ((void)0)
+#define __WFI()         ((void)hostSleeps++)
+#define __WFE()         ((void)0)
+#define __SEV()         ((void)0)
+#define __BKPT(value)   ((void)(value))
+
+#else
+/* The device header after arm_math.h: the register part of the real one */
+#include_next "core_cm3.h"
+#endif /* __HOST_CORE_CM3_H_GENERIC */
+
+/* ---------------------------------------------------------------------------
+ * Core peripherals in host memory; arm_math.h only includes the generic
+ * part of core_cm3.h (__CMSIS_GENERIC), without the register layouts
+ * ---------------------------------------------------------------------------*/
+
+#if !defined(__CMSIS_GENERIC) && !defined(__HOST_CORE_CM3_H_DEPENDANT)
+#define __HOST_CORE_CM3_H_DEPENDANT
+
+extern SCB_Type       hostSCB;
+extern NVIC_Type      hostNVIC;
+extern SysTick_Type   hostSysTick;
+extern DWT_Type       hostDWT;
+extern CoreDebug_Type hostCoreDebug;
+
+#undef SCB
+#undef NVIC
+#undef SysTick
+#undef DWT
+#undef CoreDebug
+
+#define SCB         (&hostSCB)
+#define NVIC        (&hostNVIC)
+#define SysTick     (&hostSysTick)
+#define DWT         (&hostDWT)
+#define CoreDebug   (&hostCoreDebug)
+
+#endif /* __HOST_CORE_CM3_H_DEPENDANT */
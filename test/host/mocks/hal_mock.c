@@ -0,0 +1,293 @@
+/**
+ * @file    hal_mock.c
+ * @ingroup Host_Tests
+ * @brief   Host registers and HAL function mocks.
+ */
+#include "hal_mock.h"
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ * Host core and peripheral registers
+ * ---------------------------------------------------------------------------*/
+
+volatile uint32_t hostPrimask;
+volatile uint32_t hostIpsr;
+volatile uint32_t hostSleeps;
+volatile uint32_t hostResets;
+
+GPIO_TypeDef   hostGPIOA;
+GPIO_TypeDef   hostGPIOB;
+GPIO_TypeDef   hostGPIOC;
+TIM_TypeDef    hostTIM1;
+TIM_TypeDef    hostTIM2;
+TIM_TypeDef    hostTIM3;
+CAN_TypeDef    hostCAN1;
+USART_TypeDef  hostUSART2;
+IWDG_TypeDef   hostIWDG;
+ADC_TypeDef    hostADC1;
+SCB_Type       hostSCB;
+NVIC_Type      hostNVIC;
+SysTick_Type   hostSysTick;
+DWT_Type       hostDWT;
+CoreDebug_Type hostCoreDebug;
+
+uint32_t SystemCoreClock = 72000000u;
+
+/* ---------------------------------------------------------------------------
+ * Mock state
+ * ---------------------------------------------------------------------------*/
+
+/** Value returned by HAL_GetTick */
+static uint32_t hostTick;
+
+/** HAL_GPIO_WritePin log */
+static HostGpioWriteTypeDef hostGpioLog[HOST_LOG_ENTRIES];
+static uint32_t hostGpioCount;
+
+/** HAL_CAN_AddTxMessage log and result */
+static HostCanFrameTypeDef hostCanLog[HOST_LOG_ENTRIES];
+static uint32_t hostCanCount;
+static HAL_StatusTypeDef hostCanStatus;
+
+/** HAL_UART_Transmit output */
+static char hostUartLine[HOST_UART_LINE_MAX];
+static uint32_t hostUartBytes;
+
+void HostHal_Reset(void)
+{
+    hostPrimask = 0;
+    hostIpsr = 0;
+    hostSleeps = 0;
+    hostResets = 0;
+    memset(&hostGPIOA, 0, sizeof(hostGPIOA));
+    memset(&hostGPIOB, 0, sizeof(hostGPIOB));
+    memset(&hostGPIOC, 0, sizeof(hostGPIOC));
+    memset(&hostTIM1, 0, sizeof(hostTIM1));
+    memset(&hostTIM2, 0, sizeof(hostTIM2));
+    memset(&hostTIM3, 0, sizeof(hostTIM3));
+    memset(&hostCAN1, 0, sizeof(hostCAN1));
+    memset(&hostUSART2, 0, sizeof(hostUSART2));
+    memset(&hostIWDG, 0, sizeof(hostIWDG));
+    memset(&hostADC1, 0, sizeof(hostADC1));
+    memset(&hostSCB, 0, sizeof(hostSCB));
+    memset(&hostNVIC, 0, sizeof(hostNVIC));
+    memset(&hostSysTick, 0, sizeof(hostSysTick));
+    memset(&hostDWT, 0, sizeof(hostDWT));
+    memset(&hostCoreDebug, 0, sizeof(hostCoreDebug));
+
+    hostTick = 0;
+    hostGpioCount = 0;
+    hostCanCount = 0;
+    hostCanStatus = HAL_OK;
+    hostUartLine[0] = '\0';
+    hostUartBytes = 0;
+}
+
+void HostHal_SetTick(uint32_t ms)
+{
+    hostTick = ms;
+}
+
+uint32_t HostHal_GpioWrites(void)
+{
+    return hostGpioCount;
+}
+
+const HostGpioWriteTypeDef *HostHal_GpioWrite(uint32_t back)
+{
+    if (back >= hostGpioCount || back >= HOST_LOG_ENTRIES)
+        return NULL;
+    return &hostGpioLog[(hostGpioCount - 1u - back) & (HOST_LOG_ENTRIES - 1u)];
+}
+
+void HostHal_SetCanStatus(HAL_StatusTypeDef status)
+{
+    hostCanStatus = status;
+}
+
+uint32_t HostHal_CanFrames(void)
+{
+    return hostCanCount;
+}
+
+const HostCanFrameTypeDef *HostHal_CanFrame(uint32_t back)
+{
+    if (back >= hostCanCount || back >= HOST_LOG_ENTRIES)
+        return NULL;
+    return &hostCanLog[(hostCanCount - 1u - back) & (HOST_LOG_ENTRIES - 1u)];
+}
+
+uint32_t HostHal_UartBytes(void)
+{
+    return hostUartBytes;
+}
+
+const char *HostHal_UartLine(void)
+{
+    return hostUartLine;
+}
+
+/* ---------------------------------------------------------------------------
+ * NVIC on the host registers, as in core_cm3.h
+ * ---------------------------------------------------------------------------*/
+
+void HostNvic_SetPriorityGrouping(uint32_t PriorityGroup)
+{
+    SCB->AIRCR = (SCB->AIRCR & ~(SCB_AIRCR_VECTKEY_Msk | SCB_AIRCR_PRIGROUP_Msk)) |
+                 ((PriorityGroup & 0x07u) << SCB_AIRCR_PRIGROUP_Pos);
+}
+
+uint32_t HostNvic_GetPriorityGrouping(void)
+{
+    return (SCB->AIRCR & SCB_AIRCR_PRIGROUP_Msk) >> SCB_AIRCR_PRIGROUP_Pos;
+}
+
+void HostNvic_EnableIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)IRQn >= 0)
+        NVIC->ISER[(uint32_t)IRQn >> 5] |= 1u << ((uint32_t)IRQn & 0x1Fu);
+}
+
+uint32_t HostNvic_GetEnableIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)IRQn < 0)
+        return 0;
+    return (NVIC->ISER[(uint32_t)IRQn >> 5] >> ((uint32_t)IRQn & 0x1Fu)) & 1u;
+}
+
+void HostNvic_DisableIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)IRQn >= 0)
+        NVIC->ISER[(uint32_t)IRQn >> 5] &= ~(1u << ((uint32_t)IRQn & 0x1Fu));
+}
+
+uint32_t HostNvic_GetPendingIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)IRQn < 0)
+        return 0;
+    return (NVIC->ISPR[(uint32_t)IRQn >> 5] >> ((uint32_t)IRQn & 0x1Fu)) & 1u;
+}
+
+void HostNvic_SetPendingIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)IRQn >= 0)
+        NVIC->ISPR[(uint32_t)IRQn >> 5] |= 1u << ((uint32_t)IRQn & 0x1Fu);
+}
+
+void HostNvic_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)IRQn >= 0)
+        NVIC->ISPR[(uint32_t)IRQn >> 5] &= ~(1u << ((uint32_t)IRQn & 0x1Fu));
+}
+
+uint32_t HostNvic_GetActive(IRQn_Type IRQn)
+{
+    if ((int32_t)IRQn < 0)
+        return 0;
+    return (NVIC->IABR[(uint32_t)IRQn >> 5] >> ((uint32_t)IRQn & 0x1Fu)) & 1u;
+}
+
+void HostNvic_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    uint8_t value = (uint8_t)((priority << (8u - __NVIC_PRIO_BITS)) & 0xFFu);
+
+    if ((int32_t)IRQn >= 0)
+        NVIC->IP[(uint32_t)IRQn] = value;
+    else
+        SCB->SHP[((uint32_t)IRQn & 0xFu) - 4u] = value;
+}
+
+uint32_t HostNvic_GetPriority(IRQn_Type IRQn)
+{
+    if ((int32_t)IRQn >= 0)
+        return (uint32_t)NVIC->IP[(uint32_t)IRQn] >> (8u - __NVIC_PRIO_BITS);
+    return (uint32_t)SCB->SHP[((uint32_t)IRQn & 0xFu) - 4u] >> (8u - __NVIC_PRIO_BITS);
+}
+
+void HostNvic_SystemReset(void)
+{
+    hostResets++;
+}
+
+/* ---------------------------------------------------------------------------
+ * HAL mocks
+ * ---------------------------------------------------------------------------*/
+
+uint32_t HostHal_TimCount(TIM_TypeDef *tim)
+{
+    uint32_t count = tim->CNT;
+
+    tim->CNT = (count + 1u) & 0xFFFFu;
+    return count;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return hostTick;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    HostGpioWriteTypeDef *entry = &hostGpioLog[hostGpioCount++ & (HOST_LOG_ENTRIES - 1u)];
+
+    entry->port = GPIOx;
+    entry->pin = GPIO_Pin;
+    entry->state = PinState;
+
+    if (PinState != GPIO_PIN_RESET)
+        GPIOx->ODR |= GPIO_Pin;
+    else
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+uint32_t HAL_TIM_ReadCapturedValue(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    switch (Channel)
+    {
+    case TIM_CHANNEL_1: return htim->Instance->CCR1;
+    case TIM_CHANNEL_2: return htim->Instance->CCR2;
+    case TIM_CHANNEL_3: return htim->Instance->CCR3;
+    case TIM_CHANNEL_4: return htim->Instance->CCR4;
+    default:            return 0;
+    }
+}
+
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan, CAN_TxHeaderTypeDef *pHeader,
+                                       uint8_t aData[], uint32_t *pTxMailbox)
+{
+    HostCanFrameTypeDef *frame;
+
+    (void)hcan;
+    if (hostCanStatus != HAL_OK)
+        return hostCanStatus;
+
+    frame = &hostCanLog[hostCanCount++ & (HOST_LOG_ENTRIES - 1u)];
+    frame->header = *pHeader;
+    memcpy(frame->data, aData, (pHeader->DLC <= 8u) ? pHeader->DLC : 8u);
+    *pTxMailbox = CAN_TX_MAILBOX0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout)
+{
+    uint16_t n = (Size < HOST_UART_LINE_MAX) ? Size : (uint16_t)(HOST_UART_LINE_MAX - 1u);
+
+    (void)huart;
+    (void)Timeout;
+    memcpy(hostUartLine, pData, n);
+    hostUartLine[n] = '\0';
+    hostUartBytes += Size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef *hiwdg)
+{
+    (void)hiwdg;
+    return HAL_OK;
+}
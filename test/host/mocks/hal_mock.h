@@ -0,0 +1,99 @@
+/**
+ * @file    hal_mock.h
+ * @ingroup Host_Tests
+ * @brief   Control and inspection of the host HAL mocks.
+ *
+ * The mocks stand in for the HAL functions the modules call:
+ *   - GPIO: HAL_GPIO_WritePin applies the write to the ODR of the host
+ *     port and logs it; direct BSRR writes stay in the register;
+ *   - TIM: the capture registers are those of the host timers, so a test
+ *     sets CCR1 and raises the callback as the HAL IRQ handler would;
+ *     the counters advance one count per read (HostHal_TimCount);
+ *   - CAN: HAL_CAN_AddTxMessage logs the frames, or fails on request;
+ *   - UART: HAL_UART_Transmit keeps the last line and counts the bytes;
+ *   - tick: HAL_GetTick returns what the test set.
+ * The logs are rings, so a benchmark can call the modules for ever. The
+ * core registers and NVIC are those of core_cm3.h and cmsis_nvic_virtual.h.
+ */
+#ifndef __HAL_MOCK_H
+#define __HAL_MOCK_H
+
+#include <stm32f1xx_hal.h>  /* the mock, found on the include path */
+
+/** Entries kept by the GPIO and CAN logs (power of two) */
+#define HOST_LOG_ENTRIES    64u
+
+/** Longest UART line kept */
+#define HOST_UART_LINE_MAX  128u
+
+/** One HAL_GPIO_WritePin call */
+typedef struct
+{
+    GPIO_TypeDef  *port;        /**< Port written */
+    uint16_t       pin;         /**< GPIO_PIN_* mask */
+    GPIO_PinState  state;       /**< Level written */
+} HostGpioWriteTypeDef;
+
+/** One frame queued with HAL_CAN_AddTxMessage */
+typedef struct
+{
+    CAN_TxHeaderTypeDef header; /**< Header as passed */
+    uint8_t             data[8];/**< Payload, DLC bytes valid */
+} HostCanFrameTypeDef;
+
+/**
+ * @brief Clear the host registers, the logs and the tick.
+ */
+void HostHal_Reset(void);
+
+/**
+ * @brief Set the value HAL_GetTick returns.
+ * @param ms Tick (ms).
+ */
+void HostHal_SetTick(uint32_t ms);
+
+/**
+ * @brief  Number of HAL_GPIO_WritePin calls since the reset.
+ * @retval Count, of which the last HOST_LOG_ENTRIES are kept.
+ */
+uint32_t HostHal_GpioWrites(void);
+
+/**
+ * @brief  A logged HAL_GPIO_WritePin call.
+ * @param  back 0 for the last call, 1 for the one before, ...
+ * @retval Call, or NULL past the calls kept.
+ */
+const HostGpioWriteTypeDef *HostHal_GpioWrite(uint32_t back);
+
+/**
+ * @brief Make the following HAL_CAN_AddTxMessage calls fail or succeed.
+ * @param status Status to return.
+ */
+void HostHal_SetCanStatus(HAL_StatusTypeDef status);
+
+/**
+ * @brief  Number of frames queued since the reset.
+ * @retval Count, of which the last HOST_LOG_ENTRIES are kept.
+ */
+uint32_t HostHal_CanFrames(void);
+
+/**
+ * @brief  A logged frame.
+ * @param  back 0 for the last frame, 1 for the one before, ...
+ * @retval Frame, or NULL past the frames kept.
+ */
+const HostCanFrameTypeDef *HostHal_CanFrame(uint32_t back);
+
+/**
+ * @brief  Number of bytes sent on a UART since the reset.
+ * @retval Bytes.
+ */
+uint32_t HostHal_UartBytes(void);
+
+/**
+ * @brief  Last line sent on a UART.
+ * @retval NUL-terminated line, truncated to HOST_UART_LINE_MAX - 1.
+ */
+const char *HostHal_UartLine(void);
+
+#endif /* __HAL_MOCK_H */
@@ -0,0 +1,72 @@
+/**
+ * @file    stm32f1xx_hal.h
+ * @ingroup Host_Tests
+ * @brief   HAL of the host build: the real declarations, host registers.
+ *
+ * Found before Drivers/STM32F1xx_HAL_Driver/Inc, it includes the real HAL
+ * header, so handles, register layouts and the __HAL_* macros are those
+ * of the target, then points the peripherals the nodes use at register
+ * blocks in host memory (hal_mock.c); the core ones are remapped by
+ * core_cm3.h. The HAL functions themselves are the mocks of hal_mock.c.
+ */
+#ifndef __HOST_STM32F1XX_HAL_H
+#define __HOST_STM32F1XX_HAL_H
+
+#include_next "stm32f1xx_hal.h"
+
+/* ---------------------------------------------------------------------------
+ * Peripherals in host memory
+ * ---------------------------------------------------------------------------*/
+
+extern GPIO_TypeDef   hostGPIOA;
+extern GPIO_TypeDef   hostGPIOB;
+extern GPIO_TypeDef   hostGPIOC;
+extern TIM_TypeDef    hostTIM1;
+extern TIM_TypeDef    hostTIM2;
+extern TIM_TypeDef    hostTIM3;
+extern CAN_TypeDef    hostCAN1;
+extern USART_TypeDef  hostUSART2;
+extern IWDG_TypeDef   hostIWDG;
+extern ADC_TypeDef    hostADC1;
+
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef TIM1
+#undef TIM2
+#undef TIM3
+#undef CAN1
+#undef USART2
+#undef IWDG
+#undef ADC1
+
+#define GPIOA       (&hostGPIOA)
+#define GPIOB       (&hostGPIOB)
+#define GPIOC       (&hostGPIOC)
+#define TIM1        (&hostTIM1)
+#define TIM2        (&hostTIM2)
+#define TIM3        (&hostTIM3)
+#define CAN1        (&hostCAN1)
+#define USART2      (&hostUSART2)
+#define IWDG        (&hostIWDG)
+#define ADC1        (&hostADC1)
+
+/* ---------------------------------------------------------------------------
+ * Timers count on reads
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief  Read a host timer counter, then advance it one count, as if a
+ *         microsecond passed between reads; busy-waits on it end.
+ * @param  tim Timer.
+ * @retval Counter before the advance.
+ */
+uint32_t HostHal_TimCount(TIM_TypeDef *tim);
+
+#undef __HAL_TIM_GET_COUNTER
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)   HostHal_TimCount((__HANDLE__)->Instance)
+
+/** Core clock of the nodes (Hz), set by SystemClock_Config on the target */
+extern uint32_t SystemCoreClock;
+
+#endif /* __HOST_STM32F1XX_HAL_H */
@@ -0,0 +1,124 @@
+/**
+ * @file    tx_node_stubs.c
+ * @ingroup Host_Tests
+ * @brief   What the transmitter modules under test take from main.c and
+ *          from the RTOS-bound modules left out of the host build.
+ *
+ * The peripheral handles point at the host registers of hal_mock.c. The
+ * reports of the kernel-bound modules (CPU load, stacks, idle sleep) are
+ * fixed lines naming the module, so a test can tell which report a cycle
+ * wrote; the schedule statistics are hostTtStats, set by the test.
+ */
+#include "app_tasks.h"
+#include "cpu_stats.h"
+#include "stack_mon.h"
+#include "tickless.h"
+#include "tt_sched.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "tx_node_stubs.h"
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ * main.c
+ * ---------------------------------------------------------------------------*/
+
+TIM_HandleTypeDef htim1 = { .Instance = TIM1 };
+TIM_HandleTypeDef htim2 = { .Instance = TIM2 };
+CAN_HandleTypeDef hcan = { .Instance = CAN1 };
+UART_HandleTypeDef huart2 = { .Instance = USART2 };
+IWDG_HandleTypeDef hiwdg = { .Instance = IWDG };
+#ifdef HAL_ADC_MODULE_ENABLED
+ADC_HandleTypeDef hadc1 = { .Instance = ADC1 };
+#endif
+
+CAN_TxHeaderTypeDef TxHeader = {
+    .StdId = 0x103, .IDE = CAN_ID_STD, .RTR = CAN_RTR_DATA, .DLC = TX_CAN_DLC
+};
+CAN_FilterTypeDef canfilterconfig;
+uint32_t TxMailbox;
+uint8_t TxData[8];
+
+uint8_t Distance[USENSOR_COUNT];
+uint32_t DistanceTick[USENSOR_COUNT];
+
+void MX_Deferred_Init(void)
+{
+}
+
+void Error_Handler(void)
+{
+}
+
+/* ---------------------------------------------------------------------------
+ * Kernel-bound modules
+ * ---------------------------------------------------------------------------*/
+
+TtStatsTypeDef hostTtStats;
+
+/**
+ * @brief  Write a fixed report line.
+ * @param  line NUL-terminated line.
+ * @param  buf  Output buffer.
+ * @retval Number of characters written.
+ */
+static uint16_t Host_Line(const char *line, char *buf)
+{
+    uint16_t n = (uint16_t)strlen(line);
+
+    memcpy(buf, line, n);
+    return n;
+}
+
+uint16_t CpuStats_Format(char *buf)
+{
+    return Host_Line("CPU,host\r\n", buf);
+}
+
+uint16_t StackMon_Format(char *buf)
+{
+    return Host_Line("STK,host\r\n", buf);
+}
+
+void StackMon_RegisterKernelTasks(void)
+{
+}
+
+uint8_t StackMon_Sample(void)
+{
+    return 0;
+}
+
+uint16_t Tickless_Format(char *buf)
+{
+    return Host_Line("PWR,host\r\n", buf);
+}
+
+const CrashRecordTypeDef *Crash_GetLast(void)
+{
+    return NULL;
+}
+
+uint16_t Crash_Format(char *buf)
+{
+    return Host_Line("CRASH,host\r\n", buf);
+}
+
+void Watchdog_Supervise(void)
+{
+}
+
+void Watchdog_Checkin(void)
+{
+}
+
+const TtStatsTypeDef *TtSched_GetStats(void)
+{
+    return &hostTtStats;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    (void)ticks;
+    return osOK;
+}
@@ -0,0 +1,14 @@
+/**
+ * @file    tx_node_stubs.h
+ * @ingroup Host_Tests
+ * @brief   Control of the transmitter stubs.
+ */
+#ifndef __TX_NODE_STUBS_H
+#define __TX_NODE_STUBS_H
+
+#include "tt_sched.h"
+
+/** Statistics TtSched_GetStats returns */
+extern TtStatsTypeDef hostTtStats;
+
+#endif /* __TX_NODE_STUBS_H */
@@ -0,0 +1,207 @@
+/**
+ * @file    test_capture.c
+ * @ingroup Host_Tests
+ * @brief   Echo capture callback and distance conversion (usensor.c,
+ *          echo_range.h).
+ */
+#include "check.h"
+#include "hal_mock.h"
+#include "usensor.h"
+#include "echo_range.h"
+
+/**
+ * @brief Capture an edge on a sensor's timer; as on the target, the
+ *        callback only runs while the capture interrupt is enabled.
+ * @param htim  Echo timer.
+ * @param count Counter value latched in CCR1.
+ */
+static void Edge(TIM_HandleTypeDef *htim, uint32_t count)
+{
+    htim->Instance->CCR1 = count;
+    htim->Instance->CNT = count + 3u;
+    if (__HAL_TIM_GET_IT_SOURCE(htim, TIM_IT_CC1) == RESET)
+        return;
+    htim->Channel = HAL_TIM_ACTIVE_CHANNEL_1;
+    USensor_TIM_IC_Callback(htim);
+    htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+}
+
+/**
+ * @brief Start from reset hardware and open both echo windows.
+ */
+static void Start(void)
+{
+    uint8_t i;
+
+    HostHal_Reset();
+    for (i = 0; i < USENSOR_COUNT; i++)
+    {
+        Distance[i] = 0;
+        DistanceTick[i] = 0;
+        USensor_Trigger(i);
+    }
+}
+
+static void test_pulse_width(void)
+{
+    CHECK_EQ(Echo_PulseWidth(100, 1100), 1000);
+    CHECK_EQ(Echo_PulseWidth(0, 0xFFFE), 0xFFFE);
+    /* Across the wrap of the 0xFFFE-period counter */
+    CHECK_EQ(Echo_PulseWidth(0xFF00, 0x0100), 0xFF + 0x100);
+    CHECK_EQ(Echo_PulseWidth(0xFFFE, 0), 1);
+}
+
+static void test_width_to_cm(void)
+{
+    uint32_t width;
+
+    CHECK_EQ(Echo_WidthToCm(0), 0);
+    CHECK_EQ(Echo_WidthToCm(58), 0);
+    CHECK_EQ(Echo_WidthToCm(59), 1);
+    CHECK_EQ(Echo_WidthToCm(1000), 17);
+    CHECK_EQ(Echo_WidthToCm(14941), 253);
+
+    /* The double expression the capture interrupt used to run */
+    for (width = 0; width <= 0xFFFFu; width++)
+        if (Echo_WidthToCm(width) != (uint32_t)(width * 0.034 / 2))
+        {
+            CHECK_EQ(Echo_WidthToCm(width), (uint32_t)(width * 0.034 / 2));
+            break;
+        }
+}
+
+static void test_trigger(void)
+{
+    const HostGpioWriteTypeDef *high, *low;
+
+    HostHal_Reset();
+    USensor_Trigger(1);
+
+    CHECK_EQ(HostHal_GpioWrites(), 2);
+    high = HostHal_GpioWrite(1);
+    low = HostHal_GpioWrite(0);
+    CHECK(high && high->port == USENSOR_GPIO_PORT && high->pin == USENSOR2_TRIG_PIN &&
+          high->state == GPIO_PIN_SET);
+    CHECK(low && low->port == USENSOR_GPIO_PORT && low->pin == USENSOR2_TRIG_PIN &&
+          low->state == GPIO_PIN_RESET);
+    /* The pulse lasts the 10 us of USensor_DelayUs on TIM1 */
+    CHECK(TIM1->CNT >= 10u);
+
+    CHECK(TIM2->DIER & TIM_IT_CC1);
+    CHECK(!(TIM1->DIER & TIM_IT_CC1));
+    CHECK(!(TIM2->CCER & TIM_CCER_CC1P));
+}
+
+static void test_echo(void)
+{
+    Start();
+    HostHal_SetTick(1234);
+
+    Edge(&htim1, 1000);
+    CHECK(TIM1->CCER & TIM_CCER_CC1P);      /* Now waiting for the falling edge */
+    CHECK_EQ(Distance[0], 0);
+
+    Edge(&htim1, 1000 + 5882);
+    CHECK_EQ(Distance[0], 99);
+    CHECK_EQ(DistanceTick[0], 1234);
+    CHECK_EQ(USensor_GetStatus(0), USENSOR_ECHO);
+    CHECK_EQ(TIM1->CNT, 0);                 /* Restarted for the next echo */
+    CHECK(!(TIM1->CCER & TIM_CCER_CC1P));
+    CHECK(!(TIM1->DIER & TIM_IT_CC1));      /* Window done */
+
+    /* The other sensor is untouched */
+    CHECK_EQ(Distance[1], 0);
+    CHECK(TIM2->DIER & TIM_IT_CC1);
+}
+
+static void test_echo_across_wrap(void)
+{
+    Start();
+
+    Edge(&htim2, 0xFF00);
+    Edge(&htim2, 0x0E00);
+    CHECK_EQ(Distance[1], Echo_WidthToCm(0xFF + 0x0E00));
+    CHECK_EQ(Distance[0], 0);
+}
+
+static void test_out_of_range(void)
+{
+    Start();
+
+    /* 20 ms of echo is 340 cm, more than a byte holds */
+    Edge(&htim1, 100);
+    Edge(&htim1, 100 + 20000);
+    CHECK_EQ(Distance[0], USENSOR_NO_ECHO);
+    CHECK_EQ(USensor_GetStatus(0), USENSOR_OUT_OF_RANGE);
+
+    /* Just under the limit */
+    Start();
+    Edge(&htim1, 100);
+    Edge(&htim1, 100 + 14941);
+    CHECK_EQ(Distance[0], 253);
+}
+
+static void test_other_channel_ignored(void)
+{
+    Start();
+
+    TIM1->CCR1 = 500;
+    htim1.Channel = HAL_TIM_ACTIVE_CHANNEL_2;
+    USensor_TIM_IC_Callback(&htim1);
+    htim1.Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+
+    CHECK(!(TIM1->CCER & TIM_CCER_CC1P));   /* Still waiting for the rise */
+    Edge(&htim1, 500);
+    Edge(&htim1, 500 + 1000);
+    CHECK_EQ(Distance[0], 17);
+}
+
+static void test_close_window(void)
+{
+    /* No edge at all: a dead sensor */
+    Start();
+    DistanceTick[0] = 0;
+    HostHal_SetTick(60);
+    USensor_CloseWindow(0);
+    CHECK_EQ(Distance[0], USENSOR_NO_ECHO);
+    CHECK_EQ(DistanceTick[0], 60);
+    CHECK_EQ(USensor_GetStatus(0), USENSOR_SILENT);
+    CHECK(!(TIM1->DIER & TIM_IT_CC1));
+    CHECK_EQ(__get_PRIMASK(), 0);
+
+    /* Rising edge only: an obstacle out of range; masked interrupts stay masked */
+    Start();
+    Edge(&htim2, 200);
+    __disable_irq();
+    USensor_CloseWindow(1);
+    CHECK_EQ(__get_PRIMASK(), 1);
+    __enable_irq();
+    CHECK_EQ(Distance[1], USENSOR_NO_ECHO);
+    CHECK_EQ(USensor_GetStatus(1), USENSOR_OUT_OF_RANGE);
+    CHECK(!(TIM2->CCER & TIM_CCER_CC1P));
+
+    /* A late edge after the close is not measured against the next trigger */
+    Edge(&htim2, 300);
+    CHECK_EQ(Distance[1], USENSOR_NO_ECHO);
+
+    /* A completed echo is kept */
+    Start();
+    Edge(&htim1, 0);
+    Edge(&htim1, 1000);
+    USensor_CloseWindow(0);
+    CHECK_EQ(Distance[0], 17);
+    CHECK_EQ(USensor_GetStatus(0), USENSOR_ECHO);
+}
+
+int main(void)
+{
+    CHECK_RUN(test_pulse_width);
+    CHECK_RUN(test_width_to_cm);
+    CHECK_RUN(test_trigger);
+    CHECK_RUN(test_echo);
+    CHECK_RUN(test_echo_across_wrap);
+    CHECK_RUN(test_out_of_range);
+    CHECK_RUN(test_other_channel_ignored);
+    CHECK_RUN(test_close_window);
+    return CHECK_RESULT();
+}
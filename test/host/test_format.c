@@ -0,0 +1,305 @@
+/**
+ * @file    test_format.c
+ * @ingroup Host_Tests
+ * @brief   CAN payloads and diagnostic lines of the transmitter
+ *          (app_tasks.c: Tx_SendDistances and Tx_Report).
+ *
+ * The filter, tracker and health state of app_tasks.c and range_filter.c
+ * live on from test to test, as they would from cycle to cycle; each test
+ * runs enough cycles to settle. The DWT counter stands still on the host,
+ * so every timing field reads 0.
+ */
+#include "check.h"
+#include "hal_mock.h"
+#include "tx_node_stubs.h"
+#include "app_tasks.h"
+#include "range_filter.h"
+#include "trilateration.h"
+#include "obstacle_class.h"
+#include "boot_time.h"
+#include "isr_stats.h"
+#include <stdio.h>
+
+/** Cycles run before checking a steady output */
+#define SETTLE_CYCLES   32u
+
+/** Tick of the next cycle */
+static uint32_t tick = 1000;
+
+/**
+ * @brief Run CAN slots of the schedule with steady readings.
+ * @param d0     Distance of sensor 0 (cm).
+ * @param d1     Distance of sensor 1 (cm).
+ * @param cycles Slots to run, one schedule cycle apart.
+ */
+static void Cycles(uint8_t d0, uint8_t d1, uint32_t cycles)
+{
+    while (cycles--)
+    {
+        tick += TT_CYCLE_MS;
+        HostHal_SetTick(tick);
+        Distance[0] = d0;
+        Distance[1] = d1;
+        DistanceTick[0] = tick;
+        DistanceTick[1] = tick;
+        Tx_SendDistances();
+    }
+}
+
+/**
+ * @brief Run one report cycle and keep the line written in each slot.
+ * @param lines Line of slot 1 to CPU_REPORT_EVERY in lines[0..15], empty
+ *              if the slot wrote nothing.
+ */
+static void ReportCycle(char lines[16][HOST_UART_LINE_MAX])
+{
+    uint32_t bytes;
+    uint8_t i;
+
+    for (i = 0; i < 16u; i++)
+    {
+        bytes = HostHal_UartBytes();
+        Tx_Report();
+        strcpy(lines[i], HostHal_UartBytes() != bytes ? HostHal_UartLine() : "");
+    }
+}
+
+/** Age byte Tx_SendDistances sends for samples of the given ages (ms) */
+static uint8_t AgeByte(uint32_t age0_ms, uint32_t age1_ms)
+{
+    uint32_t a0 = (age0_ms + RangeFilter_LagMs() + TX_CAN_AGE_UNIT_MS / 2u) / TX_CAN_AGE_UNIT_MS;
+    uint32_t a1 = (age1_ms + RangeFilter_LagMs() + TX_CAN_AGE_UNIT_MS / 2u) / TX_CAN_AGE_UNIT_MS;
+
+    if (a0 > 15u)
+        a0 = 15u;
+    if (a1 > 15u)
+        a1 = 15u;
+    return (uint8_t)(a0 | (a1 << TX_CAN_AGE_BITS));
+}
+
+static void test_distance_frame(void)
+{
+    const HostCanFrameTypeDef *frame;
+
+    HostHal_Reset();
+    Cycles(100, 120, 1);
+
+    /* The filter primes on the first reading: no lag yet */
+    CHECK_EQ(HostHal_CanFrames(), 2);
+    frame = HostHal_CanFrame(1);
+    CHECK(frame != NULL);
+    if (!frame)
+        return;
+    CHECK_EQ(frame->header.StdId, 0x103);
+    CHECK_EQ(frame->header.IDE, CAN_ID_STD);
+    CHECK_EQ(frame->header.DLC, TX_CAN_DLC);
+    CHECK_EQ(frame->data[TX_CAN_DISTANCE], 100);
+    CHECK_EQ(frame->data[TX_CAN_DISTANCE + 1u], 120);
+    CHECK_EQ(frame->data[TX_CAN_CLOSING] | frame->data[TX_CAN_CLOSING + 1u], 0);
+    CHECK_EQ(frame->data[TX_CAN_CLOSING + 2u] | frame->data[TX_CAN_CLOSING + 3u], 0);
+    CHECK_EQ(frame->data[TX_CAN_AGE], AgeByte(0, 0));
+}
+
+static void test_closing_velocity(void)
+{
+    const HostCanFrameTypeDef *frame;
+    int16_t closing0, closing1;
+    uint8_t cm;
+
+    /* Sensor 0 approaching 1 cm per cycle, sensor 1 steady */
+    Cycles(200, 150, SETTLE_CYCLES);
+    for (cm = 200; cm > 160; cm--)
+        Cycles(cm, 150, 1);
+
+    frame = HostHal_CanFrame(1);
+    closing0 = (int16_t)(frame->data[TX_CAN_CLOSING] | (frame->data[TX_CAN_CLOSING + 1u] << 8));
+    closing1 = (int16_t)(frame->data[TX_CAN_CLOSING + 2u] | (frame->data[TX_CAN_CLOSING + 3u] << 8));
+
+    /* 10 mm per 60 ms cycle */
+    CHECK(closing0 > 150 && closing0 < 185);
+    CHECK_EQ(closing1, 0);
+    CHECK(frame->data[TX_CAN_FLAGS] & TX_CAN_FLAG_CONFIDENT(0));
+    /* Filtered, so behind the reading but past where it started */
+    CHECK(frame->data[TX_CAN_DISTANCE] > 161 && frame->data[TX_CAN_DISTANCE] < 200);
+    CHECK_EQ(frame->data[TX_CAN_DISTANCE + 1u], 150);
+}
+
+static void test_sample_age(void)
+{
+    const HostCanFrameTypeDef *frame;
+
+    Cycles(100, 100, SETTLE_CYCLES);
+
+    /* Sensor 1 has not answered for a second: the largest age */
+    tick += TT_CYCLE_MS;
+    HostHal_SetTick(tick);
+    DistanceTick[0] = tick - 20u;
+    DistanceTick[1] = tick - 1000u;
+    Tx_SendDistances();
+
+    frame = HostHal_CanFrame(1);
+    CHECK_EQ(frame->data[TX_CAN_AGE], AgeByte(20, 1000));
+    CHECK_EQ(frame->data[TX_CAN_AGE] >> TX_CAN_AGE_BITS, 15);
+}
+
+static void test_spike_rejected(void)
+{
+    const HostCanFrameTypeDef *frame;
+
+    /* A lone nearer echo never reaches CAN; a step does, after the median */
+    Cycles(150, 150, SETTLE_CYCLES);
+    Cycles(40, 150, 1);
+    frame = HostHal_CanFrame(1);
+    CHECK_EQ(frame->data[TX_CAN_DISTANCE], 150);
+    Cycles(150, 150, 1);
+    CHECK_EQ(HostHal_CanFrame(1)->data[TX_CAN_DISTANCE], 150);
+
+    Cycles(100, 150, SETTLE_CYCLES);
+    frame = HostHal_CanFrame(1);
+    CHECK_EQ(frame->data[TX_CAN_DISTANCE], 100);
+    CHECK_EQ(frame->data[TX_CAN_DISTANCE + 1u], 150);
+}
+
+static void test_position_frame(void)
+{
+    const HostCanFrameTypeDef *frame;
+    TrilatFixTypeDef fix;
+
+    Cycles(100, 100, SETTLE_CYCLES);
+
+    frame = HostHal_CanFrame(0);
+    CHECK_EQ(frame->header.StdId, TX_CAN_POSITION_ID);
+    CHECK_EQ(frame->header.DLC, TX_CAN_POS_DLC);
+    CHECK_EQ(HostHal_CanFrame(1)->data[TX_CAN_DISTANCE], 100);
+
+    /* Straight behind the bumper centre */
+    CHECK(Trilat_Solve(1000, 1000, &fix));
+    CHECK_EQ(fix.lateral_mm, 0);
+    CHECK_EQ(frame->data[TX_CAN_POS_FLAGS], TX_CAN_POS_FLAG_VALID);
+    CHECK_EQ((int16_t)(frame->data[TX_CAN_POS_LATERAL] | (frame->data[TX_CAN_POS_LATERAL + 1u] << 8)),
+             fix.lateral_mm);
+    CHECK_EQ(frame->data[TX_CAN_POS_FORWARD] | (frame->data[TX_CAN_POS_FORWARD + 1u] << 8),
+             fix.forward_mm);
+    /* Two healthy sensors */
+    CHECK_EQ(frame->data[TX_CAN_POS_HEALTH], 0);
+
+    /* Nearer the right sensor: offset to the right, as trilateration says */
+    Cycles(100, 90, SETTLE_CYCLES);
+    frame = HostHal_CanFrame(0);
+    CHECK(Trilat_Solve(1000, 900, &fix));
+    CHECK(fix.lateral_mm > 0);
+    CHECK_EQ((int16_t)(frame->data[TX_CAN_POS_LATERAL] | (frame->data[TX_CAN_POS_LATERAL + 1u] << 8)),
+             fix.lateral_mm);
+}
+
+static void test_no_echo(void)
+{
+    const HostCanFrameTypeDef *distances, *position;
+
+    Cycles(100, USENSOR_NO_ECHO, SETTLE_CYCLES);
+
+    distances = HostHal_CanFrame(1);
+    position = HostHal_CanFrame(0);
+    CHECK_EQ(distances->data[TX_CAN_DISTANCE], 100);
+    CHECK_EQ(distances->data[TX_CAN_DISTANCE + 1u], USENSOR_NO_ECHO);
+    /* No range to intersect */
+    CHECK_EQ(position->data[TX_CAN_POS_FLAGS], 0);
+    CHECK_EQ(position->data[TX_CAN_POS_LATERAL] | position->data[TX_CAN_POS_LATERAL + 1u], 0);
+    CHECK_EQ(position->data[TX_CAN_POS_FORWARD] | position->data[TX_CAN_POS_FORWARD + 1u], 0);
+}
+
+static void test_can_failure(void)
+{
+    const HostGpioWriteTypeDef *write;
+
+    Cycles(100, 100, SETTLE_CYCLES);
+    HostHal_Reset();
+    GPIOC->ODR = GPIO_PIN_13;
+    HostHal_SetCanStatus(HAL_ERROR);
+    Cycles(100, 100, 1);
+
+    /* Both frames fail; the LED shows it */
+    CHECK_EQ(HostHal_CanFrames(), 0);
+    CHECK_EQ(HostHal_GpioWrites(), 2);
+    write = HostHal_GpioWrite(0);
+    CHECK(write && write->port == GPIOC && write->pin == GPIO_PIN_13 && write->state == GPIO_PIN_RESET);
+    CHECK(!(GPIOC->ODR & GPIO_PIN_13));
+
+    HostHal_SetCanStatus(HAL_OK);
+    Cycles(100, 100, 1);
+    CHECK_EQ(HostHal_CanFrames(), 2);
+    CHECK_EQ(HostHal_GpioWrites(), 2);
+}
+
+static void test_report_slots(void)
+{
+    static char lines[16][HOST_UART_LINE_MAX];
+    char expected[HOST_UART_LINE_MAX];
+    int n = 0;
+    uint8_t i;
+
+    HostHal_Reset();
+    hostTtStats.cycles = 1234;
+    hostTtStats.late = 2;
+    hostTtStats.worst_late = 3;
+    NVIC_SetPriority(TIM1_CC_IRQn, 5);
+
+    ReportCycle(lines);
+
+    CHECK_STR(lines[0], "TRI,isqrt,0,0,0,0\r\n");       /* Nothing solved yet */
+    CHECK_STR(lines[1], "");                            /* No crash record */
+    CHECK_STR(lines[3], "TT,1234,2,3\r\n");
+    CHECK_STR(lines[4], "CLS,0,0,2000,0,0,0\r\n");
+
+    n = sprintf(expected, "BOOT");
+    for (i = 0; i < BOOT_PHASE_COUNT; i++)
+        n += sprintf(&expected[n], ",0");
+    sprintf(&expected[n], "\r\n");
+    CHECK_STR(lines[5], expected);
+
+    CHECK_STR(lines[7], "STK,host\r\n");
+    CHECK_STR(lines[9], "ISR,0,5,0,,,,,,,,\r\n");       /* Echo 1 first, no samples */
+    CHECK_STR(lines[11], "PWR,host\r\n");
+    CHECK_STR(lines[13], "FLT,biquad,0,0,1500,0\r\n");
+    CHECK_STR(lines[15], "CPU,host\r\n");
+    CHECK_STR(lines[2], "");
+    CHECK_STR(lines[6], "");
+    CHECK_STR(lines[8], "");
+}
+
+static void test_report_counters(void)
+{
+    static char lines[16][HOST_UART_LINE_MAX];
+    unsigned avg, worst, budget, overruns, inferences, dropped;
+
+    /* Three solves and, with full classifier windows, six inferences */
+    ReportCycle(lines);
+    Cycles(100, 100, 3);
+    ReportCycle(lines);
+    CHECK_STR(lines[0], "TRI,isqrt,0,0,3,3\r\n");
+    CHECK_EQ(sscanf(lines[4], "CLS,%u,%u,%u,%u,%u,%u", &avg, &worst, &budget, &overruns,
+                    &inferences, &dropped), 6);
+    CHECK_EQ(budget, OBS_CLASS_BUDGET_CYCLES);
+    CHECK_EQ(inferences, 3u * USENSOR_COUNT);
+    CHECK(dropped <= inferences);
+    CHECK_STR(lines[9], "ISR,2,0,0,,,,,,,,\r\n");       /* One interrupt per cycle */
+
+    /* Restarted after each line */
+    ReportCycle(lines);
+    CHECK_STR(lines[0], "TRI,isqrt,0,0,0,0\r\n");
+    CHECK_STR(lines[4], "CLS,0,0,2000,0,0,0\r\n");
+}
+
+int main(void)
+{
+    CHECK_RUN(test_report_slots);
+    CHECK_RUN(test_distance_frame);
+    CHECK_RUN(test_closing_velocity);
+    CHECK_RUN(test_sample_age);
+    CHECK_RUN(test_position_frame);
+    CHECK_RUN(test_spike_rejected);
+    CHECK_RUN(test_no_echo);
+    CHECK_RUN(test_can_failure);
+    CHECK_RUN(test_report_counters);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,192 @@
+/**
+ * @file    test_frame.c
+ * @ingroup Host_Tests
+ * @brief   Serial frames of the GUI link (frame.c), decoded as
+ *          gui/frame_protocol.py does.
+ */
+#include "check.h"
+#include "frame.h"
+
+/**
+ * @brief  Undo the COBS encoding of a frame.
+ * @param  in  Encoded frame, 0x00 delimiter included.
+ * @param  len Number of encoded bytes.
+ * @param  out Raw bytes.
+ * @retval Number of raw bytes, or -1 if the encoding is broken.
+ */
+static int Cobs_Decode(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint16_t i = 0;
+    int n = 0;
+    uint8_t code, k;
+
+    if (len < 2u || in[len - 1u] != 0)
+        return -1;
+    len--;
+
+    while (i < len)
+    {
+        code = in[i++];
+        if (code == 0 || i + code - 1u > len)
+            return -1;
+        for (k = 1; k < code; k++)
+        {
+            if (in[i] == 0)
+                return -1;
+            out[n++] = in[i++];
+        }
+        if (i < len)
+            out[n++] = 0;
+    }
+    return n;
+}
+
+/** Little-endian 16-bit field */
+static uint16_t Le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void test_crc(void)
+{
+    static const uint8_t check[] = "123456789";
+
+    /* The CRC-16/CCITT-FALSE check value */
+    CHECK_EQ(Frame_Crc16(check, 9), 0x29B1);
+    CHECK_EQ(Frame_Crc16(check, 0), 0xFFFF);
+}
+
+static void test_frame_fields(void)
+{
+    FrameTypeDef frame = {0};
+    uint8_t out[FRAME_MAX_ENCODED];
+    uint8_t raw[FRAME_MAX_ENCODED];
+    uint16_t len;
+    int n;
+
+    frame.seq = 0x1234;
+    frame.timestamp = 0x00ABCDEFu;
+    frame.zone = 2;
+    frame.flags = FRAME_FLAG_STALE;
+    frame.count = 2;
+    frame.distance_mm[0] = 1000;
+    frame.distance_mm[1] = 0x0100;                  /* A zero byte to stuff */
+    frame.closing_mm_s[0] = -250;
+    frame.closing_mm_s[1] = 320;
+    frame.age_ms[0] = 48;
+    frame.age_ms[1] = 0;
+    frame.confident = 0x02;
+    frame.lateral_mm = -120;
+    frame.forward_mm = FRAME_NO_POSITION;
+
+    len = Frame_Encode(&frame, out);
+    CHECK(len <= FRAME_MAX_ENCODED);
+    CHECK(memchr(out, 0, len - 1u) == NULL);         /* Only the delimiter */
+
+    n = Cobs_Decode(out, len, raw);
+    CHECK_EQ(n, 17 + 6 * 2);
+    if (n != 17 + 6 * 2)
+        return;
+    CHECK_EQ(raw[0], FRAME_VERSION);
+    CHECK_EQ(Le16(&raw[1]), 0x1234);
+    CHECK_EQ(Le16(&raw[3]) | ((uint32_t)Le16(&raw[5]) << 16), 0x00ABCDEF);
+    CHECK_EQ(raw[7], 2);
+    CHECK_EQ(raw[8], FRAME_FLAG_STALE);
+    CHECK_EQ(raw[9], 2);
+    CHECK_EQ(Le16(&raw[10]), 1000);
+    CHECK_EQ(Le16(&raw[12]), 0x0100);
+    CHECK_EQ((int16_t)Le16(&raw[14]), -250);
+    CHECK_EQ((int16_t)Le16(&raw[16]), 320);
+    CHECK_EQ(Le16(&raw[18]), 48);
+    CHECK_EQ(Le16(&raw[20]), 0);
+    CHECK_EQ(raw[22], 0x02);
+    CHECK_EQ((int16_t)Le16(&raw[23]), -120);
+    CHECK_EQ(Le16(&raw[25]), FRAME_NO_POSITION);
+    CHECK_EQ(Le16(&raw[27]), Frame_Crc16(raw, 27));
+}
+
+static void test_frame_count_clamped(void)
+{
+    FrameTypeDef frame = {0};
+    uint8_t out[FRAME_MAX_ENCODED];
+    uint8_t raw[FRAME_MAX_ENCODED];
+    int n;
+
+    frame.count = FRAME_MAX_SENSORS + 3u;
+    n = Cobs_Decode(out, Frame_Encode(&frame, out), raw);
+    CHECK_EQ(n, 17 + 6 * FRAME_MAX_SENSORS);
+    CHECK_EQ(raw[9], FRAME_MAX_SENSORS);
+
+    /* An all-zero frame: every byte but the version stuffed */
+    frame.count = 0;
+    n = Cobs_Decode(out, Frame_Encode(&frame, out), raw);
+    CHECK_EQ(n, 17);
+    CHECK_EQ(Le16(&raw[15]), Frame_Crc16(raw, 15));
+}
+
+static void test_frame_sequence(void)
+{
+    FrameTypeDef frame = {0};
+    uint8_t out[FRAME_MAX_ENCODED];
+    uint8_t raw[FRAME_MAX_ENCODED];
+    uint32_t seq;
+    uint16_t len;
+    int n;
+
+    /* Every sequence number survives, zero bytes or not */
+    frame.count = 1;
+    for (seq = 0; seq <= 0xFFFFu; seq++)
+    {
+        frame.seq = (uint16_t)seq;
+        len = Frame_Encode(&frame, out);
+        n = Cobs_Decode(out, len, raw);
+        if (n != 23 || Le16(&raw[1]) != seq || Le16(&raw[21]) != Frame_Crc16(raw, 21) ||
+            memchr(out, 0, len - 1u) != NULL)
+        {
+            CHECK_EQ(seq, -1);
+            break;
+        }
+    }
+}
+
+static void test_diag(void)
+{
+    uint8_t payload[FRAME_MAX_DIAG_PAYLOAD + 10u];
+    uint8_t out[FRAME_MAX_ENCODED];
+    uint8_t raw[FRAME_MAX_ENCODED];
+    uint16_t len;
+    int n;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(payload); i++)
+        payload[i] = (uint8_t)(i * 7u);              /* Zero every so often */
+
+    n = Cobs_Decode(out, Frame_EncodeDiag(FRAME_DIAG_BOOT, payload, 5, out), raw);
+    CHECK_EQ(n, 1 + 5 + 2);
+    CHECK_EQ(raw[0], FRAME_DIAG_BOOT);
+    CHECK(memcmp(&raw[1], payload, 5) == 0);
+    CHECK_EQ(Le16(&raw[6]), Frame_Crc16(raw, 6));
+
+    /* The largest record fits FRAME_MAX_ENCODED; longer ones are cut */
+    len = Frame_EncodeDiag(FRAME_DIAG_TRACE, payload, sizeof(payload), out);
+    CHECK(len <= FRAME_MAX_ENCODED);
+    n = Cobs_Decode(out, len, raw);
+    CHECK_EQ(n, FRAME_MAX_RAW);
+    CHECK(memcmp(&raw[1], payload, FRAME_MAX_DIAG_PAYLOAD) == 0);
+    CHECK_EQ(Le16(&raw[1 + FRAME_MAX_DIAG_PAYLOAD]), Frame_Crc16(raw, 1 + FRAME_MAX_DIAG_PAYLOAD));
+
+    /* Empty payload */
+    n = Cobs_Decode(out, Frame_EncodeDiag(FRAME_DIAG_CPU, payload, 0, out), raw);
+    CHECK_EQ(n, 3);
+    CHECK_EQ(raw[0], FRAME_DIAG_CPU);
+}
+
+int main(void)
+{
+    CHECK_RUN(test_crc);
+    CHECK_RUN(test_frame_fields);
+    CHECK_RUN(test_frame_count_clamped);
+    CHECK_RUN(test_frame_sequence);
+    CHECK_RUN(test_diag);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,169 @@
+/**
+ * @file    test_median.c
+ * @ingroup Host_Tests
+ * @brief   Running median (median_filter.c), both builds, against the
+ *          median of a qsort of the same window.
+ */
+#include "check.h"
+#include "median_filter.h"
+#include "median_sort.h"
+#include <stdlib.h>
+
+/** Updates per window size and input kind */
+#define FUZZ_UPDATES    200000u
+
+/** Kinds of input */
+typedef enum
+{
+    INPUT_UNIFORM = 0,      /**< Any byte */
+    INPUT_DUPLICATES,       /**< Few values, many ties */
+    INPUT_READINGS,         /**< Noisy distance, spikes and missed echoes */
+    INPUT_COUNT
+} InputTypeDef;
+
+/** State of the sample generator (xorshift32), fixed for repeatable runs */
+static uint32_t seed = 0x2545F491u;
+
+static uint32_t Random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/**
+ * @brief  Next sample of an input.
+ * @param  kind Input.
+ * @param  walk Walking distance of INPUT_READINGS (cm).
+ * @retval Sample.
+ */
+static uint8_t Sample(InputTypeDef kind, int32_t *walk)
+{
+    uint32_t r = Random();
+
+    switch (kind)
+    {
+    case INPUT_UNIFORM:
+        return (uint8_t)r;
+    case INPUT_DUPLICATES:
+        return (uint8_t)(250u + (r & 3u) + ((r >> 8) & 1u));
+    default:
+        *walk += (int32_t)((r >> 8) % 5u) - 2;
+        if (*walk < 0)
+            *walk = 0;
+        else if (*walk > 254)
+            *walk = 254;
+        if ((r & 0x1Fu) == 0)
+            return 255;                 /* USENSOR_NO_ECHO */
+        if ((r & 0x1Fu) == 1)
+            return (uint8_t)(*walk / 2);
+        return (uint8_t)*walk;
+    }
+}
+
+static int CompareBytes(const void *a, const void *b)
+{
+    return (int)*(const uint8_t *)a - (int)*(const uint8_t *)b;
+}
+
+/**
+ * @brief  Median of a window by qsort.
+ * @param  window Samples.
+ * @param  size   Number of samples (odd).
+ * @retval Median.
+ */
+static uint8_t ReferenceMedian(const uint8_t *window, uint8_t size)
+{
+    uint8_t copy[MEDIAN_FILTER_MAX];
+
+    memcpy(copy, window, size);
+    qsort(copy, size, 1, CompareBytes);
+    return copy[size / 2u];
+}
+
+/**
+ * @brief  Check the state of a filter holds the window in both orders.
+ * @param  filter Filter.
+ * @retval Non-zero if consistent.
+ */
+static int Consistent(const MedianFilterTypeDef *filter)
+{
+    uint8_t ring[MEDIAN_FILTER_MAX];
+    uint8_t i;
+
+    for (i = 1; i < filter->size; i++)
+        if (filter->sorted[i - 1u] > filter->sorted[i])
+            return 0;
+    memcpy(ring, filter->ring, filter->size);
+    qsort(ring, filter->size, 1, CompareBytes);
+    return memcmp(ring, filter->sorted, filter->size) == 0 && filter->next < filter->size;
+}
+
+static void test_init(void)
+{
+    MedianFilterTypeDef filter;
+    uint8_t size;
+
+    for (size = MEDIAN_FILTER_MIN; size <= MEDIAN_FILTER_MAX; size += 2u)
+    {
+        MedianFilter_Init(&filter, size, 42);
+        CHECK(Consistent(&filter));
+        /* A lone spike never reaches the output */
+        CHECK_EQ(MedianFilter_Update(&filter, 255), 42);
+        CHECK_EQ(MedianFilter_Update(&filter, 0), 42);
+    }
+
+    /* Half the window plus one moves it */
+    MedianFilter_Init(&filter, 5, 100);
+    CHECK_EQ(MedianFilter_Update(&filter, 10), 100);
+    CHECK_EQ(MedianFilter_Update(&filter, 10), 100);
+    CHECK_EQ(MedianFilter_Update(&filter, 10), 10);
+}
+
+static void test_fuzz(void)
+{
+    MedianFilterTypeDef sorted, naive;
+    uint8_t window[MEDIAN_FILTER_MAX];
+    uint8_t size, next, value, expected, got, got_naive;
+    uint32_t n;
+    int32_t walk;
+    int kind;
+
+    for (size = MEDIAN_FILTER_MIN; size <= MEDIAN_FILTER_MAX; size += 2u)
+        for (kind = 0; kind < INPUT_COUNT; kind++)
+        {
+            walk = 128;
+            value = Sample((InputTypeDef)kind, &walk);
+            MedianFilter_Init(&sorted, size, value);
+            MedianFilterSort_Init(&naive, size, value);
+            memset(window, value, sizeof(window));
+            next = 0;
+
+            for (n = 0; n < FUZZ_UPDATES; n++)
+            {
+                value = Sample((InputTypeDef)kind, &walk);
+                window[next] = value;
+                next = (uint8_t)((next + 1u) % size);
+
+                expected = ReferenceMedian(window, size);
+                got = MedianFilter_Update(&sorted, value);
+                got_naive = MedianFilterSort_Update(&naive, value);
+                if (got != expected || got_naive != expected || !Consistent(&sorted) ||
+                    memcmp(sorted.sorted, naive.sorted, size) != 0)
+                {
+                    printf("  size %u, input %d, update %lu: median %u, naive %u, qsort %u\n",
+                           size, kind, (unsigned long)n, got, got_naive, expected);
+                    CHECK(0);
+                    break;
+                }
+            }
+        }
+}
+
+int main(void)
+{
+    CHECK_RUN(test_init);
+    CHECK_RUN(test_fuzz);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,184 @@
+/**
+ * @file    test_zone.c
+ * @ingroup Host_Tests
+ * @brief   Zone classification of the receiver and its indication
+ *          (zone_table.c, zone_filter.c, leds.c, sevenseg.c).
+ */
+#include "check.h"
+#include "hal_mock.h"
+#include "zone_table.h"
+#include "zone_filter.h"
+#include "leds.h"
+#include "sevenseg.h"
+
+/** Segment pins, segment A first */
+static const uint16_t segmentPins[7] = { A_Pin, B_Pin, C_Pin, D_Pin, E_Pin, F_Pin, G_Pin };
+
+static void test_lookup_buckets(void)
+{
+    const ZoneEntryTypeDef *prev = Zone_Lookup(0);
+    uint32_t cm;
+
+    /* Bucket limits, rounded up */
+    CHECK_EQ(Zone_Lookup(0)->zone, ZONE_RED_FULL);
+    CHECK_EQ(Zone_Lookup(30)->zone, ZONE_RED_FULL);
+    CHECK_EQ(Zone_Lookup(31)->zone, ZONE_RED);
+    CHECK_EQ(Zone_Lookup(50)->zone, ZONE_RED);
+    CHECK_EQ(Zone_Lookup(51)->zone, ZONE_YELLOW_FULL);
+    CHECK_EQ(Zone_Lookup(90)->zone, ZONE_YELLOW);
+    CHECK_EQ(Zone_Lookup(91)->zone, ZONE_GREEN_FULL);
+    CHECK_EQ(Zone_Lookup(130)->zone, ZONE_GREEN);
+    CHECK_EQ(Zone_Lookup(131)->zone, ZONE_NONE);
+    CHECK_EQ(Zone_Lookup(255)->zone, ZONE_NONE);
+    CHECK_EQ(Zone_Lookup(0)->buzzer_ms, ZONE_BUZZER_CONTINUOUS);
+    CHECK_EQ(Zone_Lookup(255)->buzzer_ms, ZONE_BUZZER_OFF);
+
+    /* Every distance has an entry; farther never lights more LEDs */
+    for (cm = 0; cm <= 255u; cm++)
+    {
+        const ZoneEntryTypeDef *entry = Zone_Lookup((uint8_t)cm);
+
+        if (entry != &zoneTable[(cm + ZONE_BUCKET_CM - 1u) / ZONE_BUCKET_CM] ||
+            entry->zone < prev->zone || (entry->led_mask & ~prev->led_mask))
+        {
+            CHECK_EQ(cm, -1);
+            break;
+        }
+        prev = entry;
+    }
+
+    /* The release limits lie past the zone they release */
+    for (cm = 0; cm < ZONE_NONE; cm++)
+        CHECK(Zone_Lookup(zoneRelease[cm])->zone > cm);
+}
+
+static void test_filter_escalates(void)
+{
+    ZoneFilterTypeDef filter;
+
+    ZoneFilter_Init(&filter);
+    CHECK_EQ(filter.entry->zone, ZONE_NONE);
+
+    CHECK_EQ(ZoneFilter_Update(&filter, 200, 0), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 100, 60), 1);
+    CHECK_EQ(filter.entry->zone, ZONE_GREEN_FULL);
+    CHECK_EQ(ZoneFilter_Update(&filter, 25, 120), 1);
+    CHECK_EQ(filter.entry->zone, ZONE_RED_FULL);
+    CHECK(filter.entry == Zone_Lookup(25));
+}
+
+static void test_filter_release(void)
+{
+    ZoneFilterTypeDef filter;
+
+    ZoneFilter_Init(&filter);
+    ZoneFilter_Update(&filter, 20, 0);
+
+    /* Farther but inside the release band: held */
+    CHECK_EQ(ZoneFilter_Update(&filter, zoneRelease[ZONE_RED_FULL], 100), 0);
+    CHECK_EQ(filter.pending, 0);
+
+    /* Past it: only after ZONE_DWELL_MS */
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, 200), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, 200 + ZONE_DWELL_MS - 1u), 0);
+    CHECK_EQ(filter.entry->zone, ZONE_RED_FULL);
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, 200 + ZONE_DWELL_MS), 1);
+    CHECK_EQ(filter.entry->zone, ZONE_RED);
+
+    /* A jump several zones out releases straight to it */
+    CHECK_EQ(ZoneFilter_Update(&filter, 200, 1000), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 200, 1000 + ZONE_DWELL_MS), 1);
+    CHECK_EQ(filter.entry->zone, ZONE_NONE);
+}
+
+static void test_filter_dwell_restarts(void)
+{
+    ZoneFilterTypeDef filter;
+
+    ZoneFilter_Init(&filter);
+    ZoneFilter_Update(&filter, 20, 0);
+
+    /* Jitter back into the band restarts the dwell */
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, 100), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 30, 200), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, 300), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, 300 + ZONE_DWELL_MS - 1u), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, 300 + ZONE_DWELL_MS), 1);
+
+    /* Across the wrap of the tick */
+    ZoneFilter_Init(&filter);
+    ZoneFilter_Update(&filter, 20, 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, 0xFFFFFFF0u), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, ZONE_DWELL_MS - 0x11u), 0);
+    CHECK_EQ(ZoneFilter_Update(&filter, 45, ZONE_DWELL_MS - 0x10u), 1);
+}
+
+static void test_leds(void)
+{
+    uint32_t mask;
+    uint16_t onA, onB;
+
+    for (mask = 0; mask < 0x80u; mask++)
+    {
+        HostHal_Reset();
+        leds_Set((uint8_t)mask);
+
+        onA = (uint16_t)(((mask & LED_GREEN1) ? Green1_Pin : 0) | ((mask & LED_GREEN2) ? Green2_Pin : 0) |
+                         ((mask & LED_BLUE2) ? Blue2_Pin : 0) | ((mask & LED_RED1) ? Red1_Pin : 0) |
+                         ((mask & LED_RED2) ? Red2_Pin : 0));
+        onB = (uint16_t)(((mask & LED_GREEN3) ? Green3_Pin : 0) | ((mask & LED_BLUE1) ? Blue1_Pin : 0));
+
+        /* One write per port, every LED set or reset */
+        if (GPIOA->BSRR != (onA | ((uint32_t)(LED_PINS_A & ~onA) << 16)) ||
+            GPIOB->BSRR != (onB | ((uint32_t)(LED_PINS_B & ~onB) << 16)) ||
+            HostHal_GpioWrites() != 0)
+        {
+            CHECK_EQ(mask, -1);
+            break;
+        }
+    }
+
+    /* The green zone lights the three greens */
+    leds_Set(Zone_Lookup(100)->led_mask);
+    CHECK_EQ(GPIOA->BSRR & 0xFFFFu, Green1_Pin | Green2_Pin);
+    CHECK_EQ(GPIOB->BSRR & 0xFFFFu, Green3_Pin);
+    leds_7();
+    CHECK_EQ(GPIOA->BSRR, LED_PINS_A);
+    CHECK_EQ(GPIOB->BSRR, LED_PINS_B);
+}
+
+static void test_sevenseg(void)
+{
+    const HostGpioWriteTypeDef *write;
+    uint8_t digit, seg;
+
+    for (digit = 0; digit < 10u; digit++)
+    {
+        HostHal_Reset();
+        SevenSegment_Update(segmentNumber[digit]);
+
+        CHECK_EQ(HostHal_GpioWrites(), 7);
+        for (seg = 0; seg < 7u; seg++)
+        {
+            write = HostHal_GpioWrite(6u - seg);
+            CHECK(write && write->port == GPIOB && write->pin == segmentPins[seg]);
+            CHECK_EQ(!!(GPIOB->ODR & segmentPins[seg]), (segmentNumber[digit] >> seg) & 1u);
+        }
+    }
+
+    /* 1 is segments B and C */
+    HostHal_Reset();
+    SevenSegment_Update(segmentNumber[1]);
+    CHECK_EQ(GPIOB->ODR, B_Pin | C_Pin);
+}
+
+int main(void)
+{
+    CHECK_RUN(test_lookup_buckets);
+    CHECK_RUN(test_filter_escalates);
+    CHECK_RUN(test_filter_release);
+    CHECK_RUN(test_filter_dwell_restarts);
+    CHECK_RUN(test_leds);
+    CHECK_RUN(test_sevenseg);
+    return CHECK_RESULT();
+}
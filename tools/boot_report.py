@@ -0,0 +1,115 @@
+"""
+Show the boot-phase timeline of a node, from reset to its first output.
+
+The receiver sends DIAG_BOOT records on its binary serial link and the
+transmitter writes "BOOT,<us>,<us>,..." text lines on USART2 (see
+boot_time.h), about once a second. Each phase time is counted in us from
+reset with the DWT cycle counter; 0 means the phase was not reached yet.
+This prints each distinct report once as a timeline with the time spent in
+every phase, so a change to the boot path can be compared against the
+previous build.
+
+Usage:
+    python tools/boot_report.py COM8                  # receiver link
+    python tools/boot_report.py --text COM9           # transmitter USART2
+    python tools/boot_report.py --text log.txt        # saved lines
+"""
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+
+from frame_protocol import BOOT_PHASES, DIAG_BOOT, DiagFrame, FrameDecoder, parse_boot  # noqa: E402
+
+#: Transmitter boot phases (BootPhaseTypeDef in its boot_time.h)
+TX_BOOT_PHASES = ("main", "clock", "can", "periph", "scheduler", "first_echo",
+                  "first_can")
+
+
+def parse_text(line):
+    """Parse one transmitter "BOOT,..." line; return None for other lines."""
+    fields = line.strip().split(",")
+    if len(fields) != 1 + len(TX_BOOT_PHASES) or fields[0] != "BOOT":
+        return None
+    try:
+        return [int(f) for f in fields[1:]]
+    except ValueError:
+        return None
+
+
+def render(times, names):
+    """Return the lines of a boot timeline."""
+    lines = ["%-18s %10s %10s" % ("phase", "at(us)", "took(us)")]
+    last = 0
+    for i, at in enumerate(times):
+        name = names[i] if i < len(names) else "phase%d" % i
+        if not at:
+            lines.append("%-18s %10s" % (name, "-"))
+            continue
+        lines.append("%-18s %10d %10d" % (name, at, at - last))
+        last = at
+    return lines
+
+
+def read_binary(source, baudrate):
+    decoder = FrameDecoder()
+    if os.path.isfile(source):
+        with open(source, "rb") as f:
+            chunks = [f.read()]
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        chunks = (ser.read(max(ser.in_waiting, 1)) for _ in iter(int, 1))
+    for data in chunks:
+        for frame in decoder.feed(data):
+            if isinstance(frame, DiagFrame) and frame.kind == DIAG_BOOT:
+                try:
+                    yield parse_boot(frame.payload)
+                except ValueError:
+                    continue
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        times = parse_text(line)
+        if times:
+            yield times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", help="serial port or capture file")
+    parser.add_argument("--text", action="store_true",
+                        help="parse transmitter text lines instead of receiver frames")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    args = parser.parse_args()
+
+    names = TX_BOOT_PHASES if args.text else BOOT_PHASES
+    reader = read_text if args.text else read_binary
+    last = None
+    try:
+        for times in reader(args.source, args.baudrate):
+            if times == last:
+                continue
+            if last is not None:
+                print()
+            print("\n".join(render(times, names)))
+            last = times
+    except KeyboardInterrupt:
+        pass
+    if last is None:
+        print("no boot reports found")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,95 @@
+"""
+Render the per-task CPU load reported by the radar nodes.
+
+The receiver sends DIAG_CPU records on its binary serial link (about once a
+second); the transmitter writes "CPU,<number>,<name>,<permille>,..." text
+lines on its USART2. Both are measured with the DWT cycle counter, so the
+numbers are CPU cycle shares over the last report window, IDLE included.
+
+Usage:
+    python tools/cpu_report.py COM8              # receiver link
+    python tools/cpu_report.py --text COM9       # transmitter USART2
+    python tools/cpu_report.py --text log.txt    # saved transmitter lines
+
+Run it before and after a change and compare the IDLE share.
+"""
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+
+from frame_protocol import DIAG_CPU, DiagFrame, FrameDecoder, TaskLoad, parse_cpu  # noqa: E402
+
+#: Width of the load bar at 100 %
+BAR_WIDTH = 40
+
+
+def parse_text(line):
+    """Parse one transmitter "CPU,..." line; return None for other lines."""
+    fields = line.strip().split(",")
+    if len(fields) < 4 or fields[0] != "CPU" or (len(fields) - 1) % 3:
+        return None
+    try:
+        return [TaskLoad(fields[i + 1], int(fields[i]), int(fields[i + 2]))
+                for i in range(1, len(fields), 3)]
+    except ValueError:
+        return None
+
+
+def render(loads, out=sys.stdout):
+    """Print one report as a bar chart, busiest task first, IDLE last."""
+    busy = sum(t.permille for t in loads if t.name != "IDLE")
+    idle = [t for t in loads if t.name == "IDLE"]
+    out.write("\n%-10s %6s\n" % ("task", "cpu %"))
+    for t in sorted((t for t in loads if t.name != "IDLE"),
+                    key=lambda t: -t.permille) + idle:
+        bar = "#" * round(t.permille * BAR_WIDTH / 1000)
+        out.write("%-10s %6.1f %s\n" % (t.name, t.permille / 10, bar))
+    out.write("%-10s %6.1f\n" % ("busy", busy / 10))
+    out.flush()
+
+
+def read_binary(port, baudrate):
+    import serial
+    decoder = FrameDecoder()
+    with serial.Serial(port, baudrate, timeout=1) as ser:
+        while True:
+            for frame in decoder.feed(ser.read(max(ser.in_waiting, 1))):
+                if isinstance(frame, DiagFrame) and frame.kind == DIAG_CPU:
+                    yield parse_cpu(frame.payload)
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        loads = parse_text(line)
+        if loads:
+            yield loads
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", help="serial port, or a log file with --text")
+    parser.add_argument("--text", action="store_true",
+                        help="parse transmitter text lines instead of receiver frames")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    args = parser.parse_args()
+
+    reader = read_text if args.text else read_binary
+    try:
+        for loads in reader(args.source, args.baudrate):
+            render(loads)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
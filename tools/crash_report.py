@@ -0,0 +1,190 @@
+"""
+Decode the crash record a node reports after a crash reset.
+
+After a HardFault, a failed configASSERT, Error_Handler or a watchdog
+reset, the receiver sends DIAG_CRASH records on its binary serial link and
+the transmitter writes "CRASH,..." text lines on USART2 (see crash.h). This
+prints each distinct record once: the reason and reset cause, the blamed
+task, the fault status bits, and PC, LR and the saved stack words resolved
+to functions with the map file of the build that crashed.
+
+Usage:
+    python tools/crash_report.py COM8 --map firmware/receiver_node/MDK-ARM
+    python tools/crash_report.py --text COM9 --map firmware/transmitter_node/MDK-ARM
+    python tools/crash_report.py --text log.txt
+"""
+import argparse
+import bisect
+import os
+import re
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+sys.path.insert(0, os.path.dirname(__file__))
+
+from frame_protocol import (CRASH_REASONS, CRASH_STACK_WORDS, DIAG_CRASH, CrashRecord,  # noqa: E402
+                            DiagFrame, FrameDecoder, parse_crash)
+from ram_report import find_map  # noqa: E402
+
+#: STM32F103C6 flash
+FLASH_BASE = 0x08000000
+FLASH_SIZE = 32 * 1024
+
+_CODE = re.compile(r"^\s*(\S+)?\s+0x([0-9a-fA-F]{8})\s+(?:Thumb|ARM) Code\s+(\d+)\s")
+
+#: RCC_CSR reset flags, from bit 26
+RESET_CAUSES = ("pin", "power-on", "software", "IWDG", "WWDG", "low-power")
+
+#: SCB->CFSR bits
+CFSR_BITS = {0: "IACCVIOL", 1: "DACCVIOL", 3: "MUNSTKERR", 4: "MSTKERR",
+             7: "MMARVALID", 8: "IBUSERR", 9: "PRECISERR", 10: "IMPRECISERR",
+             11: "UNSTKERR", 12: "STKERR", 15: "BFARVALID", 16: "UNDEFINSTR",
+             17: "INVSTATE", 18: "INVPC", 19: "NOCP", 24: "UNALIGNED", 25: "DIVBYZERO"}
+
+#: SCB->HFSR bits
+HFSR_BITS = {1: "VECTTBL", 30: "FORCED", 31: "DEBUGEVT"}
+
+
+def parse_text(line):
+    """Parse one transmitter "CRASH,..." line; return None for other lines."""
+    fields = line.strip().split(",")
+    if len(fields) != 13 + CRASH_STACK_WORDS or fields[0] != "CRASH":
+        return None
+    try:
+        words = [int(f, 16) for f in fields[7:]]
+        return CrashRecord(int(fields[1]), int(fields[2]), int(fields[4]), int(fields[5]),
+                           int(fields[6], 16), *words[:6], stack=words[6:], name=fields[3])
+    except ValueError:
+        return None
+
+
+def load_symbols(path):
+    """Return the code symbols of a map file as a sorted (address, size, name) list."""
+    symbols = []
+    pending = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = _CODE.match(line)
+            if m:
+                name = m.group(1) or pending
+                if name:
+                    symbols.append((int(m.group(2), 16) & ~1, int(m.group(3)), name))
+                pending = None
+                continue
+            # armlink wraps long symbol names onto their own line
+            fields = line.split()
+            pending = fields[0] if len(fields) == 1 else None
+    symbols.sort()
+    return symbols
+
+
+def lookup(symbols, addr):
+    """Return "function+offset" for a code address, or None."""
+    addr &= ~1
+    i = bisect.bisect_right(symbols, (addr, float("inf"), "")) - 1
+    if i < 0:
+        return None
+    start, size, name = symbols[i]
+    if addr >= start + max(size, 2):
+        return None
+    return "%s+0x%X" % (name, addr - start)
+
+
+def bits(value, names):
+    return " ".join(n for b, n in sorted(names.items()) if value & (1 << b)) or "-"
+
+
+def describe(rec, symbols=()):
+    """Return the lines describing one crash record."""
+    def where(addr):
+        sym = lookup(symbols, addr) if symbols else None
+        return "0x%08X%s" % (addr, "  " + sym if sym else "")
+
+    reason = CRASH_REASONS[rec.reason] if rec.reason < len(CRASH_REASONS) else str(rec.reason)
+    causes = [c for i, c in enumerate(RESET_CAUSES) if rec.cause & (1 << i)]
+    lines = ["crash reset #%d: %s (reset cause: %s)" % (
+        rec.resets, reason, ", ".join(causes) or "none")]
+    if rec.name:
+        lines.append("  task  %d %s%s" % (rec.task, rec.name,
+                                          " (in interrupt %d)" % (rec.psr & 0x1FF)
+                                          if rec.psr & 0x1FF else ""))
+    if rec.line:
+        lines.append("  line  %d" % rec.line)
+    if not (rec.pc or rec.lr or rec.sp):
+        lines.append("  no context saved (watchdog reset with interrupts masked)")
+        return lines
+    lines.append("  pc    " + where(rec.pc))
+    lines.append("  lr    " + where(rec.lr))
+    lines.append("  sp    0x%08X  xpsr 0x%08X" % (rec.sp, rec.psr))
+    if rec.reason == CRASH_REASONS.index("hardfault"):
+        lines.append("  cfsr  0x%08X  %s" % (rec.cfsr, bits(rec.cfsr, CFSR_BITS)))
+        lines.append("  hfsr  0x%08X  %s" % (rec.hfsr, bits(rec.hfsr, HFSR_BITS)))
+    for i, word in enumerate(rec.stack):
+        if FLASH_BASE <= word < FLASH_BASE + FLASH_SIZE and word & 1:
+            lines.append("  sp+%-2d %s" % (4 * i, where(word)))   # likely return address
+        else:
+            lines.append("  sp+%-2d 0x%08X" % (4 * i, word))
+    return lines
+
+
+def read_binary(source, baudrate):
+    decoder = FrameDecoder()
+    if os.path.isfile(source):
+        with open(source, "rb") as f:
+            chunks = [f.read()]
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        chunks = (ser.read(max(ser.in_waiting, 1)) for _ in iter(int, 1))
+    for data in chunks:
+        for frame in decoder.feed(data):
+            if isinstance(frame, DiagFrame) and frame.kind == DIAG_CRASH:
+                try:
+                    yield parse_crash(frame.payload)
+                except ValueError:
+                    continue
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        rec = parse_text(line)
+        if rec:
+            yield rec
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", help="serial port or capture file")
+    parser.add_argument("--text", action="store_true",
+                        help="parse transmitter text lines instead of receiver frames")
+    parser.add_argument("--map", help="map file, or a directory holding one")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    args = parser.parse_args()
+
+    symbols = load_symbols(find_map(args.map)) if args.map else []
+    seen = set()
+    reader = read_text if args.text else read_binary
+    try:
+        for rec in reader(args.source, args.baudrate):
+            key = tuple(rec[:-2]) + tuple(rec.stack)
+            if key in seen:
+                continue
+            seen.add(key)
+            print("\n".join(describe(rec, symbols)))
+    except KeyboardInterrupt:
+        pass
+    if not seen:
+        print("no crash records found")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,136 @@
+"""
+Print the receiver's diagnostic records as they arrive on the serial link.
+
+Distance frames are counted but not printed; each DIAG_SCHED record is shown
+as a table of task priority, deadline misses and worst response time, with
+task names taken from the firmware's schedTable, each DIAG_CPU record
+as a per-task load chart (see cpu_report.py) and each DIAG_STACK record as
+a table of stack size and least free stack per task, each DIAG_POWER
+record as one line of idle sleep statistics (see power_report.py), each
+DIAG_ISR record as a table of interrupt latency and duration (see
+isr_report.py), each new DIAG_BOOT record as a boot-phase timeline (see boot_report.py), and
+the first DIAG_CRASH record as the decoded crash of the last reset (see
+crash_report.py, which also resolves the addresses).
+
+Usage:
+    python tools/diag_monitor.py COM8 [baudrate]
+"""
+import os
+import sys
+
+import serial
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+sys.path.insert(0, os.path.dirname(__file__))
+
+from frame_protocol import (BOOT_PHASES, DIAG_BOOT, DIAG_CPU, DIAG_CRASH,  # noqa: E402
+                            DIAG_ISR, DIAG_POWER, DIAG_SCHED, DIAG_STACK, ISR_NAMES,
+                            DiagFrame, FrameDecoder, parse_boot, parse_cpu, parse_crash,
+                            parse_isr, parse_power, parse_sched, parse_stack)
+from sched_check import DEFAULT_SOURCE, load_tasks  # noqa: E402
+from cpu_report import render  # noqa: E402
+from crash_report import describe  # noqa: E402
+from boot_report import render as render_boot  # noqa: E402
+from isr_report import render as render_isr  # noqa: E402
+
+
+def show_sched(payload, names):
+    try:
+        stats = parse_sched(payload)
+    except ValueError as e:
+        print("bad sched record: %s" % e)
+        return
+    print("%-12s %4s %6s %9s" % ("task", "prio", "misses", "worst(ms)"))
+    for i, s in enumerate(stats):
+        name = names[i] if i < len(names) else "task%d" % i
+        print("%-12s %4d %6d %9d" % (name, s.priority, s.misses, s.worst_ms))
+
+
+def show_stack(payload, names):
+    try:
+        margin, usages = parse_stack(payload)
+    except ValueError as e:
+        print("bad stack record: %s" % e)
+        return
+    print("%-12s %6s %6s  (margin %d)" % ("task", "size", "free", margin))
+    for u in usages:
+        print("%-12s %6d %6d%s" % (names.get(u.number, "task %d" % u.number),
+                                   u.size, u.min_free, "  LOW" if u.low else ""))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 2
+    baudrate = int(sys.argv[2]) if len(sys.argv) > 2 else 115200
+    try:
+        names = [t.name for t in load_tasks(DEFAULT_SOURCE)]
+    except (OSError, ValueError):
+        names = []
+
+    numbers = {}
+    crash_shown = False
+    boot_shown = None
+    decoder = FrameDecoder()
+    with serial.Serial(sys.argv[1], baudrate, timeout=1) as ser:
+        try:
+            while True:
+                for frame in decoder.feed(ser.read(max(ser.in_waiting, 1))):
+                    if not isinstance(frame, DiagFrame):
+                        continue
+                    print("-- frames %d, errors %d, lost %d" % (
+                        decoder.frames, decoder.errors, decoder.lost))
+                    if frame.kind == DIAG_SCHED:
+                        show_sched(frame.payload, names)
+                    elif frame.kind == DIAG_CPU:
+                        try:
+                            loads = parse_cpu(frame.payload)
+                        except ValueError as e:
+                            print("bad cpu record: %s" % e)
+                            continue
+                        numbers.update((t.number, t.name) for t in loads)
+                        render(loads)
+                    elif frame.kind == DIAG_STACK:
+                        show_stack(frame.payload, numbers)
+                    elif frame.kind == DIAG_POWER:
+                        try:
+                            p = parse_power(frame.payload)
+                        except ValueError as e:
+                            print("bad power record: %s" % e)
+                            continue
+                        print("asleep %.1f %%, %d sleeps, longest %d ms, masked %d cycles" % (
+                            p.residency / 10, p.sleeps, p.longest_ms, p.masked_cycles))
+                    elif frame.kind == DIAG_CRASH:
+                        if crash_shown:
+                            continue
+                        try:
+                            print("\n".join(describe(parse_crash(frame.payload))))
+                        except ValueError as e:
+                            print("bad crash record: %s" % e)
+                            continue
+                        crash_shown = True
+                    elif frame.kind == DIAG_ISR:
+                        try:
+                            report = list(enumerate(parse_isr(frame.payload)))
+                        except ValueError as e:
+                            print("bad isr record: %s" % e)
+                            continue
+                        print("\n".join(render_isr(report, ISR_NAMES)))
+                    elif frame.kind == DIAG_BOOT:
+                        try:
+                            times = parse_boot(frame.payload)
+                        except ValueError as e:
+                            print("bad boot record: %s" % e)
+                            continue
+                        if times != boot_shown:
+                            print("\n".join(render_boot(times, BOOT_PHASES)))
+                            boot_shown = times
+                    else:
+                        print("diag 0x%02X: %s" % (frame.kind, frame.payload.hex()))
+        except KeyboardInterrupt:
+            pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
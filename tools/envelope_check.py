@@ -0,0 +1,276 @@
+"""
+Check the transmitter envelope ranging against synthetic echo buffers.
+
+Compiles firmware/transmitter_node/Core/Src/echo_envelope.c with
+arm_correlate_fast_q15 from the vendored CMSIS-DSP sources into a shared
+library with the host C compiler, and feeds it pings built from the echo
+model of tools/gen_echo_template.py: the burst ringing at the start, echoes
+at chosen ranges and strengths, a baseline and white noise, quantised to
+12 bits as the ADC would. It prints:
+
+    - the range error over a sweep of ranges, strong and weak, which has to
+      stay within TOL_MM, and how many pings missed their echo;
+    - the range error over echo strengths, which moves the threshold
+      crossing of a digital echo pin but not a correlation peak;
+    - the smallest spacing at which two echoes are told apart;
+    - the false echoes found in pings of noise only;
+    - that the burst ringing is heard in every ping, and in none of a dead
+      transducer's, which usensor.c reports as silent.
+
+The cycle cost can only be measured on the target: in envelope mode
+Tx_Report writes "ENV,<avg_cycles>,<worst_cycles>,<budget>,<overruns>,
+<pings>,<echoes>" lines on USART2, which are summarised against the
+schedule cycle when captures (or a serial port) are given:
+
+    python tools/envelope_check.py
+    python tools/envelope_check.py --log env.txt
+"""
+import argparse
+import ctypes
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+NODE = os.path.join(ROOT, "firmware", "transmitter_node")
+SRC = os.path.join(NODE, "Core", "Src", "echo_envelope.c")
+INC = os.path.join(NODE, "Core", "Inc")
+DSP = os.path.join(NODE, "Drivers", "CMSIS", "DSP")
+
+sys.path.insert(0, os.path.dirname(__file__))
+
+from gen_echo_template import RATE_HZ, envelope  # noqa: E402
+
+#: Samples per ping, ECHO_ENV_SAMPLES in echo_envelope.h
+SAMPLES = 160
+
+#: Echoes returned at most, ECHO_ENV_MAX_ECHOES
+MAX_ECHOES = 4
+
+#: Time of the first sample after the burst (us), ECHO_ENV_FIRST_SAMPLE_US
+FIRST_SAMPLE_US = 1e6 / RATE_HZ
+
+#: Range per us of flight (mm), ECHO_CM_PER_MS in echo_range.h
+MM_PER_US = 0.17
+
+#: ADC baseline and noise (counts, standard deviation)
+BASELINE = 200
+NOISE = 15
+
+#: Burst ringing picked up at the start of every ping (counts)
+DIRECT = 3000
+
+#: Echo strengths (counts): strong and weak
+STRONG = 2000
+WEAK = 300
+
+#: Ranges swept (mm), past the blanking of the burst and up to USENSOR_NO_ECHO
+RANGES_MM = range(200, 2541, 7)
+
+#: Largest range error allowed (mm)
+TOL_MM = 10.0
+
+#: Spacings of two echoes tried (mm)
+SPACINGS_MM = (50, 75, 100, 150, 200, 300)
+
+#: Pings of noise only
+NOISE_PINGS = 1000
+
+#: Schedule cycle (ms) and core clock (Hz) of the transmitter
+CYCLE_MS = 60
+CPU_HZ = 72000000
+
+
+class Echo(ctypes.Structure):
+    """EchoEnvEchoTypeDef"""
+    _fields_ = [("mm", ctypes.c_uint16), ("strength", ctypes.c_uint16)]
+
+
+def build(cc):
+    """Compile the ranging and return the loaded library."""
+    out = os.path.join(tempfile.mkdtemp(), "echo_envelope.so")
+    subprocess.check_call([cc, "-O2", "-shared", "-fPIC", "-w", "-DARM_MATH_CM3",
+                           "-I", INC, "-I", os.path.join(DSP, "Include"),
+                           "-I", os.path.join(NODE, "Drivers", "CMSIS", "Include"), SRC,
+                           os.path.join(DSP, "Source", "FilteringFunctions", "arm_correlate_fast_q15.c"),
+                           "-o", out])
+    lib = ctypes.CDLL(out)
+    lib.EchoEnv_Range.argtypes = [ctypes.POINTER(ctypes.c_uint16), ctypes.POINTER(Echo), ctypes.c_uint8]
+    lib.EchoEnv_Range.restype = ctypes.c_uint8
+    lib.EchoEnv_Ringing.restype = ctypes.c_uint8
+    return lib
+
+
+#: Echo envelope on a 1 us grid
+_SHAPE = [envelope(t) for t in range(2000)]
+
+
+def shape(t_us):
+    if t_us <= 0 or t_us >= len(_SHAPE) - 1:
+        return 0.0
+    i = int(t_us)
+    return _SHAPE[i] + (_SHAPE[i + 1] - _SHAPE[i]) * (t_us - i)
+
+
+def ping(echoes, rng, noise=NOISE, direct=DIRECT):
+    """ADC samples of a ping with echoes as (range mm, strength counts) and
+    the burst ringing picked up at direct counts."""
+    period_us = 1e6 / RATE_HZ
+    samples = []
+    for n in range(SAMPLES):
+        t = FIRST_SAMPLE_US + n * period_us
+        value = BASELINE + direct * shape(t) + rng.gauss(0, noise)
+        for mm, strength in echoes:
+            value += strength * shape(t - mm / MM_PER_US)
+        samples.append(min(4095, max(0, int(round(value)))))
+    return samples
+
+
+def measure(lib, samples):
+    """Return the echoes found as (mm, strength), nearest first."""
+    buf = (ctypes.c_uint16 * SAMPLES)(*samples)
+    echoes = (Echo * MAX_ECHOES)()
+    found = lib.EchoEnv_Range(buf, echoes, MAX_ECHOES)
+    return [(e.mm, e.strength) for e in echoes[:found]]
+
+
+def ringing(lib, samples):
+    """Return whether the burst ringing is heard in a ping."""
+    measure(lib, samples)
+    return bool(lib.EchoEnv_Ringing())
+
+
+def sweep(lib, strength, rng):
+    """Return (worst error, rms error, misses) over RANGES_MM."""
+    errors = []
+    misses = 0
+    for mm in RANGES_MM:
+        found = measure(lib, ping([(mm, strength)], rng))
+        if not found:
+            misses += 1
+            continue
+        errors.append(min(abs(f - mm) for f, _ in found))
+    rms = (sum(e * e for e in errors) / len(errors)) ** 0.5 if errors else 0.0
+    return (max(errors) if errors else 0.0), rms, misses
+
+
+def resolve(lib, rng, trials=20):
+    """Return {spacing: pings with both echoes within TOL_MM}."""
+    result = {}
+    for spacing in SPACINGS_MM:
+        ok = 0
+        for _ in range(trials):
+            near = rng.uniform(300, 1800)
+            found = [mm for mm, _ in measure(lib, ping([(near, STRONG), (near + spacing, STRONG)], rng))]
+            ok += any(abs(f - near) <= TOL_MM for f in found) and \
+                any(abs(f - near - spacing) <= TOL_MM for f in found)
+        result[spacing] = ok / float(trials)
+    return result
+
+
+def parse_text(line):
+    """Parse one "ENV,..." line into its six counters; None otherwise."""
+    fields = line.strip().split(",")
+    if len(fields) != 7 or fields[0] != "ENV":
+        return None
+    try:
+        return tuple(int(f) for f in fields[1:])
+    except ValueError:
+        return None
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        stats = parse_text(line)
+        if stats:
+            yield stats
+
+
+def report_cost(sources, baudrate, hz):
+    """Print the target cycles per ping found in the captures."""
+    cycles = pings = echoes = overruns = worst = 0
+    budget = None
+    try:
+        for source in sources:
+            for avg, w, b, over, n, e in read_text(source, baudrate):
+                cycles += avg * n
+                pings += n
+                echoes += e
+                overruns += over
+                worst = max(worst, w)
+                budget = b
+    except KeyboardInterrupt:
+        pass
+    if not pings:
+        print("no envelope reports found")
+        return 1
+    slot = CYCLE_MS * hz / 1000.0
+    print("%d pings, %.2f echoes each: avg %.0f cycles (%.1f us), worst %d (%.1f us), "
+          "%.2f%% of a %d ms cycle, budget %d, overruns %d" % (
+              pings, echoes / float(pings), cycles / float(pings), cycles * 1e6 / pings / hz,
+              worst, worst * 1e6 / hz, 100.0 * worst / slot, CYCLE_MS, budget, overruns))
+    return 1 if overruns or worst > slot else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cc", default="cc", help="host C compiler")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--log", nargs="+", help="serial port or captures with ENV lines")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--hz", type=int, default=CPU_HZ, help="core clock (Hz)")
+    args = parser.parse_args()
+
+    if args.log:
+        return report_cost(args.log, args.baudrate, args.hz)
+
+    lib = build(args.cc)
+    rng = random.Random(args.seed)
+    failed = 0
+
+    for name, strength in (("strong", STRONG), ("weak", WEAK)):
+        worst, rms, misses = sweep(lib, strength, rng)
+        ok = worst <= TOL_MM and not misses
+        failed += not ok
+        print("%-6s echoes, %4d-%4d mm: error rms %.1f, worst %.1f mm (limit %.0f), %d missed  %s"
+              % (name, RANGES_MM[0], RANGES_MM[-1], rms, worst, TOL_MM, misses, "ok" if ok else "FAIL"))
+
+    spread = []
+    for strength in (WEAK, 600, 1000, STRONG, 3000):
+        found = measure(lib, ping([(1000, strength)], random.Random(args.seed), noise=0))
+        spread.append(found[0][0] if found else None)
+    ok = None not in spread and max(spread) - min(spread) <= TOL_MM
+    failed += not ok
+    print("strength %d-%d at 1000 mm: %s mm  %s" % (WEAK, 3000, spread, "ok" if ok else "FAIL"))
+
+    resolved = resolve(lib, rng)
+    print("two echoes told apart: %s" % ", ".join(
+        "%d mm %.0f%%" % (s, 100 * r) for s, r in sorted(resolved.items())))
+    ok = resolved[SPACINGS_MM[-1]] == 1.0
+    failed += not ok
+
+    false = sum(len(measure(lib, ping([], rng))) for _ in range(NOISE_PINGS))
+    ok = false <= NOISE_PINGS // 100
+    failed += not ok
+    print("noise only: %d false echoes in %d pings  %s" % (false, NOISE_PINGS, "ok" if ok else "FAIL"))
+
+    live = sum(ringing(lib, ping([], rng)) for _ in range(NOISE_PINGS))
+    dead = sum(ringing(lib, ping([], rng, direct=0)) for _ in range(NOISE_PINGS))
+    ok = live == NOISE_PINGS and not dead
+    failed += not ok
+    print("burst ringing heard: %d of %d pings, %d of %d dead  %s" % (
+        live, NOISE_PINGS, dead, NOISE_PINGS, "ok" if ok else "FAIL"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,186 @@
+"""
+Check the CMSIS-DSP range filter against the plain C build on the host.
+
+Compiles firmware/transmitter_node/Core/Src/range_filter.c twice per
+low-pass kernel, with RANGE_FILTER_USE_CMSIS=1 (the vendored fast q15
+kernels) and =0 (the plain C loops), against the HAL and core mocks of
+test/host/mocks. Both builds filter the same noisy readings: approaches,
+spikes, missed echoes, steps and the ends of the range. The plain C
+output must match the CMSIS one within TOLERANCE_CM; the q15 states differ
+by a few LSBs of rounding, which can move the output across a half cm.
+The median and tracker stages are the same code, so the tracked
+velocities must match exactly. Then each build is timed on a long run of
+readings. Prints the comparison and timing of every build and exits
+non-zero if any build drifts:
+
+    python tools/filter_check.py
+    python tools/filter_check.py --cc clang --samples 1000000
+
+The host times rank the builds; tools/filter_report.py reads the cycle
+counts of the target ("FLT" lines).
+"""
+import argparse
+import ctypes
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+NODE = os.path.join(ROOT, "firmware", "transmitter_node")
+SRC = os.path.join(NODE, "Core", "Src")
+INC = os.path.join(NODE, "Core", "Inc")
+CMSIS = os.path.join(NODE, "Drivers", "CMSIS")
+DSP = os.path.join(CMSIS, "DSP", "Source", "FilteringFunctions")
+MOCKS = os.path.join(ROOT, "test", "host", "mocks")
+
+#: Reported when no echo came back (USENSOR_NO_ECHO)
+NO_ECHO = 255
+
+#: Largest difference allowed between the builds (cm)
+TOLERANCE_CM = 1
+
+#: Low-pass kernels, RANGE_FILTER_KERNEL value
+KERNELS = [("biquad", 0), ("fir", 1)]
+
+#: Loop of the filter, so the timing holds no per-sample Python call
+DRIVER = r"""
+#include "range_filter.h"
+
+void FilterCheck_Run(uint8_t sensor, const uint8_t *in, uint8_t *out, int16_t *closing, uint32_t n)
+{
+    RangeTrackTypeDef track;
+
+    while (n--)
+    {
+        *out++ = RangeFilter_Process(sensor, *in++);
+        if (closing)
+        {
+            RangeFilter_GetTrack(sensor, &track);
+            *closing++ = track.closing_mm_s;
+        }
+    }
+}
+"""
+
+
+def build(cc, kernel, cmsis):
+    """Compile one build of the filter and return the loaded library."""
+    tmp = tempfile.mkdtemp()
+    driver = os.path.join(tmp, "filter_check.c")
+    with open(driver, "w") as f:
+        f.write(DRIVER)
+    out = os.path.join(tmp, "range_filter.so")
+    includes = [MOCKS, INC, os.path.join(NODE, "Drivers", "STM32F1xx_HAL_Driver", "Inc"),
+                os.path.join(CMSIS, "Device", "ST", "STM32F1xx", "Include"),
+                os.path.join(CMSIS, "Include"), os.path.join(CMSIS, "DSP", "Include"),
+                os.path.join(NODE, "Middlewares", "Third_Party", "FreeRTOS", "Source", "CMSIS_RTOS_V2")]
+    subprocess.check_call([cc, "-O2", "-shared", "-fPIC", "-w", "-DSTM32F103x6", "-DUSE_HAL_DRIVER",
+                           "-DARM_MATH_CM3", "-DRANGE_FILTER_KERNEL=%d" % kernel,
+                           "-DRANGE_FILTER_USE_CMSIS=%d" % cmsis] +
+                          ["-I" + i for i in includes] +
+                          [driver, os.path.join(SRC, "range_filter.c"), os.path.join(SRC, "fmt.c"),
+                           os.path.join(SRC, "median_filter.c"), os.path.join(SRC, "range_tracker.c"),
+                           os.path.join(MOCKS, "hal_mock.c"),
+                           os.path.join(DSP, "arm_biquad_cascade_df1_fast_q15.c"),
+                           os.path.join(DSP, "arm_biquad_cascade_df1_init_q15.c"),
+                           os.path.join(DSP, "arm_fir_fast_q15.c"),
+                           os.path.join(DSP, "arm_fir_init_q15.c"),
+                           "-o", out])
+    lib = ctypes.CDLL(out)
+    lib.FilterCheck_Run.argtypes = [ctypes.c_uint8, ctypes.POINTER(ctypes.c_uint8),
+                                    ctypes.POINTER(ctypes.c_uint8), ctypes.POINTER(ctypes.c_int16),
+                                    ctypes.c_uint32]
+    lib.FilterCheck_Run.restype = None
+    return lib
+
+
+# --------------------------------------------------------------------------
+# Readings
+# --------------------------------------------------------------------------
+
+def noisy(cm, rng):
+    return min(NO_ECHO - 1, max(0, int(round(cm + rng.gauss(0, 1.0)))))
+
+
+def readings(rng):
+    """Readings of one sensor through every case, back to back."""
+    out = []
+    # Approach from the far end to the bumper
+    out += [noisy(250 - n * 0.8, rng) for n in range(290)]
+    # Parked, with missed echoes and spikes from something nearer
+    for n in range(300):
+        r = rng.random()
+        out.append(NO_ECHO if r < 0.05 else 20 if r < 0.1 else noisy(60, rng))
+    # Steps, in and out of range
+    for level in (30, 200, 5, 254, 120, NO_ECHO, 80, 0, 180):
+        out += [level] * 40
+    # Random walk over the whole range
+    cm = 128.0
+    for n in range(2000):
+        cm = min(254.0, max(0.0, cm + rng.gauss(0, 4.0)))
+        out.append(NO_ECHO if rng.random() < 0.02 else noisy(cm, rng))
+    return out
+
+
+def run(lib, sensor, data):
+    """Filter readings; return (filtered cm, closing mm/s)."""
+    n = len(data)
+    out = (ctypes.c_uint8 * n)()
+    closing = (ctypes.c_int16 * n)()
+    lib.FilterCheck_Run(sensor, (ctypes.c_uint8 * n)(*data), out, closing, n)
+    return list(out), list(closing)
+
+
+def timing(lib, data, repeat):
+    """Best time per sample (ns) over repeat runs of the readings."""
+    n = len(data)
+    buf = (ctypes.c_uint8 * n)(*data)
+    out = (ctypes.c_uint8 * n)()
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        lib.FilterCheck_Run(1, buf, out, None, n)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best * 1e9 / n
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cc", default="cc", help="host C compiler")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--samples", type=int, default=200000, help="readings per timing run")
+    parser.add_argument("--repeat", type=int, default=5, help="timing runs, the best is kept")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    data = readings(rng)
+    bench = [data[n % len(data)] for n in range(args.samples)]
+    failed = 0
+
+    print("%-10s %9s %10s %9s %9s %8s" % ("kernel", "samples", "max(cm)", "differ", "ns/samp", "vs cmsis"))
+    for name, kernel in KERNELS:
+        cmsis = build(args.cc, kernel, 1)
+        plain = build(args.cc, kernel, 0)
+
+        ref_out, ref_closing = run(cmsis, 0, data)
+        out, closing = run(plain, 0, data)
+        worst = max(abs(a - b) for a, b in zip(ref_out, out))
+        differ = sum(a != b for a, b in zip(ref_out, out))
+        ok = worst <= TOLERANCE_CM and closing == ref_closing
+        failed += not ok
+
+        ref_ns = timing(cmsis, bench, args.repeat)
+        ns = timing(plain, bench, args.repeat)
+        print("%-10s %9d %10s %9s %9.1f %8s" % (name, len(data), "-", "-", ref_ns, "1.00x"))
+        print("%-10s %9d %7d/%-2d %8.2f%% %9.1f %7.2fx  %s" % (
+            name + "_c", len(data), worst, TOLERANCE_CM, 100.0 * differ / len(data), ns, ns / ref_ns,
+            "ok" if ok else "FAIL" if closing == ref_closing else "FAIL (velocity)"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,105 @@
+"""
+Show the cost of the transmitter range filter and compare kernels.
+
+The transmitter writes "FLT,<kernel>,<avg_cycles>,<worst_cycles>,<budget>,
+<overruns>" text lines on USART2 (see range_filter.h), about once a second.
+The kernel is the low-pass the build runs: biquad or fir on the CMSIS-DSP
+fast q15 functions, biquad_c or fir_c on the plain C loops
+(RANGE_FILTER_USE_CMSIS=0), with a _sort suffix when the median stage sorts
+its whole window per sample (MEDIAN_FILTER_SORTED=0). For every capture this prints the average and
+worst time per sample against the budget; given captures of several builds
+it also prints how each kernel compares with the fastest one, measured on
+the target itself; tools/filter_check.py compares the builds on the host,
+outputs and timing, without flashing them.
+
+Usage:
+    python tools/filter_report.py COM9                     # live USART2
+    python tools/filter_report.py cmsis.txt plain_c.txt    # saved lines
+"""
+import argparse
+import os
+import sys
+from collections import namedtuple
+
+#: Core clock of the transmitter (Hz)
+CPU_HZ = 72000000
+
+#: One "FLT" line
+FilterStats = namedtuple("FilterStats", "kernel avg worst budget overruns")
+
+
+def parse_text(line):
+    """Parse one "FLT,..." line into FilterStats; None for other lines."""
+    fields = line.strip().split(",")
+    if len(fields) != 6 or fields[0] != "FLT":
+        return None
+    try:
+        return FilterStats(fields[1], *(int(f) for f in fields[2:]))
+    except ValueError:
+        return None
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        stats = parse_text(line)
+        if stats:
+            yield stats
+
+
+def summarise(reports):
+    """Return {kernel: (mean of avg, worst, budget, overruns)} over the reports."""
+    kernels = {}
+    for s in reports:
+        if not s.avg:
+            continue
+        avgs, worst, _, overruns = kernels.get(s.kernel, ([], 0, s.budget, 0))
+        avgs.append(s.avg)
+        kernels[s.kernel] = (avgs, max(worst, s.worst), s.budget, overruns + s.overruns)
+    return {k: (sum(a) / float(len(a)), w, b, o) for k, (a, w, b, o) in kernels.items()}
+
+
+def render(summary, hz=CPU_HZ):
+    """Return the comparison lines of summarise()."""
+    lines = ["%-10s %9s %9s %8s %8s %9s %7s" % ("kernel", "avg(cyc)", "worst", "avg(us)",
+                                              "budget", "overruns", "vs best")]
+    best = min(avg for avg, _, _, _ in summary.values())
+    for kernel, (avg, worst, budget, overruns) in sorted(summary.items(), key=lambda i: i[1][0]):
+        lines.append("%-10s %9.0f %9d %8.2f %8d %9d %6.2fx" % (kernel, avg, worst, avg * 1e6 / hz,
+                                                             budget, overruns, avg / best))
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("sources", nargs="+", help="serial port or capture files")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--hz", type=int, default=CPU_HZ, help="core clock (Hz)")
+    args = parser.parse_args()
+
+    reports = []
+    try:
+        for source in args.sources:
+            for stats in read_text(source, args.baudrate):
+                if len(args.sources) == 1 and not os.path.isfile(source):
+                    print("%-10s avg %5d worst %5d cycles (budget %d), %d overruns" % stats)
+                reports.append(stats)
+    except KeyboardInterrupt:
+        pass
+    summary = summarise(reports)
+    if not summary:
+        print("no filter reports found")
+        return 1
+
+    print("\n".join(render(summary, args.hz)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,136 @@
+"""
+Generate the burst template of the transmitter envelope ranging.
+
+In envelope capture mode (USENSOR_ENVELOPE, see echo_envelope.h) the
+transmitter samples the receive envelope of each ping with the ADC and
+correlates it with the envelope one echo is expected to have. That shape is
+modelled here: a BURST_CYCLES burst at CARRIER_HZ rings up and down through
+the transmitting and the receiving transducer, each a resonator of quality
+factor Q. It is sampled at the ADC rate from the burst onset and written,
+in q15, to:
+
+    - firmware/transmitter_node/Core/Inc/echo_template.h
+
+The taps are scaled to a sum just under one, which keeps the 2.30
+accumulator of arm_correlate_fast_q15 from wrapping for any input.
+tools/envelope_check.py builds its synthetic echoes from the same model.
+Run from any directory after editing the specification:
+
+    python tools/gen_echo_template.py
+"""
+import math
+import os
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+# --------------------------------------------------------------------------
+# Template specification
+# --------------------------------------------------------------------------
+
+#: Transducer resonance and burst frequency (Hz)
+CARRIER_HZ = 40000
+
+#: Carrier cycles in one burst
+BURST_CYCLES = 8
+
+#: Quality factor of each transducer
+Q = 15
+
+#: ADC sample rate of the envelope (Hz), ECHO_ENV_RATE_HZ in echo_envelope.h
+RATE_HZ = 10000
+
+#: Envelope tail kept, relative to its peak
+TAIL = 0.05
+
+#: Sum of the taps, relative to q15 one
+TAP_SUM = 0.98
+
+Q15_ONE = 1 << 15
+
+
+def _ring(t_us):
+    """Receive envelope t_us after the burst onset, unscaled.
+
+    Each resonator rings up as 1 - exp(-t / tau) while driven and down as
+    exp(-t / tau) afterwards; the second one is driven by the output of the
+    first, which is a convolution of the two envelopes, integrated here on
+    a 1 us grid.
+    """
+    tau = Q / (math.pi * CARRIER_HZ) * 1e6
+    burst = BURST_CYCLES * 1e6 / CARRIER_HZ
+
+    def first(t):
+        if t < burst:
+            return 1.0 - math.exp(-t / tau)
+        return (1.0 - math.exp(-burst / tau)) * math.exp(-(t - burst) / tau)
+
+    if t_us <= 0:
+        return 0.0
+    return sum(first(t_us - s) * math.exp(-s / tau) for s in range(int(t_us) + 1)) / tau
+
+
+_PEAK = max(_ring(t) for t in range(0, 2000, 5))
+
+
+def envelope(t_us):
+    """Receive envelope t_us after the burst onset, peak 1."""
+    return _ring(t_us) / _PEAK
+
+
+def template():
+    """Return the q15 taps, one per ADC sample from the burst onset."""
+    period_us = 1e6 / RATE_HZ
+    shape = []
+    t = 0.0
+    while True:
+        value = envelope(t)
+        if shape and value < TAIL and value < shape[-1]:
+            break
+        shape.append(value)
+        t += period_us
+    scale = TAP_SUM * Q15_ONE / sum(shape)
+    return [int(round(v * scale)) for v in shape]
+
+
+def write_c_header(path, taps):
+    text = """\
+/**
+ * @file    echo_template.h
+ * @ingroup Transmitter_Node
+ * @brief   Envelope of one echo, for envelope ranging (generated, do not edit).
+ *
+ * Generated by tools/gen_echo_template.py for a %d-cycle %d kHz burst,
+ * transducers of Q %d and %d Hz sampling. Edit the specification there and
+ * re-run it.
+ */
+#ifndef __ECHO_TEMPLATE_H
+#define __ECHO_TEMPLATE_H
+
+/** Sample rate the template is made for (Hz) */
+#define ECHO_TEMPLATE_RATE_HZ   %du
+
+/** Number of taps */
+#define ECHO_TEMPLATE_LEN       %du
+
+/** Envelope from the burst onset, one tap per sample, sum under one (q15) */
+#define ECHO_TEMPLATE_TAPS      { %s }
+
+#endif /* __ECHO_TEMPLATE_H */
+""" % (BURST_CYCLES, CARRIER_HZ // 1000, Q, RATE_HZ, RATE_HZ, len(taps),
+       ", ".join("%d" % t for t in taps))
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def main():
+    taps = template()
+    write_c_header(os.path.join(ROOT, "firmware", "transmitter_node", "Core", "Inc",
+                                "echo_template.h"), taps)
+    peak = max(range(len(taps)), key=lambda i: taps[i])
+    print("template: %d taps, sum %d, peak at tap %d (%.0f us)"
+          % (len(taps), sum(taps), peak, peak * 1e6 / RATE_HZ))
+    return 0
+
+
+if __name__ == "__main__":
+    main()
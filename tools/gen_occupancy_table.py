@@ -0,0 +1,195 @@
+"""
+Generate the occupancy grid geometry shared by the receiver and the GUI.
+
+The grid covers the area behind the bumper in square cells; the sensors
+sit on the bumper line, each with its lateral position and yaw in SENSORS
+below. For each sensor, every cell whose centre lies inside its beam is
+listed with its range, sorted from near to far, so a measurement updates
+the grid in a single pass over a flash table (occupancy.h):
+
+    - firmware/receiver_node/Core/Inc/occupancy_table.h  (sizes and types)
+    - firmware/receiver_node/Core/Src/occupancy_table.c  (const tables)
+    - gui/occupancy_table.py                             (grid geometry)
+
+Run from any directory after editing the specification:
+
+    python tools/gen_occupancy_table.py
+"""
+import math
+import os
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+# --------------------------------------------------------------------------
+# Grid specification
+# --------------------------------------------------------------------------
+
+#: Cells across the bumper, centred on its middle
+COLS = 16
+
+#: Cells away from the bumper
+ROWS = 16
+
+#: Side of one cell (cm)
+CELL_CM = 10
+
+#: (lateral position in mm, positive right of the bumper centre, yaw in
+#: degrees, positive turned right) of each sensor, in CAN payload order.
+#: TRILAT_BASELINE_MM apart on the transmitter.
+SENSORS = [
+    (-150, 0),
+    (150, 0),
+]
+
+#: Half-angle of each sensor's beam (degrees)
+BEAM_HALF_DEG = 30
+
+#: Largest range of a cell that fits the table (cm)
+MAX_CM = 254
+
+
+def cell_centre(cell):
+    """(lateral, forward) of a cell centre in cm."""
+    row, col = divmod(cell, COLS)
+    return (col - COLS / 2.0 + 0.5) * CELL_CM, (row + 0.5) * CELL_CM
+
+
+def build_beams():
+    """Return one list of (cell, range cm) per sensor, sorted by range."""
+    if COLS * ROWS > 256:
+        raise ValueError("%d cells do not fit a byte index" % (COLS * ROWS))
+    beams = []
+    for lateral_mm, yaw in SENSORS:
+        beam = []
+        for cell in range(COLS * ROWS):
+            x, y = cell_centre(cell)
+            dx = x - lateral_mm / 10.0
+            bearing = math.degrees(math.atan2(dx, y)) - yaw
+            if abs(bearing) > BEAM_HALF_DEG:
+                continue
+            cm = int(round(math.hypot(dx, y)))
+            if cm > MAX_CM:
+                raise ValueError("cell %d is %d cm from sensor, over %d" % (cell, cm, MAX_CM))
+            beam.append((cm, cell))
+        beams.append([(cell, cm) for cm, cell in sorted(beam)])
+    return beams
+
+
+BANNER = "Generated by tools/gen_occupancy_table.py - do not edit by hand."
+
+
+def write_c_header(path, beams):
+    text = """/**
+ * @file    occupancy_table.h
+ * @ingroup Receiver_Node
+ * @brief   Occupancy grid geometry shared with the GUI.
+ *
+ * %s
+ *
+ * The grid is OCC_COLS cells across the bumper by OCC_ROWS away from it,
+ * each OCC_CELL_CM square; cell index is row * OCC_COLS + column, row 0
+ * against the bumper and column 0 on the left. The cells inside the beam
+ * of sensor s are occBeamCells[occBeamStart[s]] up to, not including,
+ * occBeamCells[occBeamStart[s + 1]], sorted by range.
+ */
+#ifndef __OCCUPANCY_TABLE_H
+#define __OCCUPANCY_TABLE_H
+
+#include <stdint.h>
+
+/** Cells across the bumper */
+#define OCC_COLS                %du
+/** Cells away from the bumper */
+#define OCC_ROWS                %du
+/** Number of cells */
+#define OCC_CELLS               (OCC_COLS * OCC_ROWS)
+/** Side of one cell (cm) */
+#define OCC_CELL_CM             %du
+/** Number of sensors */
+#define OCC_SENSORS             %du
+/** Entries in occBeamCells */
+#define OCC_BEAM_CELLS          %du
+
+/** One cell inside a sensor's beam */
+typedef struct
+{
+    uint8_t cell;       /**< Cell index */
+    uint8_t cm;         /**< Range of the cell centre from the sensor (cm) */
+} OccBeamCellTypeDef;
+
+/** Cells of every beam, sensor by sensor, each sorted by range */
+extern const OccBeamCellTypeDef occBeamCells[OCC_BEAM_CELLS];
+
+/** First entry of each sensor's beam in occBeamCells, and the end */
+extern const uint16_t occBeamStart[OCC_SENSORS + 1u];
+
+#endif /* __OCCUPANCY_TABLE_H */
+""" % (BANNER, COLS, ROWS, CELL_CM, len(SENSORS), sum(len(b) for b in beams))
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def write_c_source(path, beams):
+    rows = []
+    starts = [0]
+    for sensor, beam in enumerate(beams):
+        rows.append("    /* Sensor %d: %d mm, %d deg */" % ((sensor,) + SENSORS[sensor]))
+        for i in range(0, len(beam), 6):
+            rows.append("    " + " ".join("{ %3du, %3du }," % entry for entry in beam[i:i + 6]))
+        starts.append(starts[-1] + len(beam))
+    text = """/**
+ * @file    occupancy_table.c
+ * @ingroup Receiver_Node
+ * @brief   Occupancy grid beam tables.
+ *
+ * %s
+ */
+#include "occupancy_table.h"
+
+const OccBeamCellTypeDef occBeamCells[OCC_BEAM_CELLS] = {
+%s
+};
+
+const uint16_t occBeamStart[OCC_SENSORS + 1u] = { %s };
+""" % (BANNER, "\n".join(rows), ", ".join("%du" % s for s in starts))
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def write_python(path):
+    text = '''"""
+Occupancy grid geometry shared with the receiver firmware.
+
+%s
+"""
+
+#: Cells across the bumper; column 0 is on the left
+COLS = %d
+
+#: Cells away from the bumper; row 0 is against it
+ROWS = %d
+
+#: Side of one cell (cm)
+CELL_CM = %d
+
+#: (lateral position in mm, positive right, yaw in degrees) per sensor
+SENSORS = %r
+
+#: Half-angle of each sensor's beam (degrees)
+BEAM_HALF_DEG = %d
+''' % (BANNER, COLS, ROWS, CELL_CM, SENSORS, BEAM_HALF_DEG)
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def main():
+    beams = build_beams()
+    write_c_header(os.path.join(
+        ROOT, "firmware", "receiver_node", "Core", "Inc", "occupancy_table.h"), beams)
+    write_c_source(os.path.join(
+        ROOT, "firmware", "receiver_node", "Core", "Src", "occupancy_table.c"), beams)
+    write_python(os.path.join(ROOT, "gui", "occupancy_table.py"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,183 @@
+"""
+Generate the q15 coefficients of the transmitter range filter.
+
+The transmitter smooths every sensor's distance once per schedule cycle
+(see range_filter.h) with either a second-order Butterworth low-pass, run
+as a CMSIS-DSP biquad, or a Hamming-windowed sinc FIR. Both are designed
+here for the schedule rate and written as initialisers to:
+
+    - firmware/transmitter_node/Core/Inc/range_filter_coef.h
+
+The quantised coefficients are adjusted to a DC gain of exactly one, so a
+parked car reads the same distance filtered and unfiltered. The design is
+printed with its group delay and step response, which is what the driver
+sees as added reaction time. The lag of each kernel behind a steady
+approach is also written to the header: the transmitter adds it to the
+age of the samples it sends, for the receiver to predict it away. Run from any directory after editing the
+specification:
+
+    python tools/gen_range_filter.py
+"""
+import math
+import os
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+# --------------------------------------------------------------------------
+# Filter specification
+# --------------------------------------------------------------------------
+
+#: Schedule cycle (ms), TT_CYCLE_MS in tt_sched.h: one sample per sensor.
+CYCLE_MS = 60
+
+#: Low-pass cut-off (Hz). The fastest approach worth tracking is about
+#: 1 m/s, which crosses a 20 cm zone in 200 ms.
+CUTOFF_HZ = 3.0
+
+#: FIR length; even, as arm_fir_fast_q15 needs, and at most 8 so the
+#: accumulator keeps its headroom with the input scaling of range_filter.c.
+FIR_TAPS = 6
+
+Q15_ONE = 1 << 15
+
+
+def butterworth():
+    """Return (b0, b1, b2, a1, a2) of y = b.x - a.y, bilinear transform."""
+    k = math.tan(math.pi * CUTOFF_HZ * CYCLE_MS / 1000.0)
+    norm = 1.0 / (1.0 + math.sqrt(2.0) * k + k * k)
+    b0 = k * k * norm
+    return (b0, 2.0 * b0, b0, 2.0 * (k * k - 1.0) * norm,
+            (1.0 - math.sqrt(2.0) * k + k * k) * norm)
+
+
+def quantise_biquad(coefs):
+    """Return (q15 list in CMSIS DF1 order {b0, 0, b1, b2, a1, a2}, postShift).
+
+    CMSIS adds the feedback terms, so a1 and a2 change sign. Coefficients are
+    scaled down by 2^postShift to fit q15; b1 absorbs the rounding so that
+    the DC gain sum(b) / (1 - sum(a)) is exactly one.
+    """
+    b0, b1, b2, a1, a2 = coefs
+    shift = 0
+    while max(abs(c) for c in coefs) >= (1 << shift):
+        shift += 1
+    scale = Q15_ONE >> shift
+
+    def q(c):
+        return max(-Q15_ONE, min(Q15_ONE - 1, int(round(c * scale))))
+
+    qb0, qb2, qa1, qa2 = q(b0), q(b2), q(-a1), q(-a2)
+    qb1 = scale - qa1 - qa2 - qb0 - qb2
+    return [qb0, 0, qb1, qb2, qa1, qa2], shift
+
+
+def fir():
+    """Return the q15 taps of the windowed-sinc low-pass, summing to one."""
+    fc = CUTOFF_HZ * CYCLE_MS / 1000.0
+    mid = (FIR_TAPS - 1) / 2.0
+    taps = []
+    for n in range(FIR_TAPS):
+        t = n - mid
+        h = 2.0 * fc * (math.sin(2.0 * math.pi * fc * t) / (2.0 * math.pi * fc * t) if t else 1.0)
+        taps.append(h * (0.54 - 0.46 * math.cos(2.0 * math.pi * n / (FIR_TAPS - 1))))
+    total = sum(taps)
+    q = [int(round(h / total * Q15_ONE)) for h in taps]
+    q[FIR_TAPS // 2] += Q15_ONE - sum(q)
+    return q
+
+
+def step_biquad(q, shift, samples):
+    """Step response (fraction of the step) of the quantised biquad."""
+    b0, _, b1, b2, a1, a2 = q
+    x1 = x2 = y1 = y2 = 0
+    out = []
+    for _ in range(samples):
+        x = 4080
+        acc = b0 * x + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2
+        y = max(-Q15_ONE, min(Q15_ONE - 1, acc >> (15 - shift)))
+        x2, x1, y2, y1 = x1, x, y1, y
+        out.append(y / 4080.0)
+    return out
+
+
+def step_fir(q, samples):
+    """Step response (fraction of the step) of the quantised FIR."""
+    return [sum(q[:n + 1]) / float(Q15_ONE) for n in range(samples)]
+
+
+def settle(step):
+    """Samples until the step response stays within 10 % of the final value."""
+    for n in range(len(step)):
+        if all(abs(v - 1.0) <= 0.1 for v in step[n:]):
+            return n + 1
+    return len(step)
+
+
+def lag_biquad(q, shift):
+    """Lag (samples) of the quantised biquad behind a ramp, i.e. its group
+    delay at DC: sum(k b_k) / sum(b) plus the same for 1 / (1 - a1 z^-1 -
+    a2 z^-2)."""
+    b0, _, b1, b2, a1, a2 = [c / float(Q15_ONE >> shift) for c in q]
+    return (b1 + 2.0 * b2) / (b0 + b1 + b2) + (a1 + 2.0 * a2) / (1.0 - a1 - a2)
+
+
+def lag_fir(q):
+    """Lag (samples) of the quantised FIR behind a ramp: its tap centroid."""
+    return sum(n * h for n, h in enumerate(q)) / float(sum(q))
+
+
+def write_c_header(path, biquad, shift, taps):
+    text = """\
+/**
+ * @file    range_filter_coef.h
+ * @ingroup Transmitter_Node
+ * @brief   Range filter coefficients (generated, do not edit).
+ *
+ * Generated by tools/gen_range_filter.py for a %d ms schedule cycle and a
+ * %.1f Hz cut-off. Edit the specification there and re-run it.
+ */
+#ifndef __RANGE_FILTER_COEF_H
+#define __RANGE_FILTER_COEF_H
+
+/** Butterworth low-pass, CMSIS DF1 order {b0, 0, b1, b2, a1, a2} (q15) */
+#define RANGE_FILTER_BIQUAD_COEFS       { %s }
+
+/** Coefficient scaling of the biquad: values are divided by 2^shift */
+#define RANGE_FILTER_BIQUAD_POST_SHIFT  %d
+
+/** Number of FIR taps */
+#define RANGE_FILTER_FIR_TAPS           %du
+
+/** Windowed-sinc low-pass taps, in CMSIS time-reversed order (q15) */
+#define RANGE_FILTER_FIR_COEFS          { %s }
+
+/** Lag of each kernel behind a steady approach (ms) */
+#define RANGE_FILTER_BIQUAD_LAG_MS      %du
+#define RANGE_FILTER_FIR_LAG_MS         %du
+
+#endif /* __RANGE_FILTER_COEF_H */
+""" % (CYCLE_MS, CUTOFF_HZ, ", ".join("%d" % c for c in biquad), shift,
+       FIR_TAPS, ", ".join("%d" % c for c in reversed(taps)),
+       int(round(lag_biquad(biquad, shift) * CYCLE_MS)), int(round(lag_fir(taps) * CYCLE_MS)))
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def main():
+    biquad, shift = quantise_biquad(butterworth())
+    taps = fir()
+
+    write_c_header(os.path.join(ROOT, "firmware", "transmitter_node", "Core", "Inc",
+                                "range_filter_coef.h"), biquad, shift, taps)
+
+    fir_delay = (FIR_TAPS - 1) / 2.0 * CYCLE_MS
+    print("biquad: %s >> %d, lag %.0f ms, 90%% after %d ms" % (
+        biquad, shift, lag_biquad(biquad, shift) * CYCLE_MS,
+        settle(step_biquad(biquad, shift, 64)) * CYCLE_MS))
+    print("fir:    %s, group delay %.0f ms, 90%% after %d ms" % (taps, fir_delay,
+                                                                settle(step_fir(taps, 64)) * CYCLE_MS))
+    return 0
+
+
+if __name__ == "__main__":
+    main()
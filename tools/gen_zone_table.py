@@ -0,0 +1,348 @@
+"""
+Generate the distance-to-zone lookup tables shared by firmware and GUI.
+
+The zone ladder is specified once in ZONES below and expanded into a
+direct-indexed table keyed by distance bucket, so that classification is a
+single table load on both sides. The time-to-collision curve TTC_CURVE is
+expanded the same way, keyed by TTC bucket:
+
+    - firmware/receiver_node/Core/Inc/zone_table.h  (types and lookup)
+    - firmware/receiver_node/Core/Src/zone_table.c  (const table in flash)
+    - gui/zone_table.py                             (same table for the GUI)
+
+Run from any directory after editing the specification:
+
+    python tools/gen_zone_table.py
+"""
+import os
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+# --------------------------------------------------------------------------
+# Zone specification
+# --------------------------------------------------------------------------
+
+#: Width of one distance bucket in centimetres. Every zone limit must be a
+#: multiple of this so that no bucket straddles two zones.
+BUCKET_CM = 10
+
+#: Largest distance that can be reported over CAN (one byte, in cm).
+MAX_CM = 255
+
+#: Buzzer period meaning "always on".
+BUZZER_CONTINUOUS = 0xFFFF
+
+#: Buzzer period meaning "silent".
+BUZZER_OFF = 0
+
+#: Time a farther zone must be observed continuously before it is shown.
+DWELL_MS = 150
+
+#: (name, inclusive upper limit in cm, number of LEDs lit, buzzer period ms,
+#: hysteresis band in cm) ordered from closest to farthest. The last zone
+#: catches everything beyond. A zone is left for a farther one only once the
+#: distance exceeds its limit plus the band for DWELL_MS; moving closer is
+#: always immediate.
+ZONES = [
+    ("RED_FULL",    30,   7, BUZZER_CONTINUOUS, 4),
+    ("RED",         50,   6, 50,                5),
+    ("YELLOW_FULL", 70,   5, 100,               5),
+    ("YELLOW",      90,   4, 300,               6),
+    ("GREEN_FULL",  110,  3, 400,               6),
+    ("GREEN",       130,  2, 600,               8),
+    ("NONE",        None, 1, BUZZER_OFF,        0),
+]
+
+
+#: Time-to-collision alerting: (TTC in ms, distance in cm) points of a
+#: piecewise-linear curve giving the distance at which a parked obstacle is
+#: as urgent as one closing in with that TTC. The receiver indicates the
+#: closer of the measured and the TTC distance, so the zone ladder above
+#: also sets the LEDs and buzzer cadence of a fast approach. TTC beyond the
+#: last point does not escalate.
+TTC_CURVE = [
+    (0,    0),
+    (600,  30),
+    (1000, 50),
+    (1400, 70),
+    (1800, 90),
+    (2200, 110),
+    (2600, 130),
+]
+
+#: Width of one TTC bucket (ms); a TTC is rounded down, towards urgency.
+TTC_BUCKET_MS = 100
+
+#: Closing velocity under which TTC is not used (mm/s): a car creeping
+#: or parked is already covered by the distance zones.
+TTC_MIN_CLOSING_MM_S = 50
+
+
+def bucket_of(cm):
+    """Return the bucket index of a distance in centimetres (ceiling)."""
+    return (cm + BUCKET_CM - 1) // BUCKET_CM
+
+
+def build_table():
+    """Expand ZONES into one (zone index, LED mask, buzzer ms) per bucket."""
+    for _, limit, _, _, _ in ZONES[:-1]:
+        if limit % BUCKET_CM:
+            raise ValueError("zone limit %d cm is not a multiple of %d cm"
+                             % (limit, BUCKET_CM))
+
+    table = []
+    for bucket in range(bucket_of(MAX_CM) + 1):
+        cm = bucket * BUCKET_CM
+        for index, (_, limit, leds, buzzer, _) in enumerate(ZONES):
+            if limit is None or cm <= limit:
+                table.append((index, (1 << leds) - 1, buzzer))
+                break
+    return table
+
+
+def build_ttc_table():
+    """Expand TTC_CURVE into one distance (cm) per TTC bucket."""
+    table = []
+    last_ms = TTC_CURVE[-1][0]
+    for bucket in range(last_ms // TTC_BUCKET_MS + 1):
+        ms = bucket * TTC_BUCKET_MS
+        for (t0, d0), (t1, d1) in zip(TTC_CURVE, TTC_CURVE[1:]):
+            if t0 <= ms <= t1:
+                table.append(int(round(d0 + (d1 - d0) * (ms - t0) / float(t1 - t0))))
+                break
+    return table
+
+
+def release_limits():
+    """Distance (cm) above which each zone may be left for a farther one."""
+    return [MAX_CM if limit is None else min(limit + band, MAX_CM)
+            for _, limit, _, _, band in ZONES]
+
+
+BANNER = "Generated by tools/gen_zone_table.py - do not edit by hand."
+
+
+def write_c_header(path):
+    names = ",\n".join("    ZONE_%s%s" % (name, " = 0" if i == 0 else "")
+                       for i, (name, _, _, _, _) in enumerate(ZONES))
+    text = """/**
+ * @file    zone_table.h
+ * @ingroup Receiver_Node
+ * @brief   Distance-to-zone lookup table shared with the GUI.
+ *
+ * %s
+ *
+ * Distances are grouped in %d cm buckets (rounded up) and each bucket maps
+ * directly to its zone, LED mask and buzzer period, so classification is a
+ * single table load. Times to collision are grouped in %d ms buckets
+ * (rounded down) and each maps to the distance of equal urgency.
+ */
+#ifndef __ZONE_TABLE_H
+#define __ZONE_TABLE_H
+
+#include <stdint.h>
+
+/** Width of one distance bucket in centimetres */
+#define ZONE_BUCKET_CM          %du
+/** Number of entries in zoneTable */
+#define ZONE_BUCKET_COUNT       %du
+
+/** Buzzer period value meaning the buzzer is held on */
+#define ZONE_BUZZER_CONTINUOUS  0x%04Xu
+/** Buzzer period value meaning the buzzer is silent */
+#define ZONE_BUZZER_OFF         %du
+
+/** Time a farther zone must persist before it is indicated (ms) */
+#define ZONE_DWELL_MS           %du
+
+/** Width of one time-to-collision bucket (ms) */
+#define ZONE_TTC_BUCKET_MS      %du
+/** Number of entries in zoneTtcCm */
+#define ZONE_TTC_BUCKET_COUNT   %du
+/** Closing velocity under which the TTC is not used (mm/s) */
+#define ZONE_TTC_MIN_CLOSING_MM_S  %du
+
+/** Indication zones, ordered from closest to farthest */
+typedef enum
+{
+%s,
+    ZONE_COUNT
+} ZoneIdTypeDef;
+
+/** One bucket of the lookup table */
+typedef struct
+{
+    uint8_t  zone;       /**< ZoneIdTypeDef value */
+    uint8_t  led_mask;   /**< LEDs to light, bit 0 = Green1 ... bit 6 = Red2 */
+    uint16_t buzzer_ms;  /**< Buzzer toggle period in ms */
+} ZoneEntryTypeDef;
+
+/** Direct-indexed zone table, one entry per distance bucket */
+extern const ZoneEntryTypeDef zoneTable[ZONE_BUCKET_COUNT];
+
+/** Per-zone distance (cm) that must be exceeded to leave the zone */
+extern const uint8_t zoneRelease[ZONE_COUNT];
+
+/** Distance (cm) as urgent as each time-to-collision bucket */
+extern const uint8_t zoneTtcCm[ZONE_TTC_BUCKET_COUNT];
+
+/**
+ * @brief  Look up the zone entry for a distance.
+ * @param  cm Distance in centimetres as received over CAN.
+ * @retval Pointer to the matching table entry.
+ */
+static inline const ZoneEntryTypeDef *Zone_Lookup(uint8_t cm)
+{
+    return &zoneTable[(cm + ZONE_BUCKET_CM - 1u) / ZONE_BUCKET_CM];
+}
+
+/**
+ * @brief  Look up the distance as urgent as a time to collision.
+ * @param  ttc_ms Time to collision (ms).
+ * @retval Distance in centimetres; 255 beyond the curve.
+ */
+static inline uint8_t Zone_TtcCm(uint32_t ttc_ms)
+{
+    uint32_t bucket = ttc_ms / ZONE_TTC_BUCKET_MS;
+
+    return (bucket < ZONE_TTC_BUCKET_COUNT) ? zoneTtcCm[bucket] : 255u;
+}
+
+#endif /* __ZONE_TABLE_H */
+""" % (BANNER, BUCKET_CM, TTC_BUCKET_MS, BUCKET_CM, bucket_of(MAX_CM) + 1,
+       BUZZER_CONTINUOUS, BUZZER_OFF, DWELL_MS, TTC_BUCKET_MS,
+       len(build_ttc_table()), TTC_MIN_CLOSING_MM_S, names)
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def write_c_source(path, table):
+    rows = []
+    for bucket, (zone, mask, buzzer) in enumerate(table):
+        lo = max((bucket - 1) * BUCKET_CM + 1, 0)
+        hi = min(bucket * BUCKET_CM, MAX_CM)
+        buzzer_txt = {BUZZER_CONTINUOUS: "ZONE_BUZZER_CONTINUOUS",
+                      BUZZER_OFF: "ZONE_BUZZER_OFF"}.get(buzzer, "%du" % buzzer)
+        rows.append("    { ZONE_%-12s 0x%02Xu, %-22s },  /* %3d..%3d cm */"
+                    % (ZONES[zone][0] + ",", mask, buzzer_txt, lo, hi))
+    text = """/**
+ * @file    zone_table.c
+ * @ingroup Receiver_Node
+ * @brief   Distance-to-zone lookup table data.
+ *
+ * %s
+ */
+#include "zone_table.h"
+
+const ZoneEntryTypeDef zoneTable[ZONE_BUCKET_COUNT] = {
+%s
+};
+
+const uint8_t zoneRelease[ZONE_COUNT] = {
+%s
+};
+
+const uint8_t zoneTtcCm[ZONE_TTC_BUCKET_COUNT] = {
+%s
+};
+""" % (BANNER, "\n".join(rows),
+       "\n".join("    %-5s /* ZONE_%s */" % ("%du," % cm, z[0])
+                 for cm, z in zip(release_limits(), ZONES)),
+       "\n".join("    %-5s /* %4d ms */" % ("%du," % cm, i * TTC_BUCKET_MS)
+                 for i, cm in enumerate(build_ttc_table())))
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def write_python(path, table):
+    rows = "\n".join("    (%d, 0x%02X, %d)," % row for row in table)
+    names = "\n".join('    "%s",' % z[0] for z in ZONES)
+    text = '''"""
+Distance-to-zone lookup table shared with the receiver firmware.
+
+%s
+"""
+
+#: Width of one distance bucket in centimetres
+BUCKET_CM = %d
+
+#: Largest distance reported by the radar (cm)
+MAX_CM = %d
+
+#: Buzzer period value meaning the buzzer is held on
+BUZZER_CONTINUOUS = 0x%04X
+
+#: Buzzer period value meaning the buzzer is silent
+BUZZER_OFF = %d
+
+#: Time a farther zone must persist before it is indicated (ms)
+DWELL_MS = %d
+
+#: Zone names, ordered from closest to farthest
+ZONES = (
+%s
+)
+
+#: (zone index, LED mask, buzzer period ms) per distance bucket
+TABLE = (
+%s
+)
+
+#: Per-zone distance (cm) that must be exceeded to leave the zone
+RELEASE_CM = (%s)
+
+#: Width of one time-to-collision bucket (ms)
+TTC_BUCKET_MS = %d
+
+#: Closing velocity under which the TTC is not used (mm/s)
+TTC_MIN_CLOSING_MM_S = %d
+
+#: Distance (cm) as urgent as each time-to-collision bucket
+TTC_CM = (%s)
+
+
+def lookup(cm):
+    """
+    Return the table entry for a distance in centimetres.
+
+    Args:
+        cm (int): Distance in centimetres; clamped to 0..MAX_CM.
+
+    Returns:
+        tuple: (zone index, LED mask, buzzer period ms)
+    """
+    cm = min(max(int(cm), 0), MAX_CM)
+    return TABLE[(cm + BUCKET_CM - 1) // BUCKET_CM]
+
+
+def ttc_cm(ttc_ms):
+    """
+    Return the distance as urgent as a time to collision.
+
+    Args:
+        ttc_ms (float): Time to collision in milliseconds.
+
+    Returns:
+        int: Distance in centimetres; MAX_CM beyond the curve.
+    """
+    bucket = int(ttc_ms) // TTC_BUCKET_MS
+    return TTC_CM[bucket] if 0 <= bucket < len(TTC_CM) else MAX_CM
+''' % (BANNER, BUCKET_CM, MAX_CM, BUZZER_CONTINUOUS, BUZZER_OFF, DWELL_MS,
+       names, rows, ", ".join(str(cm) for cm in release_limits()),
+       TTC_BUCKET_MS, TTC_MIN_CLOSING_MM_S,
+       ", ".join(str(cm) for cm in build_ttc_table()))
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def main():
+    table = build_table()
+    write_c_header(os.path.join(
+        ROOT, "firmware", "receiver_node", "Core", "Inc", "zone_table.h"))
+    write_c_source(os.path.join(
+        ROOT, "firmware", "receiver_node", "Core", "Src", "zone_table.c"), table)
+    write_python(os.path.join(ROOT, "gui", "zone_table.py"), table)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,264 @@
+"""
+Simulate each sensor fault through the transmitter health estimator.
+
+Compiles firmware/transmitter_node/Core/Src/sensor_health.c into a shared
+library with the host C compiler and feeds it simulated readings of both
+sensors, one Tx_SendDistances cycle (CYCLE_MS) at a time, while the car
+manoeuvres; sensor 0 is the one under test. The envelope scenarios range
+pings of the echo model of tools/envelope_check.py with echo_envelope.c,
+silent without the burst ringing as USensor_CloseWindow takes them:
+
+    - healthy:      manoeuvring, and approach, parked without jitter,
+                    then open space; has to stay HEALTH_OK, a parked car
+                    is not stuck
+    - disconnected: no echo at all;            FAILED, timeout
+    - intermittent: 40% of the windows silent; DEGRADED or POOR, timeout
+    - noisy:        readings scattered +-50 cm;  POOR, noise
+    - rough:        readings scattered +-12 cm;  DEGRADED, noise
+    - stuck:        frozen while the car backs in; FAILED, stuck
+    - crosstalk:    half of the readings are the other sensor's;
+                    DEGRADED or POOR, xtalk
+    - dead:         envelope mode, the transducer neither rings nor
+                    hears; FAILED, timeout
+    - open space:   envelope mode, nothing in range; has to stay
+                    HEALTH_OK, an echo out of range is not a timeout
+    - recovery:     disconnected, then healthy again; the level has to fall
+                    one step per block back to HEALTH_OK
+
+and prints how long each fault took to be published. Returns non-zero if
+any scenario leaves the expected levels, names the wrong fault in more
+than 1 - FAULT_SHARE of the cycles, or takes longer than LATENCY_BLOCKS
+blocks.
+
+    python tools/health_check.py
+"""
+import argparse
+import ctypes
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(__file__))
+
+import envelope_check  # noqa: E402
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+NODE = os.path.join(ROOT, "firmware", "transmitter_node")
+SRC = os.path.join(NODE, "Core", "Src", "sensor_health.c")
+INC = os.path.join(NODE, "Core", "Inc")
+
+#: Reading without an echo, HEALTH_NO_ECHO
+NO_ECHO = 0xFF
+
+#: Readings per graded block, HEALTH_BLOCK
+BLOCK = 32
+
+#: Levels and faults of sensor_health.h
+LEVELS = ("OK", "DEGRADED", "POOR", "FAILED")
+FAULTS = ("timeout", "noise", "stuck", "xtalk")
+
+#: Schedule cycle of the transmitter (ms)
+CYCLE_MS = 60
+
+#: Blocks a fault may take to be published: the one it starts in, and a
+#: whole one
+LATENCY_BLOCKS = 2
+
+#: Share of the cycles after that which have to name the fault: scattered
+#: readings may now and then land on the other sensor's often enough to
+#: look like crosstalk
+FAULT_SHARE = 0.9
+
+#: Cycles simulated per scenario
+CYCLES = 16 * BLOCK
+
+
+class Health(ctypes.Structure):
+    """HealthSensorTypeDef"""
+    _fields_ = [("readings", ctypes.c_uint8), ("timeouts", ctypes.c_uint8),
+                ("jumps", ctypes.c_uint8), ("xtalk", ctypes.c_uint8),
+                ("changes", ctypes.c_uint8),
+                ("mean", ctypes.c_int32), ("m2", ctypes.c_int32),
+                ("last", ctypes.c_uint8), ("run", ctypes.c_uint8),
+                ("other_start", ctypes.c_uint8), ("moved", ctypes.c_uint8),
+                ("stuck", ctypes.c_uint8),
+                ("nibble", ctypes.c_uint8)]
+
+
+def build(cc):
+    """Compile the estimator and return the loaded library."""
+    out = os.path.join(tempfile.mkdtemp(), "sensor_health.so")
+    subprocess.check_call([cc, "-O2", "-shared", "-fPIC", "-Wall", "-I", INC, SRC, "-o", out])
+    lib = ctypes.CDLL(out)
+    lib.Health_Init.argtypes = [ctypes.POINTER(Health)]
+    lib.Health_Update.argtypes = [ctypes.POINTER(Health), ctypes.c_uint8, ctypes.c_uint8, ctypes.c_uint8]
+    lib.Health_Nibble.argtypes = [ctypes.POINTER(Health)]
+    lib.Health_Nibble.restype = ctypes.c_uint8
+    return lib
+
+
+def parking(t):
+    """True distances of both sensors (cm) at cycle t: the car backs in
+    towards a wall for 20 s, stays parked, then drives off."""
+    if t < 330:
+        d = 250 - 220 * t // 330
+    elif t < 420:
+        d = 30
+    else:
+        d = min(30 + 5 * (t - 420), NO_ECHO)
+    if d >= 240:
+        return NO_ECHO, NO_ECHO
+    return d, min(d + 25, 239)
+
+
+def manoeuvre(t):
+    """True distances of both sensors (cm) at cycle t: the car keeps
+    backing in and pulling out between 40 and 200 cm, 14 s a round."""
+    d = 40 + abs(160 - 4 * (t % 240) // 3)
+    return d, d + 25
+
+
+def healthy(rng, t, d, parked=False):
+    """Reading of a working sensor, +-1 cm unless parked: (cm, silent)."""
+    if d == NO_ECHO:
+        return NO_ECHO, False
+    if parked:
+        return d, False
+    return max(2, d + rng.randint(-1, 1)), False
+
+
+def envelope_reading(env, rng, d, direct=envelope_check.DIRECT):
+    """Reading of a sensor in envelope mode, with the burst ringing picked
+    up at direct counts: (cm, silent)."""
+    echoes = envelope_check.measure(env, envelope_check.ping(
+        [] if d == NO_ECHO else [(10 * d, envelope_check.STRONG)], rng, direct=direct))
+    if not env.EchoEnv_Ringing():
+        return NO_ECHO, True
+    cm = (echoes[0][0] + 5) // 10 if echoes else NO_ECHO
+    return min(cm, NO_ECHO), False
+
+
+def fault_reading(name, rng, t, d, other, env):
+    """Reading of the sensor under test in a scenario: (cm, silent)."""
+    if name == "dead":
+        return envelope_reading(env, rng, d, direct=0)
+    if name == "open space":
+        return envelope_reading(env, rng, NO_ECHO)
+    if name == "disconnected":
+        return NO_ECHO, True
+    if name == "intermittent" and rng.random() < 0.4:
+        return NO_ECHO, True
+    if name == "noisy" and d != NO_ECHO:
+        return max(2, min(d + rng.randint(-50, 50), 239)), False
+    if name == "rough" and d != NO_ECHO:
+        return max(2, min(d + rng.randint(-12, 12), 239)), False
+    if name == "stuck":
+        return 87, False
+    if name == "crosstalk" and other != NO_ECHO and rng.random() < 0.5:
+        return other, False
+    if name == "recovery" and t < 5 * BLOCK:
+        return NO_ECHO, True
+    return healthy(rng, t, d)
+
+
+def run(lib, name, rng, scene=manoeuvre, env=None):
+    """Simulate a scenario; return the published nibbles of both sensors
+    after every cycle."""
+    h = [Health(), Health()]
+    for s in h:
+        lib.Health_Init(ctypes.byref(s))
+    published = []
+    for t in range(CYCLES):
+        d0, d1 = scene(t)
+        parked = scene is parking and 330 <= t < 420
+        cm1, silent1 = healthy(rng, t, d1, parked)
+        cm0, silent0 = healthy(rng, t, d0, parked) if name == "healthy" else fault_reading(name, rng, t, d0, cm1, env)
+        lib.Health_Update(ctypes.byref(h[0]), cm0, silent0, cm1)
+        lib.Health_Update(ctypes.byref(h[1]), cm1, silent1, cm0)
+        published.append((lib.Health_Nibble(ctypes.byref(h[0])), lib.Health_Nibble(ctypes.byref(h[1]))))
+    return published
+
+
+def describe(nibble):
+    level = nibble & 3
+    return LEVELS[level] if not level else "%s/%s" % (LEVELS[level], FAULTS[nibble >> 2])
+
+
+def check_fault(lib, name, levels, fault, rng, env=None):
+    """Check a fault scenario: sensor 0 reaches one of the levels in time
+    and stays there, mostly naming the fault, and sensor 1 stays OK."""
+    published = run(lib, name, rng, env=env)
+    first = next((t for t, (n0, _) in enumerate(published) if n0 & 3 in levels), None)
+    tail = [n0 for n0, _ in published[LATENCY_BLOCKS * BLOCK:]]
+    ok = first is not None and first < LATENCY_BLOCKS * BLOCK \
+        and all(n & 3 in levels for n in tail) \
+        and sum(n >> 2 == fault for n in tail) >= FAULT_SHARE * len(tail) \
+        and all(n1 == 0 for _, n1 in published)
+    print("%-13s %-15s after %5d ms  worst other %-9s %s" % (
+        name, describe(published[first][0]) if first is not None else "never",
+        (first + 1) * CYCLE_MS if first is not None else 0,
+        describe(max(n1 & 3 for _, n1 in published)), "ok" if ok else "FAIL"))
+    return ok
+
+
+def check_healthy(lib, rng):
+    """Both sensors stay OK manoeuvring, and through the approach, parking
+    and drive-off."""
+    ok = True
+    for scene in (manoeuvre, parking):
+        published = run(lib, "healthy", rng, scene)
+        worst = max(max(n0 & 3, n1 & 3) for n0, n1 in published)
+        ok &= worst == 0
+        print("%-13s %-15s worst %-9s %s" % ("healthy", scene.__name__, LEVELS[worst],
+                                            "ok" if worst == 0 else "FAIL"))
+    return ok
+
+
+def check_open_space(lib, rng, env):
+    """A live sensor in envelope mode with nothing in range stays OK."""
+    published = run(lib, "open space", rng, env=env)
+    worst = max(n0 & 3 for n0, _ in published)
+    print("%-13s %-15s worst %-9s %s" % ("open space", "envelope", LEVELS[worst],
+                                        "ok" if worst == 0 else "FAIL"))
+    return worst == 0
+
+
+def check_recovery(lib, rng):
+    """After the fault clears the level falls one step per block."""
+    published = run(lib, "recovery", rng)
+    blocks = [n0 & 3 for n0, _ in published[BLOCK - 1::BLOCK]]
+    back = blocks[5:]
+    ok = blocks[4] == 3 and back[:4] == [2, 1, 0, 0] and all(b == 0 for b in back[3:])
+    print("%-13s levels per block %s  %s" % ("recovery", " ".join(LEVELS[b][0] for b in blocks),
+                                             "ok" if ok else "FAIL"))
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cc", default="cc", help="host C compiler")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    lib = build(args.cc)
+    env = envelope_check.build(args.cc)
+    rng = random.Random(args.seed)
+    results = [
+        check_healthy(lib, rng),
+        check_fault(lib, "disconnected", (3,), 0, rng),
+        check_fault(lib, "intermittent", (1, 2), 0, rng),
+        check_fault(lib, "noisy", (2,), 1, rng),
+        check_fault(lib, "rough", (1,), 1, rng),
+        check_fault(lib, "stuck", (3,), 2, rng),
+        check_fault(lib, "crosstalk", (1, 2), 3, rng),
+        check_fault(lib, "dead", (3,), 0, rng, env),
+        check_open_space(lib, rng, env),
+        check_recovery(lib, rng),
+    ]
+    return 0 if all(results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
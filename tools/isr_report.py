@@ -0,0 +1,147 @@
+"""
+Show interrupt entry latency and handler duration per interrupt.
+
+The receiver sends DIAG_ISR records on its binary serial link and the
+transmitter writes one "ISR,<id>,<priority>,<runs>,<latency min,avg,max,p99>,
+<duration min,avg,max,p99>" text line per interrupt in turn on USART2 (see
+isr_stats.h). Values are CPU cycles over the report window; latency is only
+measured where the hardware latches the event time (timebase update, echo
+capture). For every report this prints a table in microseconds; the summary
+at the end gives each interrupt's worst values over the run and the longest
+handler of the other interrupts at the same NVIC priority, which is what a
+latency-critical interrupt can be blocked for at worst, to decide which
+interrupts deserve a priority of their own.
+
+Usage:
+    python tools/isr_report.py COM8                   # receiver link
+    python tools/isr_report.py --text COM9            # transmitter USART2
+    python tools/isr_report.py --text log.txt         # saved lines
+"""
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+
+from frame_protocol import (DIAG_ISR, ISR_NAMES, DiagFrame, FrameDecoder,  # noqa: E402
+                            IsrStats, parse_isr)
+
+#: Transmitter interrupts ("ISR" line ids, IsrStatsIdTypeDef in its isr_stats.h)
+TX_ISR_NAMES = ("echo1", "echo2", "tick", "can")
+
+#: Core clock of both nodes (Hz)
+CPU_HZ = 72000000
+
+
+def parse_text(line):
+    """Parse one transmitter "ISR,..." line into (id, IsrStats); None for other lines."""
+    fields = line.strip().split(",")
+    if len(fields) != 12 or fields[0] != "ISR":
+        return None
+    try:
+        latency = tuple(int(f) for f in fields[4:8]) if fields[4] else None
+        return int(fields[1]), IsrStats(int(fields[2]), int(fields[3]), latency,
+                                        tuple(int(f) for f in fields[8:12]))
+    except ValueError:
+        return None
+
+
+def read_binary(source, baudrate):
+    decoder = FrameDecoder()
+    if os.path.isfile(source):
+        with open(source, "rb") as f:
+            chunks = [f.read()]
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        chunks = (ser.read(max(ser.in_waiting, 1)) for _ in iter(int, 1))
+    for data in chunks:
+        for frame in decoder.feed(data):
+            if isinstance(frame, DiagFrame) and frame.kind == DIAG_ISR:
+                try:
+                    yield list(enumerate(parse_isr(frame.payload)))
+                except ValueError:
+                    continue
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        stats = parse_text(line)
+        if stats:
+            yield [stats]
+
+
+def render(report, names, hz=CPU_HZ):
+    """Return the table lines of one report: a list of (id, IsrStats)."""
+    def us(values):
+        if values is None:
+            return "%31s" % "-"
+        return " ".join("%7.2f" % (v * 1e6 / hz) for v in values)
+
+    lines = ["%-8s %4s %6s  %-31s  %s" % ("isr", "prio", "runs",
+                                         "latency min/avg/max/p99 (us)",
+                                         "duration min/avg/max/p99 (us)")]
+    for i, s in report:
+        name = names[i] if i < len(names) else "isr%d" % i
+        lines.append("%-8s %4d %6d  %s  %s" % (name, s.priority, s.count, us(s.latency),
+                                               us(s.duration if s.count else None)))
+    return lines
+
+
+def summarise(worst, names, hz=CPU_HZ):
+    """Return the summary lines from the worst values seen per interrupt."""
+    lines = []
+    for i, (prio, lat, dur) in sorted(worst.items()):
+        name = names[i] if i < len(names) else "isr%d" % i
+        peers = [d for j, (p, _, d) in worst.items() if j != i and p == prio]
+        line = "%-8s prio %2d: longest run %7.2f us" % (name, prio, dur * 1e6 / hz)
+        if lat is not None:
+            line += ", worst latency %7.2f us" % (lat * 1e6 / hz)
+        if peers:
+            line += ", blocked by peers up to %7.2f us" % (max(peers) * 1e6 / hz)
+        lines.append(line)
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", help="serial port or capture file")
+    parser.add_argument("--text", action="store_true",
+                        help="parse transmitter text lines instead of receiver frames")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--hz", type=int, default=CPU_HZ, help="core clock (Hz)")
+    args = parser.parse_args()
+
+    names = TX_ISR_NAMES if args.text else ISR_NAMES
+    reader = read_text if args.text else read_binary
+    worst = {}
+    try:
+        for report in reader(args.source, args.baudrate):
+            print("\n".join(render(report, names, args.hz)))
+            for i, s in report:
+                _, lat, dur = worst.get(i, (s.priority, None, 0))
+                if s.latency is not None:
+                    lat = max(lat or 0, s.latency[2])
+                if s.count:
+                    dur = max(dur, s.duration[2])
+                worst[i] = (s.priority, lat, dur)
+    except KeyboardInterrupt:
+        pass
+    if not worst:
+        print("no interrupt reports found")
+        return 1
+
+    print()
+    print("\n".join(summarise(worst, names, args.hz)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,235 @@
+"""
+Check the transmitter obstacle classifier against its exporter.
+
+Compiles firmware/transmitter_node/Core/Src/obstacle_class.c with the
+vendored CMSIS-NN arm_fully_connected_q7 and arm_relu_q7 into a shared
+library with the host C compiler, built for the Cortex-M3 (reference
+loops, as on the target), and checks:
+
+    - the features of random windows, full and partly filled, against
+      `features` of tools/train_obstacle_net.py, bit for bit;
+    - the scores of random feature vectors against `infer_q7` on the
+      tables read back from obstacle_net.h, bit for bit;
+    - the classes of fresh simulated windows: the confusion matrix, and
+      how many readings of an obstacle Tx_SendDistances would drop
+      (classed ground or noise, OBS_CLASS_KEEP_CM or further), which
+      has to stay under DROP_LIMIT, none of them solid.
+
+The cycle cost can only be measured on the target: Tx_Report writes
+"CLS,<avg_cycles>,<worst_cycles>,<budget>,<overruns>,<inferences>,
+<dropped>" lines on USART2, which are summarised when captures (or a
+serial port) are given:
+
+    python tools/obstacle_check.py
+    python tools/obstacle_check.py --log cls.txt
+"""
+import argparse
+import ctypes
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+NODE = os.path.join(ROOT, "firmware", "transmitter_node")
+SRC = os.path.join(NODE, "Core", "Src", "obstacle_class.c")
+INC = os.path.join(NODE, "Core", "Inc")
+CMSIS = os.path.join(NODE, "Drivers", "CMSIS")
+NN = os.path.join(CMSIS, "NN", "Source")
+
+sys.path.insert(0, os.path.dirname(__file__))
+
+import train_obstacle_net as net_spec  # noqa: E402
+from train_obstacle_net import CLASSES, FEATURES, NO_ECHO, WINDOW  # noqa: E402
+
+#: Readings nearer than this are never dropped (cm), OBS_CLASS_KEEP_CM
+KEEP_CM = 30
+
+#: Share of obstacle readings that may be dropped
+DROP_LIMIT = 0.05
+
+#: Random windows and feature vectors compared bit for bit
+EXACT_CASES = 20000
+
+#: Simulated windows per class classified
+WINDOWS_PER_CLASS = 1000
+
+#: Schedule cycle (ms) and core clock (Hz) of the transmitter
+CYCLE_MS = 60
+CPU_HZ = 72000000
+
+
+class Window(ctypes.Structure):
+    """ObsWindowTypeDef"""
+    _fields_ = [("cm", ctypes.c_uint8 * WINDOW), ("next", ctypes.c_uint8), ("count", ctypes.c_uint8)]
+
+
+def build(cc):
+    """Compile the classifier and return the loaded library."""
+    out = os.path.join(tempfile.mkdtemp(), "obstacle_class.so")
+    subprocess.check_call([cc, "-O2", "-shared", "-fPIC", "-w", "-DARM_MATH_CM3",
+                           "-I", INC, "-I", os.path.join(CMSIS, "Include"),
+                           "-I", os.path.join(CMSIS, "DSP", "Include"),
+                           "-I", os.path.join(CMSIS, "NN", "Include"), SRC,
+                           os.path.join(NN, "FullyConnectedFunctions", "arm_fully_connected_q7.c"),
+                           os.path.join(NN, "ActivationFunctions", "arm_relu_q7.c"),
+                           "-o", out])
+    lib = ctypes.CDLL(out)
+    lib.ObsClass_Push.argtypes = [ctypes.POINTER(Window), ctypes.c_uint8]
+    lib.ObsClass_Features.argtypes = [ctypes.POINTER(Window), ctypes.POINTER(ctypes.c_int8)]
+    lib.ObsClass_Infer.argtypes = [ctypes.POINTER(ctypes.c_int8), ctypes.POINTER(ctypes.c_int8)]
+    lib.ObsClass_Infer.restype = ctypes.c_int
+    return lib
+
+
+def firmware_features(lib, readings):
+    """Push readings into an empty window and return its features."""
+    w = Window()
+    for cm in readings:
+        lib.ObsClass_Push(ctypes.byref(w), cm)
+    out = (ctypes.c_int8 * FEATURES)()
+    lib.ObsClass_Features(ctypes.byref(w), out)
+    return list(out)
+
+
+def firmware_infer(lib, feats):
+    out = (ctypes.c_int8 * len(CLASSES))()
+    best = lib.ObsClass_Infer((ctypes.c_int8 * FEATURES)(*feats), out)
+    return best, list(out)
+
+
+def random_window(rng):
+    """Readings of any class, or of none, some of them missing."""
+    if rng.random() < 0.5:
+        return net_spec.simulate(rng.choice(CLASSES), rng)
+    return [NO_ECHO if rng.random() < 0.3 else rng.randint(0, 254) for _ in range(WINDOW)]
+
+
+def check_features(lib, rng):
+    """Return the number of windows whose features differ."""
+    wrong = 0
+    for _ in range(EXACT_CASES):
+        readings = (random_window(rng) + random_window(rng))[:rng.randint(1, 2 * WINDOW)]
+        wrong += firmware_features(lib, readings) != net_spec.features(readings[-WINDOW:])
+    return wrong
+
+
+def check_scores(lib, net, rng):
+    """Return the number of feature vectors whose scores or class differ."""
+    wrong = 0
+    for _ in range(EXACT_CASES):
+        feats = [rng.randint(-128, 127) for _ in range(FEATURES)]
+        wrong += firmware_infer(lib, feats) != net_spec.infer_q7(net, feats)
+    return wrong
+
+
+def classify(lib, rng):
+    """Return (confusion matrix, obstacle readings dropped, solid ones dropped)."""
+    confusion = [[0] * len(CLASSES) for _ in CLASSES]
+    dropped = solid = 0
+    for c, label in enumerate(CLASSES):
+        for _ in range(WINDOWS_PER_CLASS):
+            readings = net_spec.simulate(label, rng)
+            feats = firmware_features(lib, readings)
+            best, _ = firmware_infer(lib, feats)
+            confusion[c][best] += 1
+            last = readings[-1]
+            if label in ("solid", "soft") and best >= CLASSES.index("ground") \
+                    and last != NO_ECHO and last >= KEEP_CM:
+                dropped += 1
+                solid += label == "solid"
+    return confusion, dropped, solid
+
+
+def parse_text(line):
+    """Parse one "CLS,..." line into its six counters; None otherwise."""
+    fields = line.strip().split(",")
+    if len(fields) != 7 or fields[0] != "CLS":
+        return None
+    try:
+        return tuple(int(f) for f in fields[1:])
+    except ValueError:
+        return None
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        stats = parse_text(line)
+        if stats:
+            yield stats
+
+
+def report_cost(sources, baudrate, hz):
+    """Print the target cycles per inference found in the captures."""
+    cycles = inferences = dropped = overruns = worst = 0
+    budget = None
+    try:
+        for source in sources:
+            for avg, w, b, over, n, d in read_text(source, baudrate):
+                cycles += avg * n
+                inferences += n
+                dropped += d
+                overruns += over
+                worst = max(worst, w)
+                budget = b
+    except KeyboardInterrupt:
+        pass
+    if not inferences:
+        print("no classifier reports found")
+        return 1
+    slot = CYCLE_MS * hz / 1000.0
+    print("%d inferences, %d readings dropped: avg %.0f cycles (%.1f us), worst %d (%.1f us), "
+          "%.3f%% of a %d ms cycle, budget %d, overruns %d" % (
+              inferences, dropped, cycles / float(inferences), cycles * 1e6 / inferences / hz,
+              worst, worst * 1e6 / hz, 100.0 * worst / slot, CYCLE_MS, budget, overruns))
+    return 1 if overruns else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cc", default="cc", help="host C compiler")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--log", nargs="+", help="serial port or captures with CLS lines")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--hz", type=int, default=CPU_HZ, help="core clock (Hz)")
+    args = parser.parse_args()
+
+    if args.log:
+        return report_cost(args.log, args.baudrate, args.hz)
+
+    lib = build(args.cc)
+    net = net_spec.parse_header(os.path.join(INC, "obstacle_net.h"))
+    rng = random.Random(args.seed)
+    failed = 0
+
+    wrong = check_features(lib, rng)
+    failed += wrong != 0
+    print("features: %d of %d windows differ  %s" % (wrong, EXACT_CASES, "ok" if not wrong else "FAIL"))
+
+    wrong = check_scores(lib, net, rng)
+    failed += wrong != 0
+    print("scores:   %d of %d inputs differ  %s" % (wrong, EXACT_CASES, "ok" if not wrong else "FAIL"))
+
+    confusion, dropped, solid = classify(lib, rng)
+    print("%-8s %s" % ("", " ".join("%7s" % c for c in CLASSES)))
+    for c, row in enumerate(confusion):
+        print("%-8s %s  %.1f%%" % (CLASSES[c], " ".join("%7d" % n for n in row),
+                                   100.0 * row[c] / WINDOWS_PER_CLASS))
+    share = dropped / (2.0 * WINDOWS_PER_CLASS)
+    ok = share <= DROP_LIMIT and not solid
+    failed += not ok
+    print("obstacle readings dropped: %.1f%% (limit %.0f%%), %d solid  %s"
+          % (100 * share, 100 * DROP_LIMIT, solid, "ok" if ok else "FAIL"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,302 @@
+"""
+Check the receiver occupancy grid and its delta stream on simulated scenes.
+
+Compiles firmware/receiver_node/Core/Src/occupancy.c and occupancy_table.c
+(which only depend on <stdint.h>) into a shared library with the host C
+compiler, feeds it the distances each sensor would measure of the scenes
+below at the CAN rate, decays it and encodes its deltas every serial period
+as the receiver does, and decodes them with gui/frame_protocol.py. Per
+scene this checks:
+
+    - the cells of the obstacle end up occupied and the cells in front of
+      it, inside a beam, free;
+    - the grid rebuilt from the deltas matches the firmware's grid;
+    - the grid stream stays under BANDWIDTH_BPS, with its worst second.
+
+The update cost can only be measured on the target: each DIAG_GRID record
+carries the worst update or decay in cycles, which is compared against
+BUDGET_US when a serial port or a raw capture of the link is given:
+
+    python tools/occupancy_check.py
+    python tools/occupancy_check.py --show
+    python tools/occupancy_check.py --log COM8
+"""
+import argparse
+import ctypes
+import math
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+NODE = os.path.join(ROOT, "firmware", "receiver_node", "Core")
+SRCS = [os.path.join(NODE, "Src", name) for name in ("occupancy.c", "occupancy_table.c")]
+INC = os.path.join(NODE, "Inc")
+
+sys.path.insert(0, os.path.join(ROOT, "gui"))
+
+from frame_protocol import (DIAG_GRID, GRID_LEVEL_UNKNOWN, DiagFrame,  # noqa: E402
+                            Frame, FrameDecoder, apply_grid, parse_grid)
+from occupancy_table import BEAM_HALF_DEG, CELL_CM, COLS, ROWS, SENSORS  # noqa: E402
+
+#: CAN frame period (ms), TT_CYCLE_MS on the transmitter
+CAN_MS = 60
+
+#: Serial frame period (ms), serialTask period in task_sched.c
+SERIAL_MS = 60
+
+#: Decay period (ms), OCC_DECAY_MS in occupancy.h
+DECAY_MS = 250
+
+#: Run bytes per record (SERIAL_GRID_MAX_RUNS in app_tasks.c) and the rest
+#: of the record on the wire (SERIAL_GRID_OVERHEAD)
+MAX_RUNS = 32
+OVERHEAD = 9
+
+#: Frames between two whole-grid resends (SERIAL_GRID_RESYNC_EVERY)
+RESYNC_EVERY = 80
+
+#: Reading standard deviation (cm), before rounding to whole cm
+NOISE_CM = 1.0
+
+#: Reported when no echo came back (USENSOR_NO_ECHO)
+NO_ECHO = 255
+
+#: Limits of the performance targets
+BANDWIDTH_BPS = 20000
+BUDGET_US = 50
+
+#: Serial bits per byte (8N1)
+BITS_PER_BYTE = 10
+
+#: Core clock of the receiver (Hz)
+CPU_HZ = 72000000
+
+#: Levels at least this high count as occupied, at most this low as free
+OCCUPIED_LEVEL = 10
+FREE_LEVEL = 6
+
+
+def build(cc):
+    """Compile the grid and return the loaded library."""
+    out = os.path.join(tempfile.mkdtemp(), "occupancy.so")
+    subprocess.check_call([cc, "-O2", "-shared", "-fPIC", "-Wall", "-Wextra",
+                           "-I", INC] + SRCS + ["-o", out])
+    lib = ctypes.CDLL(out)
+    lib.Occupancy_Update.argtypes = [ctypes.c_uint8, ctypes.c_uint8]
+    lib.Occupancy_Encode.argtypes = [ctypes.c_char_p, ctypes.c_uint8]
+    lib.Occupancy_Encode.restype = ctypes.c_uint8
+    return lib
+
+
+# --------------------------------------------------------------------------
+# Scenes: obstacles as (lateral cm, forward cm) points, or "wall" at a depth
+# --------------------------------------------------------------------------
+
+def cell_of(x, y):
+    col = int(math.floor(x / CELL_CM + COLS / 2.0))
+    row = int(math.floor(y / CELL_CM))
+    return row * COLS + col if 0 <= col < COLS and 0 <= row < ROWS else None
+
+
+def measure(sensor, points, wall):
+    """Range a sensor measures (cm, float), or None for no echo."""
+    sx, yaw = SENSORS[sensor][0] / 10.0, SENSORS[sensor][1]
+    ranges = [math.hypot(x - sx, y) for x, y in points
+              if abs(math.degrees(math.atan2(x - sx, y)) - yaw) <= BEAM_HALF_DEG]
+    if wall is not None:
+        ranges.append(wall / math.cos(math.radians(yaw)))
+    return min(ranges) if ranges else None
+
+
+#: (name, timeline of (from s, points, wall cm or None), duration s,
+#:  cells expected occupied, cells expected free, cells expected unknown)
+def scenes():
+    post = (45, 100)
+    post_cell = cell_of(*post)
+    return [
+        ("empty", [(0, [], None)], 3.0,
+         [], [cell_of(-15, 50), cell_of(15, 100)], []),
+        ("wall 80 cm", [(0, [], 80)], 3.0,
+         [cell_of(-15, 80), cell_of(15, 80)], [cell_of(-15, 40), cell_of(15, 60)], []),
+        ("post", [(0, [post], None)], 3.0,
+         [post_cell], [cell_of(35, 60), cell_of(15, 40)], []),
+        ("post, then lost", [(0, [post], None), (2.0, None, None)], 7.0,
+         [], [], [post_cell]),
+        ("post, then gone", [(0, [post], None), (2.0, [], None)], 4.0,
+         [], [post_cell], []),
+    ]
+
+
+def run(lib, timeline, duration, rng):
+    """Simulate a scene; return (firmware grid, decoded grid, bytes per period)."""
+    lib.Occupancy_Init()
+    levels = []
+    sent = []
+    buf = ctypes.create_string_buffer(MAX_RUNS)
+    points, wall = [], None
+    for t_ms in range(0, int(duration * 1000), 5):
+        for start, scene_points, scene_wall in timeline:
+            if t_ms == int(start * 1000):
+                points, wall = scene_points, scene_wall
+        if t_ms % CAN_MS == 0 and points is not None:
+            for sensor in range(len(SENSORS)):
+                cm = measure(sensor, points, wall)
+                reading = NO_ECHO if cm is None else \
+                    min(NO_ECHO - 1, max(0, int(round(cm + rng.gauss(0, NOISE_CM)))))
+                lib.Occupancy_Update(sensor, reading)
+        elif t_ms % DECAY_MS == 0:
+            lib.Occupancy_Decay()
+        if t_ms % SERIAL_MS == 0:
+            if (t_ms // SERIAL_MS) % RESYNC_EVERY == 0:
+                lib.Occupancy_Resync()
+            levels, n = encode(lib, buf, levels)
+            sent.append(n + OVERHEAD if n else 0)
+
+    # Flush what is pending, then rebuild the whole grid from scratch
+    n = 1
+    while n:
+        levels, n = encode(lib, buf, levels)
+    lib.Occupancy_Resync()
+    truth = []
+    n = 1
+    while n:
+        truth, n = encode(lib, buf, truth)
+    return truth, levels, sent
+
+
+def encode(lib, buf, levels):
+    n = lib.Occupancy_Encode(buf, MAX_RUNS)
+    if n:
+        payload = bytes([COLS, ROWS, 0, 0]) + buf.raw[:n]
+        levels = apply_grid(levels, parse_grid(payload))
+    return levels, n
+
+
+def render(levels):
+    """ASCII picture of a grid, far rows first: # occupied, . unknown, blank free."""
+    lines = []
+    for row in reversed(range(ROWS)):
+        line = ""
+        for level in levels[row * COLS:(row + 1) * COLS]:
+            if level is None:
+                line += "?"
+            elif level >= OCCUPIED_LEVEL:
+                line += "#"
+            elif level <= FREE_LEVEL:
+                line += " "
+            else:
+                line += "."
+        lines.append("  %4d |%s|" % ((row + 1) * CELL_CM, line))
+    bumper = [" "] * COLS
+    for lateral_mm, _ in SENSORS:
+        col = cell_of(lateral_mm / 10.0, 0)
+        if col is not None:
+            bumper[col] = "^"
+    lines.append("       %s" % "".join(bumper))
+    return "\n".join(lines)
+
+
+def check(name, truth, levels, sent, occupied, free, unknown):
+    problems = []
+    if truth != levels:
+        problems.append("decoded grid differs in %d cells"
+                        % sum(a != b for a, b in zip(truth, levels)))
+    problems += ["cell %d is %s, not occupied" % (c, truth[c]) for c in occupied
+                 if truth[c] < OCCUPIED_LEVEL]
+    problems += ["cell %d is %s, not free" % (c, truth[c]) for c in free
+                 if truth[c] > FREE_LEVEL]
+    problems += ["cell %d is %s, not unknown" % (c, truth[c]) for c in unknown
+                 if abs(truth[c] - GRID_LEVEL_UNKNOWN) > 1]
+    per_second = 1000 // SERIAL_MS
+    worst = max(sum(sent[i:i + per_second]) for i in range(max(1, len(sent) - per_second + 1)))
+    bps = worst * BITS_PER_BYTE * 1000.0 / (per_second * SERIAL_MS)
+    if bps > BANDWIDTH_BPS:
+        problems.append("%.0f bit/s over %d" % (bps, BANDWIDTH_BPS))
+    average = sum(sent) * BITS_PER_BYTE * 1000.0 / (len(sent) * SERIAL_MS)
+    print("%-16s %8.0f %8.0f  %s" % (name, average, bps, "ok" if not problems else "FAIL"))
+    for problem in problems:
+        print("    %s" % problem)
+    return not problems
+
+
+def read_log(source, baudrate):
+    """Yield the frames decoded from a raw capture or a serial port."""
+    decoder = FrameDecoder()
+    if os.path.isfile(source):
+        with open(source, "rb") as f:
+            chunks = iter(lambda: f.read(4096), b"")
+            for chunk in chunks:
+                for frame in decoder.feed(chunk):
+                    yield frame
+        return
+    import serial
+    with serial.Serial(source, baudrate, timeout=1) as ser:
+        while True:
+            for frame in decoder.feed(ser.read(max(ser.in_waiting, 1))):
+                yield frame
+
+
+def report_log(source, baudrate, hz, show):
+    """Print the target cost and grid bandwidth found in a capture."""
+    worst = periods = grid_bytes = records = 0
+    levels = []
+    try:
+        for frame in read_log(source, baudrate):
+            if isinstance(frame, Frame):
+                periods += 1
+            elif isinstance(frame, DiagFrame) and frame.kind == DIAG_GRID:
+                try:
+                    delta = parse_grid(frame.payload)
+                except ValueError as e:
+                    print("bad grid record: %s" % e)
+                    continue
+                records += 1
+                grid_bytes += len(frame.payload) + OVERHEAD - 4
+                worst = max(worst, delta.worst_cycles)
+                levels = apply_grid(levels, delta)
+    except KeyboardInterrupt:
+        pass
+    if not records or not periods:
+        print("no grid records found")
+        return 1
+    us = worst * 1e6 / hz
+    bps = grid_bytes * BITS_PER_BYTE * 1000.0 / (periods * SERIAL_MS)
+    ok = us <= BUDGET_US and bps <= BANDWIDTH_BPS
+    print("%d records over %d periods: worst update %d cycles = %.1f us (limit %d), "
+          "%.0f bit/s (limit %d)  %s" % (records, periods, worst, us, BUDGET_US, bps,
+                                         BANDWIDTH_BPS, "ok" if ok else "FAIL"))
+    if show and len(levels) == COLS * ROWS:
+        print(render(levels))
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cc", default="cc", help="host C compiler")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--show", action="store_true", help="draw the grid of each scene")
+    parser.add_argument("--log", help="serial port or raw capture of the receiver link")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--hz", type=int, default=CPU_HZ, help="core clock (Hz)")
+    args = parser.parse_args()
+
+    if args.log:
+        return report_log(args.log, args.baudrate, args.hz, args.show)
+
+    lib = build(args.cc)
+    rng = random.Random(args.seed)
+    failed = 0
+    print("%-16s %8s %8s  (grid stream, bit/s)" % ("scene", "average", "worst 1s"))
+    for name, timeline, duration, occupied, free, unknown in scenes():
+        truth, levels, sent = run(lib, timeline, duration, rng)
+        failed += not check(name, truth, levels, sent, occupied, free, unknown)
+        if args.show:
+            print(render(truth))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
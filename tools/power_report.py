@@ -0,0 +1,108 @@
+"""
+Show idle sleep residency and interrupt latency cost of the tickless idle.
+
+The receiver sends DIAG_POWER records on its binary serial link and the
+transmitter writes "PWR,<residency>,<sleeps>,<longest_ms>,<masked_cycles>"
+text lines on USART2 (see tickless.h), about once a second. For every
+report this prints the share of time spent asleep in WFI, the number and
+longest duration of the sleeps, and the longest section with interrupts
+masked on the sleep path. That section bounds the extra wake-up latency
+seen by CAN RX and input capture interrupts; the summary at the end gives
+the averages and the worst case over the run.
+
+Usage:
+    python tools/power_report.py COM8                 # receiver link
+    python tools/power_report.py --text COM9          # transmitter USART2
+    python tools/power_report.py --text log.txt       # saved lines
+"""
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+
+from frame_protocol import DIAG_POWER, DiagFrame, FrameDecoder, PowerStats, parse_power  # noqa: E402
+
+#: Core clock of both nodes (Hz)
+CPU_HZ = 72000000
+
+
+def parse_text(line):
+    """Parse one transmitter "PWR,..." line; return None for other lines."""
+    fields = line.strip().split(",")
+    if len(fields) != 5 or fields[0] != "PWR":
+        return None
+    try:
+        return PowerStats(*(int(f) for f in fields[1:]))
+    except ValueError:
+        return None
+
+
+def read_binary(source, baudrate):
+    decoder = FrameDecoder()
+    if os.path.isfile(source):
+        with open(source, "rb") as f:
+            chunks = [f.read()]
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        chunks = (ser.read(max(ser.in_waiting, 1)) for _ in iter(int, 1))
+    for data in chunks:
+        for frame in decoder.feed(data):
+            if isinstance(frame, DiagFrame) and frame.kind == DIAG_POWER:
+                try:
+                    yield parse_power(frame.payload)
+                except ValueError:
+                    continue
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        stats = parse_text(line)
+        if stats:
+            yield stats
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", help="serial port or capture file")
+    parser.add_argument("--text", action="store_true",
+                        help="parse transmitter text lines instead of receiver frames")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--hz", type=int, default=CPU_HZ, help="core clock (Hz)")
+    args = parser.parse_args()
+
+    reports = []
+    reader = read_text if args.text else read_binary
+    print("%9s %7s %12s %14s" % ("asleep %", "sleeps", "longest(ms)", "masked(us)"))
+    try:
+        for stats in reader(args.source, args.baudrate):
+            reports.append(stats)
+            print("%9.1f %7d %12d %14.2f" % (stats.residency / 10, stats.sleeps,
+                                             stats.longest_ms,
+                                             stats.masked_cycles * 1e6 / args.hz))
+    except KeyboardInterrupt:
+        pass
+    if not reports:
+        print("no power reports found")
+        return 1
+
+    n = len(reports)
+    print("\n%d reports: asleep %.1f %% on average, %.0f sleeps per report" % (
+        n, sum(r.residency for r in reports) / n / 10,
+        sum(r.sleeps for r in reports) / n))
+    print("longest sleep %d ms, worst added interrupt latency %.2f us" % (
+        max(r.longest_ms for r in reports),
+        max(r.masked_cycles for r in reports) * 1e6 / args.hz))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,139 @@
+"""
+RAM budget report from a Keil (armlink) map file.
+
+Lists every object placed in RAM with its size, grouped into task stacks,
+task control blocks, the startup (MSP) stack and everything else, followed
+by per-module totals and the free margin of the RAM region. With no heap in
+either node, everything in RAM is accounted for here at build time.
+
+Usage:
+    python tools/ram_report.py receiver_node.map
+    python tools/ram_report.py firmware/receiver_node/MDK-ARM   # newest *.map
+
+Both Keil projects run it as an after-build step. It exits with status 1 when
+the free margin is below --min-free bytes.
+"""
+import argparse
+import glob
+import os
+import re
+import sys
+from collections import defaultdict
+
+#: STM32F103C6 SRAM
+RAM_BASE = 0x20000000
+RAM_SIZE = 10 * 1024
+
+_REGION = re.compile(r"Execution Region (\w+) \(Exec base: 0x([0-9a-fA-F]+).*?"
+                     r"Size: 0x([0-9a-fA-F]+), Max: 0x([0-9a-fA-F]+)")
+_SYMBOL = re.compile(r"^\s*(\S+)?\s+0x([0-9a-fA-F]{8})\s+(?:Ov\s+)?Data\s+(\d+)\s+(\S+?)\((\S+)\)")
+
+
+def find_map(path):
+    """Return `path` or, for a directory, the newest map file below it."""
+    if os.path.isdir(path):
+        maps = glob.glob(os.path.join(path, "**", "*.map"), recursive=True)
+        if not maps:
+            raise FileNotFoundError("no .map file under %s" % path)
+        return max(maps, key=os.path.getmtime)
+    return path
+
+
+def parse_map(path):
+    """
+    Returns:
+        tuple: (regions, symbols) where regions is a list of
+        (name, base, size, max) and symbols a list of
+        (name, address, size, object, section) for RAM data objects.
+    """
+    regions = []
+    symbols = []
+    pending = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = _REGION.search(line)
+            if m:
+                regions.append((m.group(1), int(m.group(2), 16),
+                                int(m.group(3), 16), int(m.group(4), 16)))
+                continue
+            m = _SYMBOL.match(line)
+            if m:
+                name = m.group(1) or pending
+                addr = int(m.group(2), 16)
+                if name and RAM_BASE <= addr < RAM_BASE + RAM_SIZE and int(m.group(3)):
+                    symbols.append((name, addr, int(m.group(3)), m.group(4), m.group(5)))
+                pending = None
+                continue
+            # armlink wraps long symbol names onto their own line
+            fields = line.split()
+            pending = fields[0] if len(fields) == 1 else None
+    return regions, symbols
+
+
+def classify(name, section):
+    if section == "STACK" or name == "Stack_Mem":
+        return "MSP stack (ISRs)"
+    if section == "HEAP" or name == "Heap_Mem":
+        return "C library heap"
+    if name.endswith(("Stack", "_Stack")):
+        return "task stacks"
+    if name.endswith(("Tcb", "Cb", "_TCB")) or name == "schedTcb":
+        return "task control blocks"
+    return "other data"
+
+
+def report(regions, symbols, min_free, out=sys.stdout):
+    ram = [r for r in regions if RAM_BASE <= r[1] < RAM_BASE + RAM_SIZE]
+    used = sum(r[2] for r in ram)
+    limit = max((r[1] + r[3] for r in ram), default=RAM_BASE + RAM_SIZE) - RAM_BASE
+
+    groups = defaultdict(list)
+    for sym in symbols:
+        groups[classify(sym[0], sym[4])].append(sym)
+
+    for group in ("task stacks", "task control blocks", "MSP stack (ISRs)",
+                  "C library heap", "other data"):
+        items = sorted(groups.get(group, []), key=lambda s: -s[2])
+        if not items:
+            continue
+        out.write("\n%s (%d bytes)\n" % (group, sum(s[2] for s in items)))
+        for name, addr, size, obj, _ in items:
+            out.write("  %-32s %6d  0x%08X  %s\n" % (name, size, addr, obj))
+
+    modules = defaultdict(int)
+    for name, addr, size, obj, _ in symbols:
+        modules[obj] += size
+    out.write("\nper module\n")
+    for obj, size in sorted(modules.items(), key=lambda kv: -kv[1]):
+        out.write("  %-32s %6d\n" % (obj, size))
+
+    listed = sum(s[2] for s in symbols)
+    free = limit - used
+    out.write("\nregions: %s\n" % ", ".join("%s %d/%d" % (r[0], r[2], r[3]) for r in ram))
+    out.write("RAM used %d of %d bytes (%d in named objects, %d padding/library)\n"
+              % (used, limit, listed, used - listed))
+    out.write("free margin %d bytes (%.1f%%)\n" % (free, 100.0 * free / limit))
+    if free < min_free:
+        out.write("RAM margin below %d bytes\n" % min_free)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("map", help="armlink .map file or a directory holding one")
+    parser.add_argument("--min-free", type=int, default=256,
+                        help="fail when less RAM than this stays free (bytes)")
+    args = parser.parse_args()
+
+    path = find_map(args.map)
+    regions, symbols = parse_map(path)
+    if not regions:
+        print("%s: no execution regions found" % path)
+        return 1
+    print("RAM report for %s" % path)
+    return report(regions, symbols, args.min_free)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
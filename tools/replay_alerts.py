@@ -0,0 +1,97 @@
+"""
+Replay approach traces through distance-only and time-to-collision alerting.
+
+Each trace is run through the transmitter's range tracker (built from
+range_tracker.c as in track_check.py) for the closing velocity, then through
+two zone filters: one fed the measured distance, as before, and one fed the
+urgency distance of the TTC alerting (urgency_cm in gui/distance_logic.py,
+Alert_UrgencyCm on the receiver). For every warning zone it prints how long
+before the closest point of the trace each filter first indicated it, i.e.
+the lead time the driver gets, and the gain of the TTC alerting.
+
+Usage:
+    python tools/replay_alerts.py trace.csv   # lines of "time_ms,distance_m"
+    python tools/replay_alerts.py             # synthetic approaches
+
+Trace files use the format of replay_zones.py.
+"""
+import ctypes
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+
+from distance_logic import ZoneFilter, urgency_cm  # noqa: E402
+from replay_zones import load_trace  # noqa: E402
+from track_check import CYCLE_MS, Track, build  # noqa: E402
+from zone_table import ZONES  # noqa: E402
+
+
+def synthetic_trace(speed_mm_s, seed=1, start_cm=250, stop_cm=20):
+    """Approach at a constant speed, stopping at stop_cm, with jitter."""
+    rng = random.Random(seed)
+    samples = []
+    t = 0
+    cm = float(start_cm)
+    while True:
+        samples.append((t, max(0.0, cm + rng.gauss(0, 1.0)) / 100.0))
+        if cm <= stop_cm:
+            break
+        t += CYCLE_MS
+        cm -= speed_mm_s * CYCLE_MS / 10000.0
+    for _ in range(10):
+        t += CYCLE_MS
+        samples.append((t, stop_cm / 100.0))
+    return samples
+
+
+def replay(lib, samples):
+    """Return ({zone: first time}, {zone: first time}, closest time) in ms."""
+    state = ctypes.create_string_buffer(256)    # larger than RangeTrackerTypeDef
+    track = Track()
+    lib.RangeTracker_Init(state, CYCLE_MS)
+    by_distance, by_ttc = ZoneFilter(), ZoneFilter()
+    first_distance, first_ttc = {}, {}
+    closest_t, closest_cm = None, None
+
+    for t, dist in samples:
+        cm = min(255, max(0, int(round(dist * 100))))
+        lib.RangeTracker_Update(state, cm, ctypes.byref(track))
+        by_distance.update(dist, t)
+        by_ttc.update(urgency_cm(cm, track.closing_mm_s, track.confident) / 100.0, t)
+        for zone in range(by_distance.zone, len(ZONES) - 1):
+            first_distance.setdefault(zone, t)
+        for zone in range(by_ttc.zone, len(ZONES) - 1):
+            first_ttc.setdefault(zone, t)
+        if closest_cm is None or cm < closest_cm:
+            closest_t, closest_cm = t, cm
+    return first_distance, first_ttc, closest_t
+
+
+def render(name, first_distance, first_ttc, closest_t):
+    lines = ["%s" % name, "  %-12s %14s %14s %9s" % ("zone", "distance(ms)", "ttc(ms)", "gain")]
+    for zone in range(len(ZONES) - 2, -1, -1):
+        d = first_distance.get(zone)
+        c = first_ttc.get(zone)
+        lead_d = "-" if d is None else "%d" % (closest_t - d)
+        lead_c = "-" if c is None else "%d" % (closest_t - c)
+        gain = "" if d is None or c is None else "%+d" % (d - c)
+        lines.append("  %-12s %14s %14s %9s" % (ZONES[zone], lead_d, lead_c, gain))
+    return lines
+
+
+def main():
+    lib = build("cc")
+    if len(sys.argv) > 1:
+        traces = [(path, load_trace(path)) for path in sys.argv[1:]]
+    else:
+        traces = [("approach %.1f m/s" % (v / 1000.0), synthetic_trace(v)) for v in (1000, 300, 100)]
+
+    print("lead time before the closest point, per zone")
+    for name, samples in traces:
+        print("\n".join(render(name, *replay(lib, samples))))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+"""
+Replay a distance trace through the zone classifier and count transitions.
+
+Compares the raw table lookup against the hysteresis/dwell ZoneFilter used by
+the GUI and the receiver firmware, and reports how many zone changes (and so
+GPIO rewrites, buzzer restarts and GUI repaints) the filter suppresses.
+
+Usage:
+    python tools/replay_zones.py trace.csv   # lines of "time_ms,distance_m"
+    python tools/replay_zones.py             # synthetic jittery approach
+
+A trace line holding a single value is taken as a distance in meters sampled
+every PERIOD_MS.
+"""
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+
+from distance_logic import ZoneFilter, get_zone  # noqa: E402
+
+#: Sample period assumed for traces without timestamps (ms)
+PERIOD_MS = 60
+
+
+def load_trace(path):
+    """Read (time_ms, distance_m) samples from a CSV file."""
+    samples = []
+    with open(path) as f:
+        for n, line in enumerate(f):
+            fields = [x for x in line.strip().split(",") if x]
+            if not fields or fields[0].startswith("#"):
+                continue
+            try:
+                if len(fields) == 1:
+                    samples.append((n * PERIOD_MS, float(fields[0])))
+                else:
+                    samples.append((float(fields[0]), float(fields[1])))
+            except ValueError:
+                continue  # header line
+    return samples
+
+
+def synthetic_trace(seed=1):
+    """Slow approach from 1.5 m to 0.2 m, parking near 0.5 m, with jitter."""
+    rng = random.Random(seed)
+    samples = []
+    t = 0
+    dist = 1.5
+    while dist > 0.2:
+        # Linger around each threshold the way a car creeping back does
+        step = 0.002 if abs(dist - 0.5) < 0.05 else 0.01
+        dist -= step
+        samples.append((t, round(dist + rng.gauss(0, 0.02), 2)))
+        t += PERIOD_MS
+    return samples
+
+
+def replay(samples):
+    """Return (raw transitions, filtered transitions)."""
+    flt = ZoneFilter()
+    raw_prev = None
+    raw_changes = 0
+    filtered_changes = 0
+
+    for t, dist in samples:
+        zone = get_zone(dist)
+        if raw_prev is not None and zone != raw_prev:
+            raw_changes += 1
+        raw_prev = zone
+        if flt.update(dist, t):
+            filtered_changes += 1
+
+    return raw_changes, filtered_changes
+
+
+def main():
+    samples = load_trace(sys.argv[1]) if len(sys.argv) > 1 else synthetic_trace()
+    raw, filtered = replay(samples)
+    suppressed = raw - filtered
+    pct = 100.0 * suppressed / raw if raw else 0.0
+
+    print("samples              : %d" % len(samples))
+    print("raw zone transitions : %d" % raw)
+    print("filtered transitions : %d" % filtered)
+    print("suppressed           : %d (%.1f %%)" % (suppressed, pct))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,132 @@
+"""
+Offline schedulability check for the receiver task table.
+
+Reads schedTable from firmware/receiver_node/Core/Src/task_sched.c, assigns
+priorities the way Sched_CreateTasks does (deadline-monotonic, ties to the
+earlier row), then:
+
+- runs response-time analysis on the execution budgets (wcet_us), and
+- simulates preemptive fixed-priority scheduling over one hyperperiod with
+  all tasks released together (the critical instant).
+
+Exits with status 1 if any task can miss its deadline.
+
+Usage:
+    python tools/sched_check.py [path/to/task_sched.c]
+"""
+import math
+import os
+import re
+import sys
+from collections import namedtuple
+from functools import reduce
+
+DEFAULT_SOURCE = os.path.join(os.path.dirname(__file__), "..", "firmware",
+                              "receiver_node", "Core", "Src", "task_sched.c")
+
+#: CMSIS-RTOS2 osPriorityNormal, SCHED_BASE_PRIORITY in task_sched.h
+BASE_PRIORITY = 24
+
+Task = namedtuple("Task", "name period_us deadline_us wcet_us")
+
+# { "name", entry, stack, period, deadline, wcet_us, handle }
+_ROW = re.compile(r'\{\s*"(\w+)"\s*,\s*\w+\s*,\s*[^,]+,\s*(\d+)u?\s*,'
+                  r'\s*(\d+)u?\s*,\s*(\d+)u?\s*,')
+
+
+def load_tasks(path):
+    """Parse the schedTable rows of task_sched.c, in table order."""
+    with open(path) as f:
+        source = f.read()
+    tasks = [Task(m.group(1), int(m.group(2)) * 1000, int(m.group(3)) * 1000,
+                  int(m.group(4)))
+             for m in _ROW.finditer(source)]
+    if not tasks:
+        raise ValueError("no schedTable rows found in %s" % path)
+    return tasks
+
+
+def by_priority(tasks):
+    """Tasks ordered highest priority first (Sched_CreateTasks rule)."""
+    return sorted(tasks, key=lambda t: (t.deadline_us, tasks.index(t)))
+
+
+def response_times(tasks):
+    """Worst-case response time of each task (us), None if unbounded."""
+    ordered = by_priority(tasks)
+    result = {}
+    for i, task in enumerate(ordered):
+        higher = ordered[:i]
+        r = task.wcet_us
+        while True:
+            nxt = task.wcet_us + sum(math.ceil(r / h.period_us) * h.wcet_us
+                                     for h in higher)
+            if nxt == r:
+                break
+            if nxt > task.deadline_us:
+                r = None
+                break
+            r = nxt
+        result[task.name] = r
+    return result
+
+
+def simulate(tasks):
+    """
+    Simulate one hyperperiod in 1 us steps.
+
+    Returns:
+        dict: name -> (worst response in us, deadline misses)
+    """
+    ordered = by_priority(tasks)
+    hyper = reduce(lambda a, b: a * b // math.gcd(a, b),
+                   (t.period_us for t in ordered))
+    remaining = [0] * len(ordered)
+    release = [0] * len(ordered)
+    worst = [0] * len(ordered)
+    misses = [0] * len(ordered)
+
+    for now in range(hyper):
+        for i, t in enumerate(ordered):
+            if now % t.period_us == 0:
+                if remaining[i]:
+                    misses[i] += 1  # previous job still running
+                remaining[i] = t.wcet_us
+                release[i] = now
+        for i, t in enumerate(ordered):
+            if remaining[i]:
+                remaining[i] -= 1
+                if not remaining[i]:
+                    response = now + 1 - release[i]
+                    worst[i] = max(worst[i], response)
+                    if response > t.deadline_us:
+                        misses[i] += 1
+                break
+
+    return {t.name: (worst[i], misses[i]) for i, t in enumerate(ordered)}
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_SOURCE
+    tasks = load_tasks(path)
+    rta = response_times(tasks)
+    sim = simulate(tasks)
+    utilisation = sum(t.wcet_us / t.period_us for t in tasks)
+
+    ok = True
+    print("%-12s %4s %7s %9s %7s %9s %9s %6s" % (
+        "task", "prio", "T(ms)", "D(ms)", "C(us)", "RTA(us)", "sim(us)", "miss"))
+    for rank, t in zip(range(len(tasks) - 1, -1, -1), by_priority(tasks)):
+        r = rta[t.name]
+        worst, miss = sim[t.name]
+        ok &= r is not None and not miss
+        print("%-12s %4d %7d %9d %7d %9s %9d %6d" % (
+            t.name, BASE_PRIORITY + rank, t.period_us // 1000, t.deadline_us // 1000,
+            t.wcet_us, "-" if r is None else r, worst, miss))
+    print("utilisation %.1f%%  ->  %s" % (utilisation * 100,
+                                          "schedulable" if ok else "NOT schedulable"))
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,179 @@
+"""
+Recommend task stack sizes from the stack monitor reports of the radar nodes.
+
+The receiver sends DIAG_STACK records on its binary serial link and the
+transmitter writes "STK,..." text lines on USART2 (see stack_mon.h). Each
+report carries, per task, the stack size and the least free stack the kernel
+has seen. This script keeps the worst case over the whole run and, when it
+ends (end of file or Ctrl+C), prints for every task the peak usage and a
+recommended size: the peak plus --headroom percent, with at least the
+firmware margin spare, rounded up to 8 bytes (the stacks are uint64_t
+arrays). For the kernel's idle and timer tasks it also gives the matching
+FreeRTOSConfig.h setting in words.
+
+Usage:
+    python tools/stack_report.py COM8                 # receiver link
+    python tools/stack_report.py --text COM9          # transmitter USART2
+    python tools/stack_report.py --text log.txt       # saved lines
+
+Exercise every code path (all zones, stale data, trace dumps) during the run:
+the high-water mark only covers what actually executed.
+"""
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+sys.path.insert(0, os.path.dirname(__file__))
+
+from frame_protocol import (DIAG_CPU, DIAG_STACK, DiagFrame, FrameDecoder,  # noqa: E402
+                            StackUsage, parse_cpu, parse_stack)
+from cpu_report import parse_text as parse_cpu_text  # noqa: E402
+
+#: Bytes per StackType_t, the unit of the kernel's own stack settings
+STACK_WORD = 4
+
+#: Stack size settings of the kernel tasks, by task name
+KERNEL_TASKS = {"IDLE": "configMINIMAL_STACK_SIZE",
+                "Tmr Svc": "configTIMER_TASK_STACK_DEPTH"}
+
+
+class StackLog:
+    """Worst case stack usage per task over all reports."""
+
+    def __init__(self):
+        self.names = {}
+        self.margin = None
+        self.reports = 0
+        self.tasks = {}
+
+    def add(self, margin, usages):
+        self.margin = margin
+        self.reports += 1
+        for u in usages:
+            seen = self.tasks.get(u.number)
+            if seen is None or u.min_free < seen.min_free:
+                self.tasks[u.number] = u
+
+
+def parse_stack_text(line):
+    """
+    Parse one transmitter "STK,..." line.
+
+    Returns:
+        tuple: (margin, list[StackUsage], names) or None for other lines.
+    """
+    fields = line.strip().split(",")
+    if len(fields) < 2 or fields[0] != "STK" or (len(fields) - 2) % 5:
+        return None
+    try:
+        usages = []
+        names = {}
+        for i in range(2, len(fields), 5):
+            number = int(fields[i])
+            names[number] = fields[i + 1]
+            usages.append(StackUsage(number, int(fields[i + 2]), int(fields[i + 3]),
+                                     fields[i + 4] == "1"))
+        return int(fields[1]), usages, names
+    except ValueError:
+        return None
+
+
+def read_binary(source, baudrate, log):
+    decoder = FrameDecoder()
+    if os.path.isfile(source):
+        with open(source, "rb") as f:
+            chunks = [f.read()]
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        chunks = (ser.read(max(ser.in_waiting, 1)) for _ in iter(int, 1))
+    for data in chunks:
+        for frame in decoder.feed(data):
+            if not isinstance(frame, DiagFrame):
+                continue
+            try:
+                if frame.kind == DIAG_CPU:
+                    log.names.update((t.number, t.name) for t in parse_cpu(frame.payload))
+                elif frame.kind == DIAG_STACK:
+                    log.add(*parse_stack(frame.payload))
+            except ValueError:
+                continue
+
+
+def read_text(source, baudrate, log):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        loads = parse_cpu_text(line)
+        if loads:
+            log.names.update((t.number, t.name) for t in loads)
+            continue
+        report = parse_stack_text(line)
+        if report:
+            log.names.update(report[2])
+            log.add(report[0], report[1])
+
+
+def recommend(used, headroom, margin):
+    """Stack size for a peak usage of `used` bytes, rounded up to 8."""
+    size = max(used * (100 + headroom) // 100, used + margin)
+    return (size + 7) // 8 * 8
+
+
+def render(log, headroom, out=sys.stdout):
+    """Print the per-task table; return the number of tasks over the margin."""
+    margin = log.margin or 0
+    out.write("%d reports, firmware margin %d bytes\n\n" % (log.reports, margin))
+    out.write("%-12s %6s %6s %6s %6s %7s\n" % ("task", "size", "peak", "free", "rec.", "change"))
+    low = 0
+    total = 0
+    for number, u in sorted(log.tasks.items()):
+        name = log.names.get(number, "task %d" % number)
+        used = u.size - u.min_free
+        rec = recommend(used, headroom, margin)
+        flag = "  LOW" if u.min_free < margin else ""
+        low += bool(flag)
+        total += rec - u.size
+        out.write("%-12s %6d %6d %6d %6d %+7d%s\n" % (
+            name, u.size, used, u.min_free, rec, rec - u.size, flag))
+    out.write("%-12s %27s %+7d\n" % ("total", "", total))
+    out.write("\n")
+
+    for number, u in sorted(log.tasks.items()):
+        name = log.names.get(number, "")
+        if name in KERNEL_TASKS:
+            rec = recommend(u.size - u.min_free, headroom, margin)
+            out.write("%s: %s %d\n" % (name, KERNEL_TASKS[name], -(-rec // STACK_WORD)))
+    return low
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", help="serial port or capture file")
+    parser.add_argument("--text", action="store_true",
+                        help="parse transmitter text lines instead of receiver frames")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--headroom", type=int, default=25,
+                        help="spare stack above the measured peak (percent)")
+    args = parser.parse_args()
+
+    log = StackLog()
+    reader = read_text if args.text else read_binary
+    try:
+        reader(args.source, args.baudrate, log)
+    except KeyboardInterrupt:
+        pass
+    if not log.reports:
+        print("no stack reports found")
+        return 1
+    return 1 if render(log, args.headroom) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,213 @@
+"""
+Convert an RTOS event trace snapshot into Chrome/Perfetto trace JSON.
+
+The receiver sends snapshots as DIAG_TRACE records on its binary serial link;
+the transmitter writes them as "TRC,..." text lines on USART2 (see trace.h
+for the event layout). Task names come from the CPU load reports (DIAG_CPU
+records or "CPU,..." lines) sent on the same link.
+
+Usage:
+    python tools/trace_export.py COM8 trace.json            # receiver link
+    python tools/trace_export.py --text COM9 trace.json     # transmitter
+    python tools/trace_export.py --text log.txt trace.json  # saved lines
+
+The first complete snapshot is written. Open the JSON in ui.perfetto.dev or
+chrome://tracing: each task is a thread, ISRs run on their own track, and
+application markers (trigger, echo, CAN TX/RX, GPIO) are instant events.
+"""
+import argparse
+import json
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "gui"))
+sys.path.insert(0, os.path.dirname(__file__))
+
+from frame_protocol import (DIAG_CPU, DIAG_TRACE, DiagFrame, FrameDecoder,  # noqa: E402
+                            TraceEvent, parse_cpu, parse_trace)
+from cpu_report import parse_text  # noqa: E402
+
+#: Core clock of both nodes (Hz), the DWT cycle counter rate
+CPU_HZ = 72000000
+
+# Event types, TRACE_EV_* in trace.h
+EV_TASK_IN = 0x01
+EV_TASK_OUT = 0x02
+EV_ISR_ENTER = 0x03
+EV_ISR_EXIT = 0x04
+EV_QUEUE_SEND = 0x05
+EV_QUEUE_RECEIVE = 0x06
+EV_NOTIFY = 0x07
+EV_NOTIFY_TAKE = 0x08
+EV_MARK = 0x10
+
+#: TRACE_MARK_* names
+MARKS = {1: "trigger", 2: "echo", 3: "CAN TX", 4: "CAN RX", 5: "GPIO"}
+
+#: Cortex-M exception numbers of the traced IRQs (16 + IRQn)
+ISR_NAMES = {16 + 17: "DMA1_Channel7", 16 + 20: "CAN1_RX0",
+             16 + 27: "TIM1_CC", 16 + 28: "TIM2", 16 + 38: "USART2"}
+
+#: Thread id of the ISR track
+ISR_TID = 0
+
+
+class Snapshot:
+    """Collects the chunks of one snapshot until every event is present."""
+
+    def __init__(self):
+        self.names = {}
+        self._events = {}
+        self._total = None
+
+    def add(self, first, total, events):
+        if total != self._total or first == 0:
+            # New snapshot: drop a partial previous one
+            self._events = {}
+            self._total = total
+        for i, ev in enumerate(events):
+            self._events[first + i] = ev
+
+    def complete(self):
+        return self._total is not None and len(self._events) == self._total
+
+    def events(self):
+        return [self._events[i] for i in range(self._total)]
+
+
+def parse_trace_text(line):
+    """Parse one transmitter "TRC,..." line; return None for other lines."""
+    fields = line.strip().split(",")
+    if len(fields) < 3 or fields[0] != "TRC":
+        return None
+    try:
+        events = [TraceEvent(int(f[0:8], 16), int(f[8:10], 16),
+                             int(f[10:12], 16), int(f[12:16], 16))
+                  for f in fields[3:] if len(f) == 16]
+        return int(fields[1]), int(fields[2]), events
+    except ValueError:
+        return None
+
+
+def read_binary(source, baudrate, snap):
+    decoder = FrameDecoder()
+    if os.path.isfile(source):
+        with open(source, "rb") as f:
+            chunks = [f.read()]
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        chunks = (ser.read(max(ser.in_waiting, 1)) for _ in iter(int, 1))
+    for data in chunks:
+        for frame in decoder.feed(data):
+            if not isinstance(frame, DiagFrame):
+                continue
+            try:
+                if frame.kind == DIAG_CPU:
+                    snap.names.update((t.number, t.name) for t in parse_cpu(frame.payload))
+                elif frame.kind == DIAG_TRACE:
+                    snap.add(*parse_trace(frame.payload))
+            except ValueError:
+                continue
+            if snap.complete():
+                return True
+    return False
+
+
+def read_text(source, baudrate, snap):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        loads = parse_text(line)
+        if loads:
+            snap.names.update((t.number, t.name) for t in loads)
+            continue
+        chunk = parse_trace_text(line)
+        if chunk:
+            snap.add(*chunk)
+            if snap.complete():
+                return True
+    return False
+
+
+def to_chrome(events, names, hz=CPU_HZ):
+    """Build the Chrome trace event list from raw snapshot events."""
+    out = [{"ph": "M", "pid": 1, "tid": ISR_TID, "name": "thread_name",
+            "args": {"name": "ISR"}}]
+    for num, name in sorted(names.items()):
+        out.append({"ph": "M", "pid": 1, "tid": num, "name": "thread_name",
+                    "args": {"name": name}})
+
+    base = events[0].cycles if events else 0
+    wraps = 0
+    prev = base
+    running = None
+    for ev in events:
+        if ev.cycles < prev:
+            wraps += 1  # CYCCNT wrapped between two events
+        prev = ev.cycles
+        ts = ((ev.cycles + (wraps << 32)) - base) * 1e6 / hz
+
+        if ev.type == EV_TASK_IN:
+            running = ev.id
+            out.append({"ph": "B", "pid": 1, "tid": ev.id, "ts": ts,
+                        "name": names.get(ev.id, "task %d" % ev.id)})
+        elif ev.type == EV_TASK_OUT:
+            if running == ev.id:
+                out.append({"ph": "E", "pid": 1, "tid": ev.id, "ts": ts})
+            running = None
+        elif ev.type in (EV_ISR_ENTER, EV_ISR_EXIT):
+            out.append({"ph": "B" if ev.type == EV_ISR_ENTER else "E",
+                        "pid": 1, "tid": ISR_TID, "ts": ts,
+                        "name": ISR_NAMES.get(ev.id, "exception %d" % ev.id)})
+        else:
+            if ev.type == EV_MARK:
+                name = MARKS.get(ev.id, "mark %d" % ev.id)
+            else:
+                name = {EV_QUEUE_SEND: "queue send", EV_QUEUE_RECEIVE: "queue receive",
+                        EV_NOTIFY: "notify", EV_NOTIFY_TAKE: "notify take"}.get(
+                            ev.type, "event 0x%02X" % ev.type)
+            out.append({"ph": "i", "s": "t", "pid": 1,
+                        "tid": running if running is not None else ISR_TID,
+                        "ts": ts, "name": name,
+                        "args": {"id": ev.id, "arg": ev.arg}})
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", help="serial port or capture file")
+    parser.add_argument("output", help="JSON file to write")
+    parser.add_argument("--text", action="store_true",
+                        help="parse transmitter text lines instead of receiver frames")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--hz", type=int, default=CPU_HZ, help="DWT clock (Hz)")
+    args = parser.parse_args()
+
+    snap = Snapshot()
+    reader = read_text if args.text else read_binary
+    try:
+        found = reader(args.source, args.baudrate, snap)
+    except KeyboardInterrupt:
+        found = False
+    if not found:
+        print("no complete trace snapshot found")
+        return 1
+
+    events = snap.events()
+    with open(args.output, "w") as f:
+        json.dump({"traceEvents": to_chrome(events, snap.names, args.hz),
+                   "displayTimeUnit": "ns"}, f)
+    span = (events[-1].cycles - events[0].cycles) & 0xFFFFFFFF
+    print("%d events over %.2f ms written to %s" % (
+        len(events), span * 1e3 / args.hz, args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
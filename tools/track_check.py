@@ -0,0 +1,162 @@
+"""
+Check the transmitter range tracker against synthetic approach profiles.
+
+Compiles firmware/transmitter_node/Core/Src/range_tracker.c (which only
+depends on <stdint.h>) into a shared library with the host C compiler,
+feeds it noisy integer-cm readings of each profile below at the schedule
+rate and checks the tracked range, closing velocity and confidence flag
+against the truth once the track had time to settle. Prints one line per
+profile and exits non-zero if any check fails, so it can be run after every
+change to the tracker or its tuning:
+
+    python tools/track_check.py
+    python tools/track_check.py --cc clang --plot profile.csv
+"""
+import argparse
+import ctypes
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+SRC = os.path.join(ROOT, "firmware", "transmitter_node", "Core", "Src", "range_tracker.c")
+INC = os.path.join(ROOT, "firmware", "transmitter_node", "Core", "Inc")
+
+#: Schedule cycle (ms), TT_CYCLE_MS in tt_sched.h
+CYCLE_MS = 60
+
+#: Reading standard deviation (cm), before rounding to whole cm
+NOISE_CM = 1.0
+
+#: Reported when no echo came back (USENSOR_NO_ECHO)
+NO_ECHO = 255
+
+
+class Track(ctypes.Structure):
+    """RangeTrackTypeDef"""
+    _fields_ = [("cm", ctypes.c_uint8), ("closing_mm_s", ctypes.c_int16),
+                ("confident", ctypes.c_uint8)]
+
+
+def build(cc):
+    """Compile the tracker and return the loaded library."""
+    out = os.path.join(tempfile.mkdtemp(), "range_tracker.so")
+    subprocess.check_call([cc, "-O2", "-shared", "-fPIC", "-Wall", "-Wextra",
+                           "-I", INC, SRC, "-o", out])
+    lib = ctypes.CDLL(out)
+    lib.RangeTracker_Init.argtypes = [ctypes.c_void_p, ctypes.c_uint16]
+    lib.RangeTracker_Update.argtypes = [ctypes.c_void_p, ctypes.c_uint8, ctypes.POINTER(Track)]
+    return lib
+
+
+# --------------------------------------------------------------------------
+# Profiles: truth(t) -> (range cm or None for no echo, closing mm/s)
+# --------------------------------------------------------------------------
+
+def approach(start_cm, speed_mm_s, stop_cm=15):
+    def truth(t):
+        return max(stop_cm, start_cm - speed_mm_s * t / 10.0), speed_mm_s if \
+            start_cm - speed_mm_s * t / 10.0 > stop_cm else 0
+    return truth
+
+
+def brake(start_cm, speed_mm_s, decel_mm_s2, brake_at_s):
+    def truth(t):
+        if t < brake_at_s:
+            return start_cm - speed_mm_s * t / 10.0, speed_mm_s
+        tb = min(t - brake_at_s, speed_mm_s / float(decel_mm_s2))
+        v = speed_mm_s - decel_mm_s2 * tb
+        return start_cm - (speed_mm_s * brake_at_s + speed_mm_s * tb
+                           - decel_mm_s2 * tb * tb / 2.0) / 10.0, v
+    return truth
+
+
+def appear(at_s, cm, speed_mm_s):
+    def truth(t):
+        if t < at_s:
+            return None, 0
+        return cm - speed_mm_s * (t - at_s) / 10.0, speed_mm_s
+    return truth
+
+
+#: (name, truth, duration s, settle s, range tolerance cm,
+#:  velocity tolerance mm/s, spike every N samples or 0)
+PROFILES = [
+    ("approach 1 m/s",    approach(250, 1000),          2.0, 0.8, 3, 150, 0),
+    ("approach 0.1 m/s",  approach(150, 100),           6.0, 1.5, 3, 80,  0),
+    ("parked",            approach(80, 0),              4.0, 1.0, 2, 80,  0),
+    ("brake to stop",     brake(200, 500, 1000, 1.0),   4.0, 2.5, 2, 80,  0),
+    ("parked, spikes",    approach(80, 0),              6.0, 1.0, 2, 100, 17),
+    ("obstacle appears",  appear(1.0, 120, 300),        4.0, 2.2, 3, 100, 0),
+]
+
+
+def run(lib, truth, duration, spike_every, rng):
+    state = ctypes.create_string_buffer(256)    # larger than RangeTrackerTypeDef
+    track = Track()
+    lib.RangeTracker_Init(state, CYCLE_MS)
+    rows = []
+    for n in range(int(duration * 1000 / CYCLE_MS)):
+        t = n * CYCLE_MS / 1000.0
+        cm, closing = truth(t)
+        if cm is None:
+            reading = NO_ECHO
+        elif spike_every and n % spike_every == spike_every - 1:
+            reading = max(0, int(cm) - 40)
+        else:
+            reading = min(NO_ECHO, max(0, int(round(cm + rng.gauss(0, NOISE_CM)))))
+        lib.RangeTracker_Update(state, reading, ctypes.byref(track))
+        rows.append((t, cm, closing, reading, track.cm, track.closing_mm_s, track.confident))
+    return rows
+
+
+def check(rows, settle, spike_every):
+    """Return (worst range error, worst velocity error, unconfident samples).
+
+    A spike is gated, which rightly drops the confidence for that sample.
+    """
+    worst_cm = worst_vel = unconfident = 0
+    for n, (t, cm, closing, _, est_cm, est_vel, confident) in enumerate(rows):
+        if t < settle or cm is None:
+            continue
+        worst_cm = max(worst_cm, abs(est_cm - cm))
+        worst_vel = max(worst_vel, abs(est_vel - closing))
+        if not (spike_every and n % spike_every == spike_every - 1):
+            unconfident += not confident
+    return worst_cm, worst_vel, unconfident
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cc", default="cc", help="host C compiler")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--plot", help="write every sample of every profile to this CSV")
+    args = parser.parse_args()
+
+    lib = build(args.cc)
+    rng = random.Random(args.seed)
+    failed = 0
+    csv = open(args.plot, "w") if args.plot else None
+    if csv:
+        csv.write("profile,t,truth_cm,truth_mm_s,reading,cm,closing_mm_s,confident\n")
+
+    print("%-18s %9s %13s %11s" % ("profile", "range(cm)", "closing(mm/s)", "unconfident"))
+    for name, truth, duration, settle, cm_tol, vel_tol, spikes in PROFILES:
+        rows = run(lib, truth, duration, spikes, rng)
+        worst_cm, worst_vel, unconfident = check(rows, settle, spikes)
+        ok = worst_cm <= cm_tol and worst_vel <= vel_tol and not unconfident
+        failed += not ok
+        print("%-18s %5.1f/%-3d %7.0f/%-5d %11d  %s" % (name, worst_cm, cm_tol, worst_vel, vel_tol,
+                                                       unconfident, "ok" if ok else "FAIL"))
+        if csv:
+            for row in rows:
+                csv.write("%s,%s\n" % (name, ",".join("" if v is None else str(v) for v in row)))
+    if csv:
+        csv.close()
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,385 @@
+"""
+Train the transmitter obstacle classifier and export it as int8 tables.
+
+The transmitter classes the last WINDOW readings of each sensor as a solid
+obstacle, a soft one, a ground reflection or noise (see obstacle_class.h)
+with a fully connected network, FEATURES inputs, HIDDEN ReLU units and one
+output per class, run by CMSIS-NN on the target. It is trained here in
+floating point by mini-batch SGD, on windows either simulated from the
+class models below or read from a capture (--data), then quantised to q7
+with power-of-two scales, the form arm_fully_connected_q7 takes: each
+layer gets the bias and output shifts that line up its weights, biases
+and outputs. The tables and shifts are written to:
+
+    - firmware/transmitter_node/Core/Inc/obstacle_net.h
+
+Float and q7 accuracy on held-out windows are printed and written to the
+header. `features` and `infer_q7` reproduce the firmware bit for bit;
+tools/obstacle_check.py checks the build against them. Run from any
+directory:
+
+    python tools/train_obstacle_net.py
+    python tools/train_obstacle_net.py --data windows.csv
+
+A capture has one window per line, "<class>,<cm>,...,<cm>" with the
+class name and WINDOW readings, oldest first, 255 for no echo.
+"""
+import argparse
+import math
+import os
+import random
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+# --------------------------------------------------------------------------
+# Network specification
+# --------------------------------------------------------------------------
+
+#: Readings per window, OBS_WINDOW in obstacle_class.h
+WINDOW = 8
+
+#: Inputs, OBS_FEATURES: range, spread, echo rate, trend
+FEATURES = 4
+
+#: Hidden units
+HIDDEN = 12
+
+#: Classes, in the order of ObsClassTypeDef
+CLASSES = ("solid", "soft", "ground", "noise")
+
+#: Reading without an echo, OBS_NO_ECHO
+NO_ECHO = 255
+
+#: Loss weight of each class; missing an obstacle costs more than a
+#: false alarm, so the obstacles weigh more
+CLASS_WEIGHT = (3.0, 2.0, 1.0, 1.0)
+
+#: Simulated windows per class, for training and for the held-out check
+TRAIN_PER_CLASS = 1500
+TEST_PER_CLASS = 500
+
+#: Training
+EPOCHS = 40
+BATCH = 16
+RATE = 0.05
+MOMENTUM = 0.9
+SEED = 7
+
+# --------------------------------------------------------------------------
+# Class models, readings once per 60 ms schedule cycle
+# --------------------------------------------------------------------------
+
+
+def _readings(rng, start, speed, sigma, dropout):
+    out = []
+    for k in range(WINDOW):
+        if rng.random() < dropout:
+            out.append(NO_ECHO)
+        else:
+            out.append(min(254, max(2, int(round(start + speed * k + rng.gauss(0, sigma))))))
+    return out
+
+
+def simulate(label, rng):
+    """Return WINDOW readings (cm) of one window of a class."""
+    if label == "solid":
+        # A bumper or wall: steady echoes, approached at up to 0.7 m/s
+        return _readings(rng, rng.uniform(20, 240), rng.uniform(-4, 1.5), 1.0, 0.03)
+    if label == "soft":
+        # A hedge or clothing: scattered, often missed echoes
+        return _readings(rng, rng.uniform(20, 200), rng.uniform(-3, 1), rng.uniform(3, 10),
+                         rng.uniform(0.15, 0.45))
+    if label == "ground":
+        # The road under the beam: far, still, intermittent
+        return _readings(rng, rng.uniform(110, 250), rng.uniform(-0.5, 0.5), rng.uniform(2, 6),
+                         rng.uniform(0.3, 0.7))
+    # Crosstalk and stray echoes: anywhere, now and then
+    hits = rng.uniform(0.1, 0.5)
+    return [int(rng.uniform(2, 254)) if rng.random() < hits else NO_ECHO for _ in range(WINDOW)]
+
+
+def dataset(per_class, rng):
+    data = [(simulate(label, rng), c) for c, label in enumerate(CLASSES) for _ in range(per_class)]
+    rng.shuffle(data)
+    return data
+
+
+def load(path):
+    """Read a capture of labelled windows."""
+    data = []
+    with open(path) as f:
+        for line in f:
+            fields = line.strip().split(",")
+            if len(fields) != WINDOW + 1 or fields[0] not in CLASSES:
+                continue
+            data.append(([int(v) for v in fields[1:]], CLASSES.index(fields[0])))
+    return data
+
+# --------------------------------------------------------------------------
+# Firmware arithmetic (obstacle_class.c, arm_fully_connected_q7)
+# --------------------------------------------------------------------------
+
+
+def _cdiv(a, b):
+    """C integer division, truncating toward zero."""
+    q = abs(a) // abs(b)
+    return q if (a >= 0) == (b >= 0) else -q
+
+
+def _clamp(v):
+    return max(-127, min(127, v))
+
+
+def features(window):
+    """ObsClass_Features of WINDOW readings, oldest first."""
+    hits = [(i, x) for i, x in enumerate(window) if x != NO_ECHO]
+    n = len(hits)
+    if not n:
+        return [127, 0, 0, 0]
+    sx = sum(x for _, x in hits)
+    si = sum(i for i, _ in hits)
+    six = sum(i * x for i, x in hits)
+    sii = sum(i * i for i, _ in hits)
+    mean = (sx + n // 2) // n
+    dev = sum(abs(x - mean) for _, x in hits)
+    num = n * six - si * sx
+    den = n * sii - si * si
+    return [mean // 2, _clamp((dev + n // 2) // n), n * 127 // WINDOW,
+            _clamp(_cdiv(num * 4, den)) if den else 0]
+
+
+def fully_connected_q7(vec, weights, rows, bias, bias_shift, out_shift):
+    """arm_fully_connected_q7, reference loops, rounding on."""
+    dim = len(vec)
+    out = []
+    for r in range(rows):
+        acc = (bias[r] << bias_shift) + (1 << (out_shift - 1))
+        acc += sum(vec[j] * weights[r * dim + j] for j in range(dim))
+        out.append(max(-128, min(127, acc >> out_shift)))
+    return out
+
+
+def infer_q7(net, feats):
+    """ObsClass_Infer: return (class, scores)."""
+    hidden = fully_connected_q7(feats, net["w1"], HIDDEN, net["b1"], net["l1_bias_shift"], net["l1_out_shift"])
+    hidden = [max(0, h) for h in hidden]
+    scores = fully_connected_q7(hidden, net["w2"], len(CLASSES), net["b2"], net["l2_bias_shift"],
+                                net["l2_out_shift"])
+    return scores.index(max(scores)), scores
+
+# --------------------------------------------------------------------------
+# Float network
+# --------------------------------------------------------------------------
+
+
+def _inputs(window):
+    return [f / 128.0 for f in features(window)]
+
+
+def forward(model, x):
+    w1, b1, w2, b2 = model
+    h = [max(0.0, b1[r] + sum(w1[r][j] * x[j] for j in range(FEATURES))) for r in range(HIDDEN)]
+    z = [b2[c] + sum(w2[c][r] * h[r] for r in range(HIDDEN)) for c in range(len(CLASSES))]
+    return h, z
+
+
+def train(data, rng):
+    """Return (w1, b1, w2, b2) trained on [(window, class)]."""
+    k1 = math.sqrt(2.0 / FEATURES)
+    k2 = math.sqrt(2.0 / HIDDEN)
+    w1 = [[rng.gauss(0, k1) for _ in range(FEATURES)] for _ in range(HIDDEN)]
+    b1 = [0.0] * HIDDEN
+    w2 = [[rng.gauss(0, k2) for _ in range(HIDDEN)] for _ in range(len(CLASSES))]
+    b2 = [0.0] * len(CLASSES)
+    model = (w1, b1, w2, b2)
+    params = [w1, b1, w2, b2]
+    velocity = [[[0.0] * len(row) for row in p] if isinstance(p[0], list) else [0.0] * len(p) for p in params]
+    samples = [(_inputs(w), c) for w, c in data]
+
+    for epoch in range(EPOCHS):
+        rate = RATE * (0.5 * (1.0 + math.cos(math.pi * epoch / EPOCHS)))
+        rng.shuffle(samples)
+        for start in range(0, len(samples), BATCH):
+            batch = samples[start:start + BATCH]
+            gw1 = [[0.0] * FEATURES for _ in range(HIDDEN)]
+            gb1 = [0.0] * HIDDEN
+            gw2 = [[0.0] * HIDDEN for _ in range(len(CLASSES))]
+            gb2 = [0.0] * len(CLASSES)
+            for x, c in batch:
+                h, z = forward(model, x)
+                top = max(z)
+                e = [math.exp(v - top) for v in z]
+                total = sum(e)
+                dz = [CLASS_WEIGHT[c] * (e[k] / total - (k == c)) / len(batch) for k in range(len(CLASSES))]
+                for k in range(len(CLASSES)):
+                    gb2[k] += dz[k]
+                    for r in range(HIDDEN):
+                        gw2[k][r] += dz[k] * h[r]
+                for r in range(HIDDEN):
+                    if h[r] <= 0.0:
+                        continue
+                    dh = sum(dz[k] * w2[k][r] for k in range(len(CLASSES)))
+                    gb1[r] += dh
+                    for j in range(FEATURES):
+                        gw1[r][j] += dh * x[j]
+            for p, g, v in zip(params, (gw1, gb1, gw2, gb2), velocity):
+                if isinstance(p[0], list):
+                    for row, grow, vrow in zip(p, g, v):
+                        for j in range(len(row)):
+                            vrow[j] = MOMENTUM * vrow[j] - rate * grow[j]
+                            row[j] += vrow[j]
+                else:
+                    for j in range(len(p)):
+                        v[j] = MOMENTUM * v[j] - rate * g[j]
+                        p[j] += v[j]
+    return model
+
+
+def accuracy_float(model, data):
+    hits = 0
+    for w, c in data:
+        _, z = forward(model, _inputs(w))
+        hits += z.index(max(z)) == c
+    return hits / float(len(data))
+
+
+def accuracy_q7(net, data):
+    return sum(infer_q7(net, features(w))[0] == c for w, c in data) / float(len(data))
+
+# --------------------------------------------------------------------------
+# Quantisation
+# --------------------------------------------------------------------------
+
+
+def _frac_bits(peak):
+    """Fraction bits that fit peak in q7."""
+    if peak <= 0.0:
+        return 7
+    return int(math.floor(math.log(127.0 / peak, 2)))
+
+
+def _layer(weights, bias, in_frac, out_peak):
+    """Quantise one layer; return (q7 weights, q7 bias, bias_shift, out_shift, out_frac)."""
+    w_frac = _frac_bits(max(abs(v) for row in weights for v in row))
+    b_frac = min(_frac_bits(max(abs(v) for v in bias)), in_frac + w_frac)
+    out_frac = min(_frac_bits(out_peak), in_frac + w_frac - 1)
+    qw = [max(-128, min(127, int(round(v * 2.0 ** w_frac))))
+          for row in weights for v in row]
+    qb = [max(-128, min(127, int(round(v * 2.0 ** b_frac)))) for v in bias]
+    return qw, qb, in_frac + w_frac - b_frac, in_frac + w_frac - out_frac, out_frac
+
+
+def quantise(model, data):
+    """Return the q7 network of a float model, scaled on data."""
+    w1, b1, w2, b2 = model
+    peak_h = peak_z = 0.0
+    for w, _ in data:
+        h, z = forward(model, _inputs(w))
+        peak_h = max(peak_h, max(h))
+        peak_z = max(peak_z, max(abs(v) for v in z))
+    qw1, qb1, bs1, os1, h_frac = _layer(w1, b1, 7, peak_h)
+    qw2, qb2, bs2, os2, z_frac = _layer(w2, b2, h_frac, peak_z)
+    return {"w1": qw1, "b1": qb1, "l1_bias_shift": bs1, "l1_out_shift": os1, "hidden_frac": h_frac,
+            "w2": qw2, "b2": qb2, "l2_bias_shift": bs2, "l2_out_shift": os2, "score_frac": z_frac}
+
+
+def parse_header(path):
+    """Read the q7 network back from obstacle_net.h."""
+    net = {}
+    with open(path) as f:
+        text = f.read().replace("\\\n", " ")
+    for line in text.splitlines():
+        parts = line.split(None, 2)
+        if len(parts) < 3 or parts[0] != "#define" or not parts[1].startswith("OBS_NET_"):
+            continue
+        key = parts[1][len("OBS_NET_"):].lower()
+        value = parts[2].strip()
+        if value.startswith("{"):
+            net[key] = [int(v) for v in value.strip("{} ").split(",")]
+        else:
+            net[key] = int(value.rstrip("u"))
+    return net
+
+
+def _rows(values, width):
+    return ",\n    ".join(", ".join("%4d" % v for v in values[i:i + width])
+                          for i in range(0, len(values), width))
+
+
+def write_c_header(path, net, float_acc, q7_acc, source):
+    text = """\
+/**
+ * @file    obstacle_net.h
+ * @ingroup Transmitter_Node
+ * @brief   Weights of the obstacle classifier (generated, do not edit).
+ *
+ * Generated by tools/train_obstacle_net.py from %s. Held-out
+ * accuracy %.1f%% in float, %.1f%% in q7. Fraction bits: 7 in the
+ * inputs, %d in the hidden units, %d in the scores.
+ */
+#ifndef __OBSTACLE_NET_H
+#define __OBSTACLE_NET_H
+
+/** Layer sizes */
+#define OBS_NET_INPUTS          %du
+#define OBS_NET_HIDDEN          %du
+#define OBS_NET_CLASSES         %du
+
+/** Shifts of arm_fully_connected_q7 */
+#define OBS_NET_L1_BIAS_SHIFT   %du
+#define OBS_NET_L1_OUT_SHIFT    %du
+#define OBS_NET_L2_BIAS_SHIFT   %du
+#define OBS_NET_L2_OUT_SHIFT    %du
+
+/** Hidden layer: one row of OBS_NET_INPUTS weights per unit, then biases */
+#define OBS_NET_W1 { \\
+    %s }
+#define OBS_NET_B1 { %s }
+
+/** Output layer: one row of OBS_NET_HIDDEN weights per class, then biases */
+#define OBS_NET_W2 { \\
+    %s }
+#define OBS_NET_B2 { %s }
+
+#endif /* __OBSTACLE_NET_H */
+""" % (source, 100 * float_acc, 100 * q7_acc, net["hidden_frac"], net["score_frac"],
+       FEATURES, HIDDEN, len(CLASSES),
+       net["l1_bias_shift"], net["l1_out_shift"], net["l2_bias_shift"], net["l2_out_shift"],
+       _rows(net["w1"], FEATURES).replace("\n", " \\\n"), ", ".join("%d" % v for v in net["b1"]),
+       _rows(net["w2"], HIDDEN).replace("\n", " \\\n"), ", ".join("%d" % v for v in net["b2"]))
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--data", help="capture of labelled windows instead of simulated ones")
+    parser.add_argument("--seed", type=int, default=SEED)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    if args.data:
+        data = load(args.data)
+        rng.shuffle(data)
+        split = len(data) * TEST_PER_CLASS // (TRAIN_PER_CLASS + TEST_PER_CLASS)
+        test, data = data[:split], data[split:]
+        source = os.path.basename(args.data)
+    else:
+        data = dataset(TRAIN_PER_CLASS, rng)
+        test = dataset(TEST_PER_CLASS, rng)
+        source = "simulated windows"
+
+    model = train(data, rng)
+    net = quantise(model, data)
+    float_acc = accuracy_float(model, test)
+    q7_acc = accuracy_q7(net, test)
+    write_c_header(os.path.join(ROOT, "firmware", "transmitter_node", "Core", "Inc", "obstacle_net.h"),
+                   net, float_acc, q7_acc, source)
+    print("%d windows: held-out accuracy %.1f%% float, %.1f%% q7; shifts %d/%d, %d/%d"
+          % (len(data), 100 * float_acc, 100 * q7_acc, net["l1_bias_shift"], net["l1_out_shift"],
+             net["l2_bias_shift"], net["l2_out_shift"]))
+    return 0
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,196 @@
+"""
+Check the accuracy and cost of the transmitter trilateration.
+
+Compiles firmware/transmitter_node/Core/Src/trilateration.c into a shared
+library with the host C compiler, once with the plain C square root and once
+with arm_sqrt_q15 (TRILAT_USE_CMSIS=1, from the vendored CMSIS-DSP sources),
+and places an obstacle on a grid of positions in front of the bumper. For
+each position seen by both beams, the two ranges are rounded to whole cm as
+they go on the bus and solved. Per build this prints:
+
+    - the arithmetic error against the exact intersection of the same
+      rounded ranges, which has to stay within TOL_MM;
+    - the total error against the true position, which is mostly the
+      1 cm range resolution magnified by the geometry, per distance band.
+
+The cycle cost can only be measured on the target: Tx_Report writes
+"TRI,<sqrt>,<avg_cycles>,<worst_cycles>,<fixes>,<solves>" lines on USART2,
+which are summarised per build when captures (or a serial port) are given:
+
+    python tools/trilat_check.py
+    python tools/trilat_check.py --log tri_isqrt.txt tri_cmsis.txt
+"""
+import argparse
+import ctypes
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+NODE = os.path.join(ROOT, "firmware", "transmitter_node")
+SRC = os.path.join(NODE, "Core", "Src", "trilateration.c")
+INC = os.path.join(NODE, "Core", "Inc")
+DSP = os.path.join(NODE, "Drivers", "CMSIS", "DSP")
+
+#: Sensor spacing (mm), TRILAT_BASELINE_MM in trilateration.h
+BASELINE_MM = 300
+
+#: Half-angle of each sensor's beam (degrees)
+BEAM_HALF_DEG = 30
+
+#: Longest range sent (mm), below USENSOR_NO_ECHO
+MAX_RANGE_MM = 2540
+
+#: Largest arithmetic error allowed (mm)
+TOL_MM = 1.0
+
+#: Upper limits of the distance bands of the total error (mm)
+BANDS_MM = (500, 1000, 1500, 2500)
+
+#: Core clock of the transmitter (Hz)
+CPU_HZ = 72000000
+
+
+class Fix(ctypes.Structure):
+    """TrilatFixTypeDef"""
+    _fields_ = [("lateral_mm", ctypes.c_int16), ("forward_mm", ctypes.c_uint16)]
+
+
+def build(cc, cmsis):
+    """Compile the solver and return the loaded library."""
+    out = os.path.join(tempfile.mkdtemp(), "trilateration.so")
+    cmd = [cc, "-O2", "-shared", "-fPIC", "-I", INC, SRC, "-o", out]
+    if cmsis:
+        cmd += ["-DTRILAT_USE_CMSIS=1", "-DARM_MATH_CM3", "-w",
+                "-I", os.path.join(DSP, "Include"),
+                "-I", os.path.join(NODE, "Drivers", "CMSIS", "Include"),
+                os.path.join(DSP, "Source", "FastMathFunctions", "arm_sqrt_q15.c")]
+    else:
+        cmd += ["-Wall", "-Wextra"]
+    subprocess.check_call(cmd)
+    lib = ctypes.CDLL(out)
+    lib.Trilat_Solve.argtypes = [ctypes.c_uint16, ctypes.c_uint16, ctypes.POINTER(Fix)]
+    lib.Trilat_Solve.restype = ctypes.c_uint8
+    return lib
+
+
+def in_beam(sensor_x, x, y):
+    return y > 0 and abs(math.degrees(math.atan2(x - sensor_x, y))) <= BEAM_HALF_DEG
+
+
+def exact(r0, r1):
+    """Exact intersection of two ranges, or None."""
+    x = (r0 * r0 - r1 * r1) / (2.0 * BASELINE_MM)
+    y2 = r0 * r0 - (x + BASELINE_MM / 2.0) ** 2
+    return (x, math.sqrt(y2)) if y2 >= 0 else None
+
+
+def check(lib):
+    """Return (positions, fixes, worst arithmetic error, {band: total errors})."""
+    fix = Fix()
+    positions = fixes = 0
+    worst = 0.0
+    bands = {band: [] for band in BANDS_MM}
+    half = BASELINE_MM / 2.0
+    for y in range(100, BANDS_MM[-1] + 1, 20):
+        for x in range(-1200, 1201, 20):
+            if not (in_beam(-half, x, y) and in_beam(half, x, y)):
+                continue
+            r0 = int(round(math.hypot(x + half, y) / 10.0)) * 10
+            r1 = int(round(math.hypot(x - half, y) / 10.0)) * 10
+            if max(r0, r1) > MAX_RANGE_MM:
+                continue
+            positions += 1
+            if not lib.Trilat_Solve(r0, r1, ctypes.byref(fix)):
+                continue
+            fixes += 1
+            ex, ey = exact(r0, r1)
+            worst = max(worst, abs(fix.lateral_mm - ex), abs(fix.forward_mm - ey))
+            band = next(b for b in BANDS_MM if y <= b)
+            bands[band].append((abs(fix.lateral_mm - x), abs(fix.forward_mm - y)))
+    return positions, fixes, worst, bands
+
+
+def parse_text(line):
+    """Parse one "TRI,..." line into (sqrt, avg, worst, fixes, solves); None otherwise."""
+    fields = line.strip().split(",")
+    if len(fields) != 6 or fields[0] != "TRI":
+        return None
+    try:
+        return (fields[1],) + tuple(int(f) for f in fields[2:])
+    except ValueError:
+        return None
+
+
+def read_text(source, baudrate):
+    if os.path.isfile(source):
+        with open(source) as f:
+            lines = list(f)
+    else:
+        import serial
+        ser = serial.Serial(source, baudrate, timeout=1)
+        lines = (ser.readline().decode("ascii", "replace") for _ in iter(int, 1))
+    for line in lines:
+        stats = parse_text(line)
+        if stats:
+            yield stats
+
+
+def report_cost(sources, baudrate, hz):
+    """Print the target cycles per solve of each build found in the captures."""
+    builds = {}
+    try:
+        for source in sources:
+            for name, avg, worst, fixes, solves in read_text(source, baudrate):
+                cycles, n, w, f = builds.get(name, (0, 0, 0, 0))
+                builds[name] = (cycles + avg * solves, n + solves, max(w, worst), f + fixes)
+    except KeyboardInterrupt:
+        pass
+    builds = {k: v for k, v in builds.items() if v[1]}
+    if not builds:
+        print("no trilateration reports found")
+        return 1
+    best = min(c / float(n) for c, n, _, _ in builds.values())
+    print("%-6s %9s %7s %8s %8s %7s" % ("sqrt", "avg(cyc)", "worst", "avg(us)", "fixes", "vs best"))
+    for name, (cycles, n, worst, fixes) in sorted(builds.items(), key=lambda i: i[1][0] / i[1][1]):
+        avg = cycles / float(n)
+        print("%-6s %9.0f %7d %8.2f %7.0f%% %6.2fx" % (name, avg, worst, avg * 1e6 / hz,
+                                                     100.0 * fixes / n, avg / best))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cc", default="cc", help="host C compiler")
+    parser.add_argument("--log", nargs="+", help="serial port or captures with TRI lines")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--hz", type=int, default=CPU_HZ, help="core clock (Hz)")
+    args = parser.parse_args()
+
+    failed = 0
+    for name, cmsis in (("isqrt", False), ("cmsis", True)):
+        positions, fixes, worst, bands = check(build(args.cc, cmsis))
+        ok = worst <= TOL_MM and fixes == positions
+        failed += not ok
+        print("%s: %d/%d positions fixed, arithmetic error %.2f mm (limit %.1f)  %s"
+              % (name, fixes, positions, worst, TOL_MM, "ok" if ok else "FAIL"))
+        print("  %-12s %14s %14s" % ("distance", "lateral rms/max", "forward rms/max"))
+        low = 0
+        for band in BANDS_MM:
+            errors = bands[band]
+            if errors:
+                rms = [math.sqrt(sum(e[i] ** 2 for e in errors) / len(errors)) for i in (0, 1)]
+                print("  %4d-%-4d mm %7.0f/%-6.0f %7.0f/%-6.0f" % (
+                    low, band, rms[0], max(e[0] for e in errors), rms[1], max(e[1] for e in errors)))
+            low = band
+
+    if args.log:
+        print("")
+        failed += report_cost(args.log, args.baudrate, args.hz)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
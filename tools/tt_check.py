@@ -0,0 +1,132 @@
+"""
+Check the transmitter's time-triggered schedule before it is built.
+
+Reads TT_CYCLE_MS from tt_sched.h, the slot table from tt_sched.c and
+USENSOR_COUNT from usensor.h, prints the cycle as a timeline and checks the
+rules listed in tt_sched.h:
+  - every slot lies inside the cycle;
+  - trigger, CAN and report slots do not overlap each other;
+  - echo windows do not overlap each other;
+  - each sensor has one trigger and one echo window starting with it.
+
+Usage:
+    python tools/tt_check.py
+    python tools/tt_check.py firmware/transmitter_node/Core
+
+The transmitter Keil project runs it as a before-build step. It exits with
+status 1 when a rule is broken, which stops the build.
+"""
+import argparse
+import os
+import re
+import sys
+
+_CYCLE = re.compile(r"#define\s+TT_CYCLE_MS\s+(\d+)u?")
+_COUNT = re.compile(r"#define\s+USENSOR_COUNT\s+(\d+)u?")
+_ROW = re.compile(r"\{\s*(TT_\w+)\s*,\s*(\d+)u?\s*,\s*(\d+)u?\s*,\s*(\d+)u?\s*\}")
+
+#: Slots that run code on the CPU for their whole length
+ACTIVE = ("TT_TRIGGER", "TT_CAN_TX", "TT_REPORT")
+
+
+def default_core():
+    return os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                        "..", "firmware", "transmitter_node", "Core")
+
+
+def read_define(path, pattern):
+    with open(path) as f:
+        match = pattern.search(f.read())
+    if not match:
+        raise ValueError("%s: %s not found" % (path, pattern.pattern))
+    return int(match.group(1))
+
+
+def read_table(path):
+    """Return the ttTable rows as (action, sensor, offset, length) tuples."""
+    with open(path) as f:
+        text = f.read()
+    start = text.find("ttTable[]")
+    end = text.find("};", start)
+    if start < 0 or end < 0:
+        raise ValueError("%s: ttTable not found" % path)
+    return [(m.group(1), int(m.group(2)), int(m.group(3)), int(m.group(4)))
+            for m in _ROW.finditer(text[start:end])]
+
+
+def overlaps(a, b):
+    return a[2] < b[2] + b[3] and b[2] < a[2] + a[3]
+
+
+def check(table, cycle, sensors):
+    """Return the list of rule violations."""
+    errors = []
+    for row in table:
+        action, sensor, offset, length = row
+        if length == 0 or offset + length > cycle:
+            errors.append("%s sensor %d [%d, %d) is outside the %d ms cycle"
+                          % (action, sensor, offset, offset + length, cycle))
+
+    for kinds, what in ((ACTIVE, "CPU slots"), (("TT_ECHO",), "echo windows")):
+        rows = [r for r in table if r[0] in kinds]
+        for i, a in enumerate(rows):
+            for b in rows[i + 1:]:
+                if overlaps(a, b):
+                    errors.append("%s overlap: %s %d at %d ms and %s %d at %d ms"
+                                  % (what, a[0], a[1], a[2], b[0], b[1], b[2]))
+
+    for sensor in range(sensors):
+        triggers = [r for r in table if r[0] == "TT_TRIGGER" and r[1] == sensor]
+        echoes = [r for r in table if r[0] == "TT_ECHO" and r[1] == sensor]
+        if len(triggers) != 1 or len(echoes) != 1:
+            errors.append("sensor %d has %d trigger and %d echo slots, expected 1 each"
+                          % (sensor, len(triggers), len(echoes)))
+        elif triggers[0][2] != echoes[0][2]:
+            errors.append("sensor %d echo window starts at %d ms, its trigger at %d ms"
+                          % (sensor, echoes[0][2], triggers[0][2]))
+    for row in table:
+        if row[0] in ("TT_TRIGGER", "TT_ECHO") and row[1] >= sensors:
+            errors.append("%s for sensor %d, only %d sensors" % (row[0], row[1], sensors))
+    return errors
+
+
+def timeline(table, cycle):
+    """One line per slot, one character per millisecond."""
+    lines = []
+    order = sorted(table, key=lambda r: (r[2], r[0] == "TT_ECHO", r[0]))
+    for action, sensor, offset, length in order:
+        bar = "." * offset + "#" * length
+        bar = (bar + "." * cycle)[:max(cycle, offset + length)]
+        lines.append("%-11s %d %3d-%-3d |%s|" % (action, sensor, offset, offset + length, bar))
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("core", nargs="?", default=default_core(),
+                        help="transmitter Core directory (default: from this script)")
+    args = parser.parse_args()
+
+    try:
+        cycle = read_define(os.path.join(args.core, "Inc", "tt_sched.h"), _CYCLE)
+        sensors = read_define(os.path.join(args.core, "Inc", "usensor.h"), _COUNT)
+        table = read_table(os.path.join(args.core, "Src", "tt_sched.c"))
+    except (OSError, ValueError) as err:
+        print("tt_check: error: %s" % err)
+        return 1
+
+    print("schedule: %d slots, %d ms cycle, %d sensors" % (len(table), cycle, sensors))
+    for line in timeline(table, cycle):
+        print(line)
+
+    errors = check(table, cycle, sensors)
+    for err in errors:
+        print("tt_check: error: %s" % err)
+    if errors:
+        return 1
+    print("schedule OK")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())